@@ -65,6 +65,13 @@
 #define MODBUS_VALIDITY_INTERVAL 250       // 250 milliseconds
 
 // Manager Configuration -------------------------------------------------------------------
+// Managers task wakeups (see managers/managerEvents.h)
+#define MANAGERS_IDLE_WAKEUP_MS 1000               // Longest sleep without an event, socket data or deadline
+#define MANAGERS_MIN_PASS_INTERVAL_MS 5            // Spacing between passes under a sustained event stream
+#define MANAGERS_BUSY_INTERVAL_MS 50               // Pass interval while a manager has paced background work
+#define MANAGERS_FALLBACK_POLL_MS 50               // Poll interval when eventfd is unavailable
+#define MANAGERS_MAX_WATCHED_PORTS 4              // Local ports whose sockets wake the managers task
+
 // NetworkingManager (Ethernet) Constants
 #define NETWORKING_CONNECT_TIMEOUT_MS 30000 // How long to wait for IP after cable plugged (30 seconds)
 #define NETWORKING_RETRY_INTERVAL_MS 5000   // Wait before retrying ethernet connection (5 seconds)
@@ -75,17 +82,144 @@
 #define CONNECTIVITY_PING_INTERVAL_MS 30000  // 30 seconds between connectivity checks
 #define CONNECTIVITY_RETRY_INTERVAL_MS 10000 // 10 seconds retry interval on failure
 #define CONNECTIVITY_PING_HOST "www.novalogic.io" // Default ping target
+#define CONNECTIVITY_NTP_SERVER "pool.ntp.org"   // Wall-clock time for stored telemetry
 
 // ServicesManager (MQTT) Constants
-#define SERVICES_CONNECT_RETRY_INTERVAL_MS 15000 // Wait before retrying MQTT connect (ms)
+#define SERVICES_RETRY_BASE_MS 2000              // First reconnect delay is 1-3x this (ms)
+#define SERVICES_RETRY_CAP_MS 300000             // Longest reconnect delay (ms)
+#define SERVICES_RETRY_STABLE_MS 60000           // Connection lifetime that resets the backoff (ms)
 #define SERVICES_KEEPALIVE_INTERVAL_MS 10000     // MQTT keepalive interval (ms)
 #define SERVICES_CONNECTION_TIMEOUT_MS 30000     // MQTT connection timeout (ms)
+#define SERVICES_MAX_REGISTERED 4                // ServicesManager registry size
+#define SERVICES_TASK_STACK_SIZE 8192            // Services registered with their own task
+#define SERVICES_TASK_PRIORITY 5                 // Below the managers (8) and display (7) tasks
+#define SERVICES_TASK_INTERVAL_MS 50             // Longest sleep between loop() calls on a service task
 
 // TagoIO Service Constants
 #define TAGOIO_UPDATE_INTERVAL 60000               // 60 seconds
+#define TAGOIO_BATCH_MAX_VARIABLES 48              // Distinct variables merged per send interval
+#define TAGOIO_VARIABLE_NAME_LENGTH 32
+#define TAGOIO_VARIABLE_UNIT_LENGTH 12
+#define TAGOIO_BATCH_ARENA_SIZE 6144               // Serialized batch payload
+#define TAGOIO_COMPRESSION_ENABLED 0               // 1 = LZSS data and backfill blocks on the .../lzss topics (needs the payload parser, 1 KB window slots)
+#define UPLINK_DICTIONARY_SIZE 256                 // Preset dictionary (UPLINK_DICTIONARY) upper bound
+#define UPLINK_COMPRESSED_SIZE 3072                // Payloads compressing to more are sent uncompressed
+
+// Telemetry Constants
+#define TELEMETRY_BUFFER_SIZE 512                  // Encoded snapshot (a full keyframe needs ~330 bytes)
+#define TELEMETRY_KEYFRAME_INTERVAL 10             // Delta snapshots between keyframes
+#define TELEMETRY_STORE_DIRECTORY "/outbox"        // Store-and-forward segment files
+#define TELEMETRY_STORE_CURSOR_FILE "/outbox/cursor"
+#define TELEMETRY_STORE_SEGMENT_SIZE 16384         // Rotate to a new segment file at this size
+#define TELEMETRY_STORE_TOTAL_LIMIT (512 * 1024)   // Oldest segments are dropped above this
+#define TELEMETRY_STORE_RECORD_SIZE 384            // Largest stored payload (one standalone keyframe)
+#define TELEMETRY_STORE_CURSOR_SAVE_RECORDS 16     // Replay cursor is persisted every N acknowledged records
+#define TELEMETRY_STORE_INTERVAL_MS 30000          // Snapshot interval while offline
+#define TELEMETRY_BACKFILL_INTERVAL_MS 500         // Replay pacing once back online
+#define TELEMETRY_BACKFILL_BURST 5                 // Stored records (compressed: blocks) sent per backfill interval
+#define TELEMETRY_BACKFILL_BLOCK_SIZE 2048         // Stored records compressed together into one backfill publish
+#define TELEMETRY_BACKFILL_BLOCK_COMPRESSED_SIZE 1024  // Largest compressed block (halved and retried above)
+#define TELEMETRY_TEXT_LENGTH 16                   // Longest formatted channel value ("-2147483648.00")
+#define TELEMETRY_JSON_SIZE 2560                   // Every valid channel as one JSON object (~1.9 KB)
+
+// Local MQTT Broker Constants
+#define LOCAL_BROKER_ENABLED 1                     // 0 = no on-device broker for LAN consumers
+#define LOCAL_BROKER_PORT 1883
+#define LOCAL_BROKER_MAX_CLIENTS 4                 // Further CONNECTs are refused (server unavailable)
+#define LOCAL_BROKER_TOPIC_PREFIX "genset"         // genset/<channel>, genset/snapshot, genset/status
+#define LOCAL_BROKER_TOPIC_LENGTH 48
+
+// HTTP Server Constants (LAN, Ethernet interface)
+#define HTTP_SERVER_ENABLED 1                      // 0 = no LAN HTTP server (metrics, dashboard)
+#define HTTP_SERVER_PORT 80
+#define HTTP_SERVER_REQUEST_SIZE 512               // Request line and headers kept (the rest is skipped)
+#define HTTP_SERVER_WRITE_BUFFER_SIZE 512          // Response bytes gathered per socket write
+#define HTTP_SERVER_REQUEST_TIMEOUT_MS 2000        // Complete request headers within this time
+#define HTTP_SERVER_POLL_INTERVAL_MS 50            // Accept and event poll interval
+#define HTTP_SERVER_EVENT_CLIENTS 3                // Concurrent /events streams; further ones get 503
+#define HTTP_SERVER_EVENT_SEND_TIMEOUT_MS 250      // A stream that cannot take an event in time is closed
+#define HTTP_SERVER_EVENT_KEEPALIVE_MS 15000       // Comment line on otherwise idle streams
+#define HTTP_SERVER_STATUS_INTERVAL_MS 1000        // Status is rebuilt at this interval, sent when it changed
+#define HTTP_SERVER_STATUS_SIZE 256
+#define HTTP_SERVER_DASHBOARD_FILE "/www/index.html.gz"   // LittleFS, built by scripts/buildweb.py
+#define HTTP_SERVER_TASK_STACK_SIZE 6144
+#define HTTP_SERVER_TASK_PRIORITY 3                // Below the services (5), managers (8) and display (7) tasks
+
+// Metrics Constants
+#define METRICS_PREFIX "dl1000_"                   // Metric name prefix
+#define METRICS_HISTOGRAM_MAX_BUCKETS 12
+
+// Remote Configuration Constants
+#define CONFIG_ERROR_LENGTH 64                     // Reason a configuration document was rejected
+#define CONFIG_STATUS_SIZE 512                     // config/status reply (result and applied configuration)
+
+// Logging Constants
+#define LOG_RING_BUFFER_SIZE 8192                  // Deferred log record ring buffer (bytes)
+#define LOG_MAX_STRING_ARG_LENGTH 64               // String arguments are copied and truncated to this length
+#define LOG_LINE_BUFFER_SIZE 320                   // Formatted message buffer used by the drain task
+#define LOG_RECORD_BUFFER_SIZE 512                 // Per-sink encoded record buffer (JSON needs the most)
+#define LOG_DRAIN_TASK_STACK_SIZE 4096
+#define LOG_DRAIN_TASK_PRIORITY 2                  // Below all application tasks
+#define LOG_DRAIN_IDLE_MS 1000                     // Drain task wakes at least this often to flush sinks
+#define LOG_SERIAL_DEFAULT_ENCODING LOG_ENCODING_TEXT
+#define LOG_FILE_DIRECTORY "/logs"
+#define LOG_FILE_DEFAULT_ENCODING LOG_ENCODING_BINARY
+#define LOG_FILE_BLOCK_SIZE 4096                   // Records are written to flash one block at a time
+#define LOG_FILE_SEGMENT_SIZE 65536                // Rotate to a new segment at this size
+#define LOG_FILE_TOTAL_LIMIT (1024 * 1024)         // Oldest segments are deleted above this total
+#define LOG_FILE_FLUSH_INTERVAL_MS 30000           // Flush a partial block after this long
+#define LOG_FILE_HOUSEKEEPING_INTERVAL_MS 5000     // Size limit / compression scan interval
+#define LOG_FILE_MAX_DELETES_PER_PASS 8
+#define LOG_MQTT_DEFAULT_ENCODING LOG_ENCODING_JSON
+#define LOG_MQTT_BATCH_SIZE 1024                   // Largest log batch payload published in one message
+#define LOG_MQTT_FLUSH_INTERVAL_MS 5000            // Publish a partial batch after this long
+#define LOG_MQTT_QUEUE_SIZE 8192                   // Sealed batches waiting for the MQTT link
+#define LOG_MQTT_CONGESTION_PERCENT 50             // Queue fill level at which INFO is sampled and DEBUG dropped
+#define LOG_MQTT_INFO_SAMPLE_RATE 4                // Keep 1 in N INFO records while congested
+#define LOG_MQTT_MAX_BATCHES_PER_LOOP 2            // Batches published per NovaLogicService::loop
+#define LOG_TRANSFER_CHUNK_SIZE 2048               // Stored log bytes per get_logs chunk
+#define LOG_TRANSFER_CHUNK_INTERVAL_MS 100         // Minimum gap between chunks so telemetry keeps flowing
+#define LOG_CRASH_RING_SIZE 4096                   // RTC memory ring kept across warm resets
+#define LOG_CRASH_DEFAULT_ENCODING LOG_ENCODING_TEXT // Readable even if the firmware changed (OTA)
+#define LOG_CRASH_DIRECTORY "/crash"
+#define LOG_CRASH_RING_FILE "/crash/ring.log"
+#define LOG_CRASH_UPLOAD_INTERVAL_MS 500           // Post-mortem chunks are sent slower than log retrieval
+#define LOG_RATE_LIMIT_SITES 64                    // Call sites tracked for flood protection
+#define LOG_RATE_LIMIT_PROBES 4                    // Slots searched before the oldest site is evicted
+#define LOG_RATE_LIMIT_BURST 10                    // Records a call site may log back to back
+#define LOG_RATE_LIMIT_PER_SECOND 1                // Sustained records per second per call site
+#define LOG_REPEAT_FLUSH_MS 10000                  // Longest delay before "repeated N times" is logged
 
 // OTA Update Constants
-#define OTA_CHUNK_SIZE 8192                        // 8KB chunks for OTA writing
+#define OTA_CHUNK_SIZE 4096                        // One flash sector per static OTA chunk
+#define OTA_CHUNK_COUNT 4                          // Chunks in the receive -> flash ring
+#define OTA_REQUIRE_DIGEST 0                       // 1 = refuse images without a prior ota/md5 digest
+#define OTA_WRITE_TIMEOUT_MS 10000                 // Longest wait for the flash writer to free a chunk
+#define OTA_WRITER_TASK_STACK_SIZE 4096
+#define OTA_WRITER_TASK_PRIORITY 2                 // Below the managers, display and LED tasks
+#define OTA_DELTA_SOURCE_BUFFER_SIZE 1024          // Running-image read buffer of the delta patcher
+#define OTA_DELTA_COPY_SLICE OTA_CHUNK_SIZE        // Source bytes a delta COPY hands the writer per pass
+#define OTA_DELTA_VERIFY_SLICE (64 * 1024)         // Source bytes hashed per pass before a delta is applied
+#define OTA_DELTA_DECODE_STEP 128                  // Patch bytes decoded at a time (a paused COPY buffers 9x)
+#define OTA_STREAM_INPUT_SIZE 1024                 // Compressed/patch bytes read from MQTT per step
+#define OTA_COMPRESSED_MAGIC "NLZ1"                // ota/compressed header: magic + image size
+#define OTA_COMPRESSED_HEADER_SIZE 8
+#define OTA_SEGMENT_MAGIC "OTAS"                   // Segment header: magic + stream offset + stream size
+#define OTA_SEGMENT_HEADER_SIZE 12
+#define OTA_SEGMENT_TIMEOUT_MS 30000               // Segmented transfer abandoned without a segment this long
+#define OTA_PROGRESS_INTERVAL_BYTES (64 * 1024)    // ota/status progress message interval
+#define OTA_RESULT_DELAY_MS 2500                   // OTA result shown before restarting / resuming
+#define OTA_HTTP_URL_LENGTH 160                    // Longest ota/url firmware URL
+#define OTA_HTTP_LINE_LENGTH 128                   // Longest HTTP response header line kept
+#define OTA_HTTP_BUFFER_SIZE 4096                  // One flash sector, erased and written whole
+#define OTA_HTTP_SLICE_SIZE (16 * 1024)            // Bytes skipped or verified per loop() call
+#define OTA_HTTP_CHECKPOINT_BYTES (64 * 1024)      // NVS checkpoint interval
+#define OTA_HTTP_TIMEOUT_MS 10000                  // Connect / no-data timeout
+#define OTA_HTTP_CONNECT_TASK_STACK_SIZE 4096      // Name lookup and TCP connect off the managers task
+#define OTA_HTTP_CONNECT_TASK_PRIORITY 2
+#define OTA_HTTP_RETRY_MIN_MS 2000                 // Reconnect backoff, doubled per failure
+#define OTA_HTTP_RETRY_MAX_MS 60000
+#define OTA_HTTP_MAX_RETRIES 10                    // Consecutive failures without progress before giving up
 #define OTA_WATCHDOG_TIMEOUT_SEC 30                // 30 seconds watchdog timeout during OTA
 
 // RGB LED Definitions --------------------------------------------------------------------
@@ -99,6 +233,25 @@
 #define MQTT_SERVER_TAGO_URL "mqtt.tago.io"
 #define MQTT_SERVER_TAGO_PORT 1883
 #define MQTT_SERVER_TAGO_TOPIC "readings"
+#define MQTT_SERVER_TAGO_DATA_TOPIC "tago/data/post"   // JSON variable batches
+#define MQTT_SERVER_TAGO_TELEMETRY_TOPIC "telemetry/dse"  // CBOR snapshots, decoded by a TagoIO payload parser
+#define MQTT_SERVER_TAGO_BACKFILL_TOPIC "telemetry/dse/backfill"  // Replayed snapshots stored while offline
+#define MQTT_SERVER_TAGO_COMPRESSED_DATA_TOPIC "telemetry/data/lzss"   // Data topic JSON, LZSS with UPLINK_DICTIONARY
+#define MQTT_SERVER_TAGO_COMPRESSED_BACKFILL_TOPIC "telemetry/dse/backfill/lzss"
+
+#define MQTT_TOPIC_LENGTH 64                       // Longest resolved device topic
+#define MQTT_DEVICE_TOPIC_PREFIX "devices"
+
+// MQTT QoS1 Publish Window
+#define MQTT_PUBLISH_WINDOW_SIZE 8                 // QoS1 publishes awaiting PUBACK at the same time
+#define MQTT_PUBLISH_WINDOW_SLOTS 12               // Messages held per client (in flight + queued)
+#define MQTT_PUBLISH_WINDOW_TOPIC_LENGTH 96
+#if TAGOIO_COMPRESSION_ENABLED
+#define MQTT_PUBLISH_WINDOW_PAYLOAD_SIZE TELEMETRY_BACKFILL_BLOCK_COMPRESSED_SIZE  // Largest windowed payload
+#else
+#define MQTT_PUBLISH_WINDOW_PAYLOAD_SIZE 512       // Largest windowed payload (TELEMETRY_BUFFER_SIZE)
+#endif
+#define MQTT_PUBLISH_WINDOW_STATS_INTERVAL_MS 60000
 
 // MQTT Command Definitions ----------------------------------------------------------------
 // Client Commands
@@ -161,6 +314,39 @@ enum ServicesStatus
     SERVICES_NOT_CONNECTED
 };
 
+// NovaLogic device topics (devices/<serial>/<suffix>), resolved once by MQTTTopicTable
+enum MQTTTopic : uint8_t
+{
+    MQTT_TOPIC_MESSAGES,
+    MQTT_TOPIC_VERSION,
+    MQTT_TOPIC_MODEL,
+    MQTT_TOPIC_CONNECTED,
+    MQTT_TOPIC_OTA_VERSION,
+    MQTT_TOPIC_OTA_MD5,
+    MQTT_TOPIC_OTA_UPDATE,
+    MQTT_TOPIC_OTA_DELTA,
+    MQTT_TOPIC_OTA_COMPRESSED,
+    MQTT_TOPIC_OTA_URL,
+    MQTT_TOPIC_OTA_STATUS,
+    MQTT_TOPIC_OTA_ACK,
+    MQTT_TOPIC_LOGS,
+    MQTT_TOPIC_LOGS_STATS,
+    MQTT_TOPIC_LOGGING_CONFIG,
+    MQTT_TOPIC_LOGGING_GET_CONFIG,
+    MQTT_TOPIC_LOGGING_GET_LOGS,
+    MQTT_TOPIC_LOGGING_CURRENT_CONFIG,
+    MQTT_TOPIC_LOGGING_TRANSFER,
+    MQTT_TOPIC_LOGGING_SEGMENTS,
+    MQTT_TOPIC_LOGGING_LOGS,
+    MQTT_TOPIC_CRASH_INFO,
+    MQTT_TOPIC_CRASH_RING,
+    MQTT_TOPIC_CRASH_COREDUMP,
+    MQTT_TOPIC_CONFIG_UPDATE,
+    MQTT_TOPIC_CONFIG_GET,
+    MQTT_TOPIC_CONFIG_STATUS,
+    MQTT_TOPIC_COUNT
+};
+
 enum ModbusMonitorStatus
 {
     MODBUS_INACTIVE,    // No traffic detected
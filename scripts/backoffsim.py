@@ -0,0 +1,44 @@
+#!/usr/bin/env python3
+"""
+Simulate a fleet reconnecting to the MQTT broker after it went away for all
+devices at once (broker restart, site-wide power cut).
+
+The simulation runs the firmware's own reconnect logic: BaseService
+(src/services/baseService.cpp) compiled for the host with the constants of
+include/definitions.h (scripts/hostcheck.py serviceBackoff, driver
+scripts/host/serviceBackoffSim.cpp). After a failure the next attempt waits a
+delay drawn from [SERVICES_RETRY_BASE_MS, 3 x previous delay], capped at
+SERVICES_RETRY_CAP_MS. The fixed 30 s retry interval the services used before
+is simulated alongside for comparison.
+
+Broker model: unreachable for --outage seconds, then accepting at most --rate
+connections per second. A refused attempt is only noticed when the CONNECTING
+state times out (SERVICES_CONNECTION_TIMEOUT_MS), like on the device.
+
+Usage:
+    python scripts/backoffsim.py [--devices 2000] [--outage 60] [--rate 50]
+
+Prints the connection attempts reaching the broker over time, the peak rate,
+and the distribution of the time each device needed to reconnect; fails if a
+delay leaves its documented bounds or the backoff does not lower the peak.
+"""
+
+import argparse
+import sys
+
+import hostcheck
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Fleet reconnect simulation for the service backoff")
+    parser.add_argument("--devices", type=int, default=2000)
+    parser.add_argument("--outage", type=int, default=60, help="seconds the broker is unreachable")
+    parser.add_argument("--rate", type=int, default=50, help="connections the broker accepts per second")
+    args = parser.parse_args()
+
+    arguments = [str(args.devices), str(args.outage), str(args.rate)]
+    return 0 if hostcheck.run("serviceBackoff", arguments) else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
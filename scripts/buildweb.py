@@ -0,0 +1,52 @@
+#!/usr/bin/env python3
+"""
+Build the on-device dashboard into the LittleFS image directory.
+
+web/index.html is gzip-compressed into data/www/index.html.gz, which the HTTP
+server sends as it is with Content-Encoding: gzip (src/services/httpServer.h).
+The output is deterministic (no timestamp or file name in the gzip header), so
+it only changes in git when the page does.
+
+Usage:
+    python scripts/buildweb.py [--source web/index.html] [--output data/www/index.html.gz]
+    pio run -t uploadfs
+"""
+
+import argparse
+import gzip
+import io
+import os
+import sys
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def build(source, output):
+    with open(source, "rb") as f:
+        page = f.read()
+
+    buffer = io.BytesIO()
+    with gzip.GzipFile(filename="", mode="wb", compresslevel=9, fileobj=buffer, mtime=0) as gz:
+        gz.write(page)
+    data = buffer.getvalue()
+
+    os.makedirs(os.path.dirname(output), exist_ok=True)
+    with open(output, "wb") as f:
+        f.write(data)
+    return len(page), len(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compress the dashboard for the LittleFS image")
+    parser.add_argument("--source", default=os.path.join(ROOT, "web", "index.html"))
+    parser.add_argument("--output", default=os.path.join(ROOT, "data", "www", "index.html.gz"))
+    args = parser.parse_args()
+
+    size, compressed = build(args.source, args.output)
+    print("%s: %d -> %d bytes (%.1f%%)" % (os.path.relpath(args.output, ROOT), size, compressed,
+                                          100.0 * compressed / size))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
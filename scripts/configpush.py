@@ -0,0 +1,122 @@
+#!/usr/bin/env python3
+"""
+Push a versioned configuration document to a fleet and collect the results.
+
+The document is published to devices/<id>/config/update of every device; each
+device validates it in full and answers on devices/<id>/config/status (see
+src/managers/configManager.h):
+    {"result":"applied","version":7,"changed":["modbus.slave"],"restarted":[],...}
+
+A device that already runs the version (or a newer one) answers "current", so
+the push can simply be repeated for devices that did not answer.
+
+Usage:
+    python scripts/configpush.py CONFIG.json --devices DL1000-0001 DL1000-0002 ...
+                                 [--devices-file ids.txt] [--host localhost] [--port 1883]
+                                 [--timeout 30]
+    python scripts/configpush.py --get --devices ...
+        Request config/status only (version and applied configuration).
+
+Example CONFIG.json:
+    {"version": 7, "modbus": {"baudRate": 19200, "slaveId": 10}, "logging": {"mqtt": false}}
+"""
+
+import argparse
+import json
+import os
+import struct
+import sys
+import time
+
+from mqttbench import DISCONNECT, PUBLISH, PacketReader, connect, packet, utf8
+
+SUBSCRIBE, SUBACK = 8, 9
+TOPIC_PREFIX = "devices"
+
+
+def subscribe(sock, reader, topic):
+    sock.sendall(packet(SUBSCRIBE, 0x02, struct.pack(">H", 1) + utf8(topic) + b"\x00"))
+    while True:
+        reader.feed()
+        for kind, _, _ in reader.packets():
+            if kind == SUBACK:
+                return
+
+
+def publish(sock, topic, payload):
+    sock.sendall(packet(PUBLISH, 0, utf8(topic) + payload))
+
+
+def collect(sock, reader, devices, timeout):
+    """Wait for config/status from every device (QoS0 publishes from the broker)"""
+    results = {}
+    deadline = time.monotonic() + timeout
+    sock.settimeout(0.5)
+    while len(results) < len(devices) and time.monotonic() < deadline:
+        try:
+            reader.feed()
+        except OSError:
+            continue
+        for kind, flags, body in reader.packets():
+            if kind != PUBLISH:
+                continue
+            length = struct.unpack(">H", body[:2])[0]
+            topic = body[2:2 + length].decode()
+            payload = body[2 + length + (2 if (flags >> 1) & 3 else 0):]
+            device = topic.split("/")[1]
+            if device in devices:
+                try:
+                    results[device] = json.loads(payload)
+                except ValueError:
+                    results[device] = {"result": "unreadable"}
+    return results
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Publish a configuration document to many devices")
+    parser.add_argument("config", nargs="?", help="JSON document with a version")
+    parser.add_argument("--get", action="store_true", help="only request the current status")
+    parser.add_argument("--devices", nargs="*", default=[])
+    parser.add_argument("--devices-file", help="one device ID per line")
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--timeout", type=float, default=30, help="seconds to wait for the answers")
+    args = parser.parse_args()
+
+    devices = list(args.devices)
+    if args.devices_file:
+        with open(args.devices_file) as f:
+            devices += [line.strip() for line in f if line.strip()]
+    if not devices or (not args.get and not args.config):
+        parser.error("a configuration document (or --get) and at least one device are required")
+
+    if args.get:
+        suffix, payload = "config/get", b""
+    else:
+        with open(args.config) as f:
+            document = json.load(f)
+        if not isinstance(document.get("version"), int) or document["version"] < 1:
+            sys.exit("the document needs a positive integer version")
+        suffix, payload = "config/update", json.dumps(document, separators=(",", ":")).encode()
+
+    sock, reader = connect(args.host, args.port, "dl1000-config-%d" % os.getpid())
+    subscribe(sock, reader, "%s/+/config/status" % TOPIC_PREFIX)
+    for device in devices:
+        publish(sock, "%s/%s/%s" % (TOPIC_PREFIX, device, suffix), payload)
+    results = collect(sock, reader, set(devices), args.timeout)
+    sock.sendall(packet(DISCONNECT, 0, b""))
+    sock.close()
+
+    counts = {}
+    for device in devices:
+        status = results.get(device, {"result": "no answer"})
+        result = status.get("result", "?")
+        counts[result] = counts.get(result, 0) + 1
+        detail = status.get("error") or ("restarted: %s" % ",".join(status["restarted"]) if status.get("restarted") else "")
+        print("%-24s %-14s v%-6s %s" % (device, result, status.get("version", "-"), detail))
+    print(", ".join("%s %d" % item for item in sorted(counts.items())))
+    return 0 if set(counts) <= {"applied", "current", "none"} else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,183 @@
+// Host check of src/ota/deltaPatcher.cpp with src/utils/lzss.cpp
+//
+// Usage: deltaPatcherCheck <old.bin> <new.bin> <patch.bin>
+// Applies a patch built by scripts/otadelta.py the way NovaLogicService does
+// (source verified in slices, LZSS decoder feeding the patcher a step at a time,
+// patch bytes arriving in slices, paused COPYs resumed on later passes), checks
+// the rebuilt image and its digest, that no pass copies more than
+// OTA_DELTA_COPY_SLICE bytes, and that a patch for another source image, a
+// corrupt patch and a truncated patch are rejected.
+
+#include <chrono>
+#include <mbedtls/sha256.h>
+#include <vector>
+
+#include "hostCheck.h"
+#include "ota/deltaPatcher.h"
+#include "utils/lzss.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+static bool readFile(const char *path, Bytes &data)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+        return false;
+    uint8_t buffer[65536];
+    size_t count;
+    while ((count = fread(buffer, 1, sizeof(buffer), file)) > 0)
+        data.insert(data.end(), buffer, buffer + count);
+    fclose(file);
+    return true;
+}
+
+static void sha256(const Bytes &data, uint8_t digest[32])
+{
+    mbedtls_sha256_context context;
+    mbedtls_sha256_init(&context);
+    mbedtls_sha256_starts(&context, 0);
+    mbedtls_sha256_update(&context, data.data(), data.size());
+    mbedtls_sha256_finish(&context, digest);
+    mbedtls_sha256_free(&context);
+}
+
+struct Result
+{
+    bool sourceVerified = false;
+    bool streamOk = false;
+    bool complete = false;
+    bool digestOk = false;
+    const char *error = nullptr;
+    size_t copied = 0;
+    uint32_t verifyPasses = 0;
+    uint32_t resumes = 0;
+    size_t largestPass = 0;   // Source bytes copied by one feed()/resume() call
+    Bytes image;
+
+    bool accepted() const { return sourceVerified && streamOk && complete && digestOk; }
+};
+
+// Patch bytes arrive in slices of varying size, at most OTA_STREAM_INPUT_SIZE
+static Result apply(const Bytes &source, const Bytes &patch, size_t patchLength, uint32_t seed)
+{
+    static DeltaPatcher patcher;
+    static LzssDecoder decoder;
+    Result result;
+
+    DeltaPatcher::SourceReader reader = [&source](size_t offset, uint8_t *data, size_t length) {
+        if (offset + length > source.size())
+            return false;
+        memcpy(data, source.data() + offset, length);
+        return true;
+    };
+
+    if (patchLength < DELTA_PATCH_HEADER_SIZE || !patcher.begin(patch.data(), reader))
+        return result;
+    bool verified = patcher.getSourceSize() <= source.size();
+    while (verified && patcher.isVerifying())
+    {
+        verified = patcher.verifySource();
+        result.verifyPasses++;
+    }
+    result.sourceVerified = verified;
+    if (!result.sourceVerified)
+    {
+        result.error = patcher.getError();
+        return result;
+    }
+
+    DeltaPatcher::OutputCallback writeImage = [&result](const uint8_t *image, size_t imageLength) {
+        result.image.insert(result.image.end(), image, image + imageLength);
+        return true;
+    };
+    LzssDecoder::OutputCallback applyOperations = [&result, &writeImage](const uint8_t *data, size_t length) {
+        size_t copied = patcher.getCopied();
+        bool ok = patcher.feed(data, length, writeImage);
+        result.largestPass = std::max(result.largestPass, patcher.getCopied() - copied);
+        return ok;
+    };
+
+    decoder.reset();
+    bool streamOk = true;
+    size_t received = DELTA_PATCH_HEADER_SIZE;
+    while (streamOk && received < patchLength)
+    {
+        seed = seed * 1103515245u + 12345u;
+        size_t count = 1 + (seed >> 8) % OTA_STREAM_INPUT_SIZE;
+        count = std::min(count, patchLength - received);
+
+        // A paused patcher takes no more input until the passes after it caught up
+        for (size_t step = 0; streamOk && step < count; step += OTA_DELTA_DECODE_STEP)
+        {
+            size_t stepLength = std::min((size_t)OTA_DELTA_DECODE_STEP, count - step);
+            streamOk = decoder.feed(patch.data() + received + step, stepLength, applyOperations);
+            while (streamOk && patcher.isPaused())
+            {
+                size_t copied = patcher.getCopied();
+                streamOk = patcher.resume(writeImage);
+                result.largestPass = std::max(result.largestPass, patcher.getCopied() - copied);
+                result.resumes++;
+            }
+        }
+        received += count;
+    }
+
+    result.streamOk = streamOk && decoder.isIdle();
+    result.complete = patcher.isComplete();
+    result.error = patcher.getError();
+    result.copied = patcher.getCopied();
+
+    uint8_t digest[32];
+    sha256(result.image, digest);
+    result.digestOk = result.image.size() == patcher.getTargetSize() &&
+                      memcmp(digest, patcher.getTargetDigest(), sizeof(digest)) == 0;
+    return result;
+}
+
+int main(int argc, char **argv)
+{
+    Bytes source, target, patch;
+    if (argc != 4 || !readFile(argv[1], source) || !readFile(argv[2], target) || !readFile(argv[3], patch))
+    {
+        printf("usage: %s <old.bin> <new.bin> <patch.bin>\n", argv[0]);
+        return 2;
+    }
+
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    Result result = apply(source, patch, patch.size(), 1);
+    double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    CHECK(result.accepted());
+    CHECK(result.image == target);
+    CHECK(result.largestPass <= OTA_DELTA_COPY_SLICE);
+    CHECK(result.verifyPasses >= source.size() / OTA_DELTA_VERIFY_SLICE);
+    if (result.error)
+        printf("error: %s\n", result.error);
+
+    // Same patch sliced differently
+    CHECK(apply(source, patch, patch.size(), 7).image == target);
+
+    // Built for another image: refused before anything is written
+    Bytes wrongSource = source;
+    wrongSource[wrongSource.size() / 3] ^= 0xFF;
+    Result wrong = apply(wrongSource, patch, patch.size(), 1);
+    CHECK(!wrong.sourceVerified && wrong.image.empty());
+
+    // Corrupt anywhere in the body: never accepted
+    for (size_t position : {patch.size() / 4, patch.size() / 2, patch.size() - 10})
+    {
+        Bytes corrupt = patch;
+        corrupt[position] ^= 0x55;
+        CHECK(!apply(source, corrupt, corrupt.size(), 1).accepted());
+    }
+
+    // Truncated
+    CHECK(!apply(source, patch, patch.size() - patch.size() / 3, 1).accepted());
+
+    printf("old %zu bytes, new %zu bytes, patch %zu bytes (%.1f%% of the full image)\n", source.size(), target.size(),
+           patch.size(), 100.0 * patch.size() / target.size());
+    printf("applied in %.1f ms on the host, %zu bytes (%.1f%%) copied from the old image\n", elapsed, result.copied,
+           100.0 * result.copied / target.size());
+    printf("source verified in %u passes, %u resumed COPY passes, at most %zu bytes copied per pass\n",
+           (unsigned)result.verifyPasses, (unsigned)result.resumes, result.largestPass);
+    return hostCheckResult("deltaPatcher");
+}
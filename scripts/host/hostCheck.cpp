@@ -0,0 +1,7 @@
+#include "Arduino.h"
+#include "hostCheck.h"
+
+uint32_t hostMillis = 0;
+uint32_t hostMicros = 0;
+uint32_t hostRandomState = 1;
+int hostCheckFailures = 0;
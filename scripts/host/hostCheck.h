@@ -0,0 +1,32 @@
+#pragma once
+#ifndef __HOST_CHECK_H__
+#define __HOST_CHECK_H__
+
+/*
+ * Minimal assertions for the host checks (scripts/hostcheck.py)
+ *
+ * Each check is a main() that exercises the firmware sources it is linked
+ * with, reports failures through CHECK() and returns hostCheckResult().
+ */
+
+#include <cstdio>
+
+extern int hostCheckFailures;
+
+#define CHECK(condition)                                                              \
+    do                                                                                \
+    {                                                                                 \
+        if (!(condition))                                                             \
+        {                                                                             \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);      \
+            hostCheckFailures++;                                                      \
+        }                                                                             \
+    } while (0)
+
+inline int hostCheckResult(const char *name)
+{
+    printf("%s: %s\n", name, hostCheckFailures ? "FAILED" : "ok");
+    return hostCheckFailures ? 1 : 0;
+}
+
+#endif // __HOST_CHECK_H__
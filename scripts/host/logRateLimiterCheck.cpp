@@ -0,0 +1,105 @@
+// Host check of src/logging/logRateLimiter.cpp
+
+#include "hostCheck.h"
+#include "logging/logRateLimiter.h"
+
+static const char *TAG = "Check";
+static const char *FORMAT_A = "value %d";
+static const char *FORMAT_B = "other %d";
+
+static bool admit(LogRateLimiter &limiter, const char *format, uint32_t argHash, uint32_t now,
+                  LogSuppressionReport &report)
+{
+    return limiter.admit(3, TAG, format, argHash, now, report);
+}
+
+// Identical records are collapsed and reported after LOG_REPEAT_FLUSH_MS
+static void checkCollapse()
+{
+    LogRateLimiter limiter;
+    LogSuppressionReport report;
+
+    CHECK(admit(limiter, FORMAT_A, 1, 0, report));
+    for (uint32_t i = 1; i <= 5; i++)
+        CHECK(!admit(limiter, FORMAT_A, 1, i * 100, report));
+    CHECK(limiter.getRepeatedTotal() == 5);
+
+    CHECK(!limiter.collectDue(LOG_REPEAT_FLUSH_MS, report));
+    CHECK(limiter.collectDue(100 + LOG_REPEAT_FLUSH_MS, report));
+    CHECK(report.repeated == 5 && report.suppressed == 0 && report.format == FORMAT_A);
+    CHECK(!limiter.collectDue(100 + LOG_REPEAT_FLUSH_MS, report));
+}
+
+// A message that recurs unchanged, slower than the flush interval, is logged every time
+static void checkRecurring()
+{
+    LogRateLimiter limiter;
+    LogSuppressionReport report;
+
+    for (uint32_t i = 0; i < 10; i++)
+    {
+        uint32_t now = i * 60000;
+        CHECK(admit(limiter, FORMAT_A, 7, now, report));
+        CHECK(!report.isPending());
+        CHECK(!limiter.collectDue(now + LOG_REPEAT_FLUSH_MS, report));
+    }
+
+    // Same, after a summary was flushed in between
+    uint32_t now = 600000;
+    CHECK(admit(limiter, FORMAT_A, 7, now, report));
+    CHECK(!admit(limiter, FORMAT_A, 7, now + 1000, report));
+    CHECK(limiter.collectDue(now + 1000 + LOG_REPEAT_FLUSH_MS, report));
+    CHECK(report.repeated == 1);
+    CHECK(admit(limiter, FORMAT_A, 7, now + 1000 + LOG_REPEAT_FLUSH_MS, report));
+    CHECK(!report.isPending());
+}
+
+// A steady flood of one message is logged again once per flush interval, with its count
+static void checkFlood()
+{
+    LogRateLimiter limiter;
+    LogSuppressionReport report;
+    uint32_t admitted = 0;
+    uint32_t reported = 0;
+
+    for (uint32_t now = 0; now < 60000; now += 100)
+    {
+        if (admit(limiter, FORMAT_A, 3, now, report))
+            admitted++;
+        if (report.isPending())
+            reported += report.repeated;
+    }
+    CHECK(admitted == 60000 / LOG_REPEAT_FLUSH_MS);
+    CHECK(limiter.getRepeatedTotal() == 600 - admitted);
+
+    // Every collapsed record is reported exactly once
+    CHECK(limiter.collectDue(120000, report));
+    CHECK(reported + report.repeated == limiter.getRepeatedTotal());
+}
+
+// Changing arguments spend the token bucket, then are suppressed
+static void checkBucket()
+{
+    LogRateLimiter limiter;
+    LogSuppressionReport report;
+    uint32_t admitted = 0;
+
+    for (uint32_t i = 0; i < LOG_RATE_LIMIT_BURST * 3; i++)
+        if (admit(limiter, FORMAT_B, i, 0, report))
+            admitted++;
+    CHECK(admitted == LOG_RATE_LIMIT_BURST);
+    CHECK(limiter.getSuppressedTotal() == LOG_RATE_LIMIT_BURST * 2);
+
+    // One token back after a second; the suppressed count comes with the next record
+    CHECK(admit(limiter, FORMAT_B, 1000, 1000, report));
+    CHECK(report.suppressed == LOG_RATE_LIMIT_BURST * 2);
+}
+
+int main()
+{
+    checkCollapse();
+    checkRecurring();
+    checkFlood();
+    checkBucket();
+    return hostCheckResult("logRateLimiter");
+}
@@ -0,0 +1,182 @@
+// Host check and benchmark of src/utils/mqttPublishWindow.cpp
+//
+// Runs the window against a simulated broker that acknowledges every QoS1
+// publish one round trip later (simulated time), reports throughput per
+// window size and checks packet ID use, retransmission after a reconnect and
+// that a PUBACK only releases its own message.
+
+#include <deque>
+#include <map>
+#include <set>
+
+#include "hostCheck.h"
+#include "utils/mqttPublishWindow.h"
+
+static const uint32_t ROUND_TRIP_MS = 40;
+static const uint32_t MESSAGES = 500;
+static const size_t PAYLOAD_SIZE = 300;
+
+struct SimulatedBroker
+{
+    struct Ack
+    {
+        uint32_t due;
+        uint16_t packetId;
+    };
+
+    std::deque<Ack> acks;               // In send order, so also in due order
+    std::set<uint16_t> outstanding;     // Packet IDs sent and not acknowledged yet
+    std::map<uint32_t, uint32_t> received;  // Message number -> times received
+    uint32_t duplicates = 0;
+    bool connected = true;
+
+    MQTTPublishWindow::Sender sender()
+    {
+        return [this](const char *, const uint8_t *payload, size_t length, bool, uint16_t packetId, bool duplicate) {
+            if (!connected)
+                return false;
+
+            CHECK(length == PAYLOAD_SIZE);
+            CHECK(packetId != 0);
+            // A new message never reuses the ID of one awaiting its PUBACK
+            CHECK(duplicate || outstanding.count(packetId) == 0);
+            if (duplicate)
+                duplicates++;
+
+            uint32_t number;
+            memcpy(&number, payload, sizeof(number));
+            received[number]++;
+            outstanding.insert(packetId);
+            acks.push_back({hostMillis + ROUND_TRIP_MS, packetId});
+            return true;
+        };
+    }
+
+    // Deliver the PUBACKs due by now
+    void deliver(MQTTPublishWindow &window)
+    {
+        while (!acks.empty() && (int32_t)(hostMillis - acks.front().due) >= 0)
+        {
+            outstanding.erase(acks.front().packetId);
+            window.acknowledge(acks.front().packetId);
+            acks.pop_front();
+        }
+    }
+
+    // Connection lost: PUBACKs on the way are gone
+    void disconnect()
+    {
+        acks.clear();
+        outstanding.clear();
+    }
+};
+
+static bool enqueueMessage(MQTTPublishWindow &window, uint32_t number)
+{
+    uint8_t payload[PAYLOAD_SIZE] = {};
+    memcpy(payload, &number, sizeof(number));
+    return window.enqueue("dl1000/check", payload, sizeof(payload));
+}
+
+// Publish MESSAGES as fast as the window allows; returns the simulated time taken
+static uint32_t run(MQTTPublishWindow &window, SimulatedBroker &broker, uint32_t dropAt)
+{
+    uint32_t start = hostMillis;
+    uint32_t next = 0;
+    bool dropped = false;
+
+    while (next < MESSAGES || window.getInFlight() > 0 || window.getQueued() > 0)
+    {
+        while (next < MESSAGES && enqueueMessage(window, next))
+            next++;
+        window.service(broker.sender());
+
+        if (!dropped && next >= dropAt)
+        {
+            // Reconnect with in-flight messages: they go out again with their packet IDs
+            dropped = true;
+            broker.disconnect();
+            window.sessionRestarted();
+            CHECK(window.getInFlight() == 0);
+            continue;
+        }
+
+        if (broker.acks.empty())
+            break;
+        hostMillis = broker.acks.front().due;
+        broker.deliver(window);
+    }
+    return hostMillis - start;
+}
+
+static void checkThroughput()
+{
+    printf("window  messages/s  (simulated %u ms round trip)\n", (unsigned)ROUND_TRIP_MS);
+    double baseline = 0;
+    for (size_t size : {1, 2, 4, 8})
+    {
+        MQTTPublishWindow window;
+        SimulatedBroker broker;
+        window.setWindowSize(size);
+
+        uint32_t elapsed = run(window, broker, UINT32_MAX);
+        double rate = MESSAGES * 1000.0 / elapsed;
+        if (baseline == 0)
+            baseline = rate;
+        printf("%6u  %10.1f  %5.1fx\n", (unsigned)size, rate, rate / baseline);
+
+        CHECK(window.getPeakInFlight() == size);
+        CHECK(window.getAcknowledged() == MESSAGES);
+        CHECK(broker.received.size() == MESSAGES);
+        CHECK(broker.duplicates == 0);
+    }
+}
+
+static void checkReconnect()
+{
+    MQTTPublishWindow window;
+    SimulatedBroker broker;
+
+    run(window, broker, MESSAGES / 2);
+
+    // Every message arrived, the ones in flight at the reconnect twice
+    CHECK(broker.received.size() == MESSAGES);
+    CHECK(broker.duplicates == MQTT_PUBLISH_WINDOW_SIZE);
+    CHECK(window.getRetransmitted() == MQTT_PUBLISH_WINDOW_SIZE);
+    CHECK(window.getAcknowledged() == MESSAGES);
+    for (const auto &entry : broker.received)
+        CHECK(entry.second == 1 || entry.second == 2);
+}
+
+// A PUBACK for a packet ID the window did not send must not release anything
+static void checkForeignAck()
+{
+    MQTTPublishWindow window;
+    SimulatedBroker broker;
+
+    for (uint32_t i = 0; i < 3; i++)
+        CHECK(enqueueMessage(window, i));
+    window.service(broker.sender());
+    CHECK(window.getInFlight() == 3);
+
+    for (uint16_t packetId = 100; packetId < 200; packetId++)
+        window.acknowledge(packetId);
+    CHECK(window.getInFlight() == 3);
+
+    hostMillis += ROUND_TRIP_MS;
+    broker.deliver(window);
+    CHECK(window.getInFlight() == 0);
+    CHECK(window.getFreeSlots() == MQTT_PUBLISH_WINDOW_SLOTS);
+
+    // A second PUBACK for the same ID is ignored as well
+    window.acknowledge(1);
+    CHECK(window.getAcknowledged() == 3);
+}
+
+int main()
+{
+    checkThroughput();
+    checkReconnect();
+    checkForeignAck();
+    return hostCheckResult("mqttPublishWindow");
+}
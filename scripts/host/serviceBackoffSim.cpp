@@ -0,0 +1,270 @@
+// Host simulation of the reconnect backoff in src/services/baseService.cpp
+//
+// Usage: serviceBackoffSim [devices] [outage seconds] [broker connects per second]
+// A fleet of BaseService instances, all connected, loses the broker at the same
+// moment (broker restart, site-wide power cut). Each runs the reconnect state
+// machine of NovaLogicService::loop(): a refused attempt is only noticed when
+// CONNECTING times out after SERVICES_CONNECTION_TIMEOUT_MS. The broker is
+// unreachable for the outage, then accepts a limited number of connects per
+// second. The same fleet with the fixed 30 s retry the services used before
+// (canAttemptConnection() overridden) is the baseline.
+//
+// Reports the attempts reaching the broker over time and how long the devices
+// took to reconnect, and checks every delay against the documented bounds.
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "hostCheck.h"
+#include "services/baseService.h"
+
+static const uint32_t TICK_MS = 100;                // Service loop() period
+static const uint32_t FIXED_RETRY_MS = 30000;
+static const uint32_t HORIZON_MS = 3600 * 1000;
+static const uint32_t BUCKET_MS = 60 * 1000;
+
+struct Broker
+{
+    uint32_t upAt;                          // Unreachable before
+    uint32_t rate;                          // Connects accepted per second once up
+    std::map<uint32_t, uint32_t> attempts;  // Second -> attempts reaching the broker
+    std::map<uint32_t, uint32_t> accepted;  // Second -> connects accepted
+
+    bool connect(uint32_t now)
+    {
+        if (now < upAt)
+            return false;
+        uint32_t second = now / 1000;
+        attempts[second]++;
+        if (accepted[second] >= rate)
+            return false;
+        accepted[second]++;
+        return true;
+    }
+};
+
+class SimulatedService : public BaseService
+{
+public:
+    SimulatedService(Broker &broker) : BaseService("Sim"), broker(broker) {}
+
+    void begin() override {}
+    void start() override { setStatus(SERVICE_STARTING); }
+    void stop() override { setStatus(SERVICE_STOPPED); }
+
+    void loop() override
+    {
+        switch (currentStatus)
+        {
+        case SERVICE_STARTING:
+        case SERVICE_ERROR:
+        case SERVICE_NOT_CONNECTED:
+            if (canAttemptConnection())
+            {
+                setStatus(SERVICE_CONNECTING);
+                updateLastConnectionAttempt();
+                if (broker.connect(millis()))
+                {
+                    setStatus(SERVICE_CONNECTED);
+                    connectedAt = millis();
+                }
+            }
+            break;
+
+        case SERVICE_CONNECTING:
+            if (millis() - lastConnectionAttempt > SERVICES_CONNECTION_TIMEOUT_MS)
+                fail(SERVICE_ERROR);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    // Keepalive missed: the broker is gone
+    void lose() { fail(SERVICE_NOT_CONNECTED); }
+
+    bool delaysInBounds = true;
+
+private:
+    // Each delay in [base, 3 x previous] and at most the cap; a stable connection starts over
+    void fail(ServiceStatus status)
+    {
+        bool stable = currentStatus == SERVICE_CONNECTED && millis() - connectedAt >= SERVICES_RETRY_STABLE_MS;
+        unsigned long previous = stable ? 0 : getRetryDelay();
+        setStatus(status);
+
+        unsigned long upper = std::min((unsigned long)SERVICES_RETRY_CAP_MS,
+                                       std::max((unsigned long)SERVICES_RETRY_BASE_MS, previous) * 3);
+        if (getRetryDelay() < SERVICES_RETRY_BASE_MS || getRetryDelay() > upper)
+            delaysInBounds = false;
+    }
+
+    Broker &broker;
+    uint32_t connectedAt = 0;
+};
+
+// The services before the backoff: a new attempt FIXED_RETRY_MS after the last one
+class FixedRetryService : public SimulatedService
+{
+public:
+    using SimulatedService::SimulatedService;
+
+protected:
+    bool canAttemptConnection() override
+    {
+        return lastConnectionAttempt == 0 || millis() - lastConnectionAttempt >= FIXED_RETRY_MS;
+    }
+};
+
+struct Fleet
+{
+    Broker broker;
+    std::vector<std::unique_ptr<SimulatedService>> services;
+    std::vector<uint32_t> reconnected;      // Time after the outage started, per device
+    uint32_t outageStart = 0;
+
+    template <typename Service> void run(uint32_t devices, uint32_t outageMs, uint32_t rate)
+    {
+        // Everyone connected for longer than SERVICES_RETRY_STABLE_MS, then the broker goes away
+        broker.upAt = 0;
+        broker.rate = UINT32_MAX;
+        hostMillis = 1000;
+        for (uint32_t i = 0; i < devices; i++)
+        {
+            services.emplace_back(new Service(broker));
+            services.back()->start();
+            services.back()->loop();
+        }
+        outageStart = hostMillis + SERVICES_RETRY_STABLE_MS + 1000;
+        broker.upAt = outageStart + outageMs;
+        broker.rate = rate;
+        broker.attempts.clear();
+
+        // Every device notices the loss within one keepalive interval
+        std::vector<uint32_t> lostAt;
+        for (uint32_t i = 0; i < devices; i++)
+            lostAt.push_back(outageStart + random(0, SERVICES_KEEPALIVE_INTERVAL_MS + 1));
+        reconnected.assign(devices, UINT32_MAX);
+
+        for (hostMillis = outageStart; hostMillis < outageStart + HORIZON_MS; hostMillis += TICK_MS)
+        {
+            for (uint32_t i = 0; i < devices; i++)
+            {
+                SimulatedService &service = *services[i];
+                if (service.isConnected())
+                {
+                    if (reconnected[i] == UINT32_MAX && hostMillis >= lostAt[i])
+                        service.lose();
+                    continue;
+                }
+                service.loop();
+                if (service.isConnected())
+                    reconnected[i] = hostMillis - outageStart;
+            }
+        }
+    }
+
+    bool delaysInBounds() const
+    {
+        for (const auto &service : services)
+        {
+            if (!service->delaysInBounds)
+                return false;
+        }
+        return true;
+    }
+
+    uint32_t peakAttempts() const
+    {
+        uint32_t peak = 0;
+        for (const auto &entry : broker.attempts)
+            peak = std::max(peak, entry.second);
+        return peak;
+    }
+
+    void report(const char *policy, uint32_t outageMs)
+    {
+        printf("== %s: %u devices, broker back after %u s, accepting %u connects/s\n", policy,
+               (unsigned)services.size(), (unsigned)(outageMs / 1000), (unsigned)broker.rate);
+
+        std::map<uint32_t, uint32_t> buckets;
+        uint32_t total = 0;
+        for (const auto &entry : broker.attempts)
+        {
+            buckets[(entry.first * 1000 - outageStart) / BUCKET_MS] += entry.second;
+            total += entry.second;
+        }
+        uint32_t peakBucket = 1;
+        for (const auto &entry : buckets)
+            peakBucket = std::max(peakBucket, entry.second);
+        for (const auto &entry : buckets)
+        {
+            printf("%5u-%-5u s %7u %.*s\n", (unsigned)(entry.first * BUCKET_MS / 1000),
+                   (unsigned)((entry.first + 1) * BUCKET_MS / 1000), (unsigned)entry.second,
+                   (int)(entry.second * 50 / peakBucket), "##################################################");
+        }
+
+        std::vector<uint32_t> times;
+        for (uint32_t time : reconnected)
+        {
+            if (time != UINT32_MAX)
+                times.push_back(time);
+        }
+        std::sort(times.begin(), times.end());
+        auto percentile = [&times](double fraction) {
+            return times.empty() ? 0.0 : times[std::min(times.size() - 1, (size_t)(times.size() * fraction))] / 1000.0;
+        };
+        printf("peak: %u attempts in one second, %u attempts in total\n", (unsigned)peakAttempts(), (unsigned)total);
+        printf("reconnected: %u/%u, time p50 %.0f s, p90 %.0f s, p99 %.0f s, max %.0f s\n\n", (unsigned)times.size(),
+               (unsigned)services.size(), percentile(0.5), percentile(0.9), percentile(0.99), percentile(1.0));
+    }
+};
+
+// A connection that keeps dropping right away climbs to the cap and stays within it
+static void checkUnstable()
+{
+    Broker broker{0, UINT32_MAX};
+    SimulatedService service(broker);
+    hostMillis = 1000;
+    service.start();
+    service.loop();
+
+    unsigned long longest = 0;
+    for (int i = 0; i < 40; i++)
+    {
+        hostMillis += 1000;
+        service.lose();
+        longest = std::max(longest, service.getRetryDelay());
+        hostMillis += service.getNextAttemptIn();
+        service.loop();
+        CHECK(service.isConnected());
+    }
+    CHECK(service.delaysInBounds);
+    CHECK(longest == SERVICES_RETRY_CAP_MS);
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t devices = argc > 1 ? atoi(argv[1]) : 2000;
+    uint32_t outageMs = (argc > 2 ? atoi(argv[2]) : 60) * 1000;
+    uint32_t rate = argc > 3 ? atoi(argv[3]) : 50;
+
+    randomSeed(1);
+    Fleet fixed;
+    fixed.run<FixedRetryService>(devices, outageMs, rate);
+    fixed.report("fixed 30 s retry", outageMs);
+
+    randomSeed(1);
+    Fleet backoff;
+    backoff.run<SimulatedService>(devices, outageMs, rate);
+    backoff.report("BaseService backoff", outageMs);
+
+    CHECK(backoff.delaysInBounds());
+    CHECK(std::count(backoff.reconnected.begin(), backoff.reconnected.end(), UINT32_MAX) == 0);
+    CHECK(backoff.peakAttempts() < fixed.peakAttempts());
+
+    checkUnstable();
+    return hostCheckResult("serviceBackoff");
+}
@@ -0,0 +1,69 @@
+#pragma once
+#ifndef __HOST_ARDUINO_H__
+#define __HOST_ARDUINO_H__
+
+/*
+ * Host stand-in for the parts of Arduino.h the checked sources use
+ *
+ * Time is simulated: checks set hostMillis/hostMicros and the firmware code
+ * reads them through millis()/micros().
+ */
+
+#include <cstdarg>
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <algorithm>
+#include <cmath>
+
+using std::max;
+using std::min;
+
+extern uint32_t hostMillis;
+extern uint32_t hostMicros;
+
+inline uint32_t millis() { return hostMillis; }
+inline uint32_t micros() { return hostMicros; }
+
+template <typename T>
+inline T constrain(T value, T low, T high) { return value < low ? low : (value > high ? high : value); }
+
+// Seeded by the check; [low, high) as on the device
+extern uint32_t hostRandomState;
+inline void randomSeed(unsigned long seed) { hostRandomState = seed ? (uint32_t)seed : 1; }
+inline long random(long low, long high)
+{
+    hostRandomState ^= hostRandomState << 13;
+    hostRandomState ^= hostRandomState >> 17;
+    hostRandomState ^= hostRandomState << 5;
+    return high > low ? low + (long)(hostRandomState % (uint32_t)(high - low)) : low;
+}
+
+// Output sink (metrics exposition); writes to stdout unless a check overrides write()
+class Print
+{
+public:
+    virtual ~Print() {}
+    virtual size_t write(uint8_t c) { return fputc(c, stdout) == EOF ? 0 : 1; }
+    virtual size_t write(const uint8_t *data, size_t length)
+    {
+        size_t written = 0;
+        while (written < length && write(data[written]))
+            written++;
+        return written;
+    }
+    size_t print(const char *text) { return write((const uint8_t *)text, strlen(text)); }
+    size_t printf(const char *format, ...)
+    {
+        char line[256];
+        va_list args;
+        va_start(args, format);
+        int length = vsnprintf(line, sizeof(line), format, args);
+        va_end(args);
+        return length > 0 ? write((const uint8_t *)line, min((size_t)length, sizeof(line) - 1)) : 0;
+    }
+};
+
+#endif // __HOST_ARDUINO_H__
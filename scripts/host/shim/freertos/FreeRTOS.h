@@ -0,0 +1,22 @@
+#pragma once
+#ifndef __HOST_FREERTOS_H__
+#define __HOST_FREERTOS_H__
+
+// Host checks are single threaded: critical sections are no-ops
+
+#include <cstdint>
+
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdMS_TO_TICKS(ms) ((TickType_t)(ms))
+#define portMAX_DELAY 0xFFFFFFFFu
+
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif // __HOST_FREERTOS_H__
@@ -0,0 +1,21 @@
+#pragma once
+#ifndef __HOST_SEMPHR_H__
+#define __HOST_SEMPHR_H__
+
+// Host checks are single threaded: a mutex is always free
+
+#include "freertos/FreeRTOS.h"
+
+typedef int *SemaphoreHandle_t;
+
+inline SemaphoreHandle_t xSemaphoreCreateMutex()
+{
+    static int mutex;
+    return &mutex;
+}
+
+inline void vSemaphoreDelete(SemaphoreHandle_t) {}
+inline BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+inline BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+
+#endif // __HOST_SEMPHR_H__
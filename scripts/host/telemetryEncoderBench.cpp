@@ -0,0 +1,125 @@
+// Host benchmark of src/telemetry/telemetryEncoder.cpp against the JSON batch path
+//
+// Encodes a simulated generator run (every DSE page valid) with TelemetryEncoder,
+// as TagoIOService::publishSnapshot does, and with TagoIOBatch, as every channel
+// sent through TagoIOService::publishSensorData would be, and reports bytes and
+// host encode time per snapshot.
+
+#include <chrono>
+#include <random>
+
+#include "hostCheck.h"
+#include "telemetry/telemetryEncoder.h"
+#include "telemetry/tagoIOBatch.h"
+
+static const uint32_t SNAPSHOTS = 1000;
+static const uint32_t INTERVAL_MS = 10000;
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMicros(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count();
+}
+
+// A running generator: most channels drift a little, the run time counter only rises
+static void advance(DSEValues &values, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<int> drift(-3, 3);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        if (chance(rng) < 0.3)
+            values.raw[i] += drift(rng);
+    }
+    values.raw[DSE_CHANNEL_COUNT - 1] += 10;
+}
+
+static float realValue(const DSEChannel &channel, int64_t raw)
+{
+    float value = (float)raw;
+    for (int8_t scale = channel.scale; scale < 0; scale++)
+        value /= 10.0f;
+    for (int8_t scale = channel.scale; scale > 0; scale--)
+        value *= 10.0f;
+    return value;
+}
+
+// Every channel through the TagoIO batch; returns the payload bytes of the publishes needed
+static size_t sendAsBatch(TagoIOBatch &batch, const DSEValues &values, uint32_t &publishes)
+{
+    size_t bytes = 0;
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        const DSEChannel &channel = DSE_CHANNELS[i];
+        if (batch.add(channel.name, realValue(channel, values.raw[i]), channel.unit))
+            continue;
+
+        // Table full: publish what is there, as the next send interval would
+        bytes += batch.serialize();
+        batch.commit();
+        publishes++;
+        batch.add(channel.name, realValue(channel, values.raw[i]), channel.unit);
+    }
+
+    while (batch.getPendingCount() > 0)
+    {
+        size_t length = batch.serialize();
+        CHECK(length > 0);
+        if (length == 0)
+            break;
+        bytes += length;
+        batch.commit();
+        publishes++;
+    }
+    return bytes;
+}
+
+int main()
+{
+    std::mt19937 rng(1);
+    std::uniform_int_distribution<int> initial(0, 2000);
+
+    DSEValues values;
+    values.pageMask = 0x0F;
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+        values.raw[i] = initial(rng);
+
+    static TelemetryEncoder encoder;
+    static TagoIOBatch batch;
+    size_t cborBytes = 0, jsonBytes = 0, maxCbor = 0;
+    uint32_t keyframes = 0, publishes = 0;
+    double cborMicros = 0, jsonMicros = 0;
+
+    for (uint32_t i = 0; i < SNAPSHOTS; i++)
+    {
+        advance(values, rng);
+        hostMillis = i * INTERVAL_MS;
+
+        Clock::time_point start = Clock::now();
+        size_t length = encoder.encode(values, hostMillis);
+        encoder.commit();
+        cborMicros += elapsedMicros(start);
+        CHECK(length > 0);
+        cborBytes += length;
+        maxCbor = std::max(maxCbor, length);
+        keyframes += encoder.isKeyframe();
+
+        start = Clock::now();
+        jsonBytes += sendAsBatch(batch, values, publishes);
+        jsonMicros += elapsedMicros(start);
+    }
+
+    CHECK(keyframes == (SNAPSHOTS + TELEMETRY_KEYFRAME_INTERVAL) / (TELEMETRY_KEYFRAME_INTERVAL + 1));
+    CHECK(maxCbor <= TELEMETRY_BUFFER_SIZE);
+
+    printf("snapshots:      %u (%u keyframes, %u channels each, largest %u bytes)\n", (unsigned)SNAPSHOTS,
+           (unsigned)keyframes, (unsigned)DSE_CHANNEL_COUNT, (unsigned)maxCbor);
+    printf("TagoIOBatch     %8.1f bytes/snapshot  %8.2f us/snapshot  (%.1f publishes)\n",
+           (double)jsonBytes / SNAPSHOTS, jsonMicros / SNAPSHOTS, (double)publishes / SNAPSHOTS);
+    printf("CBOR snapshot   %8.1f bytes/snapshot  %8.2f us/snapshot  (1 publish)\n",
+           (double)cborBytes / SNAPSHOTS, cborMicros / SNAPSHOTS);
+    printf("reduction       %8.1fx bytes          %8.1fx host time\n",
+           (double)jsonBytes / cborBytes, jsonMicros / cborMicros);
+    return hostCheckResult("telemetryEncoder");
+}
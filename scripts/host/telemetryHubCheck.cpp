@@ -0,0 +1,52 @@
+// Host check of src/telemetry/telemetryHub.cpp
+//
+// Changed-channel bits must survive several hub updates until the consumer
+// (LocalMQTTBroker) takes them, and the formatted text must follow the values.
+
+#include "hostCheck.h"
+#include "telemetry/telemetryHub.h"
+
+static const size_t OIL_PRESSURE = 0;       // Index in DSE_CHANNELS
+static const size_t COOLANT_TEMP = 1;
+
+static bool hasText(size_t channel, const char *expected)
+{
+    return strcmp(telemetryHub.getText(channel), expected) == 0;
+}
+
+int main()
+{
+    DSEData data;
+    data.page4Valid = true;
+    data.page4.oilPressure = 400;
+    data.page4.coolantTemp = 80;
+
+    // First update: every valid channel is new
+    telemetryHub.update(data);
+    uint64_t first = telemetryHub.takeChanged();
+    CHECK(first & (1ULL << OIL_PRESSURE));
+    CHECK(first & (1ULL << COOLANT_TEMP));
+    CHECK(telemetryHub.takeChanged() == 0);
+    CHECK(hasText(OIL_PRESSURE, "400"));
+
+    // Two updates before the consumer runs: both changes are still reported
+    data.page4.oilPressure = 410;
+    telemetryHub.update(data);
+    data.page4.coolantTemp = 81;
+    telemetryHub.update(data);
+    CHECK(telemetryHub.takeChanged() == ((1ULL << OIL_PRESSURE) | (1ULL << COOLANT_TEMP)));
+    CHECK(hasText(OIL_PRESSURE, "410") && hasText(COOLANT_TEMP, "81"));
+    CHECK(telemetryHub.getSequence() == 3);
+
+    // Unchanged data sets no bits; a page that goes invalid clears its text
+    telemetryHub.update(data);
+    CHECK(telemetryHub.takeChanged() == 0);
+    data.page4Valid = false;
+    telemetryHub.update(data);
+    CHECK(telemetryHub.takeChanged() == first);
+    CHECK(hasText(OIL_PRESSURE, ""));
+
+    DSEValues values;
+    CHECK(!telemetryHub.getValues(values));
+    return hostCheckResult("telemetryHub");
+}
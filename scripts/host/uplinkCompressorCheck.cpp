@@ -0,0 +1,247 @@
+// Host check of src/telemetry/uplinkCompressor.cpp on the payloads TagoIOService sends
+//
+// Backfill: a day of standalone keyframes (TelemetryEncoder::encodeStandalone, one
+// per TELEMETRY_STORE_INTERVAL_MS) for a running and for a stopped generator,
+// grouped into blocks the way TagoIOService::compressBackfill and
+// TelemetryStore::readFollowing do (up to TELEMETRY_BACKFILL_BLOCK_SIZE raw bytes,
+// never across a store segment, at most TELEMETRY_BACKFILL_BLOCK_COMPRESSED_SIZE
+// compressed) and compared with compressing every record on its own.
+// Data topic: the device status and backfill_recovery_s JSON, with and without the
+// preset dictionary.
+// Every compressed payload is decoded again with LzssDecoder and compared.
+
+#include <random>
+#include <vector>
+
+#include "hostCheck.h"
+#include "telemetry/telemetryEncoder.h"
+#include "telemetry/tagoIOBatch.h"
+#include "telemetry/uplinkCompressor.h"
+#include "utils/jsonStreamWriter.h"
+#include "utils/lzss.h"
+
+typedef std::vector<uint8_t> Bytes;
+
+static const uint32_t RECORDS = 86400000UL / TELEMETRY_STORE_INTERVAL_MS;
+static const size_t RECORD_HEADER_SIZE = 12;    // TELEMETRY_STORE_HEADER_SIZE (telemetryStore.h needs LittleFS)
+
+struct Traffic
+{
+    size_t raw = 0;
+    size_t sent = 0;
+    uint32_t publishes = 0;
+    uint32_t compressed = 0;
+};
+
+static bool decodesTo(const uint8_t *stream, size_t length, const uint8_t *dictionary, size_t dictionaryLength,
+                      const Bytes &expected)
+{
+    static LzssDecoder decoder;
+    Bytes output;
+    decoder.reset();
+    if (dictionaryLength)
+        decoder.setDictionary(dictionary, dictionaryLength);
+    bool ok = decoder.feed(stream, length, [&output](const uint8_t *data, size_t count) {
+        output.insert(output.end(), data, data + count);
+        return true;
+    });
+    return ok && decoder.isIdle() && output == expected;
+}
+
+// Sent as it is unless compress() gets it smaller within maxSize
+static void send(UplinkCompressor &compressor, const Bytes &payload, size_t maxSize, Traffic &traffic)
+{
+    size_t compressed = compressor.compress(payload.data(), payload.size(), maxSize);
+    if (compressed > 0)
+    {
+        CHECK(compressed < payload.size() && compressed <= maxSize);
+        CHECK(decodesTo(compressor.getBuffer(), compressed, (const uint8_t *)UPLINK_DICTIONARY,
+                        UPLINK_DICTIONARY_LENGTH, payload));
+        traffic.compressed++;
+    }
+    traffic.raw += payload.size();
+    traffic.sent += compressed > 0 ? compressed : payload.size();
+    traffic.publishes++;
+}
+
+// A day of offline snapshots; running: most channels drift and the run time counter rises,
+// stopped: only the battery voltage moves
+static std::vector<Bytes> storedRecords(bool running, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<int> initial(0, 2000), drift(-3, 3);
+    std::uniform_real_distribution<double> chance(0.0, 1.0);
+
+    DSEValues values;
+    values.pageMask = 0x0F;
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+        values.raw[i] = running ? initial(rng) : 0;
+    values.raw[5] = 1310;
+
+    std::vector<Bytes> records;
+    uint8_t buffer[TELEMETRY_STORE_RECORD_SIZE];
+    for (uint32_t i = 0; i < RECORDS; i++)
+    {
+        for (size_t c = 0; c < DSE_CHANNEL_COUNT; c++)
+        {
+            if ((running || c == 5) && chance(rng) < 0.3)
+                values.raw[c] += drift(rng);
+        }
+        if (running)
+            values.raw[DSE_CHANNEL_COUNT - 1] += TELEMETRY_STORE_INTERVAL_MS / 1000;
+
+        uint32_t timestamp = i * TELEMETRY_STORE_INTERVAL_MS;
+        size_t length = TelemetryEncoder::encodeStandalone(values, i + 1, timestamp, 1760000000 + timestamp / 1000, 7,
+                                                           buffer, sizeof(buffer));
+        CHECK(length > 0);
+        records.push_back(Bytes(buffer, buffer + length));
+    }
+    return records;
+}
+
+// Segment of every record, rotated like TelemetryStore::append()
+static std::vector<uint32_t> storeSegments(const std::vector<Bytes> &records)
+{
+    std::vector<uint32_t> segments;
+    uint32_t segment = 0;
+    size_t offset = 0;
+    for (const Bytes &record : records)
+    {
+        size_t recordSize = RECORD_HEADER_SIZE + record.size();
+        if (offset > 0 && offset + recordSize > TELEMETRY_STORE_SEGMENT_SIZE)
+        {
+            segment++;
+            offset = 0;
+        }
+        offset += recordSize;
+        segments.push_back(segment);
+    }
+    return segments;
+}
+
+static void sendBlocks(UplinkCompressor &compressor, const std::vector<Bytes> &records, Traffic &traffic,
+                       uint32_t &retries)
+{
+    std::vector<uint32_t> segments = storeSegments(records);
+    size_t i = 0;
+    size_t limit = TELEMETRY_BACKFILL_BLOCK_SIZE;
+    while (i < records.size())
+    {
+        size_t first = i++;
+        Bytes block = records[first];
+        while (i < records.size() && segments[i] == segments[first] && block.size() + records[i].size() <= limit)
+        {
+            block.insert(block.end(), records[i].begin(), records[i].end());
+            i++;
+        }
+
+        size_t compressed = compressor.compress(block.data(), block.size(), TELEMETRY_BACKFILL_BLOCK_COMPRESSED_SIZE);
+        if (compressed == 0 && i - first > 1)
+        {
+            // Rebuilt at half the size
+            retries++;
+            limit = block.size() / 2;
+            i = first;
+            continue;
+        }
+        limit = TELEMETRY_BACKFILL_BLOCK_SIZE;
+
+        traffic.raw += block.size();
+        traffic.sent += compressed > 0 ? compressed : block.size();
+        traffic.publishes++;
+        if (compressed == 0)
+            continue;
+        CHECK(compressed <= TELEMETRY_BACKFILL_BLOCK_COMPRESSED_SIZE);
+        CHECK(decodesTo(compressor.getBuffer(), compressed, (const uint8_t *)UPLINK_DICTIONARY,
+                        UPLINK_DICTIONARY_LENGTH, block));
+        traffic.compressed++;
+    }
+}
+
+static Bytes deviceStatus(const char *status, uint32_t timestamp)
+{
+    // Same document as TagoIOService::publishDeviceStatus()
+    char payload[160];
+    JsonStreamWriter json(payload, sizeof(payload));
+    json.beginObject();
+    json.key("variable");
+    json.value("device_status");
+    json.key("value");
+    json.value(status);
+    json.key("timestamp");
+    json.value(timestamp);
+    json.key("metadata");
+    json.beginObject();
+    json.key("device");
+    json.value(DEVICE_NAME);
+    json.key("source");
+    json.value("TagoIOService");
+    json.endObject();
+    json.endObject();
+    CHECK(!json.overflowed());
+    return Bytes(payload, payload + json.length());
+}
+
+static void report(const char *name, const Traffic &traffic, uint32_t records)
+{
+    printf("%-26s %9.1f %9.1f  %5.1f%%  %7.2f  %u/%u\n", name, (double)traffic.raw / records,
+           (double)traffic.sent / records, traffic.raw ? 100.0 * traffic.sent / traffic.raw : 0.0,
+           (double)traffic.publishes / records, (unsigned)traffic.compressed, (unsigned)traffic.publishes);
+}
+
+int main()
+{
+    static UplinkCompressor compressor;
+    std::mt19937 rng(1);
+
+    printf("%u stored records per scenario (a day at %u s), blocks up to %u raw bytes, dictionary %u bytes\n",
+           (unsigned)RECORDS, (unsigned)(TELEMETRY_STORE_INTERVAL_MS / 1000), (unsigned)TELEMETRY_BACKFILL_BLOCK_SIZE,
+           (unsigned)UPLINK_DICTIONARY_LENGTH);
+    printf("%-26s %9s %9s  %6s  %7s  %s\n", "payload", "raw B", "sent B", "sent", "publish", "compressed");
+
+    for (int running = 1; running >= 0; running--)
+    {
+        std::vector<Bytes> records = storedRecords(running, rng);
+        Traffic single, blocks;
+        uint32_t retries = 0;
+        for (const Bytes &record : records)
+            send(compressor, record, TELEMETRY_BACKFILL_BLOCK_COMPRESSED_SIZE, single);
+        sendBlocks(compressor, records, blocks, retries);
+
+        report(running ? "backfill running, records" : "backfill stopped, records", single, RECORDS);
+        report(running ? "backfill running, blocks" : "backfill stopped, blocks", blocks, RECORDS);
+        if (retries)
+            printf("%-26s %u blocks rebuilt at half the size\n", "", (unsigned)retries);
+        CHECK(blocks.raw == single.raw);
+        CHECK(blocks.sent * 3 < single.raw * 2);
+    }
+
+    // Data topic, per payload
+    Traffic plain, primed;
+    std::vector<Bytes> data = {deviceStatus("connected", 1200), deviceStatus("online", 61200)};
+    static TagoIOBatch batch;
+    batch.add("backfill_recovery_s", 154.0f, "s");
+    size_t length = batch.serialize();
+    CHECK(length > 0);
+    data.push_back(Bytes(batch.getPayload(), batch.getPayload() + length));
+
+    for (const Bytes &payload : data)
+    {
+        send(compressor, payload, UPLINK_COMPRESSED_SIZE, primed);
+
+        // Without the dictionary: a plain LZSS frame of the payload alone
+        static LzssEncoder encoder;
+        uint8_t out[LZSS_MAX_COMPRESSED_SIZE(256) + LZSS_FRAME_HEADER_SIZE];
+        size_t size = encoder.compressFrame(payload.data(), 0, payload.size(), out, sizeof(out));
+        CHECK(size > 0 && decodesTo(out, size, nullptr, 0, payload));
+        plain.raw += payload.size();
+        plain.sent += size < payload.size() ? size : payload.size();
+        plain.publishes++;
+        plain.compressed += size < payload.size();
+    }
+    report("data JSON, no dictionary", plain, (uint32_t)data.size());
+    report("data JSON, dictionary", primed, (uint32_t)data.size());
+    CHECK(primed.compressed == data.size());
+    CHECK(primed.sent * 2 < primed.raw);
+
+    return hostCheckResult("uplinkCompressor");
+}
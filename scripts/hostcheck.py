@@ -0,0 +1,137 @@
+#!/usr/bin/env python3
+"""
+Build and run host checks of firmware sources.
+
+Each check compiles real files from src/ together with a driver in
+scripts/host/ and the shims in scripts/host/shim/ (Arduino.h, FreeRTOS, LOG_*)
+with the host C++ compiler, then runs it. Drivers exit non-zero when a
+check fails; benchmarks print their measurements (host CPU, so timings only
+compare code paths with each other).
+
+Firmware headers that pull in device-only libraries are replaced by a
+generated header holding just the declarations a check needs, cut out of the
+real header (see EXTRACTS), so the checked code sees the same types.
+
+Usage:
+    python scripts/hostcheck.py [check...] [--list] [--cxx g++]
+
+Without arguments every check runs. Needs a C++17 compiler. Checks that take
+input files generate their own (deltaPatcher: a synthetic image pair and its
+patch); scripts/otadelta.py test runs it on real images.
+"""
+
+import argparse
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+ROOT = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..")
+HOST = os.path.join(ROOT, "scripts", "host")
+
+
+
+def delta_patch_inputs(outdir):
+    """Synthetic firmware-like image pair and its patch, built by scripts/otadelta.py"""
+    import otadelta
+    old, new = otadelta._synthetic_pair()
+    paths = [os.path.join(outdir, name) for name in ("old.bin", "new.bin", "patch.bin")]
+    for path, data in zip(paths, (old, new, otadelta.diff(old, new))):
+        with open(path, "wb") as f:
+            f.write(data)
+    return paths
+
+
+# name: (driver in scripts/host/, firmware sources in src/, arguments(outdir) or None)
+CHECKS = {
+    "logRateLimiter": ("logRateLimiterCheck.cpp", ["logging/logRateLimiter.cpp"], None),
+    "telemetryEncoder": ("telemetryEncoderBench.cpp",
+                         ["telemetry/telemetryEncoder.cpp", "telemetry/dseChannels.cpp", "telemetry/tagoIOBatch.cpp",
+                          "utils/cborWriter.cpp", "utils/jsonStreamWriter.cpp"], None),
+    "telemetryHub": ("telemetryHubCheck.cpp",
+                     ["telemetry/telemetryHub.cpp", "telemetry/dseChannels.cpp", "utils/jsonStreamWriter.cpp"], None),
+    "mqttPublishWindow": ("mqttPublishWindowCheck.cpp", ["utils/mqttPublishWindow.cpp"], None),
+    "uplinkCompressor": ("uplinkCompressorCheck.cpp",
+                         ["telemetry/uplinkCompressor.cpp", "utils/lzss.cpp", "telemetry/telemetryEncoder.cpp",
+                          "telemetry/dseChannels.cpp", "telemetry/tagoIOBatch.cpp", "utils/cborWriter.cpp",
+                          "utils/jsonStreamWriter.cpp"], None),
+    "deltaPatcher": ("deltaPatcherCheck.cpp", ["ota/deltaPatcher.cpp", "utils/lzss.cpp"], delta_patch_inputs),
+    "serviceBackoff": ("serviceBackoffSim.cpp", ["services/baseService.cpp", "metrics/metricsRegistry.cpp"], None),
+}
+
+# Header replaced for host builds: (real header in src/, includes to keep, structs to copy)
+EXTRACTS = {
+    "services/modbusMonitorService.h": ("services/modbusMonitorService.h", ["modbusData.h"], ["DSEData"]),
+}
+
+
+def generate_headers(outdir):
+    for header, (source, includes, structs) in EXTRACTS.items():
+        with open(os.path.join(ROOT, "src", source)) as f:
+            text = f.read()
+        lines = ["#pragma once", "// Generated by scripts/hostcheck.py from src/%s" % source, "#include <Arduino.h>"]
+        lines += ['#include "%s"' % include for include in includes]
+        for struct in structs:
+            match = re.search(r"^struct %s\b.*?^};" % struct, text, re.S | re.M)
+            if not match:
+                raise SystemExit("struct %s not found in src/%s" % (struct, source))
+            lines.append(match.group(0))
+        path = os.path.join(outdir, "generated", header)
+        os.makedirs(os.path.dirname(path), exist_ok=True)
+        with open(path, "w") as f:
+            f.write("\n".join(lines) + "\n")
+
+
+def build(name, cxx, outdir):
+    driver, sources, _ = CHECKS[name]
+    binary = os.path.join(outdir, name)
+    command = [cxx, "-std=c++17", "-O2", "-Wall", "-Wno-unused-function",
+               "-I", os.path.join(outdir, "generated"), "-I", os.path.join(HOST, "shim"), "-I", HOST,
+               "-I", os.path.join(ROOT, "include"), "-I", os.path.join(ROOT, "src"),
+               "-o", binary, os.path.join(HOST, driver), os.path.join(HOST, "hostCheck.cpp")]
+    command += [os.path.join(ROOT, "src", source) for source in sources]
+    subprocess.run(command, check=True)
+    return binary
+
+
+def run(name, arguments=None, cxx=None):
+    """Build and run one check; arguments default to the check's own inputs. True if it passed."""
+    with tempfile.TemporaryDirectory() as outdir:
+        generate_headers(outdir)
+        try:
+            binary = build(name, cxx or os.environ.get("CXX", "g++"), outdir)
+        except subprocess.CalledProcessError:
+            return False
+        prepare = CHECKS[name][2]
+        if arguments is None:
+            arguments = prepare(outdir) if prepare else []
+        return subprocess.run([binary] + list(arguments)).returncode == 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Build and run host checks of firmware sources")
+    parser.add_argument("checks", nargs="*", help="checks to run (default: all)")
+    parser.add_argument("--list", action="store_true", help="list the checks")
+    parser.add_argument("--cxx", default=os.environ.get("CXX", "g++"))
+    args = parser.parse_args()
+
+    if args.list:
+        for name, (driver, sources, _) in CHECKS.items():
+            print("%-18s %s" % (name, ", ".join(sources)))
+        return
+
+    names = args.checks or list(CHECKS)
+    unknown = [name for name in names if name not in CHECKS]
+    if unknown:
+        parser.error("unknown check: %s" % ", ".join(unknown))
+
+    failed = [name for name in names if not run(name, cxx=args.cxx)]
+
+    if failed:
+        print("failed: %s" % ", ".join(failed))
+        sys.exit(1)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,201 @@
+#!/usr/bin/env python3
+"""
+Decode binary log records produced by the DL1000 LoggingManager.
+
+Binary records only carry the addresses of the tag and format strings, so the
+firmware ELF of the exact build that produced the log is needed to resolve them
+(.pio/build/<env>/firmware.elf).
+
+Usage:
+    python scripts/logdecode.py <firmware.elf> <log.bin|segment.log|segment.lz>... [--json]
+
+Segment files pulled from the device's /logs directory are accepted directly:
+    raw segment:        "DLG1" [encoding:1] [reserved:3] [records...]
+    compressed segment: "DLZ1" [reserved:4] [LZSS stream of the raw segment]
+Text and JSON segments are printed as they are.
+
+Record layout (little endian), see src/logging/logRecord.h:
+    [magic:1=0xB1][level:1][timestamp:4][tag:4][format:4][argCount:1][argBytes:2][args...]
+Packed argument layout: [type:1][value...]
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import lzss  # noqa: E402
+
+try:
+    from elftools.elf.elffile import ELFFile
+except ImportError:
+    sys.exit("pyelftools is required: pip install pyelftools")
+
+RECORD_MAGIC = 0xB1
+HEADER = struct.Struct("<BBIIIBH")
+LEVELS = ["ERROR", "WARN", "INFO", "DEBUG"]
+
+SEGMENT_MAGIC = b"DLG1"
+ARCHIVE_MAGIC = b"DLZ1"
+SEGMENT_HEADER_SIZE = 8
+ENCODING_TEXT, ENCODING_BINARY, ENCODING_JSON = range(3)
+
+ARG_INT32, ARG_INT64, ARG_DOUBLE, ARG_STRING, ARG_POINTER = range(1, 6)
+
+SPEC_RE = re.compile(r"%([-+ #0]*)(\*|\d+)?(?:\.(\*|\d+))?(hh|h|ll|l|L|z|j|t|q)?([diuxXocfFeEgGaAsp%])")
+
+
+class StringTable:
+    """Resolves string addresses against the loadable sections of the firmware ELF."""
+
+    def __init__(self, elf_path):
+        self.sections = []
+        with open(elf_path, "rb") as f:
+            elf = ELFFile(f)
+            for section in elf.iter_sections():
+                if section["sh_type"] == "SHT_PROGBITS" and section["sh_addr"] and section["sh_size"]:
+                    self.sections.append((section["sh_addr"], section.data()))
+        self.cache = {}
+
+    def lookup(self, address):
+        if address in self.cache:
+            return self.cache[address]
+        text = "<0x%08x>" % address
+        for base, data in self.sections:
+            if base <= address < base + len(data):
+                end = data.find(b"\0", address - base)
+                text = data[address - base:end].decode("utf-8", "replace")
+                break
+        self.cache[address] = text
+        return text
+
+
+def read_args(data):
+    args = []
+    pos = 0
+    while pos < len(data):
+        arg_type = data[pos]
+        pos += 1
+        if arg_type == ARG_INT32:
+            args.append(("i32", struct.unpack_from("<i", data, pos)[0]))
+            pos += 4
+        elif arg_type == ARG_POINTER:
+            args.append(("ptr", struct.unpack_from("<I", data, pos)[0]))
+            pos += 4
+        elif arg_type == ARG_INT64:
+            args.append(("i64", struct.unpack_from("<q", data, pos)[0]))
+            pos += 8
+        elif arg_type == ARG_DOUBLE:
+            args.append(("f64", struct.unpack_from("<d", data, pos)[0]))
+            pos += 8
+        elif arg_type == ARG_STRING:
+            length = data[pos]
+            args.append(("str", data[pos + 1:pos + 1 + length].decode("utf-8", "replace")))
+            pos += 1 + length
+        else:
+            break
+    return args
+
+
+def format_message(fmt, args):
+    """Mirror of LogFormatter::formatMessage - the stored type decides the rendering."""
+    queue = list(args)
+
+    def take(kind_ok, with_kind=False):
+        if queue and queue[0][0] in kind_ok:
+            kind, value = queue.pop(0)
+            return (kind, value) if with_kind else value
+        if queue:
+            queue.pop(0)
+        return (None, None) if with_kind else None
+
+    def replace(match):
+        flags, width, precision, _, conversion = match.groups()
+        if conversion == "%":
+            return "%"
+        if width == "*":
+            width = str(take(("i32",)) or 0)
+        if precision == "*":
+            precision = str(take(("i32",)) or 0)
+        spec = "%" + flags + (width or "") + ("." + precision if precision is not None else "")
+
+        if conversion in "diuxXoc":
+            kind, value = take(("i32", "i64"), with_kind=True)
+            if value is None:
+                return "<?>"
+            if conversion in "uxXo" and value < 0:
+                value += 1 << (32 if kind == "i32" else 64)
+            if conversion == "u":
+                conversion = "d"
+            return (spec + conversion) % value
+        if conversion in "fFeEgGaA":
+            value = take(("f64",))
+            if value is None:
+                return "<?>"
+            return (spec + conversion.replace("a", "e").replace("A", "E")) % value
+        if conversion == "s":
+            value = take(("str",))
+            return "<?>" if value is None else (spec + "s") % value
+        if conversion == "p":
+            value = take(("ptr",))
+            return "<?>" if value is None else "0x%x" % value
+        return match.group(0)
+
+    return SPEC_RE.sub(replace, fmt)
+
+
+def decode(strings, data):
+    pos = 0
+    while pos + HEADER.size <= len(data):
+        magic, level, timestamp, tag, fmt, _, arg_bytes = HEADER.unpack_from(data, pos)
+        if magic != RECORD_MAGIC:
+            # Resynchronise on the next record marker
+            pos += 1
+            continue
+        args = read_args(data[pos + HEADER.size:pos + HEADER.size + arg_bytes])
+        pos += HEADER.size + arg_bytes
+        yield {
+            "ts": timestamp,
+            "level": LEVELS[level] if level < len(LEVELS) else str(level),
+            "tag": strings.lookup(tag),
+            "msg": format_message(strings.lookup(fmt), args),
+        }
+
+
+def unpack_segment(data):
+    """Return (encoding, records) for a segment file, or (binary, data) for a plain capture."""
+    if data[:4] == ARCHIVE_MAGIC:
+        data = lzss.decompress(data[SEGMENT_HEADER_SIZE:])
+    if data[:4] == SEGMENT_MAGIC:
+        return data[4], data[SEGMENT_HEADER_SIZE:]
+    return ENCODING_BINARY, data
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode DL1000 binary log records")
+    parser.add_argument("elf", help="firmware.elf of the build that produced the log")
+    parser.add_argument("logs", nargs="+", help="binary log or segment files, oldest first ('-' for stdin)")
+    parser.add_argument("--json", action="store_true", help="emit one JSON object per record")
+    options = parser.parse_args()
+
+    strings = StringTable(options.elf)
+    for path in options.logs:
+        data = sys.stdin.buffer.read() if path == "-" else open(path, "rb").read()
+        encoding, data = unpack_segment(data)
+
+        if encoding in (ENCODING_TEXT, ENCODING_JSON):
+            sys.stdout.write(data.decode("utf-8", "replace"))
+            continue
+
+        for record in decode(strings, data):
+            if options.json:
+                print(json.dumps(record))
+            else:
+                print("[%d][%s][%s] %s" % (record["ts"], record["level"], record["tag"], record["msg"]))
+
+
+if __name__ == "__main__":
+    main()
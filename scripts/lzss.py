@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+Host-side implementation of the DL1000 LZSS stream format (src/utils/lzss.h).
+
+Used to decompress archived log segments and to compress firmware images for
+compressed OTA updates.
+
+Usage:
+    python scripts/lzss.py compress <input> <output>
+    python scripts/lzss.py decompress <input> <output>
+    python scripts/lzss.py image <firmware.bin> <output>
+        Compressed OTA image for devices/<id>/ota/compressed: "NLZ1", the raw
+        image size (4 bytes, little endian), then the LZSS stream. Publish it
+        with scripts/otapush.py --kind compressed --digest <SHA-256 of the raw
+        firmware.bin>.
+    python scripts/lzss.py test <firmware.bin> [...]
+        Round-trip firmware images through the OTA image format and report the
+        compression ratio.
+"""
+
+import struct
+import sys
+import time
+
+IMAGE_MAGIC = b"NLZ1"
+
+WINDOW_SIZE = 4096
+MIN_MATCH = 3
+MAX_MATCH = 18
+FRAME_SIZE = 4096
+MAX_CANDIDATES = 32
+
+
+def _compress_frame(data, start, end, chains):
+    out = bytearray()
+    pos = start
+    while pos < end:
+        flag_index = len(out)
+        out.append(0)
+        flags = 0
+        for bit in range(8):
+            if pos >= end:
+                break
+            best_length = 0
+            best_offset = 0
+            if pos + MIN_MATCH <= end:
+                key = bytes(data[pos:pos + MIN_MATCH])
+                limit = min(MAX_MATCH, end - pos)
+                for candidate in reversed(chains.get(key, ())[-MAX_CANDIDATES:]):
+                    if pos - candidate > WINDOW_SIZE:
+                        break
+                    length = MIN_MATCH
+                    while length < limit and data[candidate + length] == data[pos + length]:
+                        length += 1
+                    if length > best_length:
+                        best_length = length
+                        best_offset = pos - candidate
+                        if length == limit:
+                            break
+            if best_length >= MIN_MATCH:
+                offset = best_offset - 1
+                out.append(((offset >> 8) << 4) | (best_length - MIN_MATCH))
+                out.append(offset & 0xFF)
+                flags |= 1 << bit
+                step = best_length
+            else:
+                out.append(data[pos])
+                step = 1
+            for i in range(pos, pos + step):
+                if i + MIN_MATCH <= end:
+                    chains.setdefault(bytes(data[i:i + MIN_MATCH]), []).append(i)
+            pos += step
+        out[flag_index] = flags
+    return bytes(out)
+
+
+def compress(data, dictionary=b""):
+    """Compress data into a framed stream. The optional dictionary primes the window."""
+    buffer = bytes(dictionary[-WINDOW_SIZE:]) + bytes(data)
+    chains = {}
+    for i in range(0, len(buffer) - len(data) - MIN_MATCH + 1):
+        chains.setdefault(buffer[i:i + MIN_MATCH], []).append(i)
+
+    out = bytearray()
+    pos = len(buffer) - len(data)
+    while pos < len(buffer):
+        end = min(pos + FRAME_SIZE, len(buffer))
+        frame = _compress_frame(buffer, pos, end, chains)
+        out += struct.pack("<HH", end - pos, len(frame)) + frame
+        pos = end
+        # Drop chain entries that fell out of the window to bound memory
+        if len(chains) > 200000:
+            chains = {k: [p for p in v if pos - p <= WINDOW_SIZE] for k, v in chains.items()}
+            chains = {k: v for k, v in chains.items() if v}
+    return bytes(out)
+
+
+def decompress(stream, dictionary=b""):
+    """Decompress a framed stream."""
+    history = bytearray(dictionary[-WINDOW_SIZE:])
+    base = len(history)
+    pos = 0
+    while pos + 4 <= len(stream):
+        raw_length, compressed_length = struct.unpack_from("<HH", stream, pos)
+        pos += 4
+        end = pos + compressed_length
+        produced = 0
+        while pos < end:
+            flags = stream[pos]
+            pos += 1
+            for bit in range(8):
+                if pos >= end:
+                    break
+                if flags & (1 << bit):
+                    high, low = stream[pos], stream[pos + 1]
+                    pos += 2
+                    offset = (((high >> 4) << 8) | low) + 1
+                    length = (high & 0x0F) + MIN_MATCH
+                    if offset > len(history):
+                        raise ValueError("corrupt stream: offset beyond window")
+                    for _ in range(length):
+                        history.append(history[-offset])
+                    produced += length
+                else:
+                    history.append(stream[pos])
+                    pos += 1
+                    produced += 1
+        if produced != raw_length:
+            raise ValueError("corrupt stream: frame length mismatch")
+    return bytes(history[base:])
+
+
+def compress_image(firmware):
+    """Compressed OTA image: magic, raw size, LZSS stream."""
+    return IMAGE_MAGIC + struct.pack("<I", len(firmware)) + compress(firmware)
+
+
+def decompress_image(image):
+    if image[:4] != IMAGE_MAGIC:
+        raise ValueError("not a compressed OTA image")
+    size = struct.unpack_from("<I", image, 4)[0]
+    firmware = decompress(image[8:])
+    if len(firmware) != size:
+        raise ValueError("image size mismatch")
+    return firmware
+
+
+def _test(paths):
+    failed = False
+    for path in paths:
+        firmware = open(path, "rb").read()
+        started = time.time()
+        image = compress_image(firmware)
+        elapsed = time.time() - started
+        ok = decompress_image(image) == firmware
+        failed |= not ok
+        print("%s: %d -> %d bytes (%.1f%%), compressed in %.1f s: %s" %
+              (path, len(firmware), len(image), 100.0 * len(image) / max(1, len(firmware)), elapsed,
+               "PASS" if ok else "FAIL"))
+    if failed:
+        sys.exit(1)
+
+
+def main():
+    if len(sys.argv) >= 3 and sys.argv[1] == "test":
+        _test(sys.argv[2:])
+        return
+    if len(sys.argv) != 4 or sys.argv[1] not in ("compress", "decompress", "image"):
+        sys.exit(__doc__)
+    if sys.argv[1] == "image":
+        firmware = open(sys.argv[2], "rb").read()
+        image = compress_image(firmware)
+        open(sys.argv[3], "wb").write(image)
+        print("image: %d -> %d bytes (%.1f%%)" % (len(firmware), len(image), 100.0 * len(image) / max(1, len(firmware))))
+        return
+    data = open(sys.argv[2], "rb").read()
+    result = compress(data) if sys.argv[1] == "compress" else decompress(data)
+    open(sys.argv[3], "wb").write(result)
+    print("%s: %d -> %d bytes (%.1f%%)" % (sys.argv[1], len(data), len(result),
+                                           100.0 * len(result) / max(1, len(data))))
+
+
+if __name__ == "__main__":
+    main()
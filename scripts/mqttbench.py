@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+Stand-in MQTT broker for measuring the QoS1 in-flight window on a device.
+
+It accepts any client and acknowledges QoS1 publishes after --delay-ms, to
+emulate the round trip to a remote broker. Point a device at it and read the
+window statistics NovaLogicService logs every minute (sent, acked,
+retransmitted, mean ack time, peak in flight). For a real mosquitto, add
+latency with e.g. `tc qdisc add dev lo root netem delay 25ms` instead.
+
+The window code itself (src/utils/mqttPublishWindow.cpp) is checked and
+benchmarked on the host against a simulated broker:
+    python scripts/hostcheck.py mqttPublishWindow
+
+Usage:
+    python scripts/mqttbench.py broker [--port 1883] [--delay-ms 50]
+"""
+
+import argparse
+import heapq
+import select
+import socket
+import struct
+import sys
+import time
+
+CONNECT, CONNACK, PUBLISH, PUBACK, PINGREQ, PINGRESP, DISCONNECT = 1, 2, 3, 4, 12, 13, 14
+
+
+def encode_length(length):
+    out = bytearray()
+    while True:
+        byte, length = length % 128, length // 128
+        out.append(byte | (0x80 if length else 0))
+        if not length:
+            return bytes(out)
+
+
+def packet(kind, flags, body):
+    return bytes([kind << 4 | flags]) + encode_length(len(body)) + body
+
+
+def utf8(text):
+    data = text.encode()
+    return struct.pack(">H", len(data)) + data
+
+
+class PacketReader:
+    def __init__(self, sock):
+        self.sock = sock
+        self.buffer = b""
+
+    def feed(self):
+        data = self.sock.recv(65536)
+        if not data:
+            raise ConnectionError("connection closed")
+        self.buffer += data
+
+    def packets(self):
+        while len(self.buffer) >= 2:
+            length, multiplier, pos = 0, 1, 1
+            while True:
+                if pos >= len(self.buffer):
+                    return
+                byte = self.buffer[pos]
+                length += (byte & 0x7F) * multiplier
+                multiplier *= 128
+                pos += 1
+                if not byte & 0x80:
+                    break
+            if len(self.buffer) < pos + length:
+                return
+            header, body = self.buffer[0], self.buffer[pos:pos + length]
+            self.buffer = self.buffer[pos + length:]
+            yield header >> 4, header & 0x0F, body
+
+
+# Client (also used by scripts/configpush.py) -------------------------------------------
+
+def connect(host, port, client_id):
+    sock = socket.create_connection((host, port))
+    sock.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+    body = utf8("MQTT") + bytes([4, 0x02]) + struct.pack(">H", 60) + utf8(client_id)
+    sock.sendall(packet(CONNECT, 0, body))
+    reader = PacketReader(sock)
+    while True:
+        reader.feed()
+        for kind, _, body in reader.packets():
+            if kind == CONNACK:
+                if body[1] != 0:
+                    raise ConnectionError("CONNACK return code %d" % body[1])
+                return sock, reader
+
+
+# Stand-in broker -----------------------------------------------------------------------
+
+def broker(args):
+    server = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+    server.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+    server.bind(("0.0.0.0", args.port))
+    server.listen()
+    print("stand-in broker on port %d, PUBACK delay %d ms" % (args.port, args.delay_ms))
+
+    clients = {}
+    pending = []    # (due, order, socket, data)
+    order = 0
+    while True:
+        timeout = max(0.0, pending[0][0] - time.monotonic()) if pending else None
+        readable, _, _ = select.select([server] + list(clients), [], [], timeout)
+
+        for sock in readable:
+            if sock is server:
+                client, _ = server.accept()
+                client.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+                clients[client] = PacketReader(client)
+                continue
+            try:
+                clients[sock].feed()
+                for kind, flags, body in clients[sock].packets():
+                    reply = None
+                    if kind == CONNECT:
+                        reply = packet(CONNACK, 0, b"\x00\x00")
+                    elif kind == PUBLISH and (flags >> 1) & 3:
+                        topic_length = struct.unpack(">H", body[:2])[0]
+                        reply = packet(PUBACK, 0, body[2 + topic_length:4 + topic_length])
+                    elif kind == PINGREQ:
+                        reply = packet(PINGRESP, 0, b"")
+                    elif kind == DISCONNECT:
+                        raise ConnectionError
+                    if reply:
+                        order += 1
+                        heapq.heappush(pending, (time.monotonic() + args.delay_ms / 1000, order, sock, reply))
+            except (ConnectionError, OSError):
+                del clients[sock]
+                sock.close()
+
+        now = time.monotonic()
+        while pending and pending[0][0] <= now:
+            _, _, sock, data = heapq.heappop(pending)
+            if sock in clients:
+                sock.sendall(data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Stand-in broker for QoS1 in-flight window measurements")
+    commands = parser.add_subparsers(dest="command", required=True)
+    broker_parser = commands.add_parser("broker", help="run a PUBACK-only stand-in broker")
+    broker_parser.add_argument("--port", type=int, default=1883)
+    broker_parser.add_argument("--delay-ms", type=int, default=50)
+    args = parser.parse_args()
+
+    try:
+        broker(args)
+    except KeyboardInterrupt:
+        sys.exit(0)
+
+
+if __name__ == "__main__":
+    main()
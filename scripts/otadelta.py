@@ -0,0 +1,292 @@
+#!/usr/bin/env python3
+"""
+Build and apply delta OTA patches (src/ota/deltaPatcher.h format).
+
+A patch rebuilds a new firmware image from the image the device is running and
+is published to devices/<id>/ota/delta instead of the full image on ota/update
+(scripts/otapush.py --kind delta).
+The device checks the source digest against its running partition, applies the
+patch while it streams in and verifies the target digest before switching the
+boot partition.
+
+Usage:
+    python scripts/otadelta.py diff <old.bin> <new.bin> <patch.bin>
+        Build a patch. <old.bin> must be the exact image the devices run.
+    python scripts/otadelta.py apply <old.bin> <patch.bin> <new.bin>
+        Apply a patch with the reference implementation (same checks as the device).
+    python scripts/otadelta.py test [<old.bin> <new.bin>]
+        Build a patch and apply it with the firmware's own DeltaPatcher and
+        LzssDecoder, compiled for the host (scripts/hostcheck.py deltaPatcher):
+        the rebuilt image must match, and patches for the wrong image, corrupt
+        or truncated patches must be rejected. Without arguments a synthetic
+        firmware-like pair is used.
+"""
+
+import hashlib
+import os
+import random
+import struct
+import sys
+import time
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import lzss  # noqa: E402
+
+MAGIC = b"NDP1"
+HEADER_FORMAT = "<4sII32s32s"
+HEADER_SIZE = struct.calcsize(HEADER_FORMAT)
+
+OP_END, OP_COPY, OP_ADD, OP_INSERT = 0, 1, 2, 3
+
+KEY_LENGTH = 12        # Bytes hashed to find match candidates
+INDEX_STRIDE = 4       # Source positions indexed (every 4th keeps the index small)
+MAX_CANDIDATES = 4
+MIN_COPY = 24          # Shorter exact matches are cheaper as literals
+APPROX_WINDOW = 32     # Approximate extension step; kept while half the bytes match
+
+
+def _varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7F
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def _zigzag(value):
+    return (value << 1) if value >= 0 else ((-value << 1) - 1)
+
+
+def _read_varint(data, pos):
+    value = shift = 0
+    while True:
+        if pos >= len(data) or shift > 28:
+            raise ValueError("corrupt patch: varint")
+        byte = data[pos]
+        pos += 1
+        value |= (byte & 0x7F) << shift
+        shift += 7
+        if not byte & 0x80:
+            return value, pos
+
+
+def _exact_length(old, s, new, t):
+    """Length of the common run old[s:] / new[t:]."""
+    limit = min(len(old) - s, len(new) - t)
+    length = 0
+    step = 256
+    while length < limit:
+        n = min(step, limit - length)
+        if old[s + length:s + length + n] == new[t + length:t + length + n]:
+            length += n
+            continue
+        while length < limit and old[s + length] == new[t + length]:
+            length += 1
+        break
+    return length
+
+
+def _approx_length(old, s, new, t):
+    """Extend along the same alignment while at least half of each window matches."""
+    length = 0
+    while s + length < len(old) and t + length < len(new):
+        n = min(APPROX_WINDOW, len(old) - s - length, len(new) - t - length)
+        a = old[s + length:s + length + n]
+        b = new[t + length:t + length + n]
+        if sum(1 for x, y in zip(a, b) if x == y) * 2 < n:
+            break
+        length += n
+    return length
+
+
+class _OpWriter:
+    def __init__(self):
+        self.out = bytearray()
+        self.source_pos = 0
+
+    def _source_op(self, op, start, length):
+        self.out.append(op)
+        self.out += _varint(length)
+        self.out += _varint(_zigzag(start - self.source_pos))
+        self.source_pos = start + length
+
+    def copy(self, start, length):
+        self._source_op(OP_COPY, start, length)
+
+    def add(self, old, start, new, t, length):
+        self._source_op(OP_ADD, start, length)
+        self.out += bytes((new[t + i] - old[start + i]) & 0xFF for i in range(length))
+
+    def insert(self, data):
+        if data:
+            self.out.append(OP_INSERT)
+            self.out += _varint(len(data))
+            self.out += data
+
+    def end(self):
+        self.out.append(OP_END)
+        return bytes(self.out)
+
+
+def diff(old, new):
+    """Build a patch that rebuilds new from old."""
+    old = memoryview(old)
+    new = memoryview(new)
+    index = {}
+    for s in range(0, len(old) - KEY_LENGTH + 1, INDEX_STRIDE):
+        candidates = index.setdefault(bytes(old[s:s + KEY_LENGTH]), [])
+        if len(candidates) < MAX_CANDIDATES:
+            candidates.append(s)
+
+    ops = _OpWriter()
+    literal = 0
+    t = 0
+    while t <= len(new) - KEY_LENGTH:
+        best_s = best_back = best_forward = 0
+        for s in index.get(bytes(new[t:t + KEY_LENGTH]), ()):
+            forward = _exact_length(old, s, new, t)
+            back = 0
+            while t - back > literal and s - back > 0 and old[s - back - 1] == new[t - back - 1]:
+                back += 1
+            if back + forward > best_back + best_forward:
+                best_s, best_back, best_forward = s, back, forward
+        if best_back + best_forward < MIN_COPY:
+            t += 1
+            continue
+
+        start_t = t - best_back
+        start_s = best_s - best_back
+        ops.insert(bytes(new[literal:start_t]))
+        ops.copy(start_s, best_back + best_forward)
+        t = start_t + best_back + best_forward
+        s = start_s + best_back + best_forward
+
+        # Code that moved differs in a few bytes per instruction (addresses): ADD the difference
+        approx = _approx_length(old, s, new, t)
+        if approx:
+            ops.add(old, s, new, t, approx)
+            t += approx
+        literal = t
+
+    ops.insert(bytes(new[literal:]))
+    body = lzss.compress(ops.end())
+    header = struct.pack(HEADER_FORMAT, MAGIC, len(old), len(new),
+                         hashlib.sha256(old).digest(), hashlib.sha256(new).digest())
+    return header + body
+
+
+def apply(old, patch):
+    """Reference implementation of the device patcher; raises ValueError on any mismatch."""
+    if len(patch) < HEADER_SIZE:
+        raise ValueError("patch truncated")
+    magic, source_size, target_size, source_digest, target_digest = struct.unpack_from(HEADER_FORMAT, patch)
+    if magic != MAGIC:
+        raise ValueError("not a delta patch")
+    if source_size > len(old) or hashlib.sha256(old[:source_size]).digest() != source_digest:
+        raise ValueError("patch does not match the source image")
+
+    ops = lzss.decompress(patch[HEADER_SIZE:])
+    out = bytearray()
+    pos = source_pos = 0
+    while True:
+        if pos >= len(ops):
+            raise ValueError("corrupt patch: missing end")
+        op = ops[pos]
+        pos += 1
+        if op == OP_END:
+            break
+        if op not in (OP_COPY, OP_ADD, OP_INSERT):
+            raise ValueError("corrupt patch: operation %d" % op)
+        length, pos = _read_varint(ops, pos)
+        if len(out) + length > target_size:
+            raise ValueError("corrupt patch: target overrun")
+        if op == OP_INSERT:
+            out += ops[pos:pos + length]
+            pos += length
+            continue
+        offset, pos = _read_varint(ops, pos)
+        source_pos += (offset >> 1) ^ -(offset & 1)
+        if source_pos < 0 or source_pos + length > source_size:
+            raise ValueError("corrupt patch: source range")
+        if op == OP_COPY:
+            out += old[source_pos:source_pos + length]
+        else:
+            out += bytes((old[source_pos + i] + ops[pos + i]) & 0xFF for i in range(length))
+            pos += length
+        source_pos += length
+
+    if pos != len(ops) or len(out) != target_size:
+        raise ValueError("corrupt patch: size mismatch")
+    if hashlib.sha256(out).digest() != target_digest:
+        raise ValueError("rebuilt image digest mismatch")
+    return bytes(out)
+
+
+def _synthetic_pair(size=768 * 1024, seed=1):
+    """Firmware-like pair: code with embedded 4-byte addresses, a new function, a
+    removed block and every address past the insertion shifted."""
+    rng = random.Random(seed)
+    words = [rng.getrandbits(16) for _ in range(512)]
+    old = bytearray()
+    while len(old) < size:
+        if rng.random() < 0.2:
+            old += struct.pack("<I", 0x42000000 + rng.randrange(size))     # address literal
+        else:
+            old += struct.pack("<H", rng.choice(words))                     # instruction
+    old = bytes(old[:size])
+
+    insert_at, remove_at = size // 4, size // 2
+    new = bytearray(old[:insert_at] + bytes(rng.getrandbits(8) for _ in range(3000)) +
+                    old[insert_at:remove_at] + old[remove_at + 1500:])
+    for i in range(insert_at, len(new) - 4, 2):
+        value = struct.unpack_from("<I", new, i)[0]
+        if 0x42000000 + insert_at <= value < 0x42000000 + size and rng.random() < 0.5:
+            struct.pack_into("<I", new, i, value + 1500)
+    new[-200:-180] = b"DL1000 v9.9.9 build\0"
+    return old, bytes(new)
+
+
+def _test(old, new):
+    import hostcheck
+    import tempfile
+
+    started = time.time()
+    patch = diff(old, new)
+    print("patch built in %.1f s" % (time.time() - started))
+
+    with tempfile.TemporaryDirectory() as workdir:
+        paths = [os.path.join(workdir, name) for name in ("old.bin", "new.bin", "patch.bin")]
+        for path, data in zip(paths, (old, new, patch)):
+            with open(path, "wb") as f:
+                f.write(data)
+        if not hostcheck.run("deltaPatcher", paths):
+            sys.exit("FAIL")
+    print("PASS")
+
+
+def main():
+    args = sys.argv[1:]
+    if len(args) == 4 and args[0] == "diff":
+        old, new = open(args[1], "rb").read(), open(args[2], "rb").read()
+        patch = diff(old, new)
+        open(args[3], "wb").write(patch)
+        print("patch: %d bytes (%.1f%% of %d)" % (len(patch), 100.0 * len(patch) / max(1, len(new)), len(new)))
+    elif len(args) == 4 and args[0] == "apply":
+        new = apply(open(args[1], "rb").read(), open(args[2], "rb").read())
+        open(args[3], "wb").write(new)
+        print("rebuilt %d bytes, digest verified" % len(new))
+    elif args[:1] == ["test"] and len(args) in (1, 3):
+        if len(args) == 3:
+            _test(open(args[1], "rb").read(), open(args[2], "rb").read())
+        else:
+            _test(*_synthetic_pair())
+    else:
+        sys.exit(__doc__)
+
+
+if __name__ == "__main__":
+    main()
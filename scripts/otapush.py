@@ -0,0 +1,142 @@
+#!/usr/bin/env python3
+"""
+Publish an OTA image to one device in resumable segments.
+
+The device feeds each segment to the update and returns from the MQTT callback
+before the next one, so acquisition, logging and the other managers keep
+running during the transfer (see NovaLogicService::handleOTAMessage). Every
+segment is published on the OTA topic of the stream with a 12-byte header:
+    "OTAS" [offset:4] [total:4]   (little endian; total = size of the file)
+and answered on devices/<id>/ota/ack with the next offset the device expects:
+    {"offset":N,"total":T}        (0/0 when no transfer is in progress)
+A lost segment or a reconnect only costs a resend from the acknowledged offset.
+A delta patch may be acknowledged short of the segment end, and only after the
+device has verified its running image or finished a long COPY from it.
+Progress and the result arrive on devices/<id>/ota/status as for a single
+message.
+
+Usage:
+    python scripts/otapush.py <file> --device DL1000-0001 [--kind update|delta|compressed]
+                              [--digest HEX] [--segment 8192] [--host localhost] [--port 1883]
+                              [--timeout 10]
+
+    update      raw firmware.bin; its SHA-256 is published on ota/md5 unless --digest is given
+    delta       patch from scripts/otadelta.py diff (carries its own digests)
+    compressed  image from scripts/lzss.py image; pass --digest of the raw firmware.bin
+"""
+
+import argparse
+import hashlib
+import json
+import os
+import struct
+import sys
+import time
+
+from configpush import publish, subscribe
+from mqttbench import DISCONNECT, PUBLISH, connect, packet
+
+SEGMENT_MAGIC = b"OTAS"
+TOPIC_PREFIX = "devices"
+MAX_RESENDS = 10
+
+
+def receive(sock, reader, prefix, timeout):
+    """Next ota/ack or ota/status message of the device as (suffix, payload), None on timeout"""
+    deadline = time.monotonic() + timeout
+    while time.monotonic() < deadline:
+        for kind, flags, body in reader.packets():
+            if kind != PUBLISH:
+                continue
+            length = struct.unpack(">H", body[:2])[0]
+            topic = body[2:2 + length].decode()
+            payload = body[2 + length + (2 if (flags >> 1) & 3 else 0):]
+            if topic.startswith(prefix):
+                return topic[len(prefix):], payload
+        sock.settimeout(max(0.05, min(0.5, deadline - time.monotonic())))
+        try:
+            reader.feed()
+        except OSError:
+            continue
+    return None
+
+
+def push(sock, reader, args, data):
+    prefix = "%s/%s/" % (TOPIC_PREFIX, args.device)
+    topic = prefix + "ota/" + args.kind
+    offset, resends, start = 0, 0, time.monotonic()
+
+    while True:
+        if offset == 0 and args.digest:
+            publish(sock, prefix + "ota/md5", args.digest.encode())
+
+        segment = data[offset:offset + args.segment]
+        if segment:
+            publish(sock, topic, SEGMENT_MAGIC + struct.pack("<II", offset, len(data)) + segment)
+
+        message = receive(sock, reader, prefix, args.timeout)
+        while message and message[0] == "ota/status":
+            text = message[1].decode(errors="replace")
+            if text.startswith("Error"):
+                print("\n%s" % text)
+                return False
+            if text.startswith("Update successfully"):
+                print("\n%s (%d bytes in %.1f s)" % (text, len(data), time.monotonic() - start))
+                return True
+            message = receive(sock, reader, prefix, args.timeout)
+
+        if message is None:
+            resends += 1
+            if resends > MAX_RESENDS:
+                print("\nno answer from %s at %d/%d bytes" % (args.device, offset, len(data)))
+                return False
+            continue
+
+        try:
+            ack = json.loads(message[1])
+        except ValueError:
+            continue
+        # 0/0: the device dropped the transfer (timeout or restart), start over
+        expected = ack.get("offset", 0) if ack.get("total") == len(data) else 0
+        resends = 0 if expected > offset else resends + 1
+        if resends > MAX_RESENDS:
+            print("\n%s keeps expecting offset %d" % (args.device, expected))
+            return False
+        offset = expected
+        sys.stdout.write("\r%5.1f%% (%d/%d bytes)" % (100.0 * offset / len(data), offset, len(data)))
+        sys.stdout.flush()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Publish an OTA image to a device in resumable segments")
+    parser.add_argument("file", help="firmware image, delta patch or compressed image")
+    parser.add_argument("--device", required=True)
+    parser.add_argument("--kind", choices=("update", "delta", "compressed"), default="update")
+    parser.add_argument("--digest", help="MD5 or SHA-256 hex of the firmware image")
+    parser.add_argument("--segment", type=int, default=8192, help="stream bytes per message")
+    parser.add_argument("--host", default="localhost")
+    parser.add_argument("--port", type=int, default=1883)
+    parser.add_argument("--timeout", type=float, default=10, help="seconds to wait for each acknowledgement")
+    args = parser.parse_args()
+
+    with open(args.file, "rb") as f:
+        data = f.read()
+    if not data:
+        sys.exit("empty file")
+    if args.kind == "update" and not args.digest:
+        args.digest = hashlib.sha256(data).hexdigest()
+    elif args.kind == "compressed" and not args.digest:
+        print("warning: no --digest, the device cannot verify the decompressed image")
+
+    sock, reader = connect(args.host, args.port, "dl1000-ota-%d" % os.getpid())
+    prefix = "%s/%s/" % (TOPIC_PREFIX, args.device)
+    subscribe(sock, reader, prefix + "ota/ack")
+    subscribe(sock, reader, prefix + "ota/status")
+    ok = push(sock, reader, args, data)
+    sock.sendall(packet(DISCONNECT, 0, b""))
+    sock.close()
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""
+Local HTTP stand-in for resumable firmware downloads (src/ota/httpOtaDownloader.h).
+
+Serves one firmware image with HTTP/1.1 Range support, and can drop
+connections partway through to exercise the device's resume path.
+
+Usage:
+    python scripts/otaserver.py <firmware.bin> [--port 8080] [--drop-after BYTES] [--no-range]
+
+    --drop-after BYTES  close each response after BYTES body bytes (link loss)
+    --no-range          ignore Range headers and always answer 200 with the full image
+
+Then trigger the device with the URL and digest, e.g.:
+    mosquitto_pub -t devices/<id>/ota/url -m "http://<host>:8080/firmware.bin $(sha256sum firmware.bin | cut -c1-64)"
+"""
+
+import argparse
+import hashlib
+import http.server
+import os
+import re
+import socketserver
+
+
+def make_handler(image, drop_after, honour_range):
+    class Handler(http.server.BaseHTTPRequestHandler):
+        protocol_version = "HTTP/1.1"
+
+        def do_GET(self):
+            start = 0
+            match = re.match(r"bytes=(\d+)-(\d*)$", self.headers.get("Range", ""))
+            if honour_range and match:
+                start = int(match.group(1))
+                end = int(match.group(2)) + 1 if match.group(2) else len(image)
+                if start >= len(image) or end <= start:
+                    self.send_response(416)
+                    self.send_header("Content-Range", "bytes */%d" % len(image))
+                    self.send_header("Content-Length", "0")
+                    self.end_headers()
+                    return
+                body = image[start:min(end, len(image))]
+                self.send_response(206)
+                self.send_header("Content-Range", "bytes %d-%d/%d" % (start, start + len(body) - 1, len(image)))
+            else:
+                body = image
+                self.send_response(200)
+            self.send_header("Content-Type", "application/octet-stream")
+            self.send_header("Content-Length", str(len(body)))
+            self.send_header("Connection", "close")
+            self.end_headers()
+
+            sent = body if drop_after is None else body[:drop_after]
+            self.wfile.write(sent)
+            self.close_connection = True
+            self.log_message("sent %d/%d bytes from offset %d%s", len(sent), len(body), start,
+                             " (dropped)" if len(sent) < len(body) else "")
+
+    return Handler
+
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Range-capable firmware server for HTTP OTA tests")
+    parser.add_argument("image")
+    parser.add_argument("--port", type=int, default=8080)
+    parser.add_argument("--drop-after", type=int, default=None)
+    parser.add_argument("--no-range", action="store_true")
+    args = parser.parse_args()
+
+    image = open(args.image, "rb").read()
+    print("Serving %s (%d bytes, sha256 %s) on port %d" %
+          (os.path.basename(args.image), len(image), hashlib.sha256(image).hexdigest(), args.port))
+    Server(("", args.port), make_handler(image, args.drop_after, not args.no_range)).serve_forever()
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,234 @@
+#!/usr/bin/env python3
+"""
+Decode DL1000 binary DSE telemetry snapshots.
+
+Snapshots are CBOR maps with integer keys (see src/telemetry/telemetryEncoder.h):
+    0: version  1: sequence  2: timestamp (ms)  3: valid page mask (bit 0 = page 4)
+    4: keyframe - raw values of every channel on a valid page, in channel ID order
+    5: delta    - [idGap, valueDelta, ...] for changed channels only
+    6: unix time (s)  7: boot count - standalone keyframes replayed from the
+       store-and-forward queue (topic telemetry/dse/backfill)
+Real value = raw * 10^scale. Replayed snapshots are delivered at least once and
+are deduplicated on (boot count, sequence).
+
+Usage:
+    python scripts/telemetrydecode.py decode <snapshot.cbor>... [--json]
+        Files must be given in sequence order; a delta after a sequence gap is
+        skipped until the next keyframe. Replayed snapshots may be mixed in, also
+        as decompressed backfill blocks (scripts/uplinkdecode.py decode --output).
+
+Size and encode time against the TagoIO JSON batch are measured on the
+firmware code itself: python scripts/hostcheck.py telemetryEncoder
+"""
+
+import argparse
+import json
+import struct
+import sys
+
+FORMAT_VERSION = 1
+PAGES = (4, 5, 6, 7)
+
+# (id, page, name, unit, scale) - keep in sync with src/telemetry/dseChannels.cpp
+CHANNELS = [
+    (1, 4, "oilPressure", "kPa", 0),
+    (2, 4, "coolantTemp", "C", 0),
+    (3, 4, "oilTemp", "C", 0),
+    (4, 4, "fuelLevel", "%", 0),
+    (5, 4, "chargeAlternatorVoltage", "V", -1),
+    (6, 4, "engineBatteryVoltage", "V", -1),
+    (7, 4, "engineSpeed", "rpm", 0),
+    (8, 4, "generatorFrequency", "Hz", -1),
+    (9, 4, "generatorL1NVoltage", "V", -1),
+    (10, 4, "generatorL2NVoltage", "V", -1),
+    (11, 4, "generatorL3NVoltage", "V", -1),
+    (12, 4, "generatorL1L2Voltage", "V", -1),
+    (13, 4, "generatorL2L3Voltage", "V", -1),
+    (14, 4, "generatorL3L1Voltage", "V", -1),
+    (15, 4, "generatorL1Current", "A", -1),
+    (16, 4, "generatorL2Current", "A", -1),
+    (17, 4, "generatorL3Current", "A", -1),
+    (18, 4, "generatorEarthCurrent", "A", -1),
+    (19, 4, "generatorL1Watts", "W", 0),
+    (20, 4, "generatorL2Watts", "W", 0),
+    (21, 4, "generatorL3Watts", "W", 0),
+    (22, 4, "generatorCurrentLagLead", "deg", 0),
+    (23, 4, "mainsFrequency", "Hz", -1),
+    (24, 4, "mainsL1NVoltage", "V", -1),
+    (25, 4, "mainsL2NVoltage", "V", -1),
+    (26, 4, "mainsL3NVoltage", "V", -1),
+    (27, 4, "mainsL1L2Voltage", "V", -1),
+    (28, 4, "mainsL2L3Voltage", "V", -1),
+    (29, 4, "mainsL3L1Voltage", "V", -1),
+    (30, 4, "mainsVoltagePhaseLagLead", "deg", 0),
+    (31, 4, "generatorPhaseRotation", "", 0),
+    (32, 4, "mainsPhaseRotation", "", 0),
+    (33, 4, "mainsCurrentLagLead", "deg", 0),
+    (34, 4, "mainsL1Current", "A", -1),
+    (35, 4, "mainsL2Current", "A", -1),
+    (36, 4, "mainsL3Current", "A", -1),
+    (37, 4, "mainsEarthCurrent", "A", -1),
+    (38, 4, "mainsL1Watts", "W", 0),
+    (39, 4, "mainsL2Watts", "W", 0),
+    (40, 4, "mainsL3Watts", "W", 0),
+    (41, 5, "fuelConsumption", "L/h", -2),
+    (42, 6, "generatorTotalWatts", "W", 0),
+    (43, 6, "generatorL1VA", "VA", 0),
+    (44, 6, "generatorL2VA", "VA", 0),
+    (45, 6, "generatorL3VA", "VA", 0),
+    (46, 6, "generatorTotalVA", "VA", 0),
+    (47, 6, "generatorL1VAR", "var", 0),
+    (48, 6, "generatorL2VAR", "var", 0),
+    (49, 6, "generatorL3VAR", "var", 0),
+    (50, 6, "generatorTotalVAR", "var", 0),
+    (51, 6, "generatorPowerFactorL1", "", -2),
+    (52, 6, "generatorPowerFactorL2", "", -2),
+    (53, 6, "generatorPowerFactorL3", "", -2),
+    (54, 6, "generatorAveragePowerFactor", "", -2),
+    (55, 6, "generatorPercentageFullPower", "%", -1),
+    (56, 6, "generatorPercentageFullVar", "%", -1),
+    (57, 6, "mainsTotalWatts", "W", 0),
+    (58, 6, "mainsL1VA", "VA", 0),
+    (59, 6, "mainsL2VA", "VA", 0),
+    (60, 6, "mainsL3VA", "VA", 0),
+    (61, 6, "mainsTotalVA", "VA", 0),
+    (62, 7, "engineRunTime", "s", 0),
+]
+
+
+# CBOR ---------------------------------------------------------------------------------
+
+def cbor_decode(data, pos=0):
+    """Decode the subset written by CborWriter; returns (value, next position)."""
+    initial = data[pos]
+    major, info = initial >> 5, initial & 0x1F
+    pos += 1
+    if major == 7:
+        if info == 20:
+            return False, pos
+        if info == 21:
+            return True, pos
+        if info == 22:
+            return None, pos
+        if info == 26:
+            return struct.unpack_from(">f", data, pos)[0], pos + 4
+        raise ValueError("unsupported simple value %d" % info)
+
+    if info < 24:
+        argument = info
+    else:
+        size = {24: 1, 25: 2, 26: 4, 27: 8}[info]
+        argument = int.from_bytes(data[pos:pos + size], "big")
+        pos += size
+
+    if major == 0:
+        return argument, pos
+    if major == 1:
+        return -1 - argument, pos
+    if major in (2, 3):
+        raw = data[pos:pos + argument]
+        return (raw if major == 2 else raw.decode("utf-8")), pos + argument
+    if major == 4:
+        items = []
+        for _ in range(argument):
+            item, pos = cbor_decode(data, pos)
+            items.append(item)
+        return items, pos
+    if major == 5:
+        result = {}
+        for _ in range(argument):
+            key, pos = cbor_decode(data, pos)
+            result[key], pos = cbor_decode(data, pos)
+        return result, pos
+    raise ValueError("unsupported major type %d" % major)
+
+
+# Snapshot format ----------------------------------------------------------------------
+
+def valid_channels(mask):
+    return [c for c in CHANNELS if mask & (1 << (c[1] - 4))]
+
+
+class Decoder:
+    def __init__(self):
+        self.values = None
+        self.sequence = None
+        self.replayed = set()
+
+    def feed(self, payload):
+        """Decode one snapshot, or the CBOR sequence of a decompressed backfill block;
+        yields a result per snapshot (None if skipped)."""
+        pos = 0
+        while pos < len(payload):
+            snapshot, pos = cbor_decode(payload, pos)
+            yield self.apply(snapshot)
+
+    def apply(self, snapshot):
+        if snapshot.get(0) != FORMAT_VERSION:
+            raise ValueError("unknown format version %r" % snapshot.get(0))
+
+        sequence, mask = snapshot[1], snapshot[3]
+        channels = valid_channels(mask)
+        if 7 in snapshot:
+            # Replayed from flash: self-contained, independent of the live delta chain
+            key = (snapshot[7], sequence)
+            if key in self.replayed:
+                return None
+            self.replayed.add(key)
+            values = {c[0]: raw for c, raw in zip(channels, snapshot[4])}
+            return self.result(snapshot, channels, values)
+
+        if 4 in snapshot:
+            self.values = {c[0]: raw for c, raw in zip(channels, snapshot[4])}
+        elif self.values is None or sequence != self.sequence + 1:
+            self.values = None
+            return None  # Wait for the next keyframe
+        else:
+            delta = snapshot[5]
+            channel_id = 0
+            for gap, change in zip(delta[0::2], delta[1::2]):
+                channel_id += gap
+                self.values[channel_id] += change
+
+        self.sequence = sequence
+        return self.result(snapshot, channels, self.values)
+
+    @staticmethod
+    def result(snapshot, channels, values):
+        result = {"seq": snapshot[1], "ts": snapshot[2], "keyframe": 4 in snapshot}
+        if 7 in snapshot:
+            result["boot"] = snapshot[7]
+        if 6 in snapshot:
+            result["unix"] = snapshot[6]
+        for channel in channels:
+            raw = values[channel[0]]
+            result[channel[2]] = round(raw * 10 ** channel[4], -channel[4]) if channel[4] else raw
+        return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode DL1000 DSE telemetry snapshots")
+    commands = parser.add_subparsers(dest="command", required=True)
+    decode = commands.add_parser("decode", help="decode snapshot payload files in sequence order")
+    decode.add_argument("files", nargs="+")
+    decode.add_argument("--json", action="store_true", help="emit one JSON object per snapshot")
+    args = parser.parse_args()
+
+    decoder = Decoder()
+    for path in args.files:
+        with open(path, "rb") as f:
+            results = list(decoder.feed(f.read()))
+        for result in results:
+            if result is None:
+                print("%s: duplicate replay or delta after a sequence gap, skipped" % path, file=sys.stderr)
+            elif args.json:
+                print(json.dumps(result))
+            else:
+                fields = " ".join("%s=%s" % (k, v) for k, v in result.items()
+                                  if k not in ("seq", "ts", "keyframe", "boot", "unix"))
+                kind = "R%d" % result["boot"] if "boot" in result else "K" if result["keyframe"] else "D"
+                print("[%d] seq=%d %s %s" % (result["ts"], result["seq"], kind, fields))
+
+
+if __name__ == "__main__":
+    main()
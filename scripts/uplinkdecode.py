@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""
+Decode DL1000 compressed uplink payloads (src/telemetry/uplinkCompressor.h).
+
+With TAGOIO_COMPRESSION_ENABLED the device publishes payloads that get smaller
+as an LZSS stream (scripts/lzss.py format) whose window is primed with a
+preset dictionary, on separate topics:
+    telemetry/data/lzss             JSON for tago/data/post (device status, backfill_recovery_s)
+    telemetry/dse/backfill/lzss     blocks of consecutive replayed snapshots for
+                                    telemetry/dse/backfill, concatenated (a CBOR sequence)
+Payloads that would not get smaller still go to the uncompressed topics.
+
+Usage:
+    python scripts/uplinkdecode.py decode <payload>... [--output FILE]
+        Decompress payload files; JSON is printed, CBOR written to --output
+        (decode it with scripts/telemetrydecode.py).
+    python scripts/uplinkdecode.py dictionary
+        Print the preset dictionary (must match UPLINK_DICTIONARY byte for byte).
+
+The gain on the payloads the firmware sends is measured on the firmware code
+itself: python scripts/hostcheck.py uplinkCompressor
+"""
+
+import argparse
+import sys
+
+import lzss
+
+DEVICE_NAME = "DL1000"
+
+# Same construction as UPLINK_DICTIONARY in src/telemetry/uplinkCompressor.cpp
+DICTIONARY = (
+    '{"variable":"device_status","value":"connected","timestamp":'
+    + ',"metadata":{"device":"%s","source":"TagoIOService"}}' % DEVICE_NAME
+    + '[{"variable":"backfill_recovery_s","value":,"unit":"s","timestamp":'
+    + '{"variable":"device_status","value":"online","timestamp":'
+).encode()
+
+
+def decompress(payload):
+    return lzss.decompress(payload, DICTIONARY)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode DL1000 compressed uplink payloads")
+    commands = parser.add_subparsers(dest="command", required=True)
+    decode = commands.add_parser("decode", help="decompress payload files")
+    decode.add_argument("files", nargs="+")
+    decode.add_argument("--output", help="write the decompressed payload (single file) here")
+    commands.add_parser("dictionary", help="print the preset dictionary")
+    args = parser.parse_args()
+
+    if args.command == "dictionary":
+        sys.stdout.write(DICTIONARY.decode() + "\n")
+        return
+
+    for path in args.files:
+        with open(path, "rb") as f:
+            payload = decompress(f.read())
+        if args.output:
+            with open(args.output, "wb") as f:
+                f.write(payload)
+        elif payload[:1] in (b"[", b"{"):
+            print(payload.decode())
+        else:
+            print("%s: %d bytes of CBOR, use --output and scripts/telemetrydecode.py" % (path, len(payload)))
+
+
+if __name__ == "__main__":
+    main()
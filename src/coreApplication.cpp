@@ -34,6 +34,40 @@ NetworkingManager networkingManager(displayViewModel);
 ConnectivityManager connectivityManager(networkingManager, displayViewModel);
 ServicesManager servicesManager(connectivityManager, displayViewModel);
 ModbusMonitorManager modbusMonitorManager(displayViewModel);
+ConfigManager configManager(modbusMonitorManager, loggingManager);
+#if LOCAL_BROKER_ENABLED
+LocalMQTTBroker localBroker;
+#endif
+#if HTTP_SERVER_ENABLED
+HttpServer httpServer;
+#endif
+
+// Metrics read from existing state when scraped (GET /metrics)
+MetricFunction metricUptime(METRIC_GAUGE, METRICS_PREFIX "uptime_seconds", "Time since boot",
+	[]() -> int64_t { return millis() / 1000; });
+MetricFunction metricHeapFree(METRIC_GAUGE, METRICS_PREFIX "heap_free_bytes", "Free heap",
+	[]() -> int64_t { return ESP.getFreeHeap(); });
+MetricFunction metricHeapMinimum(METRIC_GAUGE, METRICS_PREFIX "heap_minimum_free_bytes", "Lowest free heap since boot",
+	[]() -> int64_t { return ESP.getMinFreeHeap(); });
+MetricFunction metricLogDropped(METRIC_COUNTER, METRICS_PREFIX "log_dropped_records", "Log records dropped with the ring buffer full",
+	[]() -> int64_t { return loggingManager.getDroppedRecords(); });
+MetricFunction metricConfigVersion(METRIC_GAUGE, METRICS_PREFIX "config_version", "Applied remote configuration version",
+	[]() -> int64_t { return configManager.getVersion(); });
+MetricFunction metricTelemetryUpdates(METRIC_COUNTER, METRICS_PREFIX "telemetry_updates", "Decoded Modbus updates",
+	[]() -> int64_t { return telemetryHub.getSequence(); });
+MetricFunction metricPublished(METRIC_COUNTER, METRICS_PREFIX "mqtt_qos1_published", "QoS1 publishes sent",
+	[]() -> int64_t { return servicesManager.getNovaLogicService().getPublishWindow().getPublished(); }, "service", "NovaLogic");
+MetricFunction metricRetransmitted(METRIC_COUNTER, METRICS_PREFIX "mqtt_qos1_retransmitted", "QoS1 publishes sent again without a PUBACK",
+	[]() -> int64_t { return servicesManager.getNovaLogicService().getPublishWindow().getRetransmitted(); }, "service", "NovaLogic");
+#if LOCAL_BROKER_ENABLED
+MetricFunction metricBrokerClients(METRIC_GAUGE, METRICS_PREFIX "local_broker_clients", "Clients connected to the on-device broker",
+	[]() -> int64_t { return localBroker.getClientCount(); });
+#endif
+
+// Managers task pass time (microseconds, exposed in seconds)
+static const uint32_t MANAGERS_PASS_BOUNDS_US[] = {100, 250, 500, 1000, 2500, 5000, 10000, 25000, 100000, 250000, 1000000};
+MetricHistogram metricManagersPass(METRICS_PREFIX "managers_pass_seconds", "Time of one managers task pass",
+	MANAGERS_PASS_BOUNDS_US, sizeof(MANAGERS_PASS_BOUNDS_US) / sizeof(MANAGERS_PASS_BOUNDS_US[0]), 1000000);
 
 bool bIsRunningTestBlock = false;
 
@@ -106,12 +140,21 @@ void coreSetup()
 	LOG_INFO(TAG, "Initializing LEDs");
 	initLEDs();
 
+	// Wakeup sources must exist before the managers register their callbacks
+	managerEvents.begin();
+
 	LOG_INFO(TAG, "Initializing Networking Managers");
 	networkingManager.begin();
 	LOG_INFO(TAG, "Initializing Connectivity Manager");
 	connectivityManager.begin();
 	LOG_INFO(TAG, "Initializing Services Manager");
 	servicesManager.begin();
+
+	// Settings (and a remotely applied Modbus configuration) before the Modbus client opens the port
+	LOG_INFO(TAG, "Loading Application Settings");
+	loadSettings();
+	configManager.begin();
+
 	LOG_INFO(TAG, "Initializing Modbus Monitor Manager");
 	modbusMonitorManager.begin();
 
@@ -121,21 +164,34 @@ void coreSetup()
 	});
 
 	// Setup NovaLogic service command callback for external processing
-	servicesManager.getNovaLogicService().setCommandCallback([](const char* topic, const char* payload) {
+	servicesManager.getNovaLogicService().setCommandCallback([](MQTTTopic topic, const char* payload) {
 		handleExternalMQTTCommand(topic, payload);
 	});
 
+	// Genset data continuity during OTA updates, reported with the OTA progress
+	servicesManager.getNovaLogicService().setOTADataGapProvider([]() {
+		return modbusMonitorManager.getOTADataGap();
+	});
+
+#ifdef TEST_ALL_SERVICES
+	// TagoIO telemetry snapshots use the values decoded by the telemetry hub
+	servicesManager.getTagoIOService().setSnapshotProvider([](DSEValues& values) {
+		return telemetryHub.getValues(values);
+	});
+#endif
+
 	LOG_INFO(TAG, "Initializing Button Matrix");
 	keypad.setDebounceTime(20);
 	// Using direct key scanning in updateKeyPad() instead of event listener
 
-	LOG_INFO(TAG, "Loading Application Settings");
-	loadSettings();
-
 	// Create Tasks
 	xTaskCreatePinnedToCore(TaskDisplayUpdate, "TaskDisplayUpdate", 8192, NULL, 7, NULL, 1);
 	xTaskCreatePinnedToCore(TaskLEDsUpdate, "TaskLEDsUpdate", 2048, NULL, 6, NULL, 1);
 	xTaskCreatePinnedToCore(TaskManagersUpdate, "TaskManagersUpdate", 8192, NULL, 8, NULL, 1);
+#if HTTP_SERVER_ENABLED
+	httpServer.setStatusWriter(writeDashboardStatus);
+	httpServer.begin();
+#endif
 }
 
 void coreLoop()
@@ -160,15 +216,25 @@ void TaskManagersUpdate(void *pvParameters)
 {
 	for (;;)
 	{
+		uint32_t passStart = micros();
+
 		// Run the state machine managers loop functions
 		loggingManager.loop();
 		networkingManager.loop();
 		connectivityManager.loop();
 		servicesManager.loop();
 		modbusMonitorManager.loop();
-
-		// Small delay to prevent task from hogging CPU
-		vTaskDelay(pdMS_TO_TICKS(50));
+#if LOCAL_BROKER_ENABLED
+		// Same pass as the Modbus update, so LAN subscribers see it right away
+		localBroker.update(networkingManager.hasIP(), modbusMonitorManager.getModbusStatus());
+#endif
+#if HTTP_SERVER_ENABLED
+		httpServer.setNetworkUp(networkingManager.hasIP());
+#endif
+		metricManagersPass.observe(micros() - passStart);
+
+		// Sleep until an event, socket data or the next deadline a manager asked for
+		managerEvents.wait();
 	}
 }
 
@@ -520,8 +586,8 @@ void showSerialMenu()
 	Serial.println(F("5. Set ModBus Slave ID"));
 	Serial.println(F("6. Toggle ModBus Debug Output"));
 	Serial.println(F("7. Toggle RS485 Debug Output"));
-	Serial.println(F("8. "));
-	Serial.println(F("9. "));
+	Serial.println(F("8. Managers Task Status"));
+	Serial.println(F("9. Services Status"));
 	// Add more options as needed
 
 	Serial.print(F("Enter your selection: "));
@@ -688,11 +754,17 @@ void handleOption7()
 void handleOption8()
 {
 	Serial.println(F("Executing Option 8"));
+
+	// Wakeup counts and event latency of the managers task
+	managerEvents.printStatus();
 }
 
 void handleOption9()
 {
 	Serial.println(F("Executing Option 9"));
+
+	// Connection state and reconnect backoff of each service
+	servicesManager.printStatus();
 }
 
 // Test Code Blocks -----------------------------------------------------------------------
@@ -722,7 +794,7 @@ void runTestCodeBlock()
 		Serial.write(file.read());
 	}
 	file.close();
-	LittleFS.end();
+	// LittleFS stays mounted - the log file sink writes to it
 
 	bIsRunningTestBlock = false;
 }
@@ -792,34 +864,229 @@ void performFactoryReset()
 
 // MQTT Related Functions  ----------------------------------------------------------------
 
-void handleExternalMQTTCommand(const char *topic, const char *payload)
+void handleExternalMQTTCommand(MQTTTopic topic, const char *payload)
 {
-	LOG_DEBUG(TAG, "External MQTT command received on topic: %s with payload: %s", topic, payload);
+	LOG_DEBUG(TAG, "External MQTT command received on topic: %s with payload: %s", MQTTTopicTable::getSuffix(topic), payload);
 
 	// Handle logging configuration commands
-	String topicStr(topic);
-	String payloadStr(payload);
-	
-	if (topicStr.endsWith("/logging/config"))
+	switch (topic)
 	{
-		LOG_INFO(TAG, "Logging configuration request received (simplified logging system)");
+	case MQTT_TOPIC_LOGGING_CONFIG:
+		handleLoggingConfigCommand(payload);
+		return;
+
+	case MQTT_TOPIC_LOGGING_GET_CONFIG:
+		publishLoggingConfig();
+		return;
+
+	case MQTT_TOPIC_LOGGING_GET_LOGS:
+		handleGetLogsCommand(payload);
+		return;
+
+	case MQTT_TOPIC_CONFIG_UPDATE:
+		configManager.update(payload);
+		publishConfigStatus();
+		return;
+
+	case MQTT_TOPIC_CONFIG_GET:
+		publishConfigStatus();
+		return;
+
+	default:
+		// Add any other custom command processing here
+		LOG_WARN(TAG, "Unhandled external MQTT command: %s", payload);
 		return;
 	}
-	
-	if (topicStr.endsWith("/logging/get_config"))
+}
+
+// Logging Command Functions --------------------------------------------------------------
+
+bool parseLogEncoding(const char *name, LogEncoding &encoding)
+{
+	if (!name)
+		return false;
+
+	if (strcmp(name, "text") == 0)
+		encoding = LOG_ENCODING_TEXT;
+	else if (strcmp(name, "binary") == 0)
+		encoding = LOG_ENCODING_BINARY;
+	else if (strcmp(name, "json") == 0)
+		encoding = LOG_ENCODING_JSON;
+	else
+		return false;
+
+	return true;
+}
+
+// Payload: {"file":true,"mqtt":true,"serialEncoding":"text","fileEncoding":"binary","mqttEncoding":"json"}
+// All fields are optional. Enables are persisted, encodings apply until restart.
+void handleLoggingConfigCommand(const char *payload)
+{
+	JsonDocument doc;
+	if (deserializeJson(doc, payload))
 	{
-		LOG_INFO(TAG, "Logging config request received (simplified logging system)");
+		LOG_WARN(TAG, "Invalid logging config payload");
 		return;
 	}
-	
-	if (topicStr.endsWith("/logging/get_logs"))
+
+	AppSettings &settings = getAppSettings();
+	bool settingsChanged = false;
+
+	if (doc["file"].is<bool>() && doc["file"].as<bool>() != settings.logToFile)
+	{
+		settings.logToFile = doc["file"].as<bool>();
+		settingsChanged = true;
+	}
+	if (doc["mqtt"].is<bool>() && doc["mqtt"].as<bool>() != settings.logToMQTT)
+	{
+		settings.logToMQTT = doc["mqtt"].as<bool>();
+		settingsChanged = true;
+	}
+
+	if (settingsChanged)
+	{
+		saveSettings();
+		loggingManager.updateSettings(settings.logToFile, settings.logToMQTT);
+	}
+
+	LogEncoding encoding;
+	if (parseLogEncoding(doc["serialEncoding"], encoding))
+		loggingManager.getSerialSink().setEncoding(encoding);
+	if (parseLogEncoding(doc["fileEncoding"], encoding))
+		loggingManager.getFileSink().setEncoding(encoding);
+	if (parseLogEncoding(doc["mqttEncoding"], encoding))
+		loggingManager.getMQTTSink().setEncoding(encoding);
+
+	LOG_INFO(TAG, "Logging configuration updated remotely");
+	publishLoggingConfig();
+}
+
+void publishLoggingConfig()
+{
+	LogFileSink &fileSink = loggingManager.getFileSink();
+	LogMQTTSink &mqttSink = loggingManager.getMQTTSink();
+
+	char payload[384];
+	JsonStreamWriter json(payload, sizeof(payload));
+	json.beginObject();
+	json.key("file");
+	json.value(fileSink.isEnabled());
+	json.key("mqtt");
+	json.value(mqttSink.isEnabled());
+	json.key("serialEncoding");
+	json.value(LogSink::encodingName(loggingManager.getSerialSink().getEncoding()));
+	json.key("fileEncoding");
+	json.value(LogSink::encodingName(fileSink.getEncoding()));
+	json.key("mqttEncoding");
+	json.value(LogSink::encodingName(mqttSink.getEncoding()));
+	json.key("droppedRecords");
+	json.value(loggingManager.getDroppedRecords());
+	json.key("activeSegment");
+	json.value(fileSink.getActiveSequence());
+	json.key("mqttDropped");
+	json.value(mqttSink.getDroppedTotal());
+	json.endObject();
+
+	servicesManager.getNovaLogicService().publish(MQTT_TOPIC_LOGGING_CURRENT_CONFIG, payload, json.length());
+}
+
+// Payload: {} or {"action":"list"}         -> segment list on logging/segments
+//          {"action":"rotate"}             -> close the active segment so it can be fetched
+//          {"action":"cancel"}             -> stop the running transfer
+//          {"segment":12,"chunk":0}        -> stream a segment on logging/logs from the beginning
+//          {"segment":12,"chunk":5,"compressed":true,"size":30712}
+//                                          -> resume; compressed and size from the earlier chunk headers,
+//                                             "changed" if the segment file is no longer that stream
+void handleGetLogsCommand(const char *payload)
+{
+	NovaLogicService &novaLogic = servicesManager.getNovaLogicService();
+	LogTransfer &transfer = loggingManager.getLogTransfer();
+
+	JsonDocument doc;
+	if (payload && payload[0] && deserializeJson(doc, payload))
+	{
+		LOG_WARN(TAG, "Invalid get_logs payload");
+		return;
+	}
+
+	const char *action = doc["action"] | "list";
+
+	if (doc["segment"].is<uint32_t>())
+	{
+		uint32_t segment = doc["segment"];
+		uint32_t chunk = doc["chunk"] | 0;
+		bool compressed = doc["compressed"] | false;
+		uint32_t size = doc["size"] | 0;
+		LogTransferResult result = transfer.start(segment, chunk, compressed, size);
+
+		char status[96];
+		snprintf(status, sizeof(status), "{\"segment\":%lu,\"chunk\":%lu,\"status\":\"%s\"}",
+				 (unsigned long)segment, (unsigned long)chunk, LogTransfer::resultName(result));
+		novaLogic.publish(MQTT_TOPIC_LOGGING_TRANSFER, status, strlen(status));
+		LOG_INFO(TAG, "Log transfer segment=%lu chunk=%lu %s", (unsigned long)segment, (unsigned long)chunk,
+				 LogTransfer::resultName(result));
+		return;
+	}
+
+	if (strcmp(action, "cancel") == 0)
+	{
+		transfer.cancel();
+		return;
+	}
+
+	if (strcmp(action, "rotate") == 0)
 	{
-		LOG_INFO(TAG, "Log file request received (simplified logging system)");
+		loggingManager.getFileSink().requestRotate();
 		return;
 	}
 
-	// Add any other custom command processing here
-	LOG_WARN(TAG, "Unhandled external MQTT command: %s", payload);
+	size_t length = transfer.listSegments();
+	if (length > 0)
+	{
+		novaLogic.publish(MQTT_TOPIC_LOGGING_SEGMENTS, transfer.getBuffer(), length);
+	}
+}
+
+// Configuration Command Functions --------------------------------------------------------
+
+// Result of the last config/update (or "none") and the applied configuration, see ConfigManager
+void publishConfigStatus()
+{
+	char payload[CONFIG_STATUS_SIZE];
+	size_t length = configManager.writeStatus(payload, sizeof(payload));
+	if (length > 0)
+		servicesManager.getNovaLogicService().publish(MQTT_TOPIC_CONFIG_STATUS, payload, length);
+}
+
+// Dashboard Functions --------------------------------------------------------------------
+
+// HTTP server task: /api/status and the dashboard "status" event. Only slowly
+// changing state, so the event is sent when something actually changed; the
+// states are the enum values (the page maps them to text).
+size_t writeDashboardStatus(char *buffer, size_t size)
+{
+	JsonStreamWriter json(buffer, size);
+	json.beginObject();
+	json.key("serial");
+	json.value(displayViewModel.getSerialNumber());
+	json.key("mac");
+	json.value(displayViewModel.getMacAddress());
+	json.key("firmware");
+	json.value(displayViewModel.getVersion());
+	json.key("status");
+	json.value(displayViewModel.getStatusString());
+	json.key("network");
+	json.value((int)displayViewModel.getNetworkStatus());
+	json.key("connectivity");
+	json.value((int)displayViewModel.getConnectivityStatus());
+	json.key("services");
+	json.value((int)displayViewModel.getServicesStatus());
+	json.key("modbus");
+	json.value((int)displayViewModel.getModbusStatus());
+	json.key("config");
+	json.value(configManager.getVersion());
+	json.endObject();
+	return json.overflowed() ? 0 : json.length();
 }
 
 // RS485 Debug Functions ------------------------------------------------------------------
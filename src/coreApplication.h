@@ -13,6 +13,7 @@
 #include "esp_ota_ops.h"
 #include <memory>
 #include "mbedtls/md.h"
+#include <ArduinoJson.h>
 
 #include "definitions.h"
 #include "statusViewModel.h"
@@ -23,6 +24,12 @@
 #include "managers/servicesManager.h"
 #include "managers/loggingManager.h"
 #include "managers/modbusMonitorManager.h"
+#include "managers/configManager.h"
+#include "managers/managerEvents.h"
+#include "services/localMQTTBroker.h"
+#include "services/httpServer.h"
+#include "metrics/metricsRegistry.h"
+#include "telemetry/telemetryHub.h"
 
 void coreSetup();
 void coreLoop();
@@ -31,6 +38,7 @@ void coreLoop();
 extern ServicesManager servicesManager;
 extern ModbusMonitorManager modbusMonitorManager;
 extern LoggingManager loggingManager;
+extern ConfigManager configManager;
 
 // Task Functions
 void TaskManagersUpdate(void *pvParameters);
@@ -65,6 +73,18 @@ void runTestCodeBlock();
 void handleOption7(); // RS485 Debug Toggle
 void updateRS485Debug();
 
-void handleExternalMQTTCommand(const char *topic, const char *payload);
+void handleExternalMQTTCommand(MQTTTopic topic, const char *payload);
+
+// Logging Command Functions
+bool parseLogEncoding(const char *name, LogEncoding &encoding);
+void handleLoggingConfigCommand(const char *payload);
+void publishLoggingConfig();
+void handleGetLogsCommand(const char *payload);
+
+// Configuration Command Functions
+void publishConfigStatus();
+
+// Dashboard Functions
+size_t writeDashboardStatus(char *buffer, size_t size);
 
 #endif // __COREMANAGER_H__
\ No newline at end of file
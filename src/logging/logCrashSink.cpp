@@ -0,0 +1,107 @@
+#include "logCrashSink.h"
+#include "logging/logFileSink.h"
+
+// Survives warm resets; validated by magic and bounds before use
+struct LogCrashRing
+{
+    uint32_t magic;
+    uint32_t head;      // Next write position
+    uint32_t used;      // Valid bytes (saturates at LOG_CRASH_RING_SIZE)
+    uint8_t data[LOG_CRASH_RING_SIZE];
+};
+
+static RTC_NOINIT_ATTR LogCrashRing crashRing;
+
+LogCrashSink::LogCrashSink()
+    : LogSink("LogCrashSink", LOG_CRASH_DEFAULT_ENCODING), recoveredBytes(0)
+{
+}
+
+void LogCrashSink::resetRing()
+{
+    crashRing.head = 0;
+    crashRing.used = 0;
+    crashRing.magic = LOG_CRASH_RING_MAGIC;
+}
+
+bool LogCrashSink::begin()
+{
+    esp_reset_reason_t reason = esp_reset_reason();
+
+    bool valid = crashRing.magic == LOG_CRASH_RING_MAGIC &&
+                 crashRing.head < LOG_CRASH_RING_SIZE &&
+                 crashRing.used <= LOG_CRASH_RING_SIZE &&
+                 crashRing.used > 0;
+
+    // RTC memory holds garbage after power-on
+    if (valid && reason != ESP_RST_POWERON)
+    {
+        saveRecoveredRing(reason);
+    }
+
+    resetRing();
+    return true;
+}
+
+bool LogCrashSink::saveRecoveredRing(esp_reset_reason_t reason)
+{
+    if (!LittleFS.begin(false, "/littlefs", 8, "littlefs"))
+        return false;
+
+    if (!LittleFS.exists(LOG_CRASH_DIRECTORY))
+    {
+        LittleFS.mkdir(LOG_CRASH_DIRECTORY);
+    }
+
+    // An earlier ring that was never uploaded is replaced by the newer one
+    File file = LittleFS.open(LOG_CRASH_RING_FILE, "w");
+    if (!file)
+        return false;
+
+    uint8_t header[LOG_SEGMENT_HEADER_SIZE] = {0};
+    memcpy(header, LOG_SEGMENT_MAGIC, 4);
+    header[4] = encoding;
+    header[5] = (uint8_t)reason;
+    file.write(header, sizeof(header));
+
+    // Oldest bytes first
+    size_t start = crashRing.used < LOG_CRASH_RING_SIZE ? 0 : crashRing.head;
+    size_t firstPart = crashRing.used < LOG_CRASH_RING_SIZE ? crashRing.used : LOG_CRASH_RING_SIZE - start;
+    file.write(crashRing.data + start, firstPart);
+    if (firstPart < crashRing.used)
+    {
+        file.write(crashRing.data, crashRing.head);
+    }
+    file.close();
+
+    recoveredBytes = crashRing.used;
+    Serial.printf("[LogCrashSink] Saved %lu bytes of logs from before reset (reason %d)\n",
+                  (unsigned long)recoveredBytes, (int)reason);
+    return true;
+}
+
+void LogCrashSink::write(const LogRecordHeader &header, const uint8_t *args)
+{
+    size_t length = encode(header, args, recordBuffer, sizeof(recordBuffer));
+    if (length == 0 || length > LOG_CRASH_RING_SIZE)
+        return;
+
+    size_t head = crashRing.head;
+    size_t firstPart = LOG_CRASH_RING_SIZE - head;
+    if (firstPart >= length)
+    {
+        memcpy(crashRing.data + head, recordBuffer, length);
+    }
+    else
+    {
+        memcpy(crashRing.data + head, recordBuffer, firstPart);
+        memcpy(crashRing.data, recordBuffer + firstPart, length - firstPart);
+    }
+
+    crashRing.head = (head + length) % LOG_CRASH_RING_SIZE;
+    if (crashRing.used < LOG_CRASH_RING_SIZE)
+    {
+        size_t used = crashRing.used + length;
+        crashRing.used = used < LOG_CRASH_RING_SIZE ? used : LOG_CRASH_RING_SIZE;
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+#ifndef __LOGCRASHSINK_H__
+#define __LOGCRASHSINK_H__
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <esp_system.h>
+
+#include "definitions.h"
+#include "logging/logSink.h"
+
+/*
+ * Crash-surviving log ring
+ *
+ * The most recent LOG_CRASH_RING_SIZE bytes of encoded records are kept in
+ * RTC memory that is not initialised on a warm reset (panic, watchdog,
+ * brownout, software restart). On the next boot the ring from the previous
+ * run is saved to LOG_CRASH_RING_FILE, using the log segment layout with the
+ * reset reason in the first reserved header byte, and PostMortem uploads it.
+ * A power-on reset starts with an empty ring.
+ */
+
+#define LOG_CRASH_RING_MAGIC 0x4C524E47   // "LRNG"
+
+class LogCrashSink : public LogSink
+{
+public:
+    LogCrashSink();
+
+    bool begin() override;
+    void write(const LogRecordHeader &header, const uint8_t *args) override;
+
+    // Bytes of the previous run saved at boot (0 if none)
+    size_t getRecoveredBytes() const { return recoveredBytes; }
+
+private:
+    bool saveRecoveredRing(esp_reset_reason_t reason);
+    void resetRing();
+
+    size_t recoveredBytes;
+    uint8_t recordBuffer[LOG_RECORD_BUFFER_SIZE];   // Only touched by the drain task
+};
+
+#endif // __LOGCRASHSINK_H__
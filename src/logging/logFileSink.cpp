@@ -0,0 +1,345 @@
+#include "logFileSink.h"
+
+// Suffix of a compressed segment that is still being written
+static const char *TEMP_SUFFIX = ".tmp";
+
+bool LogFileSink::parseSegmentName(const char *name, uint32_t &sequence, bool &compressed, bool &temporary)
+{
+    char *end = nullptr;
+    sequence = strtoul(name, &end, 10);
+    if (end == name)
+        return false;
+
+    compressed = strncmp(end, ".lz", 3) == 0;
+    temporary = strstr(end, TEMP_SUFFIX) != nullptr;
+    return compressed || strcmp(end, ".log") == 0;
+}
+
+LogFileSink::LogFileSink()
+    : LogSink("LogFileSink", LOG_FILE_DEFAULT_ENCODING),
+      mounted(false), blockFill(0), blockStartTime(0), activeSize(0),
+      activeEncoding(LOG_FILE_DEFAULT_ENCODING), activeSequence(1), rotateRequested(false),
+      compressHistory(0), compressSequence(0), compressing(false), lastHousekeeping(0), pinnedSequence(0),
+      segmentsCompressed(0), segmentsDeleted(0), writeErrors(0)
+{
+}
+
+void LogFileSink::buildSegmentPath(char *buffer, size_t bufferSize, uint32_t sequence, bool compressed)
+{
+    snprintf(buffer, bufferSize, "%s/%08lu.%s", LOG_FILE_DIRECTORY, (unsigned long)sequence, compressed ? "lz" : "log");
+}
+
+bool LogFileSink::begin()
+{
+    if (mounted)
+        return true;
+
+    if (!LittleFS.begin(false, "/littlefs", 8, "littlefs"))
+    {
+        Serial.printf("[LogFileSink] LittleFS mount failed - file logging unavailable\n");
+        return false;
+    }
+    mounted = true;
+
+    if (!LittleFS.exists(LOG_FILE_DIRECTORY))
+    {
+        LittleFS.mkdir(LOG_FILE_DIRECTORY);
+    }
+
+    // Continue numbering after the newest segment; never append to an old one
+    uint32_t highest = 0;
+    char staleFile[48] = "";
+    File dir = LittleFS.open(LOG_FILE_DIRECTORY);
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile())
+    {
+        uint32_t sequence;
+        bool compressed, temporary;
+        if (!parseSegmentName(entry.name(), sequence, compressed, temporary))
+            continue;
+
+        if (temporary)
+            snprintf(staleFile, sizeof(staleFile), "%s/%s", LOG_FILE_DIRECTORY, entry.name());
+        else if (sequence > highest)
+            highest = sequence;
+    }
+    dir.close();
+
+    // Interrupted compression from the previous boot
+    if (staleFile[0])
+    {
+        LittleFS.remove(staleFile);
+    }
+
+    activeSequence = highest + 1;
+    activeEncoding = encoding;
+
+    Serial.printf("[LogFileSink] Log segments in %s, next segment %lu\n", LOG_FILE_DIRECTORY, (unsigned long)activeSequence);
+    return true;
+}
+
+void LogFileSink::stop()
+{
+    // The drain task flushes the pending block on its next idle() call
+    enabled = false;
+}
+
+// Drain task ---------------------------------------------------------------------------
+
+void LogFileSink::write(const LogRecordHeader &header, const uint8_t *args)
+{
+    if (!mounted)
+        return;
+
+    // A segment holds a single encoding
+    if (encoding != activeEncoding)
+    {
+        flushBlock();
+        if (activeFile)
+            closeActiveSegment();
+        activeEncoding = encoding;
+    }
+
+    size_t length = encode(header, args, recordBuffer, sizeof(recordBuffer));
+    if (length == 0)
+        return;
+
+    if (blockFill + length > sizeof(block))
+    {
+        flushBlock();
+    }
+
+    if (blockFill == 0)
+    {
+        blockStartTime = millis();
+    }
+
+    memcpy(block + blockFill, recordBuffer, length);
+    blockFill += length;
+}
+
+void LogFileSink::idle()
+{
+    if (rotateRequested)
+    {
+        rotateRequested = false;
+        flushBlock();
+        if (activeFile)
+            closeActiveSegment();
+        return;
+    }
+
+    if (blockFill == 0)
+        return;
+
+    if (!enabled || millis() - blockStartTime >= LOG_FILE_FLUSH_INTERVAL_MS)
+    {
+        flushBlock();
+    }
+}
+
+bool LogFileSink::openActiveSegment()
+{
+    char path[48];
+    buildSegmentPath(path, sizeof(path), activeSequence, false);
+
+    activeFile = LittleFS.open(path, "w");
+    if (!activeFile)
+        return false;
+
+    uint8_t header[LOG_SEGMENT_HEADER_SIZE] = {0};
+    memcpy(header, LOG_SEGMENT_MAGIC, 4);
+    header[4] = activeEncoding;
+    activeFile.write(header, sizeof(header));
+    activeSize = sizeof(header);
+    return true;
+}
+
+void LogFileSink::closeActiveSegment()
+{
+    activeFile.close();
+    activeSize = 0;
+    activeSequence = activeSequence + 1;
+}
+
+void LogFileSink::flushBlock()
+{
+    if (blockFill == 0)
+        return;
+
+    if (!activeFile && !openActiveSegment())
+    {
+        writeErrors++;
+        blockFill = 0;
+        return;
+    }
+
+    size_t written = activeFile.write(block, blockFill);
+    if (written != blockFill)
+    {
+        writeErrors++;
+    }
+    activeFile.flush();
+
+    activeSize += written;
+    blockFill = 0;
+
+    if (activeSize >= LOG_FILE_SEGMENT_SIZE)
+    {
+        closeActiveSegment();
+    }
+}
+
+// Managers task ------------------------------------------------------------------------
+
+void LogFileSink::loop()
+{
+    if (!mounted)
+        return;
+
+    if (compressing)
+    {
+        // A reader pinned the segment being compressed; retry it later
+        if (compressSequence == pinnedSequence)
+            finishCompression(false);
+        else
+            compressNextFrame();
+        return;
+    }
+
+    unsigned long now = millis();
+    if (now - lastHousekeeping < LOG_FILE_HOUSEKEEPING_INTERVAL_MS)
+        return;
+    lastHousekeeping = now;
+
+    enforceSizeLimit();
+    startCompression();
+}
+
+bool LogFileSink::startCompression()
+{
+    // Oldest closed, uncompressed segment
+    uint32_t oldest = UINT32_MAX;
+    File dir = LittleFS.open(LOG_FILE_DIRECTORY);
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile())
+    {
+        uint32_t sequence;
+        bool compressed, temporary;
+        if (parseSegmentName(entry.name(), sequence, compressed, temporary) &&
+            !compressed && sequence < activeSequence && sequence != pinnedSequence && sequence < oldest)
+        {
+            oldest = sequence;
+        }
+    }
+    dir.close();
+
+    if (oldest == UINT32_MAX)
+        return false;
+
+    char path[48];
+    buildSegmentPath(path, sizeof(path), oldest, false);
+    compressSource = LittleFS.open(path, "r");
+
+    buildSegmentPath(path, sizeof(path), oldest, true);
+    strncat(path, TEMP_SUFFIX, sizeof(path) - strlen(path) - 1);
+    compressTarget = LittleFS.open(path, "w");
+
+    if (!compressSource || !compressTarget)
+    {
+        compressSequence = oldest;
+        finishCompression(false);
+        return false;
+    }
+
+    uint8_t header[LOG_SEGMENT_HEADER_SIZE] = {0};
+    memcpy(header, LOG_ARCHIVE_MAGIC, 4);
+    compressTarget.write(header, sizeof(header));
+
+    compressSequence = oldest;
+    compressHistory = 0;
+    compressing = true;
+    return true;
+}
+
+void LogFileSink::compressNextFrame()
+{
+    size_t length = compressSource.read(compressInput + compressHistory, LZSS_FRAME_SIZE);
+    if (length == 0)
+    {
+        finishCompression(true);
+        return;
+    }
+
+    size_t total = compressHistory + length;
+    size_t compressed = encoder.compressFrame(compressInput, compressHistory, total, compressOutput, sizeof(compressOutput));
+    if (compressed == 0 || compressTarget.write(compressOutput, compressed) != compressed)
+    {
+        finishCompression(false);
+        return;
+    }
+
+    // Keep the last window of input as history for the next frame
+    size_t keep = total < LZSS_WINDOW_SIZE ? total : LZSS_WINDOW_SIZE;
+    memmove(compressInput, compressInput + total - keep, keep);
+    compressHistory = keep;
+}
+
+void LogFileSink::finishCompression(bool success)
+{
+    if (compressSource)
+        compressSource.close();
+    if (compressTarget)
+        compressTarget.close();
+    compressing = false;
+
+    char rawPath[48];
+    char archivePath[48];
+    char tempPath[56];
+    buildSegmentPath(rawPath, sizeof(rawPath), compressSequence, false);
+    buildSegmentPath(archivePath, sizeof(archivePath), compressSequence, true);
+    snprintf(tempPath, sizeof(tempPath), "%s%s", archivePath, TEMP_SUFFIX);
+
+    if (success && LittleFS.rename(tempPath, archivePath))
+    {
+        LittleFS.remove(rawPath);
+        segmentsCompressed++;
+    }
+    else
+    {
+        // Leave the raw segment in place; it is still readable and counts towards the limit
+        LittleFS.remove(tempPath);
+        if (compressSequence != pinnedSequence)
+            writeErrors++;
+    }
+}
+
+void LogFileSink::enforceSizeLimit()
+{
+    for (int pass = 0; pass < LOG_FILE_MAX_DELETES_PER_PASS; pass++)
+    {
+        size_t totalSize = 0;
+        uint32_t oldest = UINT32_MAX;
+        char oldestPath[48] = "";
+
+        File dir = LittleFS.open(LOG_FILE_DIRECTORY);
+        for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile())
+        {
+            totalSize += entry.size();
+
+            uint32_t sequence;
+            bool compressed, temporary;
+            if (parseSegmentName(entry.name(), sequence, compressed, temporary) && !temporary &&
+                sequence < activeSequence && sequence != pinnedSequence && sequence < oldest)
+            {
+                oldest = sequence;
+                snprintf(oldestPath, sizeof(oldestPath), "%s/%s", LOG_FILE_DIRECTORY, entry.name());
+            }
+        }
+        dir.close();
+
+        if (totalSize <= LOG_FILE_TOTAL_LIMIT || oldest == UINT32_MAX)
+            return;
+
+        LittleFS.remove(oldestPath);
+        segmentsDeleted++;
+    }
+}
@@ -0,0 +1,104 @@
+#pragma once
+#ifndef __LOGFILESINK_H__
+#define __LOGFILESINK_H__
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include "definitions.h"
+#include "logging/logSink.h"
+#include "utils/lzss.h"
+
+/*
+ * Rotating log file sink on LittleFS
+ *
+ * Records are collected into a flash-block-sized buffer and appended to the
+ * active segment (LOG_FILE_DIRECTORY/<seq>.log) one block at a time. Once a
+ * segment reaches LOG_FILE_SEGMENT_SIZE a new one is started. Closed segments
+ * are LZSS-compressed into <seq>.lz in the background (one frame per
+ * LoggingManager::loop call) and the oldest files are removed to keep the
+ * directory under LOG_FILE_TOTAL_LIMIT.
+ *
+ * Raw segment header:        "DLG1" [encoding:1] [reserved:3]
+ * Compressed segment header: "DLZ1" [reserved:4] followed by the LZSS stream
+ * of the raw segment. scripts/logdecode.py reads both.
+ */
+
+#define LOG_SEGMENT_MAGIC "DLG1"
+#define LOG_ARCHIVE_MAGIC "DLZ1"
+#define LOG_SEGMENT_HEADER_SIZE 8
+
+class LogFileSink : public LogSink
+{
+public:
+    LogFileSink();
+
+    bool begin() override;
+    void stop() override;
+    void write(const LogRecordHeader &header, const uint8_t *args) override;
+    void idle() override;
+    void loop() override;
+
+    // Statistics
+    uint32_t getActiveSequence() const { return activeSequence; }
+    uint32_t getSegmentsCompressed() const { return segmentsCompressed; }
+    uint32_t getSegmentsDeleted() const { return segmentsDeleted; }
+    uint32_t getWriteErrors() const { return writeErrors; }
+    bool isCompressing() const { return compressing; }
+
+    // Keep a closed segment away from compression and deletion while it is read (0 = none)
+    void setPinnedSegment(uint32_t sequence) { pinnedSequence = sequence; }
+
+    // Close the active segment at the next drain idle so its records become readable
+    void requestRotate() { rotateRequested = true; }
+
+    // Build the path of a segment file ("/logs/00000012.log" or ".lz")
+    static void buildSegmentPath(char *buffer, size_t bufferSize, uint32_t sequence, bool compressed);
+
+    // Parse "<seq>.log" / "<seq>.lz" / "<seq>.lz.tmp"; returns false for foreign files
+    static bool parseSegmentName(const char *name, uint32_t &sequence, bool &compressed, bool &temporary);
+
+private:
+    // Drain task side
+    void flushBlock();
+    bool openActiveSegment();
+    void closeActiveSegment();
+
+    // Managers task side
+    bool startCompression();
+    void compressNextFrame();
+    void finishCompression(bool success);
+    void enforceSizeLimit();
+
+    bool mounted;
+
+    // Active segment (drain task only)
+    uint8_t block[LOG_FILE_BLOCK_SIZE];
+    size_t blockFill;
+    unsigned long blockStartTime;
+    uint8_t recordBuffer[LOG_RECORD_BUFFER_SIZE];
+    File activeFile;
+    size_t activeSize;
+    LogEncoding activeEncoding;
+    volatile uint32_t activeSequence;
+    volatile bool rotateRequested;
+
+    // Background compression (managers task only)
+    LzssEncoder encoder;
+    uint8_t compressInput[LZSS_WINDOW_SIZE + LZSS_FRAME_SIZE];
+    uint8_t compressOutput[LZSS_FRAME_HEADER_SIZE + LZSS_MAX_COMPRESSED_SIZE(LZSS_FRAME_SIZE)];
+    size_t compressHistory;
+    File compressSource;
+    File compressTarget;
+    uint32_t compressSequence;
+    bool compressing;
+    unsigned long lastHousekeeping;
+    volatile uint32_t pinnedSequence;
+
+    // Statistics
+    uint32_t segmentsCompressed;
+    uint32_t segmentsDeleted;
+    uint32_t writeErrors;
+};
+
+#endif // __LOGFILESINK_H__
@@ -0,0 +1,163 @@
+#include "logMQTTSink.h"
+#include "managers/managerEvents.h"
+
+LogMQTTSink::LogMQTTSink()
+    : LogSink("LogMQTTSink", LOG_MQTT_DEFAULT_ENCODING),
+      queue(nullptr), heldBatch(nullptr), heldLength(0), batchFill(0), batchHeader(), batchStartTime(0), sampleCounter(0),
+      linkUp(false), dropped(), batchesDropped(0), batchesSent(0), recordsSent(0), publishFailures(0)
+{
+}
+
+bool LogMQTTSink::begin()
+{
+    if (!queue)
+    {
+        queue = xRingbufferCreateStatic(sizeof(queueStorage), RINGBUF_TYPE_NOSPLIT, queueStorage, &queueStruct);
+    }
+    return queue != nullptr;
+}
+
+uint32_t LogMQTTSink::getDroppedTotal() const
+{
+    uint32_t total = 0;
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++)
+    {
+        total += dropped[level];
+    }
+    return total;
+}
+
+// Drain task ---------------------------------------------------------------------------
+
+bool LogMQTTSink::admit(uint8_t level)
+{
+    if (level <= LOG_LEVEL_WARN)
+        return true;
+
+    // Nothing below WARN is held back for a link that is down
+    if (!linkUp)
+        return false;
+
+    size_t freeSpace = xRingbufferGetCurFreeSize(queue);
+    if (freeSpace >= sizeof(queueStorage) * (100 - LOG_MQTT_CONGESTION_PERCENT) / 100)
+        return true;
+
+    if (level == LOG_LEVEL_INFO)
+        return (sampleCounter++ % LOG_MQTT_INFO_SAMPLE_RATE) == 0;
+
+    return false;
+}
+
+void LogMQTTSink::write(const LogRecordHeader &header, const uint8_t *args)
+{
+    if (!queue || header.level >= LOG_LEVEL_COUNT)
+        return;
+
+    if (!admit(header.level))
+    {
+        dropped[header.level]++;
+        return;
+    }
+
+    size_t length = encode(header, args, recordBuffer, sizeof(recordBuffer));
+    if (length == 0)
+        return;
+
+    if (batchFill + length > sizeof(batch))
+    {
+        sealBatch();
+    }
+
+    if (batchFill == 0)
+    {
+        batchStartTime = millis();
+    }
+
+    memcpy(batch + batchFill, recordBuffer, length);
+    batchFill += length;
+    batchHeader.records[header.level]++;
+}
+
+void LogMQTTSink::idle()
+{
+    if (batchFill > 0 && millis() - batchStartTime >= LOG_MQTT_FLUSH_INTERVAL_MS)
+    {
+        sealBatch();
+    }
+}
+
+void LogMQTTSink::sealBatch()
+{
+    if (batchFill == 0)
+        return;
+
+    void *item = nullptr;
+    if (xRingbufferSendAcquire(queue, &item, sizeof(LogBatchHeader) + batchFill, 0) == pdTRUE)
+    {
+        memcpy(item, &batchHeader, sizeof(LogBatchHeader));
+        memcpy(static_cast<uint8_t *>(item) + sizeof(LogBatchHeader), batch, batchFill);
+        xRingbufferSendComplete(queue, item);
+
+        // Published by NovaLogicService on the managers task
+        managerEvents.signal(MANAGER_EVENT_LOG);
+    }
+    else
+    {
+        batchesDropped++;
+        countDropped(batchHeader.records);
+    }
+
+    batchFill = 0;
+    batchHeader = LogBatchHeader();
+}
+
+void LogMQTTSink::countDropped(const uint16_t *records)
+{
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++)
+    {
+        dropped[level] += records[level];
+    }
+}
+
+// Publisher ----------------------------------------------------------------------------
+
+const LogBatchHeader *LogMQTTSink::receiveBatch(size_t &payloadLength)
+{
+    if (!queue)
+        return nullptr;
+
+    // A batch that failed to publish goes first, so the order is kept
+    if (!heldBatch)
+    {
+        size_t itemSize = 0;
+        void *item = xRingbufferReceive(queue, &itemSize, 0);
+        if (!item)
+            return nullptr;
+
+        heldBatch = static_cast<const LogBatchHeader *>(item);
+        heldLength = itemSize - sizeof(LogBatchHeader);
+    }
+
+    payloadLength = heldLength;
+    return heldBatch;
+}
+
+void LogMQTTSink::returnBatch(const LogBatchHeader *batch, bool published)
+{
+    if (!published)
+    {
+        // Kept at the head of the queue for the next attempt
+        publishFailures++;
+        return;
+    }
+
+    batchesSent++;
+    for (int level = 0; level < LOG_LEVEL_COUNT; level++)
+    {
+        recordsSent += batch->records[level];
+    }
+
+    heldBatch = nullptr;
+    heldLength = 0;
+    vRingbufferReturnItem(queue, const_cast<LogBatchHeader *>(batch));
+}
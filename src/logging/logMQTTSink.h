@@ -0,0 +1,96 @@
+#pragma once
+#ifndef __LOGMQTTSINK_H__
+#define __LOGMQTTSINK_H__
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/ringbuf.h>
+
+#include "definitions.h"
+#include "logging/logSink.h"
+
+/*
+ * Batched MQTT log sink
+ *
+ * The drain task appends encoded records to a batch which is sealed into a
+ * static queue when it reaches LOG_MQTT_BATCH_SIZE or LOG_MQTT_FLUSH_INTERVAL_MS.
+ * NovaLogicService publishes sealed batches from its own loop, so the drain
+ * task never touches the MQTT client.
+ *
+ * Backpressure never blocks and never allocates:
+ *   link down   - only WARN/ERROR are queued (shipped after reconnect)
+ *   congested   - DEBUG is dropped, INFO is sampled 1 in LOG_MQTT_INFO_SAMPLE_RATE
+ *   queue full  - the sealed batch is dropped
+ * Every dropped record is counted per level.
+ *
+ * A batch whose publish failed stays at the head of the queue and is offered
+ * again by the next receiveBatch(), so a failed publish delays logs but never
+ * loses them.
+ */
+
+// Prefix of every sealed batch in the queue
+struct LogBatchHeader
+{
+    uint16_t records[LOG_LEVEL_COUNT];  // Records in the batch per level
+};
+
+class LogMQTTSink : public LogSink
+{
+public:
+    LogMQTTSink();
+
+    bool begin() override;
+    void write(const LogRecordHeader &header, const uint8_t *args) override;
+    void idle() override;
+
+    // MQTT link state, from LoggingManager::onMQTTConnected/Disconnected
+    void setLinkUp(bool linkUp) { this->linkUp = linkUp; }
+    bool isLinkUp() const { return linkUp; }
+
+    // Publisher side: take the oldest sealed batch (payload follows the header),
+    // then hand it back with the publish result; an unpublished batch is kept and
+    // returned again by the next receiveBatch()
+    const LogBatchHeader *receiveBatch(size_t &payloadLength);
+    void returnBatch(const LogBatchHeader *batch, bool published);
+
+    // Statistics
+    uint32_t getDropped(uint8_t level) const { return level < LOG_LEVEL_COUNT ? dropped[level] : 0; }
+    uint32_t getDroppedTotal() const;
+    uint32_t getBatchesDropped() const { return batchesDropped; }
+    uint32_t getBatchesSent() const { return batchesSent; }
+    uint32_t getRecordsSent() const { return recordsSent; }
+    uint32_t getPublishFailures() const { return publishFailures; }
+
+private:
+    bool admit(uint8_t level);
+    void sealBatch();
+    void countDropped(const uint16_t *records);
+
+    // Outbound queue of sealed batches
+    RingbufHandle_t queue;
+    StaticRingbuffer_t queueStruct;
+    uint8_t queueStorage[LOG_MQTT_QUEUE_SIZE];
+
+    // Received but not yet published (publisher only)
+    const LogBatchHeader *heldBatch;
+    size_t heldLength;
+
+    // Batch being filled (drain task only)
+    uint8_t batch[LOG_MQTT_BATCH_SIZE];
+    size_t batchFill;
+    LogBatchHeader batchHeader;
+    unsigned long batchStartTime;
+    uint8_t recordBuffer[LOG_RECORD_BUFFER_SIZE];
+    uint32_t sampleCounter;
+
+    volatile bool linkUp;
+
+    // Statistics
+    volatile uint32_t dropped[LOG_LEVEL_COUNT];
+    volatile uint32_t batchesDropped;
+    volatile uint32_t batchesSent;
+    volatile uint32_t recordsSent;
+    volatile uint32_t publishFailures;
+};
+
+#endif // __LOGMQTTSINK_H__
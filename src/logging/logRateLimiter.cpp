@@ -0,0 +1,135 @@
+#include "logRateLimiter.h"
+
+static const uint32_t TOKEN_SCALE = 1000;
+static const uint32_t BUCKET_CAPACITY = LOG_RATE_LIMIT_BURST * TOKEN_SCALE;
+
+LogRateLimiter::LogRateLimiter()
+    : sites(), repeatedTotal(0), suppressedTotal(0)
+{
+}
+
+void LogRateLimiter::takeReport(CallSite &site, LogSuppressionReport &report)
+{
+    report.tag = site.tag;
+    report.format = site.format;
+    report.level = site.level;
+    report.repeated = site.repeated;
+    report.suppressed = site.suppressed;
+    site.repeated = 0;
+    site.suppressed = 0;
+}
+
+LogRateLimiter::CallSite *LogRateLimiter::findSite(const char *tag, const char *format, uint32_t now,
+                                                   bool &created, LogSuppressionReport &report)
+{
+    // Literals are at least 4-byte apart in practice; drop the low bits before hashing
+    uint32_t hash = (((uint32_t)(uintptr_t)format >> 2) ^ ((uint32_t)(uintptr_t)tag << 7)) * 2654435761u;
+    size_t start = hash % LOG_RATE_LIMIT_SITES;
+
+    CallSite *oldest = nullptr;
+    for (size_t probe = 0; probe < LOG_RATE_LIMIT_PROBES; probe++)
+    {
+        CallSite &site = sites[(start + probe) % LOG_RATE_LIMIT_SITES];
+        if (site.format == format && site.tag == tag)
+        {
+            created = false;
+            return &site;
+        }
+
+        if (!site.format)
+        {
+            oldest = &site;
+            break;
+        }
+
+        if (!oldest || (int32_t)(site.lastSeen - oldest->lastSeen) < 0)
+            oldest = &site;
+    }
+
+    // New site: take a free slot or evict the least recently used one
+    if (oldest->format)
+        takeReport(*oldest, report);
+
+    *oldest = CallSite();
+    oldest->format = format;
+    oldest->tag = tag;
+    oldest->tokens = BUCKET_CAPACITY;
+    oldest->lastRefill = now;
+    oldest->lastSeen = now;
+    created = true;
+    return oldest;
+}
+
+bool LogRateLimiter::admit(uint8_t level, const char *tag, const char *format, uint32_t argHash,
+                           uint32_t now, LogSuppressionReport &report)
+{
+    report = LogSuppressionReport();
+    bool created = false;
+    bool admitted = false;
+
+    portENTER_CRITICAL(&lock);
+
+    CallSite *site = findSite(tag, format, now, created, report);
+    site->level = level;
+    site->lastSeen = now;
+
+    if (!created && argHash == site->argHash && now - site->lastQueued < LOG_REPEAT_FLUSH_MS)
+    {
+        // Same message again: only count it
+        if (!site->repeated && !site->suppressed)
+            site->pendingSince = now;
+        if (site->repeated < UINT16_MAX)
+            site->repeated++;
+        repeatedTotal++;
+    }
+    else
+    {
+        uint32_t elapsed = now - site->lastRefill;
+        site->lastRefill = now;
+        uint32_t refill = (elapsed < BUCKET_CAPACITY ? elapsed : BUCKET_CAPACITY) * LOG_RATE_LIMIT_PER_SECOND;
+        site->tokens = (refill >= BUCKET_CAPACITY - site->tokens) ? BUCKET_CAPACITY : site->tokens + refill;
+
+        if (site->tokens >= TOKEN_SCALE)
+        {
+            site->tokens -= TOKEN_SCALE;
+            site->argHash = argHash;
+            site->lastQueued = now;
+            admitted = true;
+
+            // The previous message of this site is final now
+            if (site->repeated > 0 || site->suppressed > 0)
+                takeReport(*site, report);
+        }
+        else
+        {
+            if (!site->repeated && !site->suppressed)
+                site->pendingSince = now;
+            if (site->suppressed < UINT16_MAX)
+                site->suppressed++;
+            suppressedTotal++;
+        }
+    }
+
+    portEXIT_CRITICAL(&lock);
+    return admitted;
+}
+
+bool LogRateLimiter::collectDue(uint32_t now, LogSuppressionReport &report)
+{
+    bool found = false;
+
+    portENTER_CRITICAL(&lock);
+    for (size_t i = 0; i < LOG_RATE_LIMIT_SITES; i++)
+    {
+        CallSite &site = sites[i];
+        if (site.format && (site.repeated > 0 || site.suppressed > 0) && now - site.pendingSince >= LOG_REPEAT_FLUSH_MS)
+        {
+            takeReport(site, report);
+            found = true;
+            break;
+        }
+    }
+    portEXIT_CRITICAL(&lock);
+
+    return found;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#ifndef __LOGRATELIMITER_H__
+#define __LOGRATELIMITER_H__
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+
+#include "definitions.h"
+
+/*
+ * Per-call-site log flood protection
+ *
+ * A call site is identified by its tag and format string pointers (every LOG_*
+ * call has its own format literal). Sites live in a fixed open-addressed table of
+ * LOG_RATE_LIMIT_SITES entries; when all probed slots are taken the least
+ * recently used one is evicted.
+ *
+ * For each site:
+ *   - a record with the same arguments as the last one queued from that site,
+ *     less than LOG_REPEAT_FLUSH_MS after it, is not queued, only counted
+ *     ("last message repeated N times"); after that it is logged again, so a
+ *     message that recurs unchanged is never hidden for longer
+ *   - other records spend a token from a bucket holding LOG_RATE_LIMIT_BURST
+ *     tokens, refilled at LOG_RATE_LIMIT_PER_SECOND; without a token the record
+ *     is counted as suppressed
+ *
+ * Counts are reported as a summary record once the site logs something new or
+ * is evicted, and at least every LOG_REPEAT_FLUSH_MS while a flood lasts (see
+ * collectDue()).
+ * admit() runs on the task that logs, under a short critical section, so it
+ * can be called from any task.
+ */
+
+// Pending summary for one call site, emitted by the caller outside the lock
+struct LogSuppressionReport
+{
+    const char *tag;
+    const char *format;
+    uint8_t level;
+    uint16_t repeated;      // Identical records collapsed
+    uint16_t suppressed;    // Records dropped by the token bucket
+
+    bool isPending() const { return repeated > 0 || suppressed > 0; }
+};
+
+class LogRateLimiter
+{
+public:
+    LogRateLimiter();
+
+    // Returns true if the record should be queued. report is filled when a
+    // summary must be logged first (for this or an evicted site).
+    bool admit(uint8_t level, const char *tag, const char *format, uint32_t argHash,
+               uint32_t now, LogSuppressionReport &report);
+
+    // Take the summary of one site whose counts are LOG_REPEAT_FLUSH_MS old;
+    // returns false when there is none left
+    bool collectDue(uint32_t now, LogSuppressionReport &report);
+
+    uint32_t getRepeatedTotal() const { return repeatedTotal; }
+    uint32_t getSuppressedTotal() const { return suppressedTotal; }
+
+private:
+    struct CallSite
+    {
+        const char *format;     // Key with tag, nullptr when the slot is free
+        const char *tag;
+        uint32_t argHash;       // Arguments of the last queued record
+        uint32_t lastQueued;    // When that record was queued
+        uint32_t tokens;        // Token bucket, in thousandths of a token
+        uint32_t lastRefill;
+        uint32_t lastSeen;
+        uint32_t pendingSince;  // First record counted since the last summary
+        uint16_t repeated;
+        uint16_t suppressed;
+        uint8_t level;
+    };
+
+    CallSite *findSite(const char *tag, const char *format, uint32_t now, bool &created, LogSuppressionReport &report);
+    static void takeReport(CallSite &site, LogSuppressionReport &report);
+
+    CallSite sites[LOG_RATE_LIMIT_SITES];
+    portMUX_TYPE lock = portMUX_INITIALIZER_UNLOCKED;
+
+    volatile uint32_t repeatedTotal;
+    volatile uint32_t suppressedTotal;
+};
+
+#endif // __LOGRATELIMITER_H__
@@ -0,0 +1,474 @@
+#include "logRecord.h"
+#include "utils/jsonStreamWriter.h"
+
+const char *logLevelName(uint8_t level)
+{
+    switch (level)
+    {
+    case LOG_LEVEL_ERROR:
+        return "ERROR";
+    case LOG_LEVEL_WARN:
+        return "WARN";
+    case LOG_LEVEL_INFO:
+        return "INFO";
+    case LOG_LEVEL_DEBUG:
+        return "DEBUG";
+    default:
+        return "?";
+    }
+}
+
+// LogArgReader -------------------------------------------------------------------------
+
+LogArgReader::LogArgReader(const uint8_t *args, size_t length)
+    : cursor(args), end(args + length)
+{
+}
+
+LogArgType LogArgReader::peekType() const
+{
+    return hasNext() ? (LogArgType)*cursor : (LogArgType)0;
+}
+
+bool LogArgReader::readInt32(int32_t &value)
+{
+    if (peekType() != LOG_ARG_INT32 || end - cursor < 5)
+        return false;
+    memcpy(&value, cursor + 1, sizeof(value));
+    cursor += 5;
+    return true;
+}
+
+bool LogArgReader::readInt64(int64_t &value)
+{
+    if (peekType() != LOG_ARG_INT64 || end - cursor < 9)
+        return false;
+    memcpy(&value, cursor + 1, sizeof(value));
+    cursor += 9;
+    return true;
+}
+
+bool LogArgReader::readDouble(double &value)
+{
+    if (peekType() != LOG_ARG_DOUBLE || end - cursor < 9)
+        return false;
+    memcpy(&value, cursor + 1, sizeof(value));
+    cursor += 9;
+    return true;
+}
+
+bool LogArgReader::readString(const char *&value, uint8_t &length)
+{
+    if (peekType() != LOG_ARG_STRING || end - cursor < 2 || end - cursor < 2 + cursor[1])
+        return false;
+    length = cursor[1];
+    value = (const char *)(cursor + 2);
+    cursor += 2 + length;
+    return true;
+}
+
+bool LogArgReader::readPointer(uint32_t &value)
+{
+    if (peekType() != LOG_ARG_POINTER || end - cursor < 5)
+        return false;
+    memcpy(&value, cursor + 1, sizeof(value));
+    cursor += 5;
+    return true;
+}
+
+void LogArgReader::skip()
+{
+    switch (peekType())
+    {
+    case LOG_ARG_INT32:
+    case LOG_ARG_POINTER:
+        cursor += 5;
+        break;
+    case LOG_ARG_INT64:
+    case LOG_ARG_DOUBLE:
+        cursor += 9;
+        break;
+    case LOG_ARG_STRING:
+        cursor += (end - cursor >= 2) ? 2 + cursor[1] : 1;
+        break;
+    default:
+        cursor = end;
+        break;
+    }
+    if (cursor > end)
+        cursor = end;
+}
+
+// LogFormatter -------------------------------------------------------------------------
+
+// Append a snprintf result, clamping to the remaining space
+static void advance(size_t &pos, int written, size_t outSize)
+{
+    if (written <= 0)
+        return;
+    size_t remaining = outSize - 1 - pos;
+    pos += ((size_t)written < remaining) ? (size_t)written : remaining;
+}
+
+size_t LogFormatter::formatMessage(const LogRecordHeader &header, const uint8_t *args, char *out, size_t outSize)
+{
+    if (!out || outSize == 0)
+        return 0;
+
+    LogArgReader reader(args, header.argBytes);
+    const char *f = header.format ? header.format : "";
+    size_t pos = 0;
+
+    while (*f && pos < outSize - 1)
+    {
+        if (*f != '%')
+        {
+            out[pos++] = *f++;
+            continue;
+        }
+
+        f++;
+        if (*f == '%')
+        {
+            out[pos++] = '%';
+            f++;
+            continue;
+        }
+
+        // Rebuild the conversion spec without length modifiers; the stored
+        // argument type decides which modifier is used when rendering.
+        char spec[24];
+        size_t specLen = 0;
+        spec[specLen++] = '%';
+
+        while (*f && strchr("-+ #0", *f) && specLen < 8)
+            spec[specLen++] = *f++;
+
+        if (*f == '*')
+        {
+            int32_t width = 0;
+            reader.readInt32(width);
+            specLen += snprintf(spec + specLen, sizeof(spec) - specLen - 4, "%d", (int)width);
+            f++;
+        }
+        else
+        {
+            while (*f >= '0' && *f <= '9' && specLen < 14)
+                spec[specLen++] = *f++;
+        }
+
+        if (*f == '.')
+        {
+            spec[specLen++] = *f++;
+            if (*f == '*')
+            {
+                int32_t precision = 0;
+                reader.readInt32(precision);
+                specLen += snprintf(spec + specLen, sizeof(spec) - specLen - 4, "%d", (int)precision);
+                f++;
+            }
+            else
+            {
+                while (*f >= '0' && *f <= '9' && specLen < 18)
+                    spec[specLen++] = *f++;
+            }
+        }
+
+        while (*f && strchr("hlLzjtq", *f))
+            f++;
+
+        char conversion = *f;
+        if (!conversion)
+            break;
+        f++;
+
+        int written = -1;
+        size_t remaining = outSize - pos;
+
+        switch (conversion)
+        {
+        case 'd':
+        case 'i':
+        case 'u':
+        case 'x':
+        case 'X':
+        case 'o':
+        case 'c':
+            if (reader.peekType() == LOG_ARG_INT32)
+            {
+                int32_t value = 0;
+                reader.readInt32(value);
+                spec[specLen++] = conversion;
+                spec[specLen] = '\0';
+                written = snprintf(out + pos, remaining, spec, (int)value);
+            }
+            else if (reader.peekType() == LOG_ARG_INT64)
+            {
+                int64_t value = 0;
+                reader.readInt64(value);
+                spec[specLen++] = 'l';
+                spec[specLen++] = 'l';
+                spec[specLen++] = conversion;
+                spec[specLen] = '\0';
+                written = snprintf(out + pos, remaining, spec, (long long)value);
+            }
+            break;
+
+        case 'f':
+        case 'F':
+        case 'e':
+        case 'E':
+        case 'g':
+        case 'G':
+        case 'a':
+        case 'A':
+            if (reader.peekType() == LOG_ARG_DOUBLE)
+            {
+                double value = 0;
+                reader.readDouble(value);
+                spec[specLen++] = conversion;
+                spec[specLen] = '\0';
+                written = snprintf(out + pos, remaining, spec, value);
+            }
+            break;
+
+        case 's':
+            if (reader.peekType() == LOG_ARG_STRING)
+            {
+                const char *value = nullptr;
+                uint8_t length = 0;
+                reader.readString(value, length);
+
+                // Stored strings are not terminated
+                char text[256];
+                memcpy(text, value, length);
+                text[length] = '\0';
+
+                spec[specLen++] = 's';
+                spec[specLen] = '\0';
+                written = snprintf(out + pos, remaining, spec, text);
+            }
+            break;
+
+        case 'p':
+            if (reader.peekType() == LOG_ARG_POINTER)
+            {
+                uint32_t value = 0;
+                reader.readPointer(value);
+                written = snprintf(out + pos, remaining, "%p", (void *)(uintptr_t)value);
+            }
+            break;
+
+        default:
+            break;
+        }
+
+        if (written < 0)
+        {
+            // Missing or mismatched argument
+            reader.skip();
+            written = snprintf(out + pos, remaining, "<?>");
+        }
+        advance(pos, written, outSize);
+    }
+
+    out[pos] = '\0';
+    return pos;
+}
+
+size_t LogFormatter::formatText(const LogRecordHeader &header, const uint8_t *args, char *out, size_t outSize)
+{
+    if (!out || outSize < 2)
+        return 0;
+
+    size_t pos = 0;
+    advance(pos, snprintf(out, outSize - 1, "[%lu][%s][%s] ", (unsigned long)header.timestamp,
+                          logLevelName(header.level), header.tag ? header.tag : ""), outSize - 1);
+    pos += formatMessage(header, args, out + pos, outSize - 1 - pos);
+
+    out[pos++] = '\n';
+    out[pos] = '\0';
+    return pos;
+}
+
+size_t LogFormatter::encodeBinary(const LogRecordHeader &header, const uint8_t *args, uint8_t *out, size_t outSize)
+{
+    size_t total = LOG_BINARY_HEADER_SIZE + header.argBytes;
+    if (!out || outSize < total)
+        return 0;
+
+    uint32_t tag = (uint32_t)(uintptr_t)header.tag;
+    uint32_t format = (uint32_t)(uintptr_t)header.format;
+
+    out[0] = LOG_BINARY_RECORD_MAGIC;
+    out[1] = header.level;
+    memcpy(out + 2, &header.timestamp, 4);
+    memcpy(out + 6, &tag, 4);
+    memcpy(out + 10, &format, 4);
+    out[14] = header.argCount;
+    memcpy(out + 15, &header.argBytes, 2);
+    memcpy(out + LOG_BINARY_HEADER_SIZE, args, header.argBytes);
+
+    return total;
+}
+
+// Field name written directly before a conversion as "name=%..." (empty if none)
+static size_t fieldName(const char *format, const char *percent, const char *&name)
+{
+    if (percent == format || percent[-1] != '=')
+        return 0;
+
+    const char *end = percent - 1;
+    const char *start = end;
+    while (start > format && (isalnum((unsigned char)start[-1]) || start[-1] == '_'))
+        start--;
+
+    name = start;
+    return end - start;
+}
+
+// Emit the typed value of the next argument as a field
+static void writeField(JsonStreamWriter &json, LogArgReader &reader, const char *name, size_t nameLength, char conversion)
+{
+    char key[32];
+    size_t keyLength = nameLength < sizeof(key) - 1 ? nameLength : sizeof(key) - 1;
+    memcpy(key, name, keyLength);
+    key[keyLength] = '\0';
+
+    bool isUnsigned = strchr("uxXo", conversion) != nullptr;
+
+    switch (reader.peekType())
+    {
+    case LOG_ARG_INT32:
+    {
+        int32_t value = 0;
+        reader.readInt32(value);
+        json.key(key);
+        if (isUnsigned)
+            json.value((uint32_t)value);
+        else
+            json.value(value);
+        break;
+    }
+    case LOG_ARG_INT64:
+    {
+        int64_t value = 0;
+        reader.readInt64(value);
+        json.key(key);
+        if (isUnsigned)
+            json.value((uint64_t)value);
+        else
+            json.value(value);
+        break;
+    }
+    case LOG_ARG_DOUBLE:
+    {
+        double value = 0;
+        reader.readDouble(value);
+        json.key(key);
+        json.value(value);
+        break;
+    }
+    case LOG_ARG_STRING:
+    {
+        const char *value = nullptr;
+        uint8_t length = 0;
+        reader.readString(value, length);
+        json.key(key);
+        json.value(value, length);
+        break;
+    }
+    default:
+        reader.skip();
+        break;
+    }
+}
+
+size_t LogFormatter::encodeJson(const LogRecordHeader &header, const uint8_t *args, char *out, size_t outSize)
+{
+    if (!out || outSize < 2)
+        return 0;
+
+    char message[LOG_LINE_BUFFER_SIZE];
+    size_t messageLength = formatMessage(header, args, message, sizeof(message));
+
+    // Leave room for the line terminator
+    JsonStreamWriter json(out, outSize - 1);
+    json.beginObject();
+    json.key("ts");
+    json.value(header.timestamp);
+    json.key("level");
+    json.value(logLevelName(header.level));
+    json.key("tag");
+    json.value(header.tag ? header.tag : "");
+    json.key("msg");
+    json.value(message, messageLength);
+
+    // Second pass over the format for key=value fields
+    LogArgReader reader(args, header.argBytes);
+    const char *format = header.format ? header.format : "";
+    bool hasFields = false;
+
+    for (const char *f = format; *f; f++)
+    {
+        if (*f != '%')
+            continue;
+
+        const char *percent = f++;
+        if (*f == '%')
+            continue;
+
+        while (*f && strchr("-+ #0", *f))
+            f++;
+        if (*f == '*')
+        {
+            reader.skip();
+            f++;
+        }
+        while (*f >= '0' && *f <= '9')
+            f++;
+        if (*f == '.')
+        {
+            f++;
+            if (*f == '*')
+            {
+                reader.skip();
+                f++;
+            }
+            while (*f >= '0' && *f <= '9')
+                f++;
+        }
+        while (*f && strchr("hlLzjtq", *f))
+            f++;
+        if (!*f)
+            break;
+
+        const char *name = nullptr;
+        size_t nameLength = fieldName(format, percent, name);
+        if (nameLength == 0 || *f == 'p')
+        {
+            reader.skip();
+            continue;
+        }
+
+        if (!hasFields)
+        {
+            json.key("fields");
+            json.beginObject();
+            hasFields = true;
+        }
+        writeField(json, reader, name, nameLength, *f);
+    }
+
+    if (hasFields)
+        json.endObject();
+    json.endObject();
+
+    if (json.overflowed())
+        return 0;
+
+    size_t length = json.length();
+    out[length++] = '\n';
+    out[length] = '\0';
+    return length;
+}
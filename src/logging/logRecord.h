@@ -0,0 +1,213 @@
+#pragma once
+#ifndef __LOGRECORD_H__
+#define __LOGRECORD_H__
+
+#include <Arduino.h>
+#include <type_traits>
+
+#include "definitions.h"
+
+/*
+ * Deferred-formatting log records
+ *
+ * A record stores the tag pointer, the format-string pointer, a timestamp and
+ * the raw arguments. Formatting happens later on the logging drain task, or on
+ * the host (scripts/logdecode.py) when records are shipped in binary form.
+ *
+ * Tags and format strings MUST be string literals (they live in flash and are
+ * never copied). String arguments are copied into the record, truncated to
+ * LOG_MAX_STRING_ARG_LENGTH bytes.
+ *
+ * Packed argument layout: [type:1][value...]
+ *   LOG_ARG_INT32   4 bytes little endian (all integral types up to 32 bits)
+ *   LOG_ARG_INT64   8 bytes little endian
+ *   LOG_ARG_DOUBLE  8 bytes IEEE-754 (floats are promoted)
+ *   LOG_ARG_STRING  1 byte length + bytes (no terminator)
+ *   LOG_ARG_POINTER 4 bytes little endian
+ */
+
+enum LogLevel : uint8_t
+{
+    LOG_LEVEL_ERROR = 0,
+    LOG_LEVEL_WARN,
+    LOG_LEVEL_INFO,
+    LOG_LEVEL_DEBUG
+};
+
+#define LOG_LEVEL_COUNT 4
+
+enum LogArgType : uint8_t
+{
+    LOG_ARG_INT32 = 1,
+    LOG_ARG_INT64,
+    LOG_ARG_DOUBLE,
+    LOG_ARG_STRING,
+    LOG_ARG_POINTER
+};
+
+// Record header as stored in the logging ring buffer (packed arguments follow)
+struct LogRecordHeader
+{
+    uint32_t timestamp;     // millis() at capture time
+    const char *tag;        // Static tag string
+    const char *format;     // Static printf-style format string
+    uint8_t level;          // LogLevel
+    uint8_t argCount;       // Number of packed arguments
+    uint16_t argBytes;      // Size of the packed argument area
+};
+
+// Size of a record in the portable binary encoding (see LogFormatter::encodeBinary)
+#define LOG_BINARY_HEADER_SIZE 17
+#define LOG_BINARY_RECORD_MAGIC 0xB1
+
+const char *logLevelName(uint8_t level);
+
+// Argument packing ---------------------------------------------------------------------
+
+namespace LogArgs
+{
+    inline uint8_t boundedLength(const char *value, size_t maxLength = LOG_MAX_STRING_ARG_LENGTH)
+    {
+        if (!value)
+            return 6; // "(null)"
+        size_t length = strnlen(value, maxLength);
+        return (uint8_t)length;
+    }
+
+    template <typename T>
+    inline size_t packedSize(T value)
+    {
+        using U = typename std::decay<T>::type;
+        static_assert(std::is_arithmetic<U>::value || std::is_enum<U>::value || std::is_pointer<U>::value,
+                      "Log arguments must be arithmetic, enum, pointer or C string (use .c_str() for String)");
+
+        if constexpr (std::is_same<U, const char *>::value || std::is_same<U, char *>::value)
+            return 2 + boundedLength(value);
+        else if constexpr (std::is_pointer<U>::value)
+            return 1 + sizeof(uint32_t);
+        else if constexpr (std::is_floating_point<U>::value)
+            return 1 + sizeof(double);
+        else if constexpr (sizeof(U) > sizeof(uint32_t))
+            return 1 + sizeof(uint64_t);
+        else
+            return 1 + sizeof(uint32_t);
+    }
+
+    inline void packString(uint8_t *&cursor, const char *value, uint8_t length)
+    {
+        *cursor++ = LOG_ARG_STRING;
+        *cursor++ = length;
+        memcpy(cursor, value ? value : "(null)", length);
+        cursor += length;
+    }
+
+    template <typename T>
+    inline void pack(uint8_t *&cursor, T value)
+    {
+        using U = typename std::decay<T>::type;
+
+        if constexpr (std::is_same<U, const char *>::value || std::is_same<U, char *>::value)
+        {
+            packString(cursor, value, boundedLength(value));
+        }
+        else if constexpr (std::is_pointer<U>::value)
+        {
+            uint32_t raw = (uint32_t)(uintptr_t)value;
+            *cursor++ = LOG_ARG_POINTER;
+            memcpy(cursor, &raw, sizeof(raw));
+            cursor += sizeof(raw);
+        }
+        else if constexpr (std::is_floating_point<U>::value)
+        {
+            double raw = (double)value;
+            *cursor++ = LOG_ARG_DOUBLE;
+            memcpy(cursor, &raw, sizeof(raw));
+            cursor += sizeof(raw);
+        }
+        else if constexpr (sizeof(U) > sizeof(uint32_t))
+        {
+            uint64_t raw = (uint64_t)value;
+            *cursor++ = LOG_ARG_INT64;
+            memcpy(cursor, &raw, sizeof(raw));
+            cursor += sizeof(raw);
+        }
+        else
+        {
+            int32_t raw = (int32_t)value;
+            *cursor++ = LOG_ARG_INT32;
+            memcpy(cursor, &raw, sizeof(raw));
+            cursor += sizeof(raw);
+        }
+    }
+
+    // FNV-1a over the argument values, used to detect repeated messages
+    static const uint32_t HASH_SEED = 2166136261u;
+
+    inline uint32_t hashBytes(uint32_t hash, const void *data, size_t length)
+    {
+        const uint8_t *bytes = static_cast<const uint8_t *>(data);
+        for (size_t i = 0; i < length; i++)
+        {
+            hash = (hash ^ bytes[i]) * 16777619u;
+        }
+        return hash;
+    }
+
+    template <typename T>
+    inline uint32_t hash(uint32_t seed, T value)
+    {
+        using U = typename std::decay<T>::type;
+
+        if constexpr (std::is_same<U, const char *>::value || std::is_same<U, char *>::value)
+            return value ? hashBytes(seed, value, boundedLength(value)) : hashBytes(seed, "", 1);
+        else
+            return hashBytes(seed, &value, sizeof(value));
+    }
+}
+
+// Record decoding ----------------------------------------------------------------------
+
+// Sequential reader over the packed arguments of a record
+class LogArgReader
+{
+public:
+    LogArgReader(const uint8_t *args, size_t length);
+
+    bool hasNext() const { return cursor < end; }
+    LogArgType peekType() const;
+
+    // Each reader consumes the next argument; returns false on a type mismatch
+    bool readInt32(int32_t &value);
+    bool readInt64(int64_t &value);
+    bool readDouble(double &value);
+    bool readString(const char *&value, uint8_t &length);
+    bool readPointer(uint32_t &value);
+    void skip();
+
+private:
+    const uint8_t *cursor;
+    const uint8_t *end;
+};
+
+class LogFormatter
+{
+public:
+    // Render the message text only (format + arguments), returns length written
+    static size_t formatMessage(const LogRecordHeader &header, const uint8_t *args, char *out, size_t outSize);
+
+    // Render "[millis][LEVEL][tag] message\n" - the classic serial line
+    static size_t formatText(const LogRecordHeader &header, const uint8_t *args, char *out, size_t outSize);
+
+    // Portable binary encoding for host-side decoding:
+    // [magic:1][level:1][timestamp:4][tag:4][format:4][argCount:1][argBytes:2][args...]
+    // Multi-byte fields are little endian. Returns 0 if the record does not fit.
+    static size_t encodeBinary(const LogRecordHeader &header, const uint8_t *args, uint8_t *out, size_t outSize);
+
+    // One JSON object per line (NDJSON):
+    // {"ts":1234,"level":"INFO","tag":"Modbus","msg":"...","fields":{"slave":1}}
+    // Arguments written as key=%spec in the format string are also emitted as typed
+    // fields. Returns 0 if the record does not fit.
+    static size_t encodeJson(const LogRecordHeader &header, const uint8_t *args, char *out, size_t outSize);
+};
+
+#endif // __LOGRECORD_H__
@@ -0,0 +1,17 @@
+#include "logSerialSink.h"
+
+LogSerialSink::LogSerialSink()
+    : LogSink("LogSerialSink", LOG_SERIAL_DEFAULT_ENCODING)
+{
+}
+
+bool LogSerialSink::begin()
+{
+    return true;
+}
+
+void LogSerialSink::write(const LogRecordHeader &header, const uint8_t *args)
+{
+    size_t length = encode(header, args, recordBuffer, sizeof(recordBuffer));
+    Serial.write(recordBuffer, length);
+}
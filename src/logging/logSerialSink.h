@@ -0,0 +1,23 @@
+#pragma once
+#ifndef __LOGSERIALSINK_H__
+#define __LOGSERIALSINK_H__
+
+#include <Arduino.h>
+
+#include "definitions.h"
+#include "logging/logSink.h"
+
+// Serial console output, human-readable text by default
+class LogSerialSink : public LogSink
+{
+public:
+    LogSerialSink();
+
+    bool begin() override;
+    void write(const LogRecordHeader &header, const uint8_t *args) override;
+
+private:
+    uint8_t recordBuffer[LOG_RECORD_BUFFER_SIZE];   // Only touched by the drain task
+};
+
+#endif // __LOGSERIALSINK_H__
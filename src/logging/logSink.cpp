@@ -0,0 +1,40 @@
+#include "logSink.h"
+
+LogSink::LogSink(const char *sinkName, LogEncoding encoding)
+    : sinkName(sinkName), enabled(false), encoding(encoding)
+{
+}
+
+LogSink::~LogSink()
+{
+}
+
+const char *LogSink::encodingName(LogEncoding encoding)
+{
+    switch (encoding)
+    {
+    case LOG_ENCODING_BINARY:
+        return "binary";
+    case LOG_ENCODING_JSON:
+        return "json";
+    case LOG_ENCODING_TEXT:
+    default:
+        return "text";
+    }
+}
+
+size_t LogSink::encode(const LogRecordHeader &header, const uint8_t *args, uint8_t *out, size_t outSize) const
+{
+    switch (encoding)
+    {
+    case LOG_ENCODING_BINARY:
+        return LogFormatter::encodeBinary(header, args, out, outSize);
+
+    case LOG_ENCODING_JSON:
+        return LogFormatter::encodeJson(header, args, reinterpret_cast<char *>(out), outSize);
+
+    case LOG_ENCODING_TEXT:
+    default:
+        return LogFormatter::formatText(header, args, reinterpret_cast<char *>(out), outSize);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+#ifndef __LOGSINK_H__
+#define __LOGSINK_H__
+
+#include <Arduino.h>
+#include "logging/logRecord.h"
+
+// How a sink serialises records
+enum LogEncoding : uint8_t
+{
+    LOG_ENCODING_TEXT,      // "[millis][LEVEL][tag] message\n"
+    LOG_ENCODING_BINARY,    // LogFormatter::encodeBinary, decoded on the host
+    LOG_ENCODING_JSON       // LogFormatter::encodeJson, one object per line
+};
+
+// Base class for log outputs fed by the LoggingManager drain task
+class LogSink
+{
+public:
+    LogSink(const char *sinkName, LogEncoding encoding);
+    virtual ~LogSink();
+
+    virtual bool begin() = 0;
+    virtual void stop() {}
+
+    // Drain task: called for every record while the sink is enabled
+    virtual void write(const LogRecordHeader &header, const uint8_t *args) = 0;
+
+    // Drain task: called after each record and when the ring is idle (time-based flushing)
+    virtual void idle() {}
+
+    // Managers task: background work (compression, housekeeping)
+    virtual void loop() {}
+
+    void setEnabled(bool enabled) { this->enabled = enabled; }
+    bool isEnabled() const { return enabled; }
+
+    void setEncoding(LogEncoding encoding) { this->encoding = encoding; }
+    static const char *encodingName(LogEncoding encoding);
+    LogEncoding getEncoding() const { return encoding; }
+
+    const char *getSinkName() const { return sinkName; }
+
+protected:
+    // Serialise a record with the sink's current encoding, returns 0 if it does not fit
+    size_t encode(const LogRecordHeader &header, const uint8_t *args, uint8_t *out, size_t outSize) const;
+
+    const char *sinkName;
+    volatile bool enabled;
+    volatile LogEncoding encoding;
+};
+
+#endif // __LOGSINK_H__
@@ -0,0 +1,159 @@
+#include "logTransfer.h"
+
+LogTransfer::LogTransfer(LogFileSink &fileSink)
+    : fileSink(fileSink), active(false), compressed(false), segment(0), segmentSize(0), nextChunk(0),
+      lastChunkRead(false)
+{
+}
+
+LogTransferResult LogTransfer::start(uint32_t segment, uint32_t firstChunk, bool resumeCompressed,
+                                     uint32_t resumeSize)
+{
+    cancel();
+
+    // The active segment is still being written
+    if (segment == 0 || segment >= fileSink.getActiveSequence())
+        return LOG_TRANSFER_REJECTED;
+
+    // Pin first so the segment cannot be compressed or deleted while it is opened
+    fileSink.setPinnedSegment(segment);
+
+    char path[48];
+    LogFileSink::buildSegmentPath(path, sizeof(path), segment, true);
+    compressed = LittleFS.exists(path);
+    if (!compressed)
+        LogFileSink::buildSegmentPath(path, sizeof(path), segment, false);
+
+    file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        fileSink.setPinnedSegment(0);
+        return LOG_TRANSFER_REJECTED;
+    }
+
+    // An offset into the .log stream means nothing in the .lz stream (and vice versa)
+    segmentSize = file.size();
+    if (firstChunk > 0 && (compressed != resumeCompressed || segmentSize != resumeSize))
+    {
+        finish();
+        return LOG_TRANSFER_CHANGED;
+    }
+
+    if ((size_t)firstChunk * LOG_TRANSFER_CHUNK_SIZE > segmentSize)
+    {
+        finish();
+        return LOG_TRANSFER_REJECTED;
+    }
+
+    this->segment = segment;
+    nextChunk = firstChunk;
+    active = true;
+    return LOG_TRANSFER_STARTED;
+}
+
+const char *LogTransfer::resultName(LogTransferResult result)
+{
+    switch (result)
+    {
+    case LOG_TRANSFER_STARTED:
+        return "started";
+    case LOG_TRANSFER_CHANGED:
+        return "changed";
+    default:
+        return "rejected";
+    }
+}
+
+void LogTransfer::cancel()
+{
+    if (active)
+        finish();
+}
+
+void LogTransfer::finish()
+{
+    if (file)
+        file.close();
+    active = false;
+    fileSink.setPinnedSegment(0);
+}
+
+size_t LogTransfer::readNextChunk()
+{
+    if (!active)
+        return 0;
+
+    uint32_t offset = nextChunk * LOG_TRANSFER_CHUNK_SIZE;
+    if (!file.seek(offset))
+    {
+        finish();
+        return 0;
+    }
+
+    size_t length = file.read(buffer + LOG_CHUNK_HEADER_SIZE, LOG_TRANSFER_CHUNK_SIZE);
+    bool last = offset + length >= segmentSize;
+
+    // Nothing read before the end means the file went away
+    if (length == 0 && !last)
+    {
+        finish();
+        return 0;
+    }
+
+    uint8_t *header = buffer;
+    memcpy(header, &segment, 4);
+    memcpy(header + 4, &nextChunk, 4);
+    memcpy(header + 8, &offset, 4);
+    memcpy(header + 12, &segmentSize, 4);
+    header[16] = (last ? LOG_CHUNK_FLAG_LAST : 0) | (compressed ? LOG_CHUNK_FLAG_COMPRESSED : 0);
+    header[17] = header[18] = header[19] = 0;
+
+    lastChunkRead = last;
+    return LOG_CHUNK_HEADER_SIZE + length;
+}
+
+void LogTransfer::commitChunk()
+{
+    if (!active)
+        return;
+
+    nextChunk++;
+    if (lastChunkRead)
+        finish();
+}
+
+size_t LogTransfer::listSegments()
+{
+    char *text = reinterpret_cast<char *>(buffer);
+    JsonStreamWriter json(text, sizeof(buffer));
+
+    json.beginObject();
+    json.key("active");
+    json.value(fileSink.getActiveSequence());
+    json.key("chunkSize");
+    json.value(LOG_TRANSFER_CHUNK_SIZE);
+    json.key("segments");
+    json.beginArray();
+
+    File dir = LittleFS.open(LOG_FILE_DIRECTORY);
+    for (File entry = dir.openNextFile(); entry && !json.overflowed(); entry = dir.openNextFile())
+    {
+        uint32_t sequence;
+        bool isCompressed, temporary;
+        if (!LogFileSink::parseSegmentName(entry.name(), sequence, isCompressed, temporary) || temporary)
+            continue;
+
+        json.beginArray();
+        json.value(sequence);
+        json.value((uint32_t)entry.size());
+        json.value(isCompressed);
+        json.endArray();
+    }
+    if (dir)
+        dir.close();
+
+    json.endArray();
+    json.endObject();
+
+    return json.overflowed() ? 0 : json.length();
+}
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef __LOGTRANSFER_H__
+#define __LOGTRANSFER_H__
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include "definitions.h"
+#include "logging/logFileSink.h"
+#include "utils/jsonStreamWriter.h"
+
+/*
+ * Chunked retrieval of stored log segments
+ *
+ * A transfer streams one segment file (raw .log or compressed .lz) in
+ * LOG_TRANSFER_CHUNK_SIZE pieces straight from flash. Each chunk carries a
+ * header so the receiver can reassemble, detect gaps and resume by asking for
+ * the same segment from a given chunk index:
+ *
+ *   [segment:4][chunk:4][offset:4][segmentSize:4][flags:1][reserved:3][data...]
+ *   flags: LOG_CHUNK_FLAG_LAST, LOG_CHUNK_FLAG_COMPRESSED (little endian fields)
+ *
+ * Background compression replaces a closed .log segment with its .lz file, so
+ * the same segment number can name two different streams over time. A resume
+ * therefore names the stream its earlier chunks came from (compressed flag and
+ * segment size from their headers); if the file no longer matches, the resume
+ * is refused and the receiver starts over from chunk 0.
+ *
+ * The segment is pinned in the file sink while it is being read so background
+ * compression and the size limit leave it alone.
+ */
+
+#define LOG_CHUNK_HEADER_SIZE 20
+#define LOG_CHUNK_FLAG_LAST 0x01
+#define LOG_CHUNK_FLAG_COMPRESSED 0x02
+
+enum LogTransferResult : uint8_t
+{
+    LOG_TRANSFER_STARTED,
+    LOG_TRANSFER_REJECTED,      // No such closed segment, or the chunk is past its end
+    LOG_TRANSFER_CHANGED        // Resume of a stream the segment file no longer is
+};
+
+class LogTransfer
+{
+public:
+    LogTransfer(LogFileSink &fileSink);
+
+    // Start streaming a closed segment from the given chunk. Chunk 0 starts afresh;
+    // a later chunk resumes the stream identified by compressed and segmentSize.
+    LogTransferResult start(uint32_t segment, uint32_t firstChunk, bool compressed = false, uint32_t segmentSize = 0);
+    void cancel();
+    bool isActive() const { return active; }
+    uint32_t getSegment() const { return segment; }
+    uint32_t getNextChunk() const { return nextChunk; }
+
+    // Read the next chunk (header + data) into the internal buffer; returns the
+    // message length, 0 if the transfer failed. The same chunk is read again
+    // until commitChunk() confirms it was delivered.
+    size_t readNextChunk();
+    void commitChunk();
+    const uint8_t *getBuffer() const { return buffer; }
+
+    // Write {"active":N,"chunkSize":N,"segments":[[seq,size,compressed],...]} into the
+    // internal buffer; returns the length (0 if it does not fit)
+    size_t listSegments();
+
+    static const char *resultName(LogTransferResult result);
+
+private:
+    void finish();
+
+    LogFileSink &fileSink;
+    File file;
+    bool active;
+    bool compressed;
+    uint32_t segment;
+    uint32_t segmentSize;
+    uint32_t nextChunk;
+    bool lastChunkRead;
+    uint8_t buffer[LOG_CHUNK_HEADER_SIZE + LOG_TRANSFER_CHUNK_SIZE];
+};
+
+#endif // __LOGTRANSFER_H__
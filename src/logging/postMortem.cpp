@@ -0,0 +1,197 @@
+#include "postMortem.h"
+#include "logging/logFileSink.h"
+#include "utils/jsonStreamWriter.h"
+
+PostMortem::PostMortem()
+    : stage(STAGE_DONE), ringReason(ESP_RST_UNKNOWN), ringSize(0), coredumpPartition(nullptr),
+      coredumpSize(0), chunk(0), lastChunk(false)
+{
+}
+
+void PostMortem::begin()
+{
+    ringSize = 0;
+    if (LittleFS.exists(LOG_CRASH_RING_FILE))
+    {
+        File file = LittleFS.open(LOG_CRASH_RING_FILE, "r");
+        uint8_t header[LOG_SEGMENT_HEADER_SIZE];
+        if (file && file.read(header, sizeof(header)) == sizeof(header))
+        {
+            ringReason = (esp_reset_reason_t)header[5];
+            ringSize = file.size();
+        }
+        file.close();
+    }
+
+    // The first word of a stored core dump is its total length; erased flash reads 0xFFFFFFFF
+    coredumpSize = 0;
+    coredumpPartition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_COREDUMP, NULL);
+    if (coredumpPartition)
+    {
+        uint32_t length = 0;
+        if (esp_partition_read(coredumpPartition, 0, &length, sizeof(length)) == ESP_OK &&
+            length > sizeof(length) && length <= coredumpPartition->size)
+        {
+            coredumpSize = length;
+        }
+    }
+
+    stage = (ringSize > 0 || coredumpSize > 0) ? STAGE_INFO : STAGE_DONE;
+    chunk = 0;
+}
+
+const char *PostMortem::resetReasonName(esp_reset_reason_t reason)
+{
+    switch (reason)
+    {
+    case ESP_RST_POWERON:
+        return "poweron";
+    case ESP_RST_EXT:
+        return "external";
+    case ESP_RST_SW:
+        return "software";
+    case ESP_RST_PANIC:
+        return "panic";
+    case ESP_RST_INT_WDT:
+        return "interrupt_wdt";
+    case ESP_RST_TASK_WDT:
+        return "task_wdt";
+    case ESP_RST_WDT:
+        return "wdt";
+    case ESP_RST_DEEPSLEEP:
+        return "deepsleep";
+    case ESP_RST_BROWNOUT:
+        return "brownout";
+    case ESP_RST_SDIO:
+        return "sdio";
+    default:
+        return "unknown";
+    }
+}
+
+size_t PostMortem::buildInfo()
+{
+    JsonStreamWriter json(reinterpret_cast<char *>(buffer), sizeof(buffer));
+    json.beginObject();
+    json.key("resetReason");
+    json.value(resetReasonName(esp_reset_reason()));
+    json.key("ringResetReason");
+    json.value(ringSize > 0 ? resetReasonName(ringReason) : "none");
+    json.key("ringBytes");
+    json.value(ringSize);
+    json.key("coredumpBytes");
+    json.value(coredumpSize);
+    json.key("firmware");
+    json.value(FIRMWARE_VERSION);
+    json.key("chunkSize");
+    json.value(LOG_TRANSFER_CHUNK_SIZE);
+    json.endObject();
+    return json.overflowed() ? 0 : json.length();
+}
+
+size_t PostMortem::readChunk(uint32_t id, uint32_t total)
+{
+    uint32_t offset = chunk * LOG_TRANSFER_CHUNK_SIZE;
+    size_t length = total - offset < LOG_TRANSFER_CHUNK_SIZE ? total - offset : LOG_TRANSFER_CHUNK_SIZE;
+    uint8_t *data = buffer + LOG_CHUNK_HEADER_SIZE;
+
+    bool ok;
+    if (id == POST_MORTEM_ID_RING)
+    {
+        ok = ringFile.seek(offset) && ringFile.read(data, length) == length;
+    }
+    else
+    {
+        ok = esp_partition_read(coredumpPartition, offset, data, length) == ESP_OK;
+    }
+
+    if (!ok)
+    {
+        // Skip an unreadable artifact rather than retrying forever
+        advanceStage();
+        return 0;
+    }
+
+    lastChunk = offset + length >= total;
+
+    uint8_t *header = buffer;
+    memcpy(header, &id, 4);
+    memcpy(header + 4, &chunk, 4);
+    memcpy(header + 8, &offset, 4);
+    memcpy(header + 12, &total, 4);
+    header[16] = lastChunk ? LOG_CHUNK_FLAG_LAST : 0;
+    header[17] = header[18] = header[19] = 0;
+
+    return LOG_CHUNK_HEADER_SIZE + length;
+}
+
+size_t PostMortem::readNext(MQTTTopic &topic)
+{
+    switch (stage)
+    {
+    case STAGE_INFO:
+        topic = MQTT_TOPIC_CRASH_INFO;
+        lastChunk = true;
+        return buildInfo();
+
+    case STAGE_RING:
+        if (!ringFile)
+        {
+            ringFile = LittleFS.open(LOG_CRASH_RING_FILE, "r");
+            if (!ringFile)
+            {
+                advanceStage();
+                return 0;
+            }
+        }
+        topic = MQTT_TOPIC_CRASH_RING;
+        return readChunk(POST_MORTEM_ID_RING, ringSize);
+
+    case STAGE_COREDUMP:
+        topic = MQTT_TOPIC_CRASH_COREDUMP;
+        return readChunk(POST_MORTEM_ID_COREDUMP, coredumpSize);
+
+    case STAGE_DONE:
+    default:
+        return 0;
+    }
+}
+
+void PostMortem::commit()
+{
+    if (stage == STAGE_DONE)
+        return;
+
+    chunk++;
+    if (!lastChunk)
+        return;
+
+    // Artifact delivered - remove it so it is not uploaded again
+    if (stage == STAGE_RING)
+    {
+        ringFile.close();
+        LittleFS.remove(LOG_CRASH_RING_FILE);
+    }
+    else if (stage == STAGE_COREDUMP)
+    {
+        esp_partition_erase_range(coredumpPartition, 0, coredumpPartition->size);
+    }
+
+    advanceStage();
+}
+
+void PostMortem::advanceStage()
+{
+    if (ringFile)
+        ringFile.close();
+
+    chunk = 0;
+    lastChunk = false;
+
+    if (stage == STAGE_INFO)
+        stage = ringSize > 0 ? STAGE_RING : (coredumpSize > 0 ? STAGE_COREDUMP : STAGE_DONE);
+    else if (stage == STAGE_RING)
+        stage = coredumpSize > 0 ? STAGE_COREDUMP : STAGE_DONE;
+    else
+        stage = STAGE_DONE;
+}
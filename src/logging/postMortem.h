@@ -0,0 +1,74 @@
+#pragma once
+#ifndef __POSTMORTEM_H__
+#define __POSTMORTEM_H__
+
+#include <Arduino.h>
+#include <LittleFS.h>
+#include <esp_partition.h>
+#include <esp_system.h>
+
+#include "definitions.h"
+#include "logging/logTransfer.h"
+
+/*
+ * Post-mortem upload after an abnormal reset
+ *
+ * At boot it looks for the log ring saved by LogCrashSink and for a core dump
+ * in the coredump partition. NovaLogicService uploads them at low priority:
+ * first a JSON summary on crash/info, then the ring on crash/ring and the raw
+ * core dump on crash/coredump, in chunks with the LogTransfer header layout
+ * (the segment field holds POST_MORTEM_ID_*). An artifact is removed only
+ * after its last chunk was published; an interrupted upload restarts on the
+ * next boot.
+ *
+ * The raw core dump is read with:
+ *   espcoredump.py info_corefile --core-format raw -c coredump.bin firmware.elf
+ */
+
+#define POST_MORTEM_ID_RING 1
+#define POST_MORTEM_ID_COREDUMP 2
+
+class PostMortem
+{
+public:
+    PostMortem();
+
+    // Find pending artifacts (after the log sinks have started)
+    void begin();
+    bool hasPending() const { return stage != STAGE_DONE; }
+
+    // Publisher side: fill the buffer with the next message and name its topic;
+    // commit once it was published. Returns 0 when nothing is left.
+    size_t readNext(MQTTTopic &topic);
+    void commit();
+    const uint8_t *getBuffer() const { return buffer; }
+
+    static const char *resetReasonName(esp_reset_reason_t reason);
+
+private:
+    enum Stage : uint8_t
+    {
+        STAGE_INFO,
+        STAGE_RING,
+        STAGE_COREDUMP,
+        STAGE_DONE
+    };
+
+    size_t buildInfo();
+    size_t readChunk(uint32_t id, uint32_t total);
+    void advanceStage();
+
+    Stage stage;
+    esp_reset_reason_t ringReason;
+    uint32_t ringSize;
+    const esp_partition_t *coredumpPartition;
+    uint32_t coredumpSize;
+
+    // Chunk in flight
+    uint32_t chunk;
+    bool lastChunk;
+    File ringFile;
+    uint8_t buffer[LOG_CHUNK_HEADER_SIZE + LOG_TRANSFER_CHUNK_SIZE];
+};
+
+#endif // __POSTMORTEM_H__
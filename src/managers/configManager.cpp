@@ -0,0 +1,350 @@
+#include "managers/configManager.h"
+#include "managers/displayManager.h"
+#include "utils/jsonStreamWriter.h"
+#include <nvs.h>
+#include <stdarg.h>
+
+static const char *TAG = "ConfigManager";
+
+// Same namespace and blob as loadSettings()/saveSettings()
+static const char *SETTINGS_NAMESPACE = "app_settings";
+static const char *SETTINGS_KEY = "settings";
+static const char *VERSION_KEY = "config_ver";
+
+// Rates offered by data/config.json (modbus.availableBaudRates)
+static const uint32_t MODBUS_BAUD_RATES[] = {9600, 19200, 38400, 57600, 115200};
+
+static const struct
+{
+    ConfigSubsystem subsystem;
+    const char *name;
+} SUBSYSTEM_NAMES[] = {
+    {CONFIG_SUBSYSTEM_MODBUS_SERIAL, "modbus.serial"},
+    {CONFIG_SUBSYSTEM_MODBUS_SLAVE, "modbus.slave"},
+    {CONFIG_SUBSYSTEM_MODBUS_OUTPUT, "modbus.output"},
+    {CONFIG_SUBSYSTEM_LOGGING, "logging"},
+};
+
+static void writeSubsystems(JsonStreamWriter &json, uint8_t mask)
+{
+    json.beginArray();
+    for (const auto &entry : SUBSYSTEM_NAMES)
+    {
+        if (mask & entry.subsystem)
+            json.value(entry.name);
+    }
+    json.endArray();
+}
+
+ConfigManager::ConfigManager(ModbusMonitorManager &modbusManager, LoggingManager &loggingManager)
+    : modbusManager(modbusManager), loggingManager(loggingManager), version(0), lastResult(CONFIG_RESULT_NONE),
+      lastChanged(0), lastRestarted(0)
+{
+    lastError[0] = '\0';
+}
+
+void ConfigManager::begin()
+{
+    nvs_handle_t handle;
+    if (nvs_open(SETTINGS_NAMESPACE, NVS_READONLY, &handle) == ESP_OK)
+    {
+        // A version only counts together with a settings blob of this firmware's layout
+        size_t size = 0;
+        if (nvs_get_u32(handle, VERSION_KEY, &version) != ESP_OK ||
+            nvs_get_blob(handle, SETTINGS_KEY, NULL, &size) != ESP_OK || size != sizeof(AppSettings))
+        {
+            version = 0;
+        }
+        nvs_close(handle);
+    }
+
+    AppSettings &settings = getAppSettings();
+    if (version == 0)
+    {
+        // Never configured remotely: the Modbus service defaults are what runs, so updates start from them
+        takeModbusConfig(settings, modbusManager.getConfiguration());
+        return;
+    }
+
+    modbusManager.setConfiguration(modbusConfig(settings));
+    LOG_INFO(TAG, "Remote configuration version %lu", version);
+}
+
+ConfigResult ConfigManager::update(const char *payload)
+{
+    lastChanged = 0;
+    lastRestarted = 0;
+    lastError[0] = '\0';
+
+    JsonDocument doc;
+    DeserializationError error = deserializeJson(doc, payload);
+    // Keypad and serial prompt changes reach the running Modbus configuration but not
+    // AppSettings; starting from AppSettings would revert them with any document
+    AppSettings running = getAppSettings();
+    takeModbusConfig(running, modbusManager.getConfiguration());
+    AppSettings candidate = running;
+    uint32_t candidateVersion = 0;
+    if (error)
+    {
+        reject("invalid JSON: %s", error.c_str());
+    }
+    else if (parse(doc.as<JsonObjectConst>(), candidate, candidateVersion))
+    {
+        if (candidateVersion <= version)
+        {
+            LOG_INFO(TAG, "Version %lu ignored - version %lu applied", candidateVersion, version);
+            return lastResult = CONFIG_RESULT_CURRENT;
+        }
+
+        if (!persist(candidate, candidateVersion))
+        {
+            LOG_ERROR(TAG, "Version %lu could not be stored - not applied", candidateVersion);
+            snprintf(lastError, sizeof(lastError), "storage failed");
+            return lastResult = CONFIG_RESULT_STORAGE_FAILED;
+        }
+
+        // The swap: everything reading the settings sees either the old or the new document
+        getAppSettings() = candidate;
+        version = candidateVersion;
+
+        lastChanged = apply(running, candidate, lastRestarted);
+        LOG_INFO(TAG, "Version %lu applied (changed 0x%02X, restarted 0x%02X)", version, lastChanged, lastRestarted);
+        return lastResult = CONFIG_RESULT_APPLIED;
+    }
+
+    LOG_WARN(TAG, "Configuration rejected: %s", lastError);
+    return lastResult = CONFIG_RESULT_REJECTED;
+}
+
+bool ConfigManager::parse(JsonObjectConst document, AppSettings &candidate, uint32_t &candidateVersion)
+{
+    if (document.isNull())
+        return reject("document is not an object");
+
+    // Unknown keys reject the document, so a misspelt field never goes unnoticed
+    for (JsonPairConst field : document)
+    {
+        const char *key = field.key().c_str();
+        JsonVariantConst value = field.value();
+        if (strcmp(key, "version") == 0)
+        {
+            if (!value.is<uint32_t>() || value.as<uint32_t>() == 0)
+                return reject("version must be a positive integer");
+            candidateVersion = value.as<uint32_t>();
+        }
+        else if (strcmp(key, "modbus") == 0)
+        {
+            if (!value.is<JsonObjectConst>())
+                return reject("%s must be an object", key);
+            if (!parseModbus(value.as<JsonObjectConst>(), candidate))
+                return false;
+        }
+        else if (strcmp(key, "logging") == 0)
+        {
+            if (!value.is<JsonObjectConst>())
+                return reject("%s must be an object", key);
+            if (!parseLogging(value.as<JsonObjectConst>(), candidate))
+                return false;
+        }
+        else
+        {
+            return reject("unknown key %s", key);
+        }
+    }
+
+    if (candidateVersion == 0)
+        return reject("version missing");
+    return true;
+}
+
+bool ConfigManager::parseModbus(JsonObjectConst section, AppSettings &candidate)
+{
+    for (JsonPairConst field : section)
+    {
+        const char *key = field.key().c_str();
+        JsonVariantConst value = field.value();
+        if (strcmp(key, "baudRate") == 0)
+        {
+            if (!value.is<uint32_t>() || !validBaudRate(value.as<uint32_t>()))
+                return reject("unsupported modbus.%s", key);
+            candidate.modbusBaudRate = value.as<uint32_t>();
+        }
+        else if (strcmp(key, "slaveId") == 0)
+        {
+            if (!value.is<uint8_t>() || value.as<uint8_t>() < 1 || value.as<uint8_t>() > 247)
+                return reject("modbus.%s must be 1-247", key);
+            candidate.modbusSlaveId = value.as<uint8_t>();
+        }
+        else
+        {
+            bool *flag = strcmp(key, "outputToSerial") == 0 ? &candidate.modbusOutputToSerial
+                         : strcmp(key, "outputToFile") == 0 ? &candidate.modbusOutputToFile
+                         : strcmp(key, "outputToMQTT") == 0 ? &candidate.modbusOutputToMQTT
+                                                            : nullptr;
+            if (!flag)
+                return reject("unknown key modbus.%s", key);
+            if (!value.is<bool>())
+                return reject("modbus.%s must be a boolean", key);
+            *flag = value.as<bool>();
+        }
+    }
+    return true;
+}
+
+bool ConfigManager::parseLogging(JsonObjectConst section, AppSettings &candidate)
+{
+    for (JsonPairConst field : section)
+    {
+        const char *key = field.key().c_str();
+        JsonVariantConst value = field.value();
+        bool *flag = strcmp(key, "file") == 0 ? &candidate.logToFile
+                     : strcmp(key, "mqtt") == 0 ? &candidate.logToMQTT
+                                                : nullptr;
+        if (!flag)
+            return reject("unknown key logging.%s", key);
+        if (!value.is<bool>())
+            return reject("logging.%s must be a boolean", key);
+        *flag = value.as<bool>();
+    }
+    return true;
+}
+
+bool ConfigManager::reject(const char *format, ...)
+{
+    va_list args;
+    va_start(args, format);
+    vsnprintf(lastError, sizeof(lastError), format, args);
+    va_end(args);
+    return false;
+}
+
+bool ConfigManager::persist(const AppSettings &candidate, uint32_t candidateVersion)
+{
+    // Settings first, then the version: a power cut in between leaves the previous version
+    // stored, so the same document is accepted and applied again
+    nvs_handle_t handle;
+    if (nvs_open(SETTINGS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+        return false;
+
+    esp_err_t err = nvs_set_blob(handle, SETTINGS_KEY, &candidate, sizeof(AppSettings));
+    if (err == ESP_OK)
+        err = nvs_set_u32(handle, VERSION_KEY, candidateVersion);
+    if (err == ESP_OK)
+        err = nvs_commit(handle);
+    nvs_close(handle);
+    return err == ESP_OK;
+}
+
+uint8_t ConfigManager::apply(const AppSettings &previous, const AppSettings &current, uint8_t &restarted)
+{
+    uint8_t changed = 0;
+    restarted = 0;
+
+    if (current.modbusBaudRate != previous.modbusBaudRate)
+        changed |= CONFIG_SUBSYSTEM_MODBUS_SERIAL;
+    if (current.modbusSlaveId != previous.modbusSlaveId)
+        changed |= CONFIG_SUBSYSTEM_MODBUS_SLAVE;
+    if (current.modbusOutputToSerial != previous.modbusOutputToSerial ||
+        current.modbusOutputToFile != previous.modbusOutputToFile ||
+        current.modbusOutputToMQTT != previous.modbusOutputToMQTT)
+        changed |= CONFIG_SUBSYSTEM_MODBUS_OUTPUT;
+
+    if (changed && modbusManager.setConfiguration(modbusConfig(current)))
+        restarted |= CONFIG_SUBSYSTEM_MODBUS_SERIAL;
+
+    if (current.logToFile != previous.logToFile || current.logToMQTT != previous.logToMQTT)
+    {
+        changed |= CONFIG_SUBSYSTEM_LOGGING;
+        loggingManager.updateSettings(current.logToFile, current.logToMQTT);
+    }
+
+    return changed;
+}
+
+size_t ConfigManager::writeStatus(char *buffer, size_t size) const
+{
+    AppSettings settings = getAppSettings();
+    takeModbusConfig(settings, modbusManager.getConfiguration());
+
+    JsonStreamWriter json(buffer, size);
+    json.beginObject();
+    json.key("result");
+    json.value(resultName(lastResult));
+    if (lastError[0])
+    {
+        json.key("error");
+        json.value(lastError);
+    }
+    json.key("version");
+    json.value(version);
+    json.key("changed");
+    writeSubsystems(json, lastChanged);
+    json.key("restarted");
+    writeSubsystems(json, lastRestarted);
+    json.key("modbus");
+    json.beginObject();
+    json.key("baudRate");
+    json.value(settings.modbusBaudRate);
+    json.key("slaveId");
+    json.value(settings.modbusSlaveId);
+    json.key("outputToSerial");
+    json.value(settings.modbusOutputToSerial);
+    json.key("outputToFile");
+    json.value(settings.modbusOutputToFile);
+    json.key("outputToMQTT");
+    json.value(settings.modbusOutputToMQTT);
+    json.endObject();
+    json.key("logging");
+    json.beginObject();
+    json.key("file");
+    json.value(settings.logToFile);
+    json.key("mqtt");
+    json.value(settings.logToMQTT);
+    json.endObject();
+    json.endObject();
+
+    return json.overflowed() ? 0 : json.length();
+}
+
+const char *ConfigManager::resultName(ConfigResult result)
+{
+    switch (result)
+    {
+    case CONFIG_RESULT_NONE: return "none";
+    case CONFIG_RESULT_APPLIED: return "applied";
+    case CONFIG_RESULT_CURRENT: return "current";
+    case CONFIG_RESULT_REJECTED: return "rejected";
+    case CONFIG_RESULT_STORAGE_FAILED: return "storage_failed";
+    }
+    return "unknown";
+}
+
+ModbusConfig ConfigManager::modbusConfig(const AppSettings &settings)
+{
+    ModbusConfig config;
+    config.baudRate = settings.modbusBaudRate;
+    config.slaveId = settings.modbusSlaveId;
+    config.outputToSerial = settings.modbusOutputToSerial;
+    config.outputToFile = settings.modbusOutputToFile;
+    config.outputToMQTT = settings.modbusOutputToMQTT;
+    return config;
+}
+
+void ConfigManager::takeModbusConfig(AppSettings &settings, const ModbusConfig &config)
+{
+    settings.modbusBaudRate = config.baudRate;
+    settings.modbusSlaveId = config.slaveId;
+    settings.modbusOutputToSerial = config.outputToSerial;
+    settings.modbusOutputToFile = config.outputToFile;
+    settings.modbusOutputToMQTT = config.outputToMQTT;
+}
+
+bool ConfigManager::validBaudRate(uint32_t baudRate)
+{
+    for (uint32_t rate : MODBUS_BAUD_RATES)
+    {
+        if (rate == baudRate)
+            return true;
+    }
+    return false;
+}
@@ -0,0 +1,97 @@
+#pragma once
+#ifndef __CONFIG_MANAGER_H__
+#define __CONFIG_MANAGER_H__
+
+#include <Arduino.h>
+#include <ArduinoJson.h>
+
+#include "definitions.h"
+#include "managers/modbusMonitorManager.h"
+#include "managers/loggingManager.h"
+
+/*
+ * Versioned remote configuration (devices/<serial>/config/update)
+ *
+ * A document carries a version and any of these sections; omitted fields keep
+ * their current value:
+ *   {"version":7,
+ *    "modbus":{"baudRate":19200,"slaveId":10,"outputToSerial":false,"outputToFile":false,"outputToMQTT":false},
+ *    "logging":{"file":true,"mqtt":true}}
+ *
+ * The whole document is validated into a candidate AppSettings before anything
+ * changes: unknown keys, wrong types, a baud rate outside MODBUS_BAUD_RATES or a
+ * slave ID outside 1-247 reject it as a unit. A version at or below the applied
+ * one is not applied again, so a fleet publish can be repeated safely.
+ *
+ * The keypad and the serial prompt change the running Modbus configuration
+ * only, so that, not AppSettings, is the basis the Modbus half of a document is
+ * applied to and compared with.
+ *
+ * An accepted candidate is persisted (settings blob, then version), swapped in
+ * with a single assignment, and only the subsystems whose settings differ are
+ * touched: a new baud rate restarts the Modbus client, a new slave ID or output
+ * flags apply on the next request, logging flags go to the logging manager.
+ * Every update and config/get is answered on config/status.
+ */
+
+// Subsystems touched by the last update (status "changed" / "restarted")
+enum ConfigSubsystem : uint8_t
+{
+    CONFIG_SUBSYSTEM_MODBUS_SERIAL = 0x01,      // Baud rate: serial port and client restarted
+    CONFIG_SUBSYSTEM_MODBUS_SLAVE = 0x02,       // Slave ID: next request
+    CONFIG_SUBSYSTEM_MODBUS_OUTPUT = 0x04,      // Output flags: next frame
+    CONFIG_SUBSYSTEM_LOGGING = 0x08             // File/MQTT log sinks
+};
+
+enum ConfigResult : uint8_t
+{
+    CONFIG_RESULT_NONE,                         // No update received since boot
+    CONFIG_RESULT_APPLIED,
+    CONFIG_RESULT_CURRENT,                      // Version already applied
+    CONFIG_RESULT_REJECTED,                     // Invalid document, nothing changed
+    CONFIG_RESULT_STORAGE_FAILED                // Valid, but could not be persisted; nothing changed
+};
+
+class ConfigManager
+{
+public:
+    ConfigManager(ModbusMonitorManager &modbusManager, LoggingManager &loggingManager);
+
+    // After loadSettings(), before the Modbus monitor starts
+    void begin();
+
+    // Managers task (MQTT command callback)
+    ConfigResult update(const char *payload);
+
+    // config/status reply: {"result":"applied","version":7,"changed":[...],"restarted":[...],"modbus":{...},"logging":{...}}
+    size_t writeStatus(char *buffer, size_t size) const;
+
+    uint32_t getVersion() const { return version; }
+    ConfigResult getLastResult() const { return lastResult; }
+    const char *getLastError() const { return lastError; }
+
+    static const char *resultName(ConfigResult result);
+
+private:
+    bool parse(JsonObjectConst document, AppSettings &candidate, uint32_t &candidateVersion);
+    bool parseModbus(JsonObjectConst section, AppSettings &candidate);
+    bool parseLogging(JsonObjectConst section, AppSettings &candidate);
+    bool reject(const char *format, ...);
+    bool persist(const AppSettings &candidate, uint32_t candidateVersion);
+    uint8_t apply(const AppSettings &previous, const AppSettings &current, uint8_t &restarted);
+
+    static ModbusConfig modbusConfig(const AppSettings &settings);
+    static void takeModbusConfig(AppSettings &settings, const ModbusConfig &config);
+    static bool validBaudRate(uint32_t baudRate);
+
+    ModbusMonitorManager &modbusManager;
+    LoggingManager &loggingManager;
+
+    uint32_t version;                           // Last applied document, 0 = never configured remotely
+    ConfigResult lastResult;
+    uint8_t lastChanged;                        // ConfigSubsystem bits
+    uint8_t lastRestarted;
+    char lastError[CONFIG_ERROR_LENGTH];
+};
+
+#endif // __CONFIG_MANAGER_H__
@@ -1,5 +1,6 @@
 #include "loggingManager.h"
 #include "connectivityManager.h"
+#include "managerEvents.h"
 
 // Logging tag
 static const char* TAG = "ConnectivityManager";
@@ -10,7 +11,7 @@ const char *ConnectivityManager::PING_HOST = CONNECTIVITY_PING_HOST;
 ConnectivityManager::ConnectivityManager(NetworkingManager &networkingMgr, StatusViewModel &statusVM)
     : networkingManager(networkingMgr), statusViewModel(statusVM),
       currentState(CONNECTIVITY_OFFLINE), lastPingTime(0), lastStateChange(0),
-      pingRetries(0), callback(nullptr)
+      pingRetries(0), callback(nullptr), timeSyncStarted(false)
 {
 }
 
@@ -65,6 +66,7 @@ void ConnectivityManager::forceCheck()
 {
     LOG_INFO(TAG, "Force checking connectivity...");
     lastPingTime = 0; // Reset timer to trigger immediate check;
+    managerEvents.signal(MANAGER_EVENT_COMMAND);
 }
 
 void ConnectivityManager::setState(ConnectivityStatus newState)
@@ -97,6 +99,12 @@ void ConnectivityManager::setState(ConnectivityStatus newState)
             break;
         case CONNECTIVITY_ONLINE:
             LOG_DEBUG(TAG, "Internet connectivity: ONLINE");
+            if (!timeSyncStarted)
+            {
+                // SNTP keeps the clock in sync from here on (used to timestamp stored telemetry)
+                configTime(0, 0, CONNECTIVITY_NTP_SERVER);
+                timeSyncStarted = true;
+            }
             break;
         }
     }
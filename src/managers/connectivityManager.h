@@ -33,6 +33,7 @@ private:
     unsigned long lastStateChange;
     int pingRetries;
     std::function<void(ConnectivityStatus)> callback;
+    bool timeSyncStarted;
 
     void setState(ConnectivityStatus newState);
     void checkConnectivity();
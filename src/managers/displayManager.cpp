@@ -61,12 +61,6 @@ void TaskDisplayUpdate(void *pvParameters)
 
 void updateDisplay()
 {
-    // Skip display updates during OTA to prevent I2C conflicts and reduce system load
-    if (displayViewModel.isOTAActive())
-    {
-        return;
-    }
-    
     // Check for menu timeout
     if (displayMode == MENU && menuTimeoutTimer.TRIGGERED)
     {
@@ -242,79 +236,71 @@ void updateDisplayNormal()
             hwDisplay.drawXBM(1, 48, 17, 16, bitImage_CloudSync);
             if (deviceStatus == DEVICE_STARTED)
             {
-                // Get individual service statuses
-                ServiceStatus novaLogicStatus = servicesManager.getNovaLogicService().getStatus();
-                
-#ifdef TEST_ALL_SERVICES
-                ServiceStatus tagoIOStatus = servicesManager.getTagoIOService().getStatus();
-
-                // Display detailed service status information (both services)
-                if (novaLogicStatus == SERVICE_CONNECTED && tagoIOStatus == SERVICE_CONNECTED)
+                // Summarise the registered services, naming the service when only one is affected
+                size_t count = servicesManager.getServiceCount();
+                size_t connected = 0, connecting = 0, error = 0, timeout = 0;
+                const char *firstConnected = nullptr, *firstConnecting = nullptr;
+                const char *firstError = nullptr, *firstTimeout = nullptr;
+                for (size_t i = 0; i < count; i++)
                 {
-                    hwDisplay.drawStr(24, 58, "Services Connected");
+                    const char *label = servicesManager.getServiceLabel(i);
+                    switch (servicesManager.getService(i).getStatus())
+                    {
+                    case SERVICE_CONNECTED:
+                        if (!connected++) firstConnected = label;
+                        break;
+                    case SERVICE_CONNECTING:
+                        if (!connecting++) firstConnecting = label;
+                        break;
+                    case SERVICE_ERROR:
+                        if (!error++) firstError = label;
+                        break;
+                    case SERVICE_NOT_CONNECTED:
+                        if (!timeout++) firstTimeout = label;
+                        break;
+                    default:
+                        break;
+                    }
                 }
-                else if (novaLogicStatus == SERVICE_CONNECTING || tagoIOStatus == SERVICE_CONNECTING)
+
+                char line[32];
+                if (count > 0 && connected == count)
                 {
-                    if (novaLogicStatus == SERVICE_CONNECTING && tagoIOStatus == SERVICE_CONNECTING)
-                        hwDisplay.drawStr(24, 58, "Connecting Services");
-                    else if (novaLogicStatus == SERVICE_CONNECTING)
-                        hwDisplay.drawStr(24, 58, "Connecting NovaLogic");
+                    if (count > 1)
+                        snprintf(line, sizeof(line), "Services Connected");
                     else
-                        hwDisplay.drawStr(24, 58, "Connecting TagoIO");
+                        snprintf(line, sizeof(line), "%s Connected", firstConnected);
                 }
-                else if (novaLogicStatus == SERVICE_ERROR || tagoIOStatus == SERVICE_ERROR)
+                else if (connecting > 0)
                 {
-                    if (novaLogicStatus == SERVICE_ERROR && tagoIOStatus == SERVICE_ERROR)
-                        hwDisplay.drawStr(24, 58, "Services Error");
-                    else if (novaLogicStatus == SERVICE_ERROR)
-                        hwDisplay.drawStr(24, 58, "NovaLogic Error");
+                    if (connecting > 1)
+                        snprintf(line, sizeof(line), "Connecting Services");
                     else
-                        hwDisplay.drawStr(24, 58, "TagoIO Error");
+                        snprintf(line, sizeof(line), "Connecting %s", firstConnecting);
                 }
-                else if (novaLogicStatus == SERVICE_NOT_CONNECTED || tagoIOStatus == SERVICE_NOT_CONNECTED)
+                else if (error > 0)
                 {
-                    if (novaLogicStatus == SERVICE_NOT_CONNECTED && tagoIOStatus == SERVICE_NOT_CONNECTED)
-                        hwDisplay.drawStr(24, 58, "Services Timeout");
-                    else if (novaLogicStatus == SERVICE_NOT_CONNECTED)
-                        hwDisplay.drawStr(24, 58, "NovaLogic Timeout");
+                    if (error > 1)
+                        snprintf(line, sizeof(line), "Services Error");
                     else
-                        hwDisplay.drawStr(24, 58, "TagoIO Timeout");
+                        snprintf(line, sizeof(line), "%s Error", firstError);
                 }
-                else if (novaLogicStatus == SERVICE_CONNECTED)
+                else if (timeout > 0)
                 {
-                    hwDisplay.drawStr(24, 58, "NovaLogic OK");
-                }
-                else if (tagoIOStatus == SERVICE_CONNECTED)
-                {
-                    hwDisplay.drawStr(24, 58, "TagoIO OK");
-                }
-                else
-                {
-                    hwDisplay.drawStr(24, 58, "Internet Connected");
-                }
-#else
-                // Display service status information (NovaLogic only)
-                if (novaLogicStatus == SERVICE_CONNECTED)
-                {
-                    hwDisplay.drawStr(24, 58, "NovaLogic Connected");
-                }
-                else if (novaLogicStatus == SERVICE_CONNECTING)
-                {
-                    hwDisplay.drawStr(24, 58, "Connecting NovaLogic");
-                }
-                else if (novaLogicStatus == SERVICE_ERROR)
-                {
-                    hwDisplay.drawStr(24, 58, "NovaLogic Error");
+                    if (timeout > 1)
+                        snprintf(line, sizeof(line), "Services Timeout");
+                    else
+                        snprintf(line, sizeof(line), "%s Timeout", firstTimeout);
                 }
-                else if (novaLogicStatus == SERVICE_NOT_CONNECTED)
+                else if (connected > 0)
                 {
-                    hwDisplay.drawStr(24, 58, "NovaLogic Timeout");
+                    snprintf(line, sizeof(line), "%s OK", firstConnected);
                 }
                 else
                 {
-                    hwDisplay.drawStr(24, 58, "Internet Connected");
+                    snprintf(line, sizeof(line), "Internet Connected");
                 }
-#endif
+                hwDisplay.drawStr(24, 58, line);
             }
         }
 
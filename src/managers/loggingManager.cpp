@@ -1,10 +1,18 @@
 #include "loggingManager.h"
+#include "managerEvents.h"
 
 // Global instance
 LoggingManager* globalLoggingManager = nullptr;
 
+// Longest pre-formatted message queued by the printf-style functions
+static const size_t FORMATTED_MESSAGE_LENGTH = 255;
+
 LoggingManager::LoggingManager() {
     globalLoggingManager = this;
+    addSink(&serialSink);
+    addSink(&fileSink);
+    addSink(&mqttSink);
+    addSink(&crashSink);
 }
 
 LoggingManager::~LoggingManager() {
@@ -18,107 +26,243 @@ bool LoggingManager::begin() {
     if (initialized) {
         return true;
     }
-    
+
+    if (!ringBuffer) {
+        ringBuffer = xRingbufferCreateStatic(sizeof(ringBufferStorage), RINGBUF_TYPE_NOSPLIT,
+                                             ringBufferStorage, &ringBufferStruct);
+        if (!ringBuffer) {
+            Serial.printf("[LoggingManager] Failed to create log ring buffer\n");
+            return false;
+        }
+    }
+
+    for (size_t i = 0; i < sinkCount; i++) {
+        if (!sinks[i]->begin()) {
+            Serial.printf("[LoggingManager] %s unavailable\n", sinks[i]->getSinkName());
+        }
+    }
+    postMortem.begin();
+
+    serialSink.setEnabled(true);
+    crashSink.setEnabled(true);
+    fileSink.setEnabled(logToFileEnabled);
+    mqttSink.setEnabled(logToMQTTEnabled);
+
+    if (!drainTaskHandle) {
+        xTaskCreatePinnedToCore(drainTask, "TaskLogDrain", LOG_DRAIN_TASK_STACK_SIZE, this,
+                                LOG_DRAIN_TASK_PRIORITY, &drainTaskHandle, 0);
+    }
+
     initialized = true;
     Serial.printf("[LoggingManager] Enhanced logging system initialized\n");
     return true;
 }
 
 void LoggingManager::loop() {
-    // Simple implementation - no periodic tasks yet
+    // Output is handled by the drain task; sinks do their background work here
+    for (size_t i = 0; i < sinkCount; i++) {
+        sinks[i]->loop();
+    }
+
+    // Segment compression advances one frame per pass
+    if (fileSink.isCompressing()) {
+        managerEvents.wakeWithin(MANAGERS_BUSY_INTERVAL_MS);
+    }
+
+    // Summaries for call sites that are still flooding or have gone quiet
+    LogSuppressionReport report;
+    while (initialized && rateLimiter.collectDue(millis(), report)) {
+        logSuppressionReport(report);
+    }
 }
 
 void LoggingManager::stop() {
     if (!initialized) {
         return;
     }
-    
+
+    // Records already queued are still drained
     initialized = false;
+    for (size_t i = 0; i < sinkCount; i++) {
+        sinks[i]->stop();
+    }
     Serial.printf("[LoggingManager] Logging system stopped\n");
 }
 
-void LoggingManager::logError(const char* tag, const char* format, ...) {
+bool LoggingManager::addSink(LogSink* sink) {
+    if (initialized || sinkCount >= MAX_SINKS) {
+        return false;
+    }
+    sinks[sinkCount++] = sink;
+    return true;
+}
+
+bool LoggingManager::admit(LogLevel level, const char* tag, const char* format, uint32_t argHash) {
+    LogSuppressionReport report;
+    bool admitted = rateLimiter.admit(level, tag, format, argHash, millis(), report);
+    if (report.isPending()) {
+        logSuppressionReport(report);
+    }
+    return admitted;
+}
+
+void LoggingManager::logSuppressionReport(const LogSuppressionReport& report) {
+    LogLevel level = (LogLevel)report.level;
+    if (report.repeated > 0) {
+        enqueue(level, report.tag, "Last message repeated %u times: %s", (unsigned)report.repeated, report.format);
+    }
+    if (report.suppressed > 0) {
+        enqueue(level, report.tag, "Rate limit suppressed %u messages: %s", (unsigned)report.suppressed, report.format);
+    }
+}
+
+uint8_t* LoggingManager::acquireRecord(size_t size) {
+    void* record = nullptr;
+    if (!ringBuffer || xRingbufferSendAcquire(ringBuffer, &record, size, 0) != pdTRUE) {
+        droppedRecords++;
+        return nullptr;
+    }
+    return static_cast<uint8_t*>(record);
+}
+
+void LoggingManager::commitRecord(uint8_t* record) {
+    xRingbufferSendComplete(ringBuffer, record);
+}
+
+void LoggingManager::logFormatted(LogLevel level, const char* tag, const char* format, va_list args) {
     if (!initialized) return;
-    
+
+    char buffer[FORMATTED_MESSAGE_LENGTH + 1];
+    vsnprintf(buffer, sizeof(buffer), format, args);
+    uint8_t length = LogArgs::boundedLength(buffer, FORMATTED_MESSAGE_LENGTH);
+    if (!admit(level, tag, format, LogArgs::hashBytes(LogArgs::HASH_SEED, buffer, length))) return;
+
+    uint8_t* record = acquireRecord(sizeof(LogRecordHeader) + 2 + length);
+    if (!record) return;
+
+    LogRecordHeader* header = reinterpret_cast<LogRecordHeader*>(record);
+    header->timestamp = millis();
+    header->tag = tag;
+    header->format = "%s";
+    header->level = level;
+    header->argCount = 1;
+    header->argBytes = 2 + length;
+
+    uint8_t* cursor = record + sizeof(LogRecordHeader);
+    LogArgs::packString(cursor, buffer, length);
+
+    commitRecord(record);
+}
+
+void LoggingManager::logError(const char* tag, const char* format, ...) {
     va_list args;
     va_start(args, format);
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    logFormatted(LOG_LEVEL_ERROR, tag, format, args);
     va_end(args);
-    
-    Serial.printf("[%lu][ERROR][%s] %s\n", millis(), tag, buffer);
 }
 
 void LoggingManager::logWarn(const char* tag, const char* format, ...) {
-    if (!initialized) return;
-    
     va_list args;
     va_start(args, format);
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    logFormatted(LOG_LEVEL_WARN, tag, format, args);
     va_end(args);
-    
-    Serial.printf("[%lu][WARN][%s] %s\n", millis(), tag, buffer);
 }
 
 void LoggingManager::logInfo(const char* tag, const char* format, ...) {
-    if (!initialized) return;
-    
     va_list args;
     va_start(args, format);
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    logFormatted(LOG_LEVEL_INFO, tag, format, args);
     va_end(args);
-    
-    Serial.printf("[%lu][INFO][%s] %s\n", millis(), tag, buffer);
 }
 
 void LoggingManager::logDebug(const char* tag, const char* format, ...) {
-    if (!initialized) return;
-    
     va_list args;
     va_start(args, format);
-    char buffer[256];
-    vsnprintf(buffer, sizeof(buffer), format, args);
+    logFormatted(LOG_LEVEL_DEBUG, tag, format, args);
     va_end(args);
-    
-    Serial.printf("[%lu][DEBUG][%s] %s\n", millis(), tag, buffer);
+}
+
+void LoggingManager::drainTask(void* pvParameters) {
+    LoggingManager* self = static_cast<LoggingManager*>(pvParameters);
+
+    for (;;) {
+        size_t itemSize = 0;
+        uint8_t* item = static_cast<uint8_t*>(xRingbufferReceive(self->ringBuffer, &itemSize,
+                                                                  pdMS_TO_TICKS(LOG_DRAIN_IDLE_MS)));
+        if (!item) {
+            self->idleSinks();
+            continue;
+        }
+
+        const LogRecordHeader* header = reinterpret_cast<const LogRecordHeader*>(item);
+        self->drainRecord(*header, item + sizeof(LogRecordHeader));
+        vRingbufferReturnItem(self->ringBuffer, item);
+
+        self->reportDroppedRecords();
+        self->idleSinks();
+    }
+}
+
+void LoggingManager::drainRecord(const LogRecordHeader& header, const uint8_t* args) {
+    for (size_t i = 0; i < sinkCount; i++) {
+        if (sinks[i]->isEnabled()) {
+            sinks[i]->write(header, args);
+        }
+    }
+}
+
+void LoggingManager::idleSinks() {
+    for (size_t i = 0; i < sinkCount; i++) {
+        sinks[i]->idle();
+    }
+}
+
+void LoggingManager::reportDroppedRecords() {
+    uint32_t dropped = droppedRecords;
+    if (dropped != reportedDroppedRecords) {
+        Serial.printf("[%lu][WARN][LoggingManager] %lu log records dropped (ring buffer full)\n",
+                      millis(), (unsigned long)(dropped - reportedDroppedRecords));
+        reportedDroppedRecords = dropped;
+    }
 }
 
 void LoggingManager::onMQTTConnected() {
+    mqttSink.setLinkUp(true);
     if (initialized) {
         mqttConnected = true;
-        Serial.printf("[%lu][INFO][LoggingManager] MQTT connectivity established - enhanced logging features available\n", millis());
+        LOG_INFO("LoggingManager", "MQTT connectivity established - enhanced logging features available");
     }
 }
 
 void LoggingManager::onMQTTDisconnected() {
+    mqttSink.setLinkUp(false);
     if (initialized) {
         mqttConnected = false;
-        Serial.printf("[%lu][WARN][LoggingManager] MQTT connectivity lost - falling back to serial-only logging\n", millis());
+        LOG_WARN("LoggingManager", "MQTT connectivity lost - only warnings and errors are queued for MQTT");
     }
 }
 
 void LoggingManager::updateSettings(bool logToFileEnabled, bool logToMQTTEnabled) {
     this->logToFileEnabled = logToFileEnabled;
     this->logToMQTTEnabled = logToMQTTEnabled;
-    
+    fileSink.setEnabled(logToFileEnabled);
+    mqttSink.setEnabled(logToMQTTEnabled);
+
     if (initialized) {
-        Serial.printf("[%lu][INFO][LoggingManager] Settings updated - File logging: %s, MQTT logging: %s\n", 
-                     millis(), 
-                     logToFileEnabled ? "enabled" : "disabled",
-                     logToMQTTEnabled ? "enabled" : "disabled");
+        LOG_INFO("LoggingManager", "Settings updated - File logging: %s, MQTT logging: %s",
+                 logToFileEnabled ? "enabled" : "disabled",
+                 logToMQTTEnabled ? "enabled" : "disabled");
     }
 }
 
 void LoggingManager::debugPrintf(const char* format, ...) {
     if (!initialized) return;
-    
+
     va_list args;
     va_start(args, format);
     char buffer[256];
     vsnprintf(buffer, sizeof(buffer), format, args);
     va_end(args);
-    
+
     Serial.printf("[%lu][DEBUG] %s", millis(), buffer);
 }
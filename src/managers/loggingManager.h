@@ -3,54 +3,158 @@
 #define __LOGGINGMANAGER_H__
 
 #include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/ringbuf.h>
+
+#include "definitions.h"
+#include "logging/logRecord.h"
+#include "logging/logSink.h"
+#include "logging/logSerialSink.h"
+#include "logging/logFileSink.h"
+#include "logging/logMQTTSink.h"
+#include "logging/logTransfer.h"
+#include "logging/logCrashSink.h"
+#include "logging/postMortem.h"
+#include "logging/logRateLimiter.h"
 
 // Forward declaration
 class NovaLogicService;
 
-// Simple logging manager for ESP32
+// Logging manager for ESP32
+// Log calls only capture a binary record (tag/format pointers, timestamp and raw
+// arguments) into a ring buffer; encoding and output happen on the drain task,
+// which hands each record to every enabled LogSink. The encoding (text, binary
+// or JSON) is chosen per sink. Every call site passes LogRateLimiter first, so a
+// flooding site is collapsed into "repeated N times" / "suppressed" summaries.
 class LoggingManager {
 public:
     LoggingManager();
     ~LoggingManager();
-    
+
     // Basic lifecycle
     bool begin();
     void loop();
     void stop();
-    
-    // Simple logging functions
+
+    // Deferred logging - cheap enough for hot paths, used by the LOG_* macros
+    template <typename... Args>
+    void log(LogLevel level, const char* tag, const char* format, Args... args);
+
+    // printf-style logging (formats on the caller, then queues the text)
     void logError(const char* tag, const char* format, ...);
     void logWarn(const char* tag, const char* format, ...);
     void logInfo(const char* tag, const char* format, ...);
     void logDebug(const char* tag, const char* format, ...);
-    
+
     // MQTT connection events
     void onMQTTConnected();
     void onMQTTDisconnected();
-    
+
     // State queries
     bool isMQTTConnected() const { return mqttConnected; }
-    
+    uint32_t getDroppedRecords() const { return droppedRecords; }
+    const LogRateLimiter& getRateLimiter() const { return rateLimiter; }
+
+    // Output sinks (registered before begin())
+    bool addSink(LogSink* sink);
+    LogSerialSink& getSerialSink() { return serialSink; }
+    LogFileSink& getFileSink() { return fileSink; }
+    LogMQTTSink& getMQTTSink() { return mqttSink; }
+    LogTransfer& getLogTransfer() { return logTransfer; }
+    PostMortem& getPostMortem() { return postMortem; }
+
     // Settings management
     void updateSettings(bool logToFileEnabled, bool logToMQTTEnabled);
-    
+
     // Backward compatibility
     void debugPrintf(const char* format, ...);
-    
+
 private:
+    // Queue a record, bypassing flood protection
+    template <typename... Args>
+    void enqueue(LogLevel level, const char* tag, const char* format, Args... args);
+    bool admit(LogLevel level, const char* tag, const char* format, uint32_t argHash);
+    void logSuppressionReport(const LogSuppressionReport& report);
+
+    // Ring buffer access
+    uint8_t* acquireRecord(size_t size);
+    void commitRecord(uint8_t* record);
+    void logFormatted(LogLevel level, const char* tag, const char* format, va_list args);
+
+    // Drain task
+    static void drainTask(void* pvParameters);
+    void drainRecord(const LogRecordHeader& header, const uint8_t* args);
+    void reportDroppedRecords();
+    void idleSinks();
+
     bool initialized = false;
     bool mqttConnected = false;  // Track MQTT connectivity state
     bool logToFileEnabled = true;   // Settings for file logging
     bool logToMQTTEnabled = true;   // Settings for MQTT logging
     NovaLogicService* mqttService = nullptr;
+
+    // Deferred record storage
+    RingbufHandle_t ringBuffer = nullptr;
+    StaticRingbuffer_t ringBufferStruct;
+    uint8_t ringBufferStorage[LOG_RING_BUFFER_SIZE];
+    TaskHandle_t drainTaskHandle = nullptr;
+
+    // Output sinks
+    static const size_t MAX_SINKS = 4;
+    LogSink* sinks[MAX_SINKS] = {};
+    size_t sinkCount = 0;
+    LogSerialSink serialSink;
+    LogFileSink fileSink;
+    LogMQTTSink mqttSink;
+    LogCrashSink crashSink;
+    LogTransfer logTransfer{fileSink};
+    PostMortem postMortem;
+    LogRateLimiter rateLimiter;
+
+    volatile uint32_t droppedRecords = 0;
+    uint32_t reportedDroppedRecords = 0;
 };
 
+template <typename... Args>
+void LoggingManager::log(LogLevel level, const char* tag, const char* format, Args... args)
+{
+    if (!initialized) return;
+
+    uint32_t argHash = LogArgs::HASH_SEED;
+    ((argHash = LogArgs::hash(argHash, args)), ...);
+    if (!admit(level, tag, format, argHash)) return;
+
+    enqueue(level, tag, format, args...);
+}
+
+template <typename... Args>
+void LoggingManager::enqueue(LogLevel level, const char* tag, const char* format, Args... args)
+{
+    size_t argBytes = (size_t(0) + ... + LogArgs::packedSize(args));
+    uint8_t* record = acquireRecord(sizeof(LogRecordHeader) + argBytes);
+    if (!record) return;
+
+    LogRecordHeader* header = reinterpret_cast<LogRecordHeader*>(record);
+    header->timestamp = millis();
+    header->tag = tag;
+    header->format = format;
+    header->level = level;
+    header->argCount = sizeof...(Args);
+    header->argBytes = (uint16_t)argBytes;
+
+    uint8_t* cursor = record + sizeof(LogRecordHeader);
+    (LogArgs::pack(cursor, args), ...);
+    (void)cursor;   // Unused for argument-less calls
+
+    commitRecord(record);
+}
+
 // Enhanced logging macros
-#define LOG_ERROR(tag, format, ...)   do { if(globalLoggingManager) globalLoggingManager->logError(tag, format, ##__VA_ARGS__); } while(0)
-#define LOG_WARN(tag, format, ...)    do { if(globalLoggingManager) globalLoggingManager->logWarn(tag, format, ##__VA_ARGS__); } while(0)
-#define LOG_INFO(tag, format, ...)    do { if(globalLoggingManager) globalLoggingManager->logInfo(tag, format, ##__VA_ARGS__); } while(0)
-#define LOG_DEBUG(tag, format, ...)   do { if(globalLoggingManager) globalLoggingManager->logDebug(tag, format, ##__VA_ARGS__); } while(0)
-#define LOG_VERBOSE(tag, format, ...) do { if(globalLoggingManager) globalLoggingManager->logDebug(tag, format, ##__VA_ARGS__); } while(0)
+#define LOG_ERROR(tag, format, ...)   do { if(globalLoggingManager) globalLoggingManager->log(LOG_LEVEL_ERROR, tag, format, ##__VA_ARGS__); } while(0)
+#define LOG_WARN(tag, format, ...)    do { if(globalLoggingManager) globalLoggingManager->log(LOG_LEVEL_WARN, tag, format, ##__VA_ARGS__); } while(0)
+#define LOG_INFO(tag, format, ...)    do { if(globalLoggingManager) globalLoggingManager->log(LOG_LEVEL_INFO, tag, format, ##__VA_ARGS__); } while(0)
+#define LOG_DEBUG(tag, format, ...)   do { if(globalLoggingManager) globalLoggingManager->log(LOG_LEVEL_DEBUG, tag, format, ##__VA_ARGS__); } while(0)
+#define LOG_VERBOSE(tag, format, ...) do { if(globalLoggingManager) globalLoggingManager->log(LOG_LEVEL_DEBUG, tag, format, ##__VA_ARGS__); } while(0)
 
 // Backward compatibility macros that redirect to enhanced logging
 #define DEBUG_LOG_PRINTF(tag, format, ...) LOG_DEBUG(tag, format, ##__VA_ARGS__)
@@ -0,0 +1,320 @@
+#include "managerEvents.h"
+#include "loggingManager.h"
+
+#include <esp_timer.h>
+#include <esp_vfs_eventfd.h>
+#include <lwip/sockets.h>
+#include <unistd.h>
+
+static const char* TAG = "ManagerEvents";
+
+// Bits set through signal(); SOCKET and TIMER are only reported by wait()
+static const uint32_t SIGNAL_EVENTS = MANAGER_EVENT_NETWORK | MANAGER_EVENT_MODBUS | MANAGER_EVENT_LOG |
+                                      MANAGER_EVENT_COMMAND | MANAGER_EVENT_SERVICE;
+
+ManagerEvents managerEvents;
+
+ManagerEvents::ManagerEvents()
+    : group(nullptr), groupBuffer(), eventFd(-1), watchedPorts(), wakeupDeadline(0), lastPassTime(0),
+      firstSignalTime(0), queued(), passes(0), eventWakeups(0), socketWakeups(0), timerWakeups(0), maxLatencyUs(0),
+      latencyTotalUs(0), latencyCount(0)
+{
+    FD_ZERO(&woken);
+    FD_ZERO(&parked);
+}
+
+bool ManagerEvents::begin()
+{
+    if (!group)
+    {
+        group = xEventGroupCreateStatic(&groupBuffer);
+    }
+
+    if (eventFd < 0)
+    {
+        // Registration fails harmlessly if another component already did it
+        esp_vfs_eventfd_config_t config = ESP_VFS_EVENTD_CONFIG_DEFAULT();
+        esp_vfs_eventfd_register(&config);
+        eventFd = eventfd(0, 0);
+        if (eventFd < 0)
+        {
+            LOG_WARN(TAG, "eventfd unavailable - polling every %d ms", MANAGERS_FALLBACK_POLL_MS);
+        }
+    }
+
+    wakeupDeadline = millis();
+    return group != nullptr;
+}
+
+void ManagerEvents::signal(uint32_t events)
+{
+    if (!group)
+        return;
+
+    if (firstSignalTime == 0)
+    {
+        firstSignalTime = esp_timer_get_time();
+    }
+
+    xEventGroupSetBits(group, events & SIGNAL_EVENTS);
+    if (eventFd >= 0)
+    {
+        uint64_t one = 1;
+        write(eventFd, &one, sizeof(one));
+    }
+}
+
+void ManagerEvents::wakeWithin(unsigned long ms)
+{
+    unsigned long deadline = millis() + ms;
+    if ((long)(deadline - wakeupDeadline) < 0)
+    {
+        wakeupDeadline = deadline;
+    }
+}
+
+bool ManagerEvents::watchPort(uint16_t localPort)
+{
+    uint16_t *slot = nullptr;
+    for (uint16_t &port : watchedPorts)
+    {
+        if (port == localPort)
+            return true;
+        if (port == 0 && !slot)
+            slot = &port;
+    }
+
+    if (!slot || localPort == 0)
+    {
+        LOG_WARN(TAG, "Port %u not watched - its sockets only run on deadlines", (unsigned)localPort);
+        return false;
+    }
+    *slot = localPort;
+    return true;
+}
+
+void ManagerEvents::unwatchPort(uint16_t localPort)
+{
+    for (uint16_t &port : watchedPorts)
+    {
+        if (port == localPort)
+            port = 0;
+    }
+}
+
+uint32_t ManagerEvents::wait()
+{
+    updateParkedSockets();
+
+    // Under a sustained stream of events the passes stay MANAGERS_MIN_PASS_INTERVAL_MS apart
+    unsigned long sinceLastPass = millis() - lastPassTime;
+    if (sinceLastPass < MANAGERS_MIN_PASS_INTERVAL_MS)
+    {
+        vTaskDelay(pdMS_TO_TICKS(MANAGERS_MIN_PASS_INTERVAL_MS - sinceLastPass));
+    }
+
+    uint32_t events = 0;
+    while (events == 0)
+    {
+        if (group)
+        {
+            events = xEventGroupClearBits(group, SIGNAL_EVENTS) & SIGNAL_EVENTS;
+            if (events)
+                break;
+        }
+
+        long remaining = (long)(wakeupDeadline - millis());
+        if (remaining <= 0)
+        {
+            events = MANAGER_EVENT_TIMER;
+            break;
+        }
+
+        events = waitForActivity((unsigned long)remaining);
+    }
+
+    // Statistics
+    unsigned long now = millis();
+    passes++;
+    if (events & SIGNAL_EVENTS)
+    {
+        eventWakeups++;
+        int64_t signalled = firstSignalTime;
+        firstSignalTime = 0;
+        if (signalled != 0)
+        {
+            uint32_t latency = (uint32_t)(esp_timer_get_time() - signalled);
+            latencyTotalUs += latency;
+            latencyCount++;
+            if (latency > maxLatencyUs)
+                maxLatencyUs = latency;
+        }
+    }
+    else if (events & MANAGER_EVENT_SOCKET)
+    {
+        socketWakeups++;
+    }
+    else
+    {
+        timerWakeups++;
+    }
+
+    lastPassTime = now;
+    wakeupDeadline = now + MANAGERS_IDLE_WAKEUP_MS;
+    return events;
+}
+
+uint32_t ManagerEvents::waitForActivity(unsigned long timeoutMs)
+{
+    if (eventFd < 0)
+    {
+        // Signals still wake the task; sockets are polled
+        TickType_t ticks = pdMS_TO_TICKS(min(timeoutMs, (unsigned long)MANAGERS_FALLBACK_POLL_MS));
+        EventBits_t bits = group ? xEventGroupWaitBits(group, SIGNAL_EVENTS, pdTRUE, pdFALSE, ticks) : 0;
+        if (!group)
+            vTaskDelay(ticks);
+        return bits ? (bits & SIGNAL_EVENTS) : MANAGER_EVENT_TIMER;
+    }
+
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(eventFd, &readable);
+    int maxFd = eventFd;
+    for (int i = 0; i < CONFIG_LWIP_MAX_SOCKETS; i++)
+    {
+        int fd = LWIP_SOCKET_OFFSET + i;
+        if (!FD_ISSET(fd, &parked) && isWatched(fd))
+        {
+            FD_SET(fd, &readable);
+            maxFd = max(maxFd, fd);
+        }
+    }
+
+    struct timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    int count = select(maxFd + 1, &readable, nullptr, nullptr, &timeout);
+    if (count < 0)
+    {
+        // A watched socket closed between the scan and select()
+        vTaskDelay(pdMS_TO_TICKS(MANAGERS_MIN_PASS_INTERVAL_MS));
+        return 0;
+    }
+
+    if (FD_ISSET(eventFd, &readable))
+    {
+        // The signalled bits are collected by wait()
+        uint64_t value;
+        read(eventFd, &value, sizeof(value));
+    }
+
+    uint32_t events = 0;
+    for (int i = 0; i < CONFIG_LWIP_MAX_SOCKETS; i++)
+    {
+        int fd = LWIP_SOCKET_OFFSET + i;
+        if (fd != eventFd && FD_ISSET(fd, &readable))
+        {
+            FD_SET(fd, &woken);
+            queued[i] = queuedBytes(fd);
+            events |= MANAGER_EVENT_SOCKET;
+        }
+    }
+    return events;
+}
+
+void ManagerEvents::updateParkedSockets()
+{
+    for (int i = 0; i < CONFIG_LWIP_MAX_SOCKETS; i++)
+    {
+        int fd = LWIP_SOCKET_OFFSET + i;
+        if (FD_ISSET(fd, &parked))
+        {
+            // Released once the socket is closed or its receive queue changes
+            if (!isSocketOpen(fd) || queuedBytes(fd) != queued[i])
+                FD_CLR(fd, &parked);
+        }
+        else if (FD_ISSET(fd, &woken))
+        {
+            // Woke the last pass and nothing was read from it
+            if (isSocketOpen(fd) && queuedBytes(fd) == queued[i] && isSocketReadable(fd))
+                FD_SET(fd, &parked);
+        }
+    }
+    FD_ZERO(&woken);
+}
+
+uint32_t ManagerEvents::getParkedSockets() const
+{
+    uint32_t count = 0;
+    for (int i = 0; i < CONFIG_LWIP_MAX_SOCKETS; i++)
+    {
+        if (FD_ISSET(LWIP_SOCKET_OFFSET + i, &parked))
+            count++;
+    }
+    return count;
+}
+
+// Open and bound to a watched local port; false for closed sockets
+bool ManagerEvents::isWatched(int fd) const
+{
+    struct sockaddr_storage address;
+    socklen_t length = sizeof(address);
+    if (lwip_getsockname(fd, (struct sockaddr *)&address, &length) != 0)
+        return false;
+
+    uint16_t port = 0;
+    if (address.ss_family == AF_INET)
+        port = ntohs(((struct sockaddr_in *)&address)->sin_port);
+#if LWIP_IPV6
+    else if (address.ss_family == AF_INET6)
+        port = ntohs(((struct sockaddr_in6 *)&address)->sin6_port);
+#endif
+
+    for (uint16_t watched : watchedPorts)
+    {
+        if (watched != 0 && watched == port)
+            return true;
+    }
+    return false;
+}
+
+bool ManagerEvents::isSocketOpen(int fd)
+{
+    int type = 0;
+    socklen_t length = sizeof(type);
+    return lwip_getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &length) == 0;
+}
+
+bool ManagerEvents::isSocketReadable(int fd)
+{
+    fd_set readable;
+    FD_ZERO(&readable);
+    FD_SET(fd, &readable);
+    struct timeval immediate = {0, 0};
+    return select(fd + 1, &readable, nullptr, nullptr, &immediate) > 0;
+}
+
+int ManagerEvents::queuedBytes(int fd)
+{
+    int count = 0;
+    return lwip_ioctl(fd, FIONREAD, &count) == 0 ? count : -1;
+}
+
+void ManagerEvents::printStatus()
+{
+    unsigned long uptime = max(1UL, millis() / 1000);
+    LOG_INFO(TAG, "=== Managers Task ===");
+    LOG_INFO(TAG, "Mode: %s", eventFd >= 0 ? "event driven" : "polling (no eventfd)");
+    LOG_INFO(TAG, "Passes: %lu (%lu.%02lu per second)", (unsigned long)passes, (unsigned long)(passes / uptime),
+             (unsigned long)(passes * 100 / uptime % 100));
+    LOG_INFO(TAG, "Woken by events: %lu, sockets: %lu, deadlines: %lu", (unsigned long)eventWakeups,
+             (unsigned long)socketWakeups, (unsigned long)timerWakeups);
+    LOG_INFO(TAG, "Event latency: avg %lu us, max %lu us", (unsigned long)getAverageLatencyUs(),
+             (unsigned long)maxLatencyUs);
+    LOG_INFO(TAG, "Parked sockets: %lu", (unsigned long)getParkedSockets());
+    for (uint16_t port : watchedPorts)
+    {
+        if (port != 0)
+            LOG_INFO(TAG, "Watched port: %u", (unsigned)port);
+    }
+}
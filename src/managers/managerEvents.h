@@ -0,0 +1,112 @@
+#pragma once
+#ifndef __MANAGEREVENTS_H__
+#define __MANAGEREVENTS_H__
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/event_groups.h>
+#include <sys/select.h>
+
+#include "definitions.h"
+
+/*
+ * Event-driven wakeups for TaskManagersUpdate
+ *
+ * The managers task sleeps until there is work instead of running every 50 ms.
+ * A sleep ends on the first of:
+ *  - signal() from another task (Ethernet events, eModbus responses, sealed log
+ *    batches, service tasks, menu commands). Bits go to an event group, and an eventfd wakes
+ *    the select() below.
+ *  - data on a socket the managers read in loop(), registered by local port with
+ *    watchPort(): the local broker's port covers its listening socket and the
+ *    connections it accepts, the NovaLogic client's ephemeral port its one
+ *    connection. An incoming MQTT message wakes the task directly; sockets of
+ *    other tasks (HTTP server, OTA connect task, TagoIO) are never selected.
+ *  - the earliest deadline requested with wakeWithin() during the last pass.
+ *    Timers that do not report one still run every MANAGERS_IDLE_WAKEUP_MS.
+ *
+ * A watched socket that is still readable after a pass that consumed nothing
+ * (peer closed, not read yet) is parked until its receive queue changes.
+ * Passes are at least MANAGERS_MIN_PASS_INTERVAL_MS apart, which bounds the CPU
+ * use under a sustained stream. Without eventfd support the wait falls back to
+ * polling every MANAGERS_FALLBACK_POLL_MS.
+ */
+
+enum ManagerEvent : uint32_t
+{
+    MANAGER_EVENT_NETWORK = BIT0,           // Ethernet link or IP change
+    MANAGER_EVENT_MODBUS = BIT1,            // eModbus response or error
+    MANAGER_EVENT_LOG = BIT2,               // Log batch ready for MQTT
+    MANAGER_EVENT_COMMAND = BIT3,           // Request from the serial menu or keypad
+    MANAGER_EVENT_SERVICE = BIT4,           // Status change of a service running on its own task
+    MANAGER_EVENT_SOCKET = BIT5,            // Socket data (reported by wait() only)
+    MANAGER_EVENT_TIMER = BIT6              // Deadline reached (reported by wait() only)
+};
+
+class ManagerEvents
+{
+public:
+    ManagerEvents();
+
+    bool begin();
+
+    // Any task except ISRs
+    void signal(uint32_t events);
+
+    // Managers task, during a pass: run the next pass within ms
+    void wakeWithin(unsigned long ms);
+
+    // Managers task: sockets bound to localPort wake the task when readable
+    bool watchPort(uint16_t localPort);
+    void unwatchPort(uint16_t localPort);
+
+    // Managers task: sleep until the next pass is due; returns the ManagerEvent bits that ended it
+    uint32_t wait();
+
+    // Diagnostics
+    uint32_t getPasses() const { return passes; }
+    uint32_t getEventWakeups() const { return eventWakeups; }
+    uint32_t getSocketWakeups() const { return socketWakeups; }
+    uint32_t getTimerWakeups() const { return timerWakeups; }
+    uint32_t getParkedSockets() const;
+    uint32_t getMaxLatencyUs() const { return maxLatencyUs; }
+    uint32_t getAverageLatencyUs() const { return latencyCount ? (uint32_t)(latencyTotalUs / latencyCount) : 0; }
+    void printStatus();
+
+private:
+    uint32_t waitForActivity(unsigned long timeoutMs);
+    void updateParkedSockets();
+
+    bool isWatched(int fd) const;
+
+    static bool isSocketOpen(int fd);
+    static bool isSocketReadable(int fd);
+    static int queuedBytes(int fd);
+
+    EventGroupHandle_t group;
+    StaticEventGroup_t groupBuffer;
+    int eventFd;
+
+    uint16_t watchedPorts[MANAGERS_MAX_WATCHED_PORTS];  // 0 = free slot
+
+    unsigned long wakeupDeadline;
+    unsigned long lastPassTime;
+    volatile int64_t firstSignalTime;       // Oldest signal not yet handled by a pass
+
+    // Socket state, indexed by fd - LWIP_SOCKET_OFFSET
+    fd_set woken;                           // Readable when the last pass started
+    fd_set parked;                          // Excluded from select() until their queue changes
+    int queued[CONFIG_LWIP_MAX_SOCKETS];
+
+    uint32_t passes;
+    uint32_t eventWakeups;
+    uint32_t socketWakeups;
+    uint32_t timerWakeups;
+    uint32_t maxLatencyUs;
+    uint64_t latencyTotalUs;
+    uint32_t latencyCount;
+};
+
+extern ManagerEvents managerEvents;
+
+#endif // __MANAGEREVENTS_H__
@@ -1,5 +1,6 @@
 #include "managers/modbusMonitorManager.h"
 #include "managers/loggingManager.h"
+#include "telemetry/telemetryHub.h"
 
 static const char *TAG = "ModbusMonitorManager";
 
@@ -7,7 +8,14 @@ ModbusMonitorManager::ModbusMonitorManager(StatusViewModel &statusVM)
     : statusViewModel(statusVM),
       modbusService(),
       lastReportedStatus(MODBUS_INACTIVE),
-      statusChangeCallback(nullptr)
+      statusChangeCallback(nullptr),
+      otaWasActive(false),
+      lastValidFrames(0),
+      lastValidFrameTime(0),
+      otaLongestGap(0),
+      otaFrames(0),
+      telemetryUpdateTime(0),
+      telemetryPageMask(0)
 {
     LOG_INFO(TAG, "ModbusMonitorManager initialized");
 }
@@ -52,6 +60,58 @@ void ModbusMonitorManager::loop()
         
         LOG_DEBUG(TAG, "Status changed to: %d", currentStatus);
     }
+
+    updateTelemetry();
+    trackOTADataGap();
+}
+
+void ModbusMonitorManager::updateTelemetry()
+{
+    // Decoded once per stored page (or validity change) for the local broker and the cloud uplink
+    DSEData data;
+    if (!modbusService.getDSEData(data))
+    {
+        return;
+    }
+
+    uint8_t pageMask = dsePageMask(data);
+    if (data.lastUpdateTime == telemetryUpdateTime && pageMask == telemetryPageMask)
+    {
+        return;
+    }
+    telemetryUpdateTime = data.lastUpdateTime;
+    telemetryPageMask = pageMask;
+    telemetryHub.update(data);
+}
+
+void ModbusMonitorManager::trackOTADataGap()
+{
+    unsigned long now = millis();
+    bool otaActive = statusViewModel.isOTAActive();
+    if (otaActive && !otaWasActive)
+    {
+        otaLongestGap = 0;
+        otaFrames = 0;
+    }
+
+    unsigned long validFrames = modbusService.getValidFrames();
+    if (validFrames != lastValidFrames)
+    {
+        if (otaActive)
+        {
+            otaFrames += validFrames - lastValidFrames;
+            if (lastValidFrameTime != 0 && now - lastValidFrameTime > otaLongestGap)
+                otaLongestGap = now - lastValidFrameTime;
+        }
+        lastValidFrames = validFrames;
+        lastValidFrameTime = now;
+    }
+
+    if (!otaActive && otaWasActive)
+    {
+        LOG_INFO(TAG, "Genset data during OTA: %lu valid frames, longest gap %lu ms", otaFrames, otaLongestGap);
+    }
+    otaWasActive = otaActive;
 }
 
 void ModbusMonitorManager::stop()
@@ -91,6 +151,14 @@ void ModbusMonitorManager::setOutputFlags(bool serial, bool file, bool mqtt)
              serial ? "ON" : "OFF", file ? "ON" : "OFF", mqtt ? "ON" : "OFF");
 }
 
+bool ModbusMonitorManager::setConfiguration(const ModbusConfig& config)
+{
+    bool restarted = modbusService.setModbusConfig(config);
+    LOG_INFO(TAG, "Configuration set - Baud: %lu, Slave ID: 0x%02X%s", config.baudRate, config.slaveId,
+             restarted ? " (client restarted)" : "");
+    return restarted;
+}
+
 ModbusConfig ModbusMonitorManager::getConfiguration() const
 {
     return modbusService.getModbusConfig();
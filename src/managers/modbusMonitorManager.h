@@ -28,6 +28,7 @@ public:
     void setBaudRate(uint32_t baudRate);
     void setSlaveId(uint8_t slaveId);
     void setOutputFlags(bool serial, bool file, bool mqtt);
+    bool setConfiguration(const ModbusConfig& config);     // true if the client was restarted
     ModbusConfig getConfiguration() const;
     
     // Statistics access
@@ -35,6 +36,9 @@ public:
     unsigned long getValidFrames() const;
     unsigned long getInvalidFrames() const;
     unsigned long getLastActivityTime() const;
+
+    // Longest interval between valid frames during the last (or current) OTA update
+    unsigned long getOTADataGap() const { return otaLongestGap; }
     
     // DSE Data access
     bool getDSEData(DSEData& data) const;
@@ -54,7 +58,20 @@ private:
     ModbusMonitorStatus lastReportedStatus;
     std::function<void(ModbusMonitorStatus)> statusChangeCallback;
     
+    // Genset data continuity during OTA updates
+    bool otaWasActive;
+    unsigned long lastValidFrames;
+    unsigned long lastValidFrameTime;
+    unsigned long otaLongestGap;
+    unsigned long otaFrames;
+
+    // DSE data last passed to the telemetry hub
+    unsigned long telemetryUpdateTime;
+    uint8_t telemetryPageMask;
+
     void updateStatusViewModel();
+    void trackOTADataGap();
+    void updateTelemetry();
 };
 
 #endif // __MODBUS_MONITOR_MANAGER_H__
\ No newline at end of file
@@ -1,5 +1,6 @@
 #include "loggingManager.h"
 #include "networkingManager.h"
+#include "managerEvents.h"
 #include "esp_eth_driver.h"
 
 // Logging tag
@@ -19,7 +20,11 @@ EthernetUDP udpClient;
 BlockNot tmrKeepAlive = BlockNot(KEEP_ALIVE_INTERVAL);
 
 NetworkingManager::NetworkingManager(StatusViewModel &statusVM)
-    : statusViewModel(statusVM), currentState(NETWORK_STOPPED), connectStartTime(0), lastStateChange(0), retryCount(0), callback(nullptr)
+    : statusViewModel(statusVM), currentState(NETWORK_STOPPED), connectStartTime(0), lastStateChange(0), retryCount(0),
+      stateMetric(METRICS_PREFIX "network_state", "0 stopped, 1 started, 2 disconnected, 3 lost IP, 4 connected, 5 connected with IP"),
+      ipTimeouts(METRICS_PREFIX "network_ip_timeouts", "Ethernet links that got no IP address in time"),
+      restarts(METRICS_PREFIX "network_restarts", "Ethernet driver restarts"),
+      callback(nullptr)
 {
     instance = this;
 }
@@ -52,6 +57,7 @@ void NetworkingManager::initEthernet()
 void NetworkingManager::restartEthernet()
 {
     LOG_INFO(TAG, "Restarting Ethernet...");
+    restarts.increment();
 
     // Clean shutdown
     Ethernet1.end();
@@ -87,6 +93,7 @@ void NetworkingManager::loop()
             LOG_WARN(TAG, "Timeout triggered in state %d after %lu ms", currentState, now - connectStartTime);
             
             retryCount++;
+            ipTimeouts.increment();
             if (retryCount >= MAX_RETRY_COUNT)
             {
                 LOG_WARN(TAG, "IP timeout after %d retries, full restart...", retryCount);
@@ -177,6 +184,7 @@ void NetworkingManager::setState(NetworkStatus newState)
         
         NetworkStatus oldState = currentState;
         currentState = newState;
+        stateMetric.set(newState);
         lastStateChange = millis();
 
         // Update the status view model
@@ -259,8 +267,11 @@ void NetworkingManager::onNetworkEvent(arduino_event_id_t event, arduino_event_i
         break;
 
     default:
-        break;
+        return;
     }
+
+    // Connectivity and services react on the next pass instead of the next poll
+    managerEvents.signal(MANAGER_EVENT_NETWORK);
 }
 
 void NetworkingManager::keepAliveRouterUDP()
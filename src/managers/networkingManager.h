@@ -9,6 +9,7 @@
 
 #include "definitions.h"
 #include "statusViewModel.h"
+#include "metrics/metricsRegistry.h"
 
 // // Forward declarations
 // extern W5500Driver ethernetDriver1;
@@ -52,6 +53,9 @@ private:
     unsigned long connectStartTime;
     unsigned long lastStateChange;
     int retryCount;                    // Current retry attempt counter
+    MetricGauge stateMetric;           // NetworkStatus
+    MetricCounter ipTimeouts;          // retryCount increments, since boot
+    MetricCounter restarts;            // Full Ethernet restarts, since boot
     std::function<void(NetworkStatus)> callback;
 
     void setState(NetworkStatus newState);
@@ -1,5 +1,6 @@
 #include "loggingManager.h"
 #include "servicesManager.h"
+#include "managerEvents.h"
 
 // Logging tag
 static const char* TAG = "ServicesManager";
@@ -10,18 +11,15 @@ ServicesManager::ServicesManager(ConnectivityManager &connectivityMgr, StatusVie
 #ifdef TEST_ALL_SERVICES
       tagoIOService(),
 #endif
+      services(), serviceCount(0), pendingStart(0), serviceStatusChanged(false),
       currentState(SERVICES_STOPPED), initialized(false), lastMQTTConnectedState(false), stateChangeCallback(nullptr),
       lastStateCheck(0)
 {
-    // Set up service status change callbacks
-    novaLogicService.setStatusChangeCallback([this](ServiceStatus status) {
-        this->onServiceStatusChange(status);
-    });
-    
+    // NovaLogic hosts the OTA and command callbacks, which run on the managers task
+    registerService(novaLogicService, "NovaLogic");
 #ifdef TEST_ALL_SERVICES
-    tagoIOService.setStatusChangeCallback([this](ServiceStatus status) {
-        this->onServiceStatusChange(status);
-    });
+    // TagoIO's blocking connect must not hold up NovaLogic
+    registerService(tagoIOService, "TagoIO", 0, true);
 #endif
 }
 
@@ -30,21 +28,55 @@ ServicesManager::~ServicesManager()
     // Services will clean up themselves in their destructors
 }
 
+int ServicesManager::registerService(BaseService &service, const char *label, uint32_t dependsOn, bool ownTask)
+{
+    if (initialized || serviceCount >= SERVICES_MAX_REGISTERED)
+    {
+        return -1;
+    }
+
+    int id = (int)serviceCount++;
+    ServiceEntry &entry = services[id];
+    entry.service = &service;
+    entry.label = label;
+    entry.dependsOn = dependsOn;
+    entry.ownTask = ownTask;
+    entry.task = nullptr;
+
+    service.setStatusChangeCallback([this, id](ServiceStatus status) {
+        // Changes made on a service task are evaluated on the next managers pass
+        if (services[id].task && xTaskGetCurrentTaskHandle() == services[id].task)
+        {
+            serviceStatusChanged = true;
+            managerEvents.signal(MANAGER_EVENT_SERVICE);
+            return;
+        }
+        this->onServiceStatusChange(status);
+    });
+    return id;
+}
+
 void ServicesManager::begin()
 {
     LOG_INFO(TAG, "Initializing services orchestrator...");
 
     // Initialize individual services
-    novaLogicService.begin();
-#ifdef TEST_ALL_SERVICES
-    tagoIOService.begin();
-#endif
+    for (size_t i = 0; i < serviceCount; i++)
+    {
+        ServiceEntry &entry = services[i];
+        entry.service->begin();
+        if (entry.ownTask && !entry.task)
+        {
+            xTaskCreatePinnedToCore(serviceTask, entry.service->getServiceName(), SERVICES_TASK_STACK_SIZE, &entry,
+                                    SERVICES_TASK_PRIORITY, &entry.task, 1);
+        }
+    }
 
     // Start in STOPPED state - will transition to STARTING only when connectivity is available
     setState(SERVICES_STOPPED);
     initialized = true;
 
-    LOG_INFO(TAG, "Services orchestrator initialized");
+    LOG_INFO(TAG, "Services orchestrator initialized (%u services)", (unsigned)serviceCount);
 }
 
 void ServicesManager::loop()
@@ -54,11 +86,21 @@ void ServicesManager::loop()
         return;
     }
 
-    // Update individual services
-    novaLogicService.loop();
-#ifdef TEST_ALL_SERVICES
-    tagoIOService.loop();
-#endif
+    // Update the services that run on the managers task
+    for (size_t i = 0; i < serviceCount; i++)
+    {
+        if (!services[i].task)
+        {
+            services[i].service->loop();
+        }
+    }
+
+    // Status changes reported from service tasks
+    if (serviceStatusChanged)
+    {
+        serviceStatusChanged = false;
+        onServiceStatusChange(SERVICE_STOPPED);
+    }
 
     // Periodic status evaluation
     unsigned long now = millis();
@@ -68,6 +110,9 @@ void ServicesManager::loop()
         lastStateCheck = now;
     }
 
+    // Services waiting for their dependencies
+    startPendingServices();
+
     // State machine logic for service orchestration
     switch (currentState)
     {
@@ -77,18 +122,7 @@ void ServicesManager::loop()
         {
             LOG_INFO(TAG, "Internet connectivity available, starting services");
             setState(SERVICES_STARTING);
-            
-            // Start services
-            if (novaLogicService.getStatus() == SERVICE_STOPPED)
-            {
-                novaLogicService.start();
-            }
-#ifdef TEST_ALL_SERVICES
-            if (tagoIOService.getStatus() == SERVICE_STOPPED)
-            {
-                tagoIOService.start();
-            }
-#endif
+            startServices(false);
         }
         break;
 
@@ -97,10 +131,7 @@ void ServicesManager::loop()
         {
             // Lost connectivity while starting, stop services
             LOG_WARN(TAG, "Lost connectivity while starting, stopping services");
-            novaLogicService.stop();
-#ifdef TEST_ALL_SERVICES
-            tagoIOService.stop();
-#endif
+            stopServices();
             setState(SERVICES_STOPPED);
         }
         // updateOverallStatus() will handle transition to CONNECTING/CONNECTED
@@ -111,10 +142,7 @@ void ServicesManager::loop()
         {
             // Lost connectivity while connecting
             LOG_WARN(TAG, "Lost connectivity while connecting, stopping services");
-            novaLogicService.stop();
-#ifdef TEST_ALL_SERVICES
-            tagoIOService.stop();
-#endif
+            stopServices();
             setState(SERVICES_STOPPED);
         }
         // updateOverallStatus() will handle transition to CONNECTED or ERROR
@@ -124,10 +152,7 @@ void ServicesManager::loop()
         if (!hasInternetConnection())
         {
             LOG_WARN(TAG, "Internet connectivity lost, stopping services");
-            novaLogicService.stop();
-#ifdef TEST_ALL_SERVICES
-            tagoIOService.stop();
-#endif
+            stopServices();
             setState(SERVICES_NOT_CONNECTED);
         }
         break;
@@ -139,10 +164,7 @@ void ServicesManager::loop()
             // Go back to stopped if no connectivity
             if (currentState != SERVICES_STOPPED)
             {
-                novaLogicService.stop();
-#ifdef TEST_ALL_SERVICES
-                tagoIOService.stop();
-#endif
+                stopServices();
                 setState(SERVICES_STOPPED);
             }
         }
@@ -151,20 +173,7 @@ void ServicesManager::loop()
             // Retry starting services
             LOG_INFO(TAG, "Retrying service connections");
             setState(SERVICES_STARTING);
-            
-            // Restart services
-            if (novaLogicService.getStatus() == SERVICE_STOPPED || 
-                novaLogicService.getStatus() == SERVICE_ERROR)
-            {
-                novaLogicService.start();
-            }
-#ifdef TEST_ALL_SERVICES
-            if (tagoIOService.getStatus() == SERVICE_STOPPED || 
-                tagoIOService.getStatus() == SERVICE_ERROR)
-            {
-                tagoIOService.start();
-            }
-#endif
+            startServices(true);
         }
         break;
     }
@@ -175,10 +184,7 @@ void ServicesManager::stop()
     LOG_INFO(TAG, "Stopping services orchestrator...");
 
     // Stop individual services
-    novaLogicService.stop();
-#ifdef TEST_ALL_SERVICES
-    tagoIOService.stop();
-#endif
+    stopServices();
 
     setState(SERVICES_STOPPED);
     initialized = false;
@@ -186,6 +192,97 @@ void ServicesManager::stop()
     LOG_INFO(TAG, "Services orchestrator stopped");
 }
 
+void ServicesManager::startServices(bool retryFailed)
+{
+    // Stopped services (and failed ones on a retry) start together; dependents wait in pendingStart
+    for (size_t i = 0; i < serviceCount; i++)
+    {
+        ServiceStatus status = services[i].service->getStatus();
+        if (status == SERVICE_STOPPED || (retryFailed && status == SERVICE_ERROR))
+        {
+            pendingStart |= 1u << i;
+        }
+    }
+    startPendingServices();
+}
+
+void ServicesManager::startPendingServices()
+{
+    if (!pendingStart)
+    {
+        return;
+    }
+
+    uint32_t connected = 0;
+    for (size_t i = 0; i < serviceCount; i++)
+    {
+        if (services[i].service->isConnected())
+        {
+            connected |= 1u << i;
+        }
+    }
+
+    for (size_t i = 0; i < serviceCount; i++)
+    {
+        ServiceEntry &entry = services[i];
+        if ((pendingStart & (1u << i)) && (entry.dependsOn & connected) == entry.dependsOn)
+        {
+            pendingStart &= ~(1u << i);
+            sendCommand(entry, SERVICE_COMMAND_START);
+        }
+    }
+}
+
+void ServicesManager::stopServices()
+{
+    pendingStart = 0;
+    for (size_t i = 0; i < serviceCount; i++)
+    {
+        sendCommand(services[i], SERVICE_COMMAND_STOP);
+    }
+}
+
+void ServicesManager::sendCommand(ServiceEntry &entry, ServiceCommand command)
+{
+    if (entry.task)
+    {
+        // Applied by the service task before its next loop()
+        xTaskNotify(entry.task, command, eSetValueWithOverwrite);
+        return;
+    }
+
+    if (command == SERVICE_COMMAND_START)
+    {
+        entry.service->start();
+    }
+    else if (command == SERVICE_COMMAND_STOP)
+    {
+        entry.service->stop();
+    }
+}
+
+void ServicesManager::serviceTask(void *pvParameters)
+{
+    ServiceEntry *entry = static_cast<ServiceEntry *>(pvParameters);
+    for (;;)
+    {
+        uint32_t command = SERVICE_COMMAND_NONE;
+        if (xTaskNotifyWait(0, UINT32_MAX, &command, pdMS_TO_TICKS(SERVICES_TASK_INTERVAL_MS)) == pdTRUE)
+        {
+            if (command == SERVICE_COMMAND_START)
+            {
+                entry->service->start();
+            }
+            else if (command == SERVICE_COMMAND_STOP)
+            {
+                entry->service->stop();
+            }
+        }
+
+        entry->service->loop();
+    }
+}
+
 ServicesStatus ServicesManager::getState() const
 {
     return currentState;
@@ -252,27 +349,37 @@ void ServicesManager::setState(ServicesStatus newState)
 
 void ServicesManager::updateOverallStatus()
 {
-    ServiceStatus novaLogicStatus = novaLogicService.getStatus();
-#ifdef TEST_ALL_SERVICES
-    ServiceStatus tagoIOStatus = tagoIOService.getStatus();
-#endif
+    // Count the services in each state
+    size_t connected = 0, connecting = 0, starting = 0, error = 0, notConnected = 0, stopped = 0;
+    for (size_t i = 0; i < serviceCount; i++)
+    {
+        switch (services[i].service->getStatus())
+        {
+        case SERVICE_CONNECTED: connected++; break;
+        case SERVICE_CONNECTING: connecting++; break;
+        case SERVICE_STARTING: starting++; break;
+        case SERVICE_ERROR: error++; break;
+        case SERVICE_NOT_CONNECTED: notConnected++; break;
+        case SERVICE_STOPPED: stopped++; break;
+        default: break;
+        }
+    }
 
     // Determine overall status based on individual service states
     ServicesStatus newOverallStatus = currentState;
 
-#ifdef TEST_ALL_SERVICES
-    // Both services connected = CONNECTED
-    if (novaLogicStatus == SERVICE_CONNECTED && tagoIOStatus == SERVICE_CONNECTED)
+    // All services connected = CONNECTED
+    if (serviceCount > 0 && connected == serviceCount)
     {
         newOverallStatus = SERVICES_CONNECTED;
     }
     // Any service connecting = CONNECTING
-    else if (novaLogicStatus == SERVICE_CONNECTING || tagoIOStatus == SERVICE_CONNECTING)
+    else if (connecting > 0)
     {
         newOverallStatus = SERVICES_CONNECTING;
     }
     // Any service starting = STARTING
-    else if (novaLogicStatus == SERVICE_STARTING || tagoIOStatus == SERVICE_STARTING)
+    else if (starting > 0)
     {
         if (currentState == SERVICES_STOPPED)
         {
@@ -280,60 +387,25 @@ void ServicesManager::updateOverallStatus()
         }
     }
     // Any service error = ERROR
-    else if (novaLogicStatus == SERVICE_ERROR || tagoIOStatus == SERVICE_ERROR)
+    else if (error > 0)
     {
         newOverallStatus = SERVICES_ERROR;
     }
     // Any service not connected = NOT_CONNECTED (unless we're in a starting state)
-    else if ((novaLogicStatus == SERVICE_NOT_CONNECTED || tagoIOStatus == SERVICE_NOT_CONNECTED) &&
-             currentState != SERVICES_STARTING)
+    else if (notConnected > 0 && currentState != SERVICES_STARTING)
     {
         newOverallStatus = SERVICES_NOT_CONNECTED;
-#else
-    // Only NovaLogic service when TEST_ALL_SERVICES is not defined
-    if (novaLogicStatus == SERVICE_CONNECTED)
-    {
-        newOverallStatus = SERVICES_CONNECTED;
     }
-    else if (novaLogicStatus == SERVICE_CONNECTING)
-    {
-        newOverallStatus = SERVICES_CONNECTING;
-    }
-    else if (novaLogicStatus == SERVICE_STARTING)
-    {
-        if (currentState == SERVICES_STOPPED)
-        {
-            newOverallStatus = SERVICES_STARTING;
-        }
-    }
-    else if (novaLogicStatus == SERVICE_ERROR)
-    {
-        newOverallStatus = SERVICES_ERROR;
-    }
-    else if (novaLogicStatus == SERVICE_NOT_CONNECTED && currentState != SERVICES_STARTING)
-    {
-        newOverallStatus = SERVICES_NOT_CONNECTED;
-#endif
-    }
-    // Both services stopped = STOPPED
-#ifdef TEST_ALL_SERVICES
-    else if (novaLogicStatus == SERVICE_STOPPED && tagoIOStatus == SERVICE_STOPPED)
-#else
-    else if (novaLogicStatus == SERVICE_STOPPED)
-#endif
+    // All services stopped = STOPPED
+    else if (stopped == serviceCount)
     {
         newOverallStatus = SERVICES_STOPPED;
     }
 
     if (newOverallStatus != currentState)
     {
-#ifdef TEST_ALL_SERVICES
-        LOG_DEBUG(TAG, "Overall status update: NovaLogic=%d, TagoIO=%d -> Overall=%d", 
-                    novaLogicStatus, tagoIOStatus, newOverallStatus);
-#else
-        LOG_DEBUG(TAG, "Overall status update: NovaLogic=%d -> Overall=%d", 
-                    novaLogicStatus, newOverallStatus);
-#endif
+        LOG_DEBUG(TAG, "Overall status update: %u/%u connected -> Overall=%d", (unsigned)connected,
+                  (unsigned)serviceCount, newOverallStatus);
         setState(newOverallStatus);
     }
 }
@@ -391,18 +463,20 @@ void ServicesManager::checkOTAVersion()
     novaLogicService.checkOTAVersion();
 }
 
-#ifdef TEST_ALL_SERVICES
-// Delegated functions to TagoIO service
-void ServicesManager::publishSensorData(const char* variable, float value, const char* unit)
+void ServicesManager::printStatus()
 {
-    tagoIOService.publishSensorData(variable, value, unit);
-}
+    static const char *const statusNames[] = {"STOPPED", "STARTING", "STOPPING", "CONNECTING",
+                                              "CONNECTED", "ERROR", "NOT_CONNECTED"};
 
-void ServicesManager::publishDeviceStatus(const char* status)
-{
-    tagoIOService.publishDeviceStatus(status);
+    LOG_INFO(TAG, "=== Services ===");
+    for (size_t i = 0; i < serviceCount; i++)
+    {
+        const BaseService &service = *services[i].service;
+        LOG_INFO(TAG, "%s: %s, attempts %lu, failures %lu, backoff %lu ms, next attempt in %lu ms", services[i].label,
+                 statusNames[service.getStatus()], (unsigned long)service.getConnectionAttempts(),
+                 (unsigned long)service.getConnectionFailures(), service.getRetryDelay(), service.getNextAttemptIn());
+    }
 }
-#endif
 
 void ServicesManager::setStateChangeCallback(std::function<void(ServicesStatus)> callback)
 {
@@ -430,17 +504,7 @@ void ServicesManager::onConnectivityChanged(ConnectivityStatus connectivityStatu
         {
             LOG_INFO(TAG, "Internet connectivity restored, starting services");
             setState(SERVICES_STARTING);
-            
-            if (novaLogicService.getStatus() == SERVICE_STOPPED)
-            {
-                novaLogicService.start();
-            }
-#ifdef TEST_ALL_SERVICES
-            if (tagoIOService.getStatus() == SERVICE_STOPPED)
-            {
-                tagoIOService.start();
-            }
-#endif
+            startServices(false);
         }
         break;
 
@@ -450,10 +514,7 @@ void ServicesManager::onConnectivityChanged(ConnectivityStatus connectivityStatu
         if (connectivityStatus == CONNECTIVITY_OFFLINE)
         {
             LOG_WARN(TAG, "Internet connectivity lost immediately, stopping services");
-            novaLogicService.stop();
-#ifdef TEST_ALL_SERVICES
-            tagoIOService.stop();
-#endif
+            stopServices();
             setState(SERVICES_STOPPED);
         }
         break;
@@ -464,10 +525,7 @@ void ServicesManager::onConnectivityChanged(ConnectivityStatus connectivityStatu
         {
             if (currentState != SERVICES_STOPPED)
             {
-                novaLogicService.stop();
-#ifdef TEST_ALL_SERVICES
-                tagoIOService.stop();
-#endif
+                stopServices();
                 setState(SERVICES_STOPPED);
             }
         }
@@ -475,19 +533,7 @@ void ServicesManager::onConnectivityChanged(ConnectivityStatus connectivityStatu
         {
             LOG_INFO(TAG, "Internet connectivity restored, retrying service connections");
             setState(SERVICES_STARTING);
-            
-            if (novaLogicService.getStatus() == SERVICE_STOPPED || 
-                novaLogicService.getStatus() == SERVICE_ERROR)
-            {
-                novaLogicService.start();
-            }
-#ifdef TEST_ALL_SERVICES
-            if (tagoIOService.getStatus() == SERVICE_STOPPED || 
-                tagoIOService.getStatus() == SERVICE_ERROR)
-            {
-                tagoIOService.start();
-            }
-#endif
+            startServices(true);
         }
         break;
     }
@@ -17,6 +17,19 @@
 class StatusViewModel;
 class ConnectivityManager;
 
+/*
+ * Services orchestrator
+ *
+ * Services are registered once (registerService) and handled the same way:
+ * they are started together as soon as connectivity is available and stopped
+ * when it is lost, and the overall status is aggregated from all of them.
+ *
+ * A service may declare dependencies (bit n = the n-th registered service); it
+ * is started once those are connected. A service registered with its own task
+ * runs loop(), start() and stop() there, so a blocking connect cannot hold up
+ * the managers task or the other services. Its status changes are picked up
+ * on the next managers pass.
+ */
 class ServicesManager
 {
 public:
@@ -47,11 +60,11 @@ public:
     void sendConnectionStatus(bool connected);
     void checkOTAVersion();
 
-#ifdef TEST_ALL_SERVICES
-    // Data publishing functions (delegated to TagoIO service)
-    void publishSensorData(const char* variable, float value, const char* unit = nullptr);
-    void publishDeviceStatus(const char* status);
-#endif
+    // Registered services (display status line)
+    size_t getServiceCount() const { return serviceCount; }
+    const BaseService& getService(size_t index) const { return *services[index].service; }
+    const char* getServiceLabel(size_t index) const { return services[index].label; }
+    void printStatus();
 
     // Set callback for state change event
     void setStateChangeCallback(std::function<void(ServicesStatus)> callback);
@@ -60,7 +73,31 @@ public:
     void onConnectivityChanged(ConnectivityStatus connectivityStatus);
 
 private:
+    enum ServiceCommand : uint32_t
+    {
+        SERVICE_COMMAND_NONE,
+        SERVICE_COMMAND_START,
+        SERVICE_COMMAND_STOP
+    };
+
+    struct ServiceEntry
+    {
+        BaseService *service;
+        const char *label;              // Short name for the display
+        uint32_t dependsOn;             // Services that must be connected first
+        bool ownTask;
+        TaskHandle_t task;
+    };
+
+    // Returns the service ID (its dependency bit), -1 if the registry is full
+    int registerService(BaseService &service, const char *label, uint32_t dependsOn = 0, bool ownTask = false);
+
     // Service orchestration
+    void startServices(bool retryFailed);
+    void startPendingServices();
+    void stopServices();
+    void sendCommand(ServiceEntry &entry, ServiceCommand command);
+    static void serviceTask(void *pvParameters);
     void updateOverallStatus();
     void setState(ServicesStatus newState);
     void onServiceStatusChange(ServiceStatus status);
@@ -75,6 +112,12 @@ private:
 #ifdef TEST_ALL_SERVICES
     TagoIOService tagoIOService;
 #endif
+
+    // Registry
+    ServiceEntry services[SERVICES_MAX_REGISTERED];
+    size_t serviceCount;
+    uint32_t pendingStart;              // Waiting for their dependencies
+    volatile bool serviceStatusChanged; // Reported from a service task
     
     // State management
     ServicesStatus currentState;
@@ -0,0 +1,181 @@
+#include "metricsRegistry.h"
+
+// Constant-initialized, so metrics constructed during static initialization can register in any order
+MetricsRegistry metricsRegistry;
+
+static const char *TYPE_NAMES[] = {"counter", "gauge", "histogram"};
+
+// value / scale as a decimal without trailing zeros (scale is a power of ten)
+static void formatScaled(char *out, size_t size, uint64_t value, uint32_t scale)
+{
+    if (scale <= 1)
+    {
+        snprintf(out, size, "%llu", (unsigned long long)value);
+        return;
+    }
+
+    int digits = 0;
+    for (uint32_t s = scale; s > 1; s /= 10)
+        digits++;
+
+    uint32_t fraction = value % scale;
+    if (fraction == 0)
+    {
+        snprintf(out, size, "%llu", (unsigned long long)(value / scale));
+        return;
+    }
+    while (fraction % 10 == 0)
+    {
+        fraction /= 10;
+        digits--;
+    }
+    snprintf(out, size, "%llu.%0*lu", (unsigned long long)(value / scale), digits, (unsigned long)fraction);
+}
+
+Metric::Metric(MetricType type, const char *name, const char *help, const char *labelName, const char *labelValue)
+    : type(type), name(name), help(help), labelName(labelName), labelValue(labelValue), next(nullptr)
+{
+    metricsRegistry.add(this);
+}
+
+void Metric::writeSample(Print &out, const char *suffix, const char *value, const char *extraLabel) const
+{
+    char line[160];
+    int length;
+    if (labelName && extraLabel)
+        length = snprintf(line, sizeof(line), "%s%s{%s=\"%s\",%s} %s\n", name, suffix, labelName, labelValue, extraLabel, value);
+    else if (labelName)
+        length = snprintf(line, sizeof(line), "%s%s{%s=\"%s\"} %s\n", name, suffix, labelName, labelValue, value);
+    else if (extraLabel)
+        length = snprintf(line, sizeof(line), "%s%s{%s} %s\n", name, suffix, extraLabel, value);
+    else
+        length = snprintf(line, sizeof(line), "%s%s %s\n", name, suffix, value);
+
+    if (length > 0 && (size_t)length < sizeof(line))
+        out.write((const uint8_t *)line, length);
+}
+
+MetricCounter::MetricCounter(const char *name, const char *help, const char *labelName, const char *labelValue)
+    : Metric(METRIC_COUNTER, name, help, labelName, labelValue), value(0)
+{
+}
+
+void MetricCounter::writeSamples(Print &out) const
+{
+    char text[12];
+    snprintf(text, sizeof(text), "%lu", (unsigned long)get());
+    writeSample(out, "_total", text);
+}
+
+MetricGauge::MetricGauge(const char *name, const char *help, const char *labelName, const char *labelValue)
+    : Metric(METRIC_GAUGE, name, help, labelName, labelValue), value(0)
+{
+}
+
+void MetricGauge::writeSamples(Print &out) const
+{
+    char text[12];
+    snprintf(text, sizeof(text), "%ld", (long)get());
+    writeSample(out, "", text);
+}
+
+MetricFunction::MetricFunction(MetricType type, const char *name, const char *help, int64_t (*read)(),
+                               const char *labelName, const char *labelValue)
+    : Metric(type, name, help, labelName, labelValue), read(read)
+{
+}
+
+void MetricFunction::writeSamples(Print &out) const
+{
+    char text[24];
+    snprintf(text, sizeof(text), "%lld", (long long)read());
+    writeSample(out, getType() == METRIC_COUNTER ? "_total" : "", text);
+}
+
+MetricHistogram::MetricHistogram(const char *name, const char *help, const uint32_t *bounds, size_t boundCount,
+                                 uint32_t scale, const char *labelName, const char *labelValue)
+    : Metric(METRIC_HISTOGRAM, name, help, labelName, labelValue), bounds(bounds),
+      boundCount(boundCount < METRICS_HISTOGRAM_MAX_BUCKETS ? boundCount : METRICS_HISTOGRAM_MAX_BUCKETS),
+      scale(scale), sum(0)
+{
+    for (auto &count : counts)
+        count.store(0, std::memory_order_relaxed);
+}
+
+void MetricHistogram::observe(uint32_t value)
+{
+    size_t bucket = 0;
+    while (bucket < boundCount && value > bounds[bucket])
+        bucket++;
+    counts[bucket].fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+}
+
+void MetricHistogram::writeSamples(Print &out) const
+{
+    // Buckets are cumulative on the wire; _count is their total, so the two always agree
+    char text[24];
+    char label[32];
+    uint32_t cumulative = 0;
+    for (size_t i = 0; i <= boundCount; i++)
+    {
+        cumulative += counts[i].load(std::memory_order_relaxed);
+        if (i < boundCount)
+        {
+            char bound[16];
+            formatScaled(bound, sizeof(bound), bounds[i], scale);
+            snprintf(label, sizeof(label), "le=\"%s\"", bound);
+        }
+        else
+        {
+            snprintf(label, sizeof(label), "le=\"+Inf\"");
+        }
+        snprintf(text, sizeof(text), "%lu", (unsigned long)cumulative);
+        writeSample(out, "_bucket", text, label);
+    }
+
+    snprintf(text, sizeof(text), "%lu", (unsigned long)cumulative);
+    writeSample(out, "_count", text);
+    formatScaled(text, sizeof(text), sum.load(std::memory_order_relaxed), scale);
+    writeSample(out, "_sum", text);
+}
+
+void MetricsRegistry::add(Metric *metric)
+{
+    if (tail)
+        tail->next = metric;
+    else
+        head = metric;
+    tail = metric;
+    count++;
+}
+
+bool MetricsRegistry::writtenBefore(const Metric *metric) const
+{
+    for (const Metric *m = head; m != metric; m = m->next)
+    {
+        if (strcmp(m->name, metric->name) == 0)
+            return true;
+    }
+    return false;
+}
+
+void MetricsRegistry::write(Print &out) const
+{
+    // Family by family: the first metric of a name writes the metadata and every sample of that name
+    for (const Metric *metric = head; metric; metric = metric->next)
+    {
+        if (writtenBefore(metric))
+            continue;
+
+        out.printf("# TYPE %s %s\n", metric->name, TYPE_NAMES[metric->type]);
+        if (metric->help)
+            out.printf("# HELP %s %s\n", metric->name, metric->help);
+        for (const Metric *member = metric; member; member = member->next)
+        {
+            if (member == metric || strcmp(member->name, metric->name) == 0)
+                member->writeSamples(out);
+        }
+    }
+    out.print("# EOF\n");
+}
@@ -0,0 +1,152 @@
+#pragma once
+#ifndef __METRICSREGISTRY_H__
+#define __METRICSREGISTRY_H__
+
+#include <Arduino.h>
+#include <atomic>
+
+#include "definitions.h"
+
+/*
+ * Typed device metrics, scraped as OpenMetrics text (GET /metrics, see HttpServer)
+ *
+ * Metrics are objects owned by the code they describe: a counter or gauge next
+ * to the state it counts, a histogram around the operation it times. Updates
+ * are single relaxed atomic operations on 32-bit values, so they are safe from
+ * any task (including the eModbus callbacks) without a mutex. Values read at
+ * scrape time from existing state use MetricFunction instead.
+ *
+ * Every metric registers itself on construction and lives for the rest of the
+ * program; create them as globals or members of long-lived objects, never on
+ * the stack. Metrics sharing a name form one family (one # TYPE line); each
+ * carries at most one label, e.g. {service="NovaLogic"}. Label values are
+ * written as they are and must not need escaping.
+ *
+ * Histograms count observations in fixed, ascending bucket bounds given in the
+ * recorded unit. A scale turns that unit into the exposed base unit:
+ * microseconds with scale 1000000 are exposed as seconds. Counters and
+ * histogram sums are 32-bit and wrap; Prometheus treats a wrap as a counter
+ * reset.
+ */
+
+enum MetricType : uint8_t
+{
+    METRIC_COUNTER,
+    METRIC_GAUGE,
+    METRIC_HISTOGRAM
+};
+
+class Metric
+{
+public:
+    const char *getName() const { return name; }
+    MetricType getType() const { return type; }
+
+protected:
+    Metric(MetricType type, const char *name, const char *help, const char *labelName, const char *labelValue);
+    virtual ~Metric() {}
+
+    // One OpenMetrics sample line: <name><suffix>{<label>,<extraLabel>} <value>
+    void writeSample(Print &out, const char *suffix, const char *value, const char *extraLabel = nullptr) const;
+    virtual void writeSamples(Print &out) const = 0;
+
+private:
+    friend class MetricsRegistry;
+
+    MetricType type;
+    const char *name;
+    const char *help;
+    const char *labelName;
+    const char *labelValue;
+    Metric *next;
+};
+
+class MetricCounter : public Metric
+{
+public:
+    MetricCounter(const char *name, const char *help, const char *labelName = nullptr, const char *labelValue = nullptr);
+
+    void increment(uint32_t amount = 1) { value.fetch_add(amount, std::memory_order_relaxed); }
+    uint32_t get() const { return value.load(std::memory_order_relaxed); }
+
+protected:
+    void writeSamples(Print &out) const override;
+
+private:
+    std::atomic<uint32_t> value;
+};
+
+class MetricGauge : public Metric
+{
+public:
+    MetricGauge(const char *name, const char *help, const char *labelName = nullptr, const char *labelValue = nullptr);
+
+    void set(int32_t newValue) { value.store(newValue, std::memory_order_relaxed); }
+    void add(int32_t amount) { value.fetch_add(amount, std::memory_order_relaxed); }
+    int32_t get() const { return value.load(std::memory_order_relaxed); }
+
+protected:
+    void writeSamples(Print &out) const override;
+
+private:
+    std::atomic<int32_t> value;
+};
+
+// Counter or gauge read from existing state when scraped
+class MetricFunction : public Metric
+{
+public:
+    MetricFunction(MetricType type, const char *name, const char *help, int64_t (*read)(),
+                   const char *labelName = nullptr, const char *labelValue = nullptr);
+
+protected:
+    void writeSamples(Print &out) const override;
+
+private:
+    int64_t (*read)();
+};
+
+class MetricHistogram : public Metric
+{
+public:
+    // bounds: ascending upper bounds in the recorded unit (at most METRICS_HISTOGRAM_MAX_BUCKETS)
+    MetricHistogram(const char *name, const char *help, const uint32_t *bounds, size_t boundCount, uint32_t scale = 1,
+                    const char *labelName = nullptr, const char *labelValue = nullptr);
+
+    void observe(uint32_t value);
+
+protected:
+    void writeSamples(Print &out) const override;
+
+private:
+    const uint32_t *bounds;
+    size_t boundCount;
+    uint32_t scale;
+    std::atomic<uint32_t> counts[METRICS_HISTOGRAM_MAX_BUCKETS + 1];   // Per bucket, last = above every bound
+    std::atomic<uint32_t> sum;
+};
+
+class MetricsRegistry
+{
+public:
+    constexpr MetricsRegistry() : head(nullptr), tail(nullptr), count(0) {}
+
+    // Metric constructors; startup only (static initialization or setup)
+    void add(Metric *metric);
+
+    // Whole exposition, family by family, ending with "# EOF"
+    void write(Print &out) const;
+
+    size_t getCount() const { return count; }
+
+private:
+    bool writtenBefore(const Metric *metric) const;
+
+    Metric *head;
+    Metric *tail;
+    size_t count;
+};
+
+extern MetricsRegistry metricsRegistry;
+
+#endif // __METRICSREGISTRY_H__
@@ -0,0 +1,274 @@
+#include "deltaPatcher.h"
+#include <mbedtls/sha256.h>
+
+static uint32_t readU32(const uint8_t *p)
+{
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
+
+DeltaPatcher::DeltaPatcher()
+    : reader(), sourceSize(0), targetSize(0), sourceDigest(), targetDigest(), state(STATE_FAILED), op(OP_END),
+      varint(0), varintShift(0), length(0), offset(0), sourcePos(0), remaining(0), produced(0), copied(0),
+      error(nullptr), sha256(), verifyOffset(0), copyBudget(0), paused(false), pendingLength(0)
+{
+}
+
+bool DeltaPatcher::begin(const uint8_t *header, const SourceReader &reader)
+{
+    abort();
+    this->reader = reader;
+    state = STATE_OP;
+    sourcePos = 0;
+    remaining = 0;
+    produced = 0;
+    copied = 0;
+    error = nullptr;
+
+    if (memcmp(header, DELTA_PATCH_MAGIC, 4) != 0)
+        return fail("Not a delta patch");
+
+    sourceSize = readU32(header + 4);
+    targetSize = readU32(header + 8);
+    memcpy(sourceDigest, header + 12, sizeof(sourceDigest));
+    memcpy(targetDigest, header + 44, sizeof(targetDigest));
+
+    verifyOffset = 0;
+    mbedtls_sha256_init(&sha256);
+    mbedtls_sha256_starts(&sha256, 0);
+    state = STATE_VERIFY;
+    return true;
+}
+
+bool DeltaPatcher::verifySource()
+{
+    if (state != STATE_VERIFY)
+        return state != STATE_FAILED;
+
+    size_t end = min(verifyOffset + (size_t)OTA_DELTA_VERIFY_SLICE, sourceSize);
+    while (verifyOffset < end)
+    {
+        size_t count = min(sizeof(sourceBuffer), end - verifyOffset);
+        if (!reader(verifyOffset, sourceBuffer, count))
+            return fail("Source read failed");
+        mbedtls_sha256_update(&sha256, sourceBuffer, count);
+        verifyOffset += count;
+    }
+
+    if (verifyOffset < sourceSize)
+        return true;
+
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&sha256, digest);
+    mbedtls_sha256_free(&sha256);
+    state = STATE_OP;
+
+    if (memcmp(digest, sourceDigest, sizeof(digest)) != 0)
+        return fail("Patch does not match the running image");
+    return true;
+}
+
+void DeltaPatcher::abort()
+{
+    if (state == STATE_VERIFY)
+        mbedtls_sha256_free(&sha256);
+    state = STATE_FAILED;
+    paused = false;
+    pendingLength = 0;
+}
+
+bool DeltaPatcher::fail(const char *message)
+{
+    if (state != STATE_FAILED || !error)
+        error = message;
+    if (state == STATE_VERIFY)
+        mbedtls_sha256_free(&sha256);
+    state = STATE_FAILED;
+    paused = false;
+    return false;
+}
+
+// Accumulates one LEB128 byte; true once the value is complete
+bool DeltaPatcher::readVarint(uint8_t byte)
+{
+    if (varintShift > 28)
+    {
+        fail("Corrupt patch (varint)");
+        return false;
+    }
+
+    varint |= (uint32_t)(byte & 0x7F) << varintShift;
+    varintShift += 7;
+    return (byte & 0x80) == 0;
+}
+
+bool DeltaPatcher::startOperation()
+{
+    remaining = length;
+    if (produced + remaining > targetSize)
+        return fail("Corrupt patch (target overrun)");
+
+    if (op != OP_INSERT)
+    {
+        int64_t position = (int64_t)sourcePos + offset;
+        if (position < 0 || (uint64_t)position + remaining > sourceSize)
+            return fail("Corrupt patch (source range)");
+        sourcePos = (size_t)position;
+    }
+
+    state = remaining > 0 ? STATE_DATA : STATE_OP;
+    return true;
+}
+
+bool DeltaPatcher::copySource(const OutputCallback &output)
+{
+    size_t count = min(min(remaining, sizeof(sourceBuffer)), copyBudget);
+    if (!reader(sourcePos, sourceBuffer, count))
+        return fail("Source read failed");
+    if (!output(sourceBuffer, count))
+        return fail("Output aborted");
+
+    sourcePos += count;
+    remaining -= count;
+    produced += count;
+    copied += count;
+    copyBudget -= count;
+    if (remaining == 0)
+        state = STATE_OP;
+    return true;
+}
+
+// Operation bytes that arrive while paused, or that follow the COPY that paused
+bool DeltaPatcher::hold(const uint8_t *data, size_t size)
+{
+    if (pendingLength + size > sizeof(pending))
+        return fail("Patch input overrun while paused");
+    memmove(pending + pendingLength, data, size);
+    pendingLength += size;
+    return true;
+}
+
+bool DeltaPatcher::feed(const uint8_t *data, size_t size, const OutputCallback &output)
+{
+    if (state == STATE_VERIFY)
+        return fail("Source not verified");
+    if (paused)
+        return hold(data, size);
+
+    copyBudget = OTA_DELTA_COPY_SLICE;
+    return run(data, size, output);
+}
+
+bool DeltaPatcher::resume(const OutputCallback &output)
+{
+    if (!paused)
+        return state != STATE_FAILED;
+
+    // run() may pause again and hold the rest at the start of the same buffer
+    paused = false;
+    size_t size = pendingLength;
+    pendingLength = 0;
+    copyBudget = OTA_DELTA_COPY_SLICE;
+    return run(pending, size, output);
+}
+
+bool DeltaPatcher::run(const uint8_t *data, size_t size, const OutputCallback &output)
+{
+    size_t i = 0;
+    while (state != STATE_FAILED)
+    {
+        // COPY needs no patch bytes; the rest of it waits for resume() once the budget is spent
+        if (state == STATE_DATA && op == OP_COPY)
+        {
+            if (copyBudget == 0)
+            {
+                paused = true;
+                return hold(data + i, size - i);
+            }
+            copySource(output);
+            continue;
+        }
+
+        if (i >= size)
+            break;
+
+        switch (state)
+        {
+        case STATE_OP:
+            op = (Op)data[i++];
+            varint = 0;
+            varintShift = 0;
+            if (op == OP_END)
+                state = STATE_DONE;
+            else if (op == OP_COPY || op == OP_ADD || op == OP_INSERT)
+                state = STATE_LENGTH;
+            else
+                fail("Corrupt patch (operation)");
+            break;
+
+        case STATE_LENGTH:
+            if (readVarint(data[i++]))
+            {
+                length = varint;
+                varint = 0;
+                varintShift = 0;
+                if (op == OP_INSERT)
+                {
+                    offset = 0;
+                    startOperation();
+                }
+                else
+                {
+                    state = STATE_OFFSET;
+                }
+            }
+            break;
+
+        case STATE_OFFSET:
+            if (readVarint(data[i++]))
+            {
+                offset = (int32_t)(varint >> 1) ^ -(int32_t)(varint & 1);
+                startOperation();
+            }
+            break;
+
+        case STATE_DATA:
+        {
+            size_t count = min(remaining, size - i);
+            if (op == OP_ADD)
+            {
+                count = min(count, sizeof(sourceBuffer));
+                if (!reader(sourcePos, sourceBuffer, count))
+                {
+                    fail("Source read failed");
+                    break;
+                }
+                for (size_t k = 0; k < count; k++)
+                    sourceBuffer[k] += data[i + k];
+                sourcePos += count;
+            }
+
+            if (!output(op == OP_ADD ? sourceBuffer : data + i, count))
+            {
+                fail("Output aborted");
+                break;
+            }
+
+            i += count;
+            remaining -= count;
+            produced += count;
+            if (remaining == 0)
+                state = STATE_OP;
+            break;
+        }
+
+        case STATE_DONE:
+            fail("Corrupt patch (data after end)");
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    return state != STATE_FAILED;
+}
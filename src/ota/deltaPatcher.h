@@ -0,0 +1,142 @@
+#pragma once
+#ifndef __DELTAPATCHER_H__
+#define __DELTAPATCHER_H__
+
+#include <Arduino.h>
+#include <functional>
+#include <mbedtls/sha256.h>
+
+#include "definitions.h"
+#include "utils/lzss.h"
+
+/*
+ * Streaming delta (binary diff) firmware patcher
+ *
+ * A delta patch rebuilds the new application image from the running one. It is
+ * applied while it is being received: source bytes are read from flash through
+ * a small buffer and the rebuilt image goes straight to the output callback, so
+ * RAM use is bounded by OTA_DELTA_SOURCE_BUFFER_SIZE whatever the image size.
+ *
+ * Patch file (little endian), produced by scripts/otadelta.py:
+ *   header  "NDP1" [sourceSize:4][targetSize:4][sourceSha256:32][targetSha256:32]
+ *   body    LZSS stream (src/utils/lzss.h) of operations:
+ *     0x01 COPY   [length][offset]        target += source[pos + offset, +length)
+ *     0x02 ADD    [length][offset] bytes  target += source[pos + offset + i] + bytes[i]
+ *     0x03 INSERT [length] bytes          target += bytes
+ *     0x00 END
+ *   length is an unsigned LEB128 varint, offset a zigzag LEB128 varint relative
+ *   to the end of the previous COPY/ADD (pos).
+ *
+ * ADD carries the bytewise difference of code that moved, which is mostly zero
+ * and compresses well; this is the bsdiff approach with a streaming layout.
+ *
+ * The header's source digest must match the running image before anything is
+ * written, and its target digest is handed to OTAWriter, which rejects the
+ * rebuilt image before Update.end on a mismatch.
+ *
+ * Neither step runs unbounded: verifySource() hashes OTA_DELTA_VERIFY_SLICE
+ * bytes per call, and a COPY (up to the whole image) hands the output at most
+ * OTA_DELTA_COPY_SLICE bytes per feed()/resume() call. A COPY cut short pauses
+ * the patcher; operation bytes fed meanwhile are held (up to
+ * DELTA_PATCH_PENDING_SIZE, the decoded output of one OTA_DELTA_DECODE_STEP)
+ * and resume() carries on from sourcePos on the next pass.
+ */
+
+#define DELTA_PATCH_HEADER_SIZE 76
+#define DELTA_PATCH_MAGIC "NDP1"
+#define DELTA_PATCH_PENDING_SIZE (OTA_DELTA_DECODE_STEP * LZSS_MAX_MATCH / 2)
+
+class DeltaPatcher
+{
+public:
+    // Rebuilt image bytes; return false to abort
+    typedef std::function<bool(const uint8_t *data, size_t length)> OutputCallback;
+    // Read source (running image) bytes at an absolute offset
+    typedef std::function<bool(size_t offset, uint8_t *data, size_t length)> SourceReader;
+
+    DeltaPatcher();
+
+    // Parse the DELTA_PATCH_HEADER_SIZE header bytes, reset the operation parser and start verifying
+    bool begin(const uint8_t *header, const SourceReader &reader);
+
+    // Hash the next OTA_DELTA_VERIFY_SLICE source bytes; once sourceSize bytes are in, compare
+    // with the header. Call until isVerifying() is false; false on a read failure or mismatch
+    bool verifySource();
+    bool isVerifying() const { return state == STATE_VERIFY; }
+
+    // Feed any slice of the decompressed operation stream; held while paused
+    bool feed(const uint8_t *data, size_t length, const OutputCallback &output);
+
+    // Continue a paused COPY, then the operations held behind it
+    bool resume(const OutputCallback &output);
+    bool isPaused() const { return paused; }
+
+    // Drop a transfer (releases the source hash if it was being verified)
+    void abort();
+
+    // END seen and exactly targetSize bytes produced
+    bool isComplete() const { return state == STATE_DONE && produced == targetSize; }
+
+    size_t getSourceSize() const { return sourceSize; }
+    size_t getTargetSize() const { return targetSize; }
+    const uint8_t *getTargetDigest() const { return targetDigest; }
+    size_t getProduced() const { return produced; }
+    size_t getCopied() const { return copied; }
+    const char *getError() const { return error; }
+
+private:
+    enum State : uint8_t
+    {
+        STATE_VERIFY,
+        STATE_OP,
+        STATE_LENGTH,
+        STATE_OFFSET,
+        STATE_DATA,
+        STATE_DONE,
+        STATE_FAILED
+    };
+
+    enum Op : uint8_t
+    {
+        OP_END = 0x00,
+        OP_COPY = 0x01,
+        OP_ADD = 0x02,
+        OP_INSERT = 0x03
+    };
+
+    bool readVarint(uint8_t byte);
+    bool startOperation();
+    bool run(const uint8_t *data, size_t size, const OutputCallback &output);
+    bool copySource(const OutputCallback &output);
+    bool hold(const uint8_t *data, size_t size);
+    bool fail(const char *message);
+
+    SourceReader reader;
+    size_t sourceSize;
+    size_t targetSize;
+    uint8_t sourceDigest[32];
+    uint8_t targetDigest[32];
+
+    State state;
+    Op op;
+    uint32_t varint;
+    uint8_t varintShift;
+    uint32_t length;
+    int32_t offset;
+    size_t sourcePos;       // Source position of the next COPY/ADD byte
+    size_t remaining;       // Bytes left in the current operation
+    size_t produced;
+    size_t copied;          // Target bytes taken unchanged from the source
+    const char *error;
+
+    mbedtls_sha256_context sha256;
+    size_t verifyOffset;    // Source bytes hashed so far
+    size_t copyBudget;      // COPY bytes left in this feed()/resume() call
+    bool paused;
+    size_t pendingLength;   // Operation bytes held while paused
+
+    uint8_t sourceBuffer[OTA_DELTA_SOURCE_BUFFER_SIZE];
+    uint8_t pending[DELTA_PATCH_PENDING_SIZE];
+};
+
+#endif // __DELTAPATCHER_H__
@@ -0,0 +1,596 @@
+#include "httpOtaDownloader.h"
+#include "otaWriter.h"
+#include "managers/loggingManager.h"
+#include <lwip/netdb.h>
+#include <lwip/sockets.h>
+#include <nvs.h>
+
+static const char *TAG = "HttpOTADownloader";
+
+static const uint32_t CHECKPOINT_MAGIC = 0x4F544148; // "OTAH"
+static const char *NVS_NAMESPACE = "ota_http";
+static const char *NVS_KEY = "checkpoint";
+
+static StaticTask_t connectTaskStruct;
+static StackType_t connectTaskStack[OTA_HTTP_CONNECT_TASK_STACK_SIZE];
+
+HttpOTADownloader::HttpOTADownloader()
+    : state(STATE_IDLE), checkpoint(), partition(nullptr), client(), error(nullptr), host(), port(80),
+      path(nullptr), connectHandle(nullptr), connecting(false), connectSocket(-1), connectPending(false),
+      connectStale(false), connectHost(), connectPort(0), line(), lineLength(0), statusCode(0), rangeStart(0),
+      totalSize(0), skip(0), fill(0),
+      lastCheckpointOffset(0), lastDataTime(0), retryAt(0), retryDelay(OTA_HTTP_RETRY_MIN_MS), failures(0),
+      resumeCount(0), verifyOffset(0)
+{
+}
+
+bool HttpOTADownloader::begin()
+{
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &handle) != ESP_OK)
+        return false;
+
+    size_t size = sizeof(checkpoint);
+    esp_err_t err = nvs_get_blob(handle, NVS_KEY, &checkpoint, &size);
+    nvs_close(handle);
+    if (err != ESP_OK || size != sizeof(checkpoint) || checkpoint.magic != CHECKPOINT_MAGIC)
+        return false;
+
+    // A checkpoint only applies to the slot it was written to
+    partition = esp_ota_get_next_update_partition(nullptr);
+    checkpoint.url[sizeof(checkpoint.url) - 1] = '\0';
+    if (!partition || partition->address != checkpoint.partitionAddress || !parseUrl())
+    {
+        clearCheckpoint();
+        return false;
+    }
+
+    LOG_INFO(TAG, "Resuming %s at %lu/%lu bytes", checkpoint.url, (unsigned long)checkpoint.offset,
+             (unsigned long)checkpoint.imageSize);
+    resumeCount++;
+    restart();
+    return true;
+}
+
+void HttpOTADownloader::restart()
+{
+    lastCheckpointOffset = checkpoint.offset;
+    fill = 0;
+    failures = 0;
+    retryDelay = OTA_HTTP_RETRY_MIN_MS;
+    retryAt = millis();
+
+    // Everything was written before an interruption: only the verification is left
+    if (checkpoint.imageSize != 0 && checkpoint.offset == checkpoint.imageSize)
+        startVerify();
+    else
+        state = STATE_CONNECT;
+}
+
+bool HttpOTADownloader::start(const char *url, const char *digestHex)
+{
+    error = nullptr;
+    client.stop();
+    connectStale = connectPending;
+
+    uint8_t digest[32];
+    size_t digestLength = 0;
+    if (digestHex && *digestHex)
+    {
+        digestLength = OTAWriter::parseDigest(digestHex, digest);
+        if (digestLength == 0)
+        {
+            fail("Invalid image digest");
+            return false;
+        }
+    }
+
+    partition = esp_ota_get_next_update_partition(nullptr);
+    if (!url || strlen(url) >= sizeof(checkpoint.url) || !partition)
+    {
+        fail("Invalid URL or no OTA partition");
+        return false;
+    }
+
+    // The same image as an interrupted download continues from its checkpoint
+    bool resume = checkpoint.magic == CHECKPOINT_MAGIC && checkpoint.partitionAddress == partition->address &&
+                  strcmp(checkpoint.url, url) == 0 && checkpoint.digestLength == digestLength &&
+                  memcmp(checkpoint.digest, digest, digestLength) == 0;
+    if (!resume)
+    {
+        memset(&checkpoint, 0, sizeof(checkpoint));
+        checkpoint.magic = CHECKPOINT_MAGIC;
+        checkpoint.partitionAddress = partition->address;
+        strcpy(checkpoint.url, url);
+        memcpy(checkpoint.digest, digest, digestLength);
+        checkpoint.digestLength = (uint8_t)digestLength;
+    }
+
+    if (!parseUrl())
+    {
+        fail("Only http://host[:port]/path URLs are supported");
+        return false;
+    }
+
+    resumeCount = resume ? resumeCount + 1 : 0;
+    saveCheckpoint();
+    restart();
+    return true;
+}
+
+void HttpOTADownloader::discardCheckpoint()
+{
+    if (isActive() || checkpoint.magic != CHECKPOINT_MAGIC)
+        return;
+
+    LOG_INFO(TAG, "Resume point at %lu/%lu bytes discarded", (unsigned long)checkpoint.offset,
+             (unsigned long)checkpoint.imageSize);
+    checkpoint.magic = 0;
+    clearCheckpoint();
+}
+
+uint8_t HttpOTADownloader::getProgress() const
+{
+    if (checkpoint.imageSize == 0)
+        return 0;
+    return (uint8_t)((uint64_t)getOffset() * 100 / checkpoint.imageSize);
+}
+
+bool HttpOTADownloader::parseUrl()
+{
+    const char *cursor = checkpoint.url;
+    if (strncmp(cursor, "http://", 7) != 0)
+        return false;
+    cursor += 7;
+
+    size_t hostLength = strcspn(cursor, ":/");
+    if (hostLength == 0 || hostLength >= sizeof(host))
+        return false;
+    memcpy(host, cursor, hostLength);
+    host[hostLength] = '\0';
+    cursor += hostLength;
+
+    port = 80;
+    if (*cursor == ':')
+    {
+        port = (uint16_t)strtoul(cursor + 1, (char **)&cursor, 10);
+        if (port == 0)
+            return false;
+    }
+
+    path = *cursor == '/' ? cursor : "/";
+    return true;
+}
+
+void HttpOTADownloader::loop()
+{
+    switch (state)
+    {
+    case STATE_CONNECT:
+        connect();
+        break;
+
+    case STATE_HEADERS:
+        readHeaders();
+        break;
+
+    case STATE_BODY:
+        readBody();
+        break;
+
+    case STATE_VERIFY:
+        verify();
+        break;
+
+    default:
+        break;
+    }
+}
+
+void HttpOTADownloader::connectTask(void *pvParameters)
+{
+    HttpOTADownloader *downloader = (HttpOTADownloader *)pvParameters;
+    while (true)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        downloader->connectSocket = openSocket(downloader->connectHost, downloader->connectPort);
+        downloader->connecting = false;
+    }
+}
+
+// Blocking lookup and connect with a bounded wait; the connected socket or -1
+int HttpOTADownloader::openSocket(const char *host, uint16_t port)
+{
+    char service[6];
+    snprintf(service, sizeof(service), "%u", port);
+
+    struct addrinfo hints = {};
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo *address = nullptr;
+    if (lwip_getaddrinfo(host, service, &hints, &address) != 0 || !address)
+        return -1;
+
+    int fd = lwip_socket(address->ai_family, address->ai_socktype, address->ai_protocol);
+    if (fd >= 0)
+    {
+        // Non-blocking connect so the wait is OTA_HTTP_TIMEOUT_MS, not the SYN retry time
+        lwip_fcntl(fd, F_SETFL, lwip_fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+        int result = lwip_connect(fd, address->ai_addr, address->ai_addrlen);
+        if (result != 0 && errno == EINPROGRESS)
+        {
+            fd_set writable;
+            FD_ZERO(&writable);
+            FD_SET(fd, &writable);
+            struct timeval timeout = {OTA_HTTP_TIMEOUT_MS / 1000, (OTA_HTTP_TIMEOUT_MS % 1000) * 1000};
+            int socketError = -1;
+            socklen_t length = sizeof(socketError);
+            if (select(fd + 1, nullptr, &writable, nullptr, &timeout) == 1 &&
+                lwip_getsockopt(fd, SOL_SOCKET, SO_ERROR, &socketError, &length) == 0)
+                result = socketError == 0 ? 0 : -1;
+        }
+
+        if (result == 0)
+        {
+            lwip_fcntl(fd, F_SETFL, lwip_fcntl(fd, F_GETFL, 0) & ~O_NONBLOCK);
+        }
+        else
+        {
+            lwip_close(fd);
+            fd = -1;
+        }
+    }
+    lwip_freeaddrinfo(address);
+    return fd;
+}
+
+void HttpOTADownloader::connect()
+{
+    if (connecting)
+        return;
+
+    // Collect the attempt handed to the connect task
+    if (connectPending)
+    {
+        connectPending = false;
+        int fd = connectSocket;
+        if (!connectStale && fd >= 0)
+        {
+            sendRequest(fd);
+            return;
+        }
+        if (fd >= 0)
+            lwip_close(fd);
+        if (!connectStale)
+        {
+            retry("Connection failed");
+            return;
+        }
+    }
+    connectStale = false;
+
+    if ((long)(millis() - retryAt) < 0)
+        return;
+
+    if (!connectHandle)
+    {
+        connectHandle = xTaskCreateStaticPinnedToCore(connectTask, "TaskOTAConnect", OTA_HTTP_CONNECT_TASK_STACK_SIZE,
+                                                      this, OTA_HTTP_CONNECT_TASK_PRIORITY, connectTaskStack,
+                                                      &connectTaskStruct, 0);
+    }
+
+    strcpy(connectHost, host);
+    connectPort = port;
+    connectSocket = -1;
+    connecting = true;
+    connectPending = true;
+    xTaskNotifyGive(connectHandle);
+}
+
+void HttpOTADownloader::sendRequest(int fd)
+{
+    client = NetworkClient(fd);
+    client.printf("GET %s HTTP/1.1\r\nHost: %s\r\nRange: bytes=%lu-\r\nConnection: close\r\n\r\n", path, host,
+                  (unsigned long)checkpoint.offset);
+
+    lineLength = 0;
+    statusCode = 0;
+    rangeStart = 0;
+    totalSize = 0;
+    skip = 0;
+    fill = 0;
+    lastDataTime = millis();
+    state = STATE_HEADERS;
+}
+
+void HttpOTADownloader::readHeaders()
+{
+    while (client.available())
+    {
+        char c = (char)client.read();
+        lastDataTime = millis();
+        if (c == '\r')
+            continue;
+        if (c != '\n')
+        {
+            // Overlong header lines are truncated; only the short ones matter here
+            if (lineLength < sizeof(line) - 1)
+                line[lineLength++] = c;
+            continue;
+        }
+
+        line[lineLength] = '\0';
+        bool headersDone = lineLength == 0;
+        lineLength = 0;
+        if (!headersDone)
+        {
+            parseHeaderLine();
+            continue;
+        }
+
+        if (statusCode != 200 && statusCode != 206)
+        {
+            LOG_ERROR(TAG, "HTTP status %d", statusCode);
+            fail("Unexpected HTTP status");
+            return;
+        }
+        if (totalSize == 0 || totalSize > partition->size)
+        {
+            fail("Image size missing or larger than the OTA partition");
+            return;
+        }
+
+        // The file changed on the server: start over instead of mixing two images
+        if (checkpoint.imageSize != 0 && checkpoint.imageSize != totalSize)
+        {
+            LOG_WARN(TAG, "Image size changed (%lu -> %lu), restarting", (unsigned long)checkpoint.imageSize,
+                     (unsigned long)totalSize);
+            checkpoint.offset = 0;
+            checkpoint.imageSize = 0;
+            lastCheckpointOffset = 0;
+            saveCheckpoint();
+            retry("Image changed");
+            return;
+        }
+
+        if (statusCode == 206 && rangeStart != checkpoint.offset)
+        {
+            retry("Unexpected range");
+            return;
+        }
+        skip = statusCode == 200 ? checkpoint.offset : 0;
+
+        if (checkpoint.imageSize == 0)
+        {
+            checkpoint.imageSize = totalSize;
+            saveCheckpoint();
+        }
+        state = STATE_BODY;
+        return;
+    }
+
+    if (!client.connected() || millis() - lastDataTime > OTA_HTTP_TIMEOUT_MS)
+        retry("No response");
+}
+
+void HttpOTADownloader::parseHeaderLine()
+{
+    if (statusCode == 0)
+    {
+        // Status line: HTTP/1.1 206 Partial Content
+        const char *space = strchr(line, ' ');
+        statusCode = space ? atoi(space + 1) : -1;
+        return;
+    }
+
+    if (strncasecmp(line, "Content-Range:", 14) == 0)
+    {
+        // Content-Range: bytes <start>-<end>/<total>
+        unsigned long start = 0, end = 0, total = 0;
+        if (sscanf(line + 14, " bytes %lu-%lu/%lu", &start, &end, &total) == 3)
+        {
+            rangeStart = start;
+            totalSize = total;
+        }
+    }
+    else if (strncasecmp(line, "Content-Length:", 15) == 0 && statusCode == 200)
+    {
+        totalSize = strtoul(line + 15, nullptr, 10);
+    }
+}
+
+void HttpOTADownloader::readBody()
+{
+    size_t budget = OTA_HTTP_SLICE_SIZE;
+    while (budget > 0 && client.available())
+    {
+        if (skip > 0)
+        {
+            int count = client.read(buffer, min((size_t)skip, sizeof(buffer)));
+            if (count <= 0)
+                break;
+            skip -= count;
+            budget -= min((size_t)count, budget);
+            continue;
+        }
+
+        size_t want = min(sizeof(buffer) - fill, (size_t)(checkpoint.imageSize - checkpoint.offset - fill));
+        int count = client.read(buffer + fill, want);
+        if (count <= 0)
+            break;
+        fill += count;
+        budget -= min((size_t)count, budget);
+        lastDataTime = millis();
+
+        if (fill < sizeof(buffer) && checkpoint.offset + fill < checkpoint.imageSize)
+            continue;
+
+        // One sector erase and write per pass; the rest waits in the socket for the next one
+        if (!flushSector())
+            return;
+        if (checkpoint.offset == checkpoint.imageSize)
+        {
+            client.stop();
+            saveCheckpoint();
+            startVerify();
+        }
+        return;
+    }
+
+    if (client.available())
+        return;
+    if (!client.connected())
+        retry("Connection lost");
+    else if (millis() - lastDataTime > OTA_HTTP_TIMEOUT_MS)
+        retry("Download stalled");
+}
+
+bool HttpOTADownloader::flushSector()
+{
+    // Sectors are always written whole from their start, so erase-then-write is safe to repeat
+    if (esp_partition_erase_range(partition, checkpoint.offset, OTA_HTTP_BUFFER_SIZE) != ESP_OK ||
+        esp_partition_write(partition, checkpoint.offset, buffer, fill) != ESP_OK)
+    {
+        fail("Flash write failed");
+        return false;
+    }
+
+    checkpoint.offset += fill;
+    fill = 0;
+    failures = 0;
+    retryDelay = OTA_HTTP_RETRY_MIN_MS;
+
+    if (checkpoint.offset - lastCheckpointOffset >= OTA_HTTP_CHECKPOINT_BYTES)
+        saveCheckpoint();
+    return true;
+}
+
+void HttpOTADownloader::startVerify()
+{
+    verifyOffset = 0;
+    if (checkpoint.digestLength == 16)
+    {
+        mbedtls_md5_init(&md5);
+        mbedtls_md5_starts(&md5);
+    }
+    else if (checkpoint.digestLength == 32)
+    {
+        mbedtls_sha256_init(&sha256);
+        mbedtls_sha256_starts(&sha256, 0);
+    }
+    state = STATE_VERIFY;
+}
+
+void HttpOTADownloader::verify()
+{
+    // Re-read what is on flash: covers the bytes written before a reboot as well
+    uint32_t end = min(verifyOffset + (uint32_t)OTA_HTTP_SLICE_SIZE, checkpoint.imageSize);
+    while (verifyOffset < end)
+    {
+        size_t count = min(sizeof(buffer), (size_t)(end - verifyOffset));
+        if (esp_partition_read(partition, verifyOffset, buffer, count) != ESP_OK)
+        {
+            fail("Flash read failed");
+            return;
+        }
+        if (checkpoint.digestLength == 16)
+            mbedtls_md5_update(&md5, buffer, count);
+        else if (checkpoint.digestLength == 32)
+            mbedtls_sha256_update(&sha256, buffer, count);
+        verifyOffset += count;
+    }
+
+    if (verifyOffset < checkpoint.imageSize)
+        return;
+
+    uint8_t digest[32];
+    if (checkpoint.digestLength == 16)
+    {
+        mbedtls_md5_finish(&md5, digest);
+        mbedtls_md5_free(&md5);
+    }
+    else if (checkpoint.digestLength == 32)
+    {
+        mbedtls_sha256_finish(&sha256, digest);
+        mbedtls_sha256_free(&sha256);
+    }
+
+    if (checkpoint.digestLength && memcmp(digest, checkpoint.digest, checkpoint.digestLength) != 0)
+    {
+        fail("Image digest mismatch");
+        return;
+    }
+
+    // Validates the image (header, checksum, appended hash) before switching
+    if (esp_ota_set_boot_partition(partition) != ESP_OK)
+    {
+        fail("Image validation failed");
+        return;
+    }
+
+    clearCheckpoint();
+    state = STATE_COMPLETE;
+}
+
+void HttpOTADownloader::retry(const char *reason)
+{
+    client.stop();
+    fill = 0;
+    saveCheckpoint();
+
+    // Give up for now but keep the checkpoint: a reboot or the same ota/url command resumes
+    if (++failures > OTA_HTTP_MAX_RETRIES)
+    {
+        error = reason;
+        state = STATE_FAILED;
+        return;
+    }
+
+    LOG_WARN(TAG, "%s at %lu/%lu bytes, retry %u in %lu ms", reason, (unsigned long)checkpoint.offset,
+             (unsigned long)checkpoint.imageSize, failures, retryDelay);
+    retryAt = millis() + retryDelay;
+    retryDelay = min(retryDelay * 2, (unsigned long)OTA_HTTP_RETRY_MAX_MS);
+    resumeCount++;
+    state = STATE_CONNECT;
+}
+
+void HttpOTADownloader::fail(const char *reason)
+{
+    client.stop();
+    if (state == STATE_VERIFY)
+    {
+        if (checkpoint.digestLength == 16)
+            mbedtls_md5_free(&md5);
+        else if (checkpoint.digestLength == 32)
+            mbedtls_sha256_free(&sha256);
+    }
+
+    error = reason;
+    checkpoint.magic = 0;
+    clearCheckpoint();
+    state = STATE_FAILED;
+}
+
+bool HttpOTADownloader::saveCheckpoint()
+{
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+        return false;
+
+    bool ok = nvs_set_blob(handle, NVS_KEY, &checkpoint, sizeof(checkpoint)) == ESP_OK && nvs_commit(handle) == ESP_OK;
+    nvs_close(handle);
+    if (ok)
+        lastCheckpointOffset = checkpoint.offset;
+    return ok;
+}
+
+void HttpOTADownloader::clearCheckpoint()
+{
+    nvs_handle_t handle;
+    if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &handle) != ESP_OK)
+        return;
+
+    nvs_erase_key(handle, NVS_KEY);
+    nvs_commit(handle);
+    nvs_close(handle);
+}
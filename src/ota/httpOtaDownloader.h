@@ -0,0 +1,156 @@
+#pragma once
+#ifndef __HTTPOTADOWNLOADER_H__
+#define __HTTPOTADOWNLOADER_H__
+
+#include <Arduino.h>
+#include <NetworkClient.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <mbedtls/md5.h>
+#include <mbedtls/sha256.h>
+
+#include "definitions.h"
+
+/*
+ * Resumable HTTP firmware download
+ *
+ * Alternative OTA transport to the MQTT topics (ota/update etc.): the image
+ * is fetched over plain HTTP/1.1 with "Range: bytes=<offset>-" requests and
+ * written sector by sector straight into the inactive OTA partition. Progress
+ * is checkpointed in NVS every OTA_HTTP_CHECKPOINT_BYTES, so a dropped link
+ * or a reboot resumes at the last checkpoint instead of starting over. An MQTT
+ * OTA that writes the slot discards the checkpoint (discardCheckpoint()).
+ *
+ * loop() does a bounded amount of work per call (at most one sector erased and
+ * written, or one slice of the final verification), so it runs from the
+ * service loop without holding the managers task. The name lookup and TCP
+ * connect, which block for up to OTA_HTTP_TIMEOUT_MS, run on a small task of
+ * their own; loop() picks up the socket once it is connected. Servers that
+ * ignore Range (200 instead of 206) still work: the already written prefix is
+ * skipped in the response.
+ *
+ * The digest passed to start() (MD5 or SHA-256, hex) is checked by re-reading
+ * the written partition, which also covers bytes written before a reboot;
+ * esp_ota_set_boot_partition then validates the image itself before the boot
+ * partition is switched.
+ */
+
+class HttpOTADownloader
+{
+public:
+    enum State : uint8_t
+    {
+        STATE_IDLE,
+        STATE_CONNECT,
+        STATE_HEADERS,
+        STATE_BODY,
+        STATE_VERIFY,
+        STATE_COMPLETE,
+        STATE_FAILED
+    };
+
+    HttpOTADownloader();
+
+    // Load a pending checkpoint; the download resumes on the next loop()
+    bool begin();
+
+    // url: http://host[:port]/path, digestHex: optional MD5/SHA-256 of the image.
+    // Restarting the same url/digest after a failure continues from the checkpoint.
+    bool start(const char *url, const char *digestHex);
+
+    // Advance the download; call while the network is up
+    void loop();
+
+    State getState() const { return state; }
+    bool isActive() const { return state != STATE_IDLE && state != STATE_COMPLETE && state != STATE_FAILED; }
+    const char *getError() const { return error; }
+    size_t getOffset() const { return checkpoint.offset + fill; }
+    size_t getImageSize() const { return checkpoint.imageSize; }
+    uint8_t getProgress() const;
+    uint32_t getResumeCount() const { return resumeCount; }
+
+    // Acknowledge COMPLETE/FAILED and return to idle
+    void clearResult() { state = STATE_IDLE; }
+
+    // The inactive slot is being written by another transport: forget any resume point
+    void discardCheckpoint();
+
+private:
+    struct Checkpoint
+    {
+        uint32_t magic;
+        uint32_t partitionAddress;
+        uint32_t imageSize;                 // 0 until the first response
+        uint32_t offset;                    // Bytes written to flash, sector aligned
+        uint8_t digest[32];
+        uint8_t digestLength;
+        char url[OTA_HTTP_URL_LENGTH];
+    };
+
+    static void connectTask(void *pvParameters);
+    static int openSocket(const char *host, uint16_t port);
+
+    bool parseUrl();
+    void restart();
+    void connect();
+    void sendRequest(int fd);
+    void readHeaders();
+    void parseHeaderLine();
+    void readBody();
+    bool flushSector();
+    void startVerify();
+    void verify();
+    void retry(const char *reason);
+    void fail(const char *reason);
+    bool saveCheckpoint();
+    void clearCheckpoint();
+
+    State state;
+    Checkpoint checkpoint;
+    const esp_partition_t *partition;
+    NetworkClient client;
+    const char *error;
+
+    // Parsed from checkpoint.url
+    char host[64];
+    uint16_t port;
+    const char *path;
+
+    // Connect task: resolves and connects connectHost:connectPort, leaves the socket in connectSocket
+    TaskHandle_t connectHandle;
+    volatile bool connecting;
+    volatile int connectSocket;
+    bool connectPending;                    // Attempt handed to the task and not collected yet
+    bool connectStale;                      // Attempt made for a request that was replaced since
+    char connectHost[64];
+    uint16_t connectPort;
+
+    // Response state
+    char line[OTA_HTTP_LINE_LENGTH];
+    size_t lineLength;
+    int statusCode;
+    uint32_t rangeStart;
+    uint32_t totalSize;
+    uint32_t skip;                          // Body bytes already on flash (server ignored Range)
+
+    // Sector being filled, flushed when full or at the end of the image
+    uint8_t buffer[OTA_HTTP_BUFFER_SIZE];
+    size_t fill;
+    uint32_t lastCheckpointOffset;
+    unsigned long lastDataTime;
+
+    // Reconnect with backoff; consecutive failures without progress give up
+    unsigned long retryAt;
+    unsigned long retryDelay;
+    uint8_t failures;
+    uint32_t resumeCount;
+
+    // Verification pass over the written partition
+    uint32_t verifyOffset;
+    mbedtls_md5_context md5;
+    mbedtls_sha256_context sha256;
+};
+
+#endif // __HTTPOTADOWNLOADER_H__
@@ -0,0 +1,315 @@
+#include "otaWriter.h"
+
+// Single writer per firmware: the chunks and the writer task are static
+static uint8_t chunkBuffers[OTA_CHUNK_COUNT][OTA_CHUNK_SIZE];
+static StaticQueue_t filledQueueStruct;
+static uint8_t filledQueueStorage[OTA_CHUNK_COUNT * sizeof(uint8_t)];
+static StaticSemaphore_t freeChunksStruct;
+static StaticTask_t writerTaskStruct;
+static StackType_t writerTaskStack[OTA_WRITER_TASK_STACK_SIZE];
+
+static int hexValue(char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    c |= 0x20;
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+OTAWriter::OTAWriter()
+    : active(false), failed(false), error(nullptr), imageSize(0), written(0), stallTime(0), fillIndex(0), chunkHeld(false),
+      fillLength(0), chunkLengths(), filledQueue(nullptr), freeChunks(nullptr), writerHandle(nullptr),
+      expectedDigest(), digestLength(DIGEST_NONE)
+{
+}
+
+size_t OTAWriter::parseDigest(const char *hex, uint8_t *digest)
+{
+    if (!hex)
+        return 0;
+
+    while (isspace((unsigned char)*hex))
+        hex++;
+    size_t length = 0;
+    while (hex[length] && !isspace((unsigned char)hex[length]))
+        length++;
+    if (length != 2 * DIGEST_MD5 && length != 2 * DIGEST_SHA256)
+        return 0;
+
+    for (size_t i = 0; i < length / 2; i++)
+    {
+        int high = hexValue(hex[2 * i]);
+        int low = hexValue(hex[2 * i + 1]);
+        if (high < 0 || low < 0)
+            return 0;
+        digest[i] = (uint8_t)(high << 4 | low);
+    }
+    return length / 2;
+}
+
+bool OTAWriter::setExpectedDigest(const char *hex)
+{
+    clearDigest();
+    uint8_t digest[32];
+    size_t length = parseDigest(hex, digest);
+    return length > 0 && setExpectedDigest(digest, length);
+}
+
+bool OTAWriter::setExpectedDigest(const uint8_t *digest, size_t length)
+{
+    clearDigest();
+    if (!digest || (length != DIGEST_MD5 && length != DIGEST_SHA256))
+        return false;
+
+    memcpy(expectedDigest, digest, length);
+    digestLength = (uint8_t)length;
+    return true;
+}
+
+void OTAWriter::clearDigest()
+{
+    digestLength = DIGEST_NONE;
+}
+
+bool OTAWriter::begin(size_t imageSize)
+{
+    if (active)
+        abort();
+
+    if (!writerHandle)
+    {
+        filledQueue = xQueueCreateStatic(OTA_CHUNK_COUNT, sizeof(uint8_t), filledQueueStorage, &filledQueueStruct);
+        freeChunks = xSemaphoreCreateCountingStatic(OTA_CHUNK_COUNT, OTA_CHUNK_COUNT, &freeChunksStruct);
+        writerHandle = xTaskCreateStaticPinnedToCore(writerTask, "TaskOTAWriter", OTA_WRITER_TASK_STACK_SIZE, this,
+                                                     OTA_WRITER_TASK_PRIORITY, writerTaskStack, &writerTaskStruct, 0);
+    }
+
+    this->imageSize = imageSize;
+    failed = false;
+    error = nullptr;
+    written = 0;
+    stallTime = 0;
+    fillIndex = 0;
+    chunkHeld = false;
+    fillLength = 0;
+
+    if (OTA_REQUIRE_DIGEST && !hasExpectedDigest())
+    {
+        fail("No image digest received");
+        return false;
+    }
+
+    if (!Update.begin(imageSize))
+    {
+        fail("Not enough space for update");
+        clearDigest();
+        return false;
+    }
+
+    if (digestLength == DIGEST_MD5)
+    {
+        mbedtls_md5_init(&md5);
+        mbedtls_md5_starts(&md5);
+    }
+    else if (digestLength == DIGEST_SHA256)
+    {
+        mbedtls_sha256_init(&sha256);
+        mbedtls_sha256_starts(&sha256, 0);
+    }
+
+    active = true;
+    return true;
+}
+
+uint8_t *OTAWriter::acquireChunk()
+{
+    if (!active || failed || chunkHeld)
+        return nullptr;
+
+    // Only blocks when the whole ring is waiting for flash
+    if (xSemaphoreTake(freeChunks, 0) != pdTRUE)
+    {
+        unsigned long waitStart = millis();
+        if (xSemaphoreTake(freeChunks, pdMS_TO_TICKS(OTA_WRITE_TIMEOUT_MS)) != pdTRUE)
+        {
+            fail("Flash writer stalled");
+            return nullptr;
+        }
+        stallTime += millis() - waitStart;
+    }
+
+    chunkHeld = true;
+    return chunkBuffers[fillIndex];
+}
+
+bool OTAWriter::submitChunk(size_t length)
+{
+    if (!chunkHeld || length > OTA_CHUNK_SIZE)
+        return false;
+
+    chunkLengths[fillIndex] = length;
+    chunkHeld = false;
+    xQueueSend(filledQueue, &fillIndex, portMAX_DELAY);
+    fillIndex = (fillIndex + 1) % OTA_CHUNK_COUNT;
+    return !failed;
+}
+
+bool OTAWriter::write(const uint8_t *data, size_t length)
+{
+    while (length > 0)
+    {
+        if (!chunkHeld)
+        {
+            if (!acquireChunk())
+                return false;
+            fillLength = 0;
+        }
+
+        size_t room = OTA_CHUNK_SIZE - fillLength;
+        size_t count = length < room ? length : room;
+        memcpy(chunkBuffers[fillIndex] + fillLength, data, count);
+        fillLength += count;
+        data += count;
+        length -= count;
+
+        if (fillLength == OTA_CHUNK_SIZE)
+        {
+            fillLength = 0;
+            if (!submitChunk(OTA_CHUNK_SIZE))
+                return false;
+        }
+    }
+    return !failed;
+}
+
+void OTAWriter::writerTask(void *pvParameters)
+{
+    OTAWriter *self = static_cast<OTAWriter *>(pvParameters);
+
+    for (;;)
+    {
+        uint8_t index;
+        if (xQueueReceive(self->filledQueue, &index, portMAX_DELAY) == pdTRUE)
+        {
+            self->writeChunk(index);
+            xSemaphoreGive(self->freeChunks);
+        }
+    }
+}
+
+void OTAWriter::writeChunk(uint8_t index)
+{
+    if (failed)
+        return;
+
+    const uint8_t *data = chunkBuffers[index];
+    size_t length = chunkLengths[index];
+
+    if (digestLength == DIGEST_MD5)
+        mbedtls_md5_update(&md5, data, length);
+    else if (digestLength == DIGEST_SHA256)
+        mbedtls_sha256_update(&sha256, data, length);
+
+    if (Update.write(const_cast<uint8_t *>(data), length) != length)
+    {
+        fail("Flash write failed");
+        return;
+    }
+    written += length;
+}
+
+void OTAWriter::waitForWrites()
+{
+    if (chunkHeld)
+    {
+        xSemaphoreGive(freeChunks);
+        chunkHeld = false;
+    }
+
+    // All chunks free means the writer task is idle
+    int taken = 0;
+    while (taken < OTA_CHUNK_COUNT && xSemaphoreTake(freeChunks, pdMS_TO_TICKS(OTA_WRITE_TIMEOUT_MS)) == pdTRUE)
+        taken++;
+    if (taken < OTA_CHUNK_COUNT)
+        fail("Flash writer stalled");
+    while (taken-- > 0)
+        xSemaphoreGive(freeChunks);
+}
+
+void OTAWriter::fail(const char *message)
+{
+    if (!failed)
+    {
+        error = message;
+        failed = true;
+    }
+}
+
+bool OTAWriter::finish()
+{
+    if (!active)
+        return false;
+
+    if (chunkHeld && fillLength > 0)
+    {
+        submitChunk(fillLength);
+        fillLength = 0;
+    }
+
+    waitForWrites();
+    if (!failed && written != imageSize)
+        fail("Image incomplete");
+
+    if (digestLength != DIGEST_NONE)
+    {
+        uint8_t digest[32];
+        if (digestLength == DIGEST_MD5)
+        {
+            mbedtls_md5_finish(&md5, digest);
+            mbedtls_md5_free(&md5);
+        }
+        else
+        {
+            mbedtls_sha256_finish(&sha256, digest);
+            mbedtls_sha256_free(&sha256);
+        }
+
+        // Rejected here, before Update.end could switch the boot partition
+        if (!failed && memcmp(digest, expectedDigest, digestLength) != 0)
+            fail("Image digest mismatch");
+    }
+
+    active = false;
+    clearDigest();
+
+    if (failed)
+    {
+        Update.abort();
+        return false;
+    }
+
+    if (!Update.end(true))
+    {
+        fail(Update.errorString());
+        return false;
+    }
+    return true;
+}
+
+void OTAWriter::abort()
+{
+    if (!active)
+        return;
+
+    waitForWrites();
+    if (digestLength == DIGEST_MD5)
+        mbedtls_md5_free(&md5);
+    else if (digestLength == DIGEST_SHA256)
+        mbedtls_sha256_free(&sha256);
+
+    Update.abort();
+    active = false;
+    clearDigest();
+}
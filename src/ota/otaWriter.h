@@ -0,0 +1,108 @@
+#pragma once
+#ifndef __OTAWRITER_H__
+#define __OTAWRITER_H__
+
+#include <Arduino.h>
+#include <Update.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
+#include <mbedtls/md5.h>
+#include <mbedtls/sha256.h>
+
+#include "definitions.h"
+
+/*
+ * Streaming OTA image writer
+ *
+ * The image is received into a bounded ring of OTA_CHUNK_COUNT statically
+ * allocated OTA_CHUNK_SIZE chunks. A low-priority writer task hashes and writes
+ * the filled ones to flash, so the receiving task never waits on a sector erase
+ * unless the whole ring is full, and nothing is allocated during the update:
+ *
+ *   uint8_t *chunk = writer.acquireChunk();    // blocks until a chunk is free
+ *   size_t n = source.read(chunk, OTA_CHUNK_SIZE);
+ *   writer.submitChunk(n);                      // queued for the writer task
+ *   ...
+ *   writer.finish();                            // verify digest, then Update.end
+ *
+ * Producers that generate the image (delta patcher, decompressor) use write()
+ * instead, which copies into the chunks and submits them as they fill up.
+ *
+ * The expected digest (hex MD5 or SHA-256, from the ota/md5 topic) is hashed
+ * incrementally; a mismatch aborts the update before Update.end, so a bad
+ * image is never marked bootable. The digest applies to one update only.
+ */
+
+class OTAWriter
+{
+public:
+    OTAWriter();
+
+    // 32 hex characters = MD5, 64 = SHA-256; false if the text is neither
+    bool setExpectedDigest(const char *hex);
+    // Raw 16-byte MD5 or 32-byte SHA-256 (e.g. from a delta patch header)
+    bool setExpectedDigest(const uint8_t *digest, size_t length);
+    bool hasExpectedDigest() const { return digestLength > 0; }
+
+    // Hex digest (surrounding whitespace ignored) to bytes; returns 16 (MD5), 32 (SHA-256) or 0
+    static size_t parseDigest(const char *hex, uint8_t *digest);
+
+    bool begin(size_t imageSize);
+    uint8_t *acquireChunk();
+    bool submitChunk(size_t length);
+
+    // Copying alternative to acquireChunk/submitChunk; the last partial chunk is submitted by finish()
+    bool write(const uint8_t *data, size_t length);
+
+    // Wait for pending writes, verify and finalize; false if the image was rejected
+    bool finish();
+    void abort();
+
+    bool isActive() const { return active; }
+    bool hasFailed() const { return failed; }
+    const char *getError() const { return error; }
+    size_t getWritten() const { return written; }
+    size_t getImageSize() const { return imageSize; }
+
+    // Time the receiving side spent waiting for a free chunk (flash slower than the link)
+    uint32_t getStallTime() const { return stallTime; }
+
+private:
+    enum DigestType : uint8_t
+    {
+        DIGEST_NONE = 0,
+        DIGEST_MD5 = 16,
+        DIGEST_SHA256 = 32
+    };
+
+    static void writerTask(void *pvParameters);
+    void writeChunk(uint8_t index);
+    void waitForWrites();
+    void fail(const char *message);
+    void clearDigest();
+
+    bool active;
+    volatile bool failed;
+    const char *error;
+    size_t imageSize;
+    volatile size_t written;
+    uint32_t stallTime;
+
+    // Chunk ring handed between the receiving task and the writer task
+    uint8_t fillIndex;
+    bool chunkHeld;
+    size_t fillLength;      // Bytes copied into the held chunk by write()
+    size_t chunkLengths[OTA_CHUNK_COUNT];
+    QueueHandle_t filledQueue;
+    SemaphoreHandle_t freeChunks;
+    TaskHandle_t writerHandle;
+
+    // Incremental integrity check
+    uint8_t expectedDigest[32];
+    uint8_t digestLength;
+    mbedtls_md5_context md5;
+    mbedtls_sha256_context sha256;
+};
+
+#endif // __OTAWRITER_H__
@@ -2,7 +2,15 @@
 
 BaseService::BaseService(const char* serviceName)
     : serviceName(serviceName), currentStatus(SERVICE_STOPPED), 
-      lastConnectionAttempt(0), statusChangeCallback(nullptr)
+      lastConnectionAttempt(0), statusChangeCallback(nullptr), retryDelay(0), retryFrom(0), connectedSince(0),
+      connectionAttempts(0),
+      statusMetric(METRICS_PREFIX "service_status",
+                   "0 stopped, 1 starting, 2 stopping, 3 connecting, 4 connected, 5 error, 6 not connected", "service",
+                   serviceName),
+      connectionAttemptsTotal(METRICS_PREFIX "service_connection_attempts", "Connection attempts since boot", "service",
+                              serviceName),
+      connectionFailures(METRICS_PREFIX "service_connection_failures", "Failed or lost connections since boot",
+                         "service", serviceName)
 {
 }
 
@@ -15,8 +23,22 @@ void BaseService::setStatus(ServiceStatus newStatus)
     if (currentStatus != newStatus)
     {
         LOG_DEBUG(serviceName, "Status change: %d -> %d", currentStatus, newStatus);
-        
+
+        ServiceStatus oldStatus = currentStatus;
         currentStatus = newStatus;
+        statusMetric.set(newStatus);
+
+        // A connection attempt failed or an established connection was lost
+        bool failed = (newStatus == SERVICE_ERROR || newStatus == SERVICE_NOT_CONNECTED);
+        bool wasFailed = (oldStatus == SERVICE_ERROR || oldStatus == SERVICE_NOT_CONNECTED);
+        if (newStatus == SERVICE_CONNECTED)
+        {
+            connectedSince = millis();
+        }
+        else if (failed && !wasFailed)
+        {
+            scheduleRetry(oldStatus == SERVICE_CONNECTED && millis() - connectedSince >= SERVICES_RETRY_STABLE_MS);
+        }
         
         // Call callback if set
         if (statusChangeCallback)
@@ -33,6 +55,9 @@ void BaseService::setStatus(ServiceStatus newStatus)
         case SERVICE_STARTING:
             LOG_DEBUG(serviceName, "Service status: STARTING");
             break;
+        case SERVICE_STOPPING:
+            LOG_DEBUG(serviceName, "Service status: STOPPING");
+            break;
         case SERVICE_CONNECTING:
             LOG_DEBUG(serviceName, "Service status: CONNECTING");
             break;
@@ -56,13 +81,36 @@ void BaseService::setStatusChangeCallback(std::function<void(ServiceStatus)> cal
 
 bool BaseService::canAttemptConnection()
 {
-    unsigned long now = millis();
-    // Allow immediate connection on first attempt (lastConnectionAttempt == 0)
-    // or after retry interval has passed
-    return (lastConnectionAttempt == 0) || ((now - lastConnectionAttempt) >= CONNECTION_RETRY_INTERVAL_MS);
+    // The first connection is immediate, later ones wait for the backoff delay
+    return retryDelay == 0 || millis() - retryFrom >= retryDelay;
 }
 
 void BaseService::updateLastConnectionAttempt()
 {
     lastConnectionAttempt = millis();
+    connectionAttempts++;
+    connectionAttemptsTotal.increment();
+}
+
+unsigned long BaseService::getNextAttemptIn() const
+{
+    unsigned long elapsed = millis() - retryFrom;
+    return (retryDelay == 0 || elapsed >= retryDelay) ? 0 : retryDelay - elapsed;
+}
+
+void BaseService::scheduleRetry(bool wasStable)
+{
+    if (wasStable)
+    {
+        retryDelay = 0;
+        connectionAttempts = 0;
+    }
+
+    // Decorrelated jitter: random(base, 3 x previous), capped
+    unsigned long upper = max((unsigned long)SERVICES_RETRY_BASE_MS, retryDelay) * 3;
+    retryDelay = min((unsigned long)SERVICES_RETRY_CAP_MS, (unsigned long)random(SERVICES_RETRY_BASE_MS, upper + 1));
+    retryFrom = millis();
+    connectionFailures.increment();
+
+    LOG_INFO(serviceName, "Reconnecting in %lu ms (attempt %lu)", retryDelay, (unsigned long)connectionAttempts + 1);
 }
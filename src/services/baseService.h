@@ -5,6 +5,7 @@
 #include <functional>
 #include <Arduino.h>
 #include "managers/loggingManager.h"
+#include "metrics/metricsRegistry.h"
 #include "definitions.h"
 
 // Base service status
@@ -42,11 +43,22 @@ public:
     // Service information
     const char* getServiceName() const { return serviceName; }
 
+    // Reconnect backoff (diagnostics)
+    uint32_t getConnectionAttempts() const { return connectionAttempts; }
+    uint32_t getConnectionFailures() const { return connectionFailures.get(); }
+    unsigned long getRetryDelay() const { return retryDelay; }
+    unsigned long getNextAttemptIn() const;
+
 protected:
     // Status management for derived classes
     void setStatus(ServiceStatus newStatus);
     
-    // Connection management
+    // Connection management. Failed connections are retried with exponential
+    // backoff and decorrelated jitter: each delay is drawn from
+    // [SERVICES_RETRY_BASE_MS, 3 x previous delay] and capped at
+    // SERVICES_RETRY_CAP_MS, so a fleet that lost the broker at the same moment
+    // spreads its reconnects instead of retrying in lockstep. A connection that
+    // stayed up for SERVICES_RETRY_STABLE_MS starts over from the base delay.
     virtual bool canAttemptConnection();
     void updateLastConnectionAttempt();
 
@@ -57,7 +69,17 @@ protected:
     std::function<void(ServiceStatus)> statusChangeCallback;
 
 private:
-    static const unsigned long CONNECTION_RETRY_INTERVAL_MS = 30000; // 30 seconds
+    void scheduleRetry(bool wasStable);
+
+    unsigned long retryDelay;               // 0 until the first failure
+    unsigned long retryFrom;                // Time of the last failure
+    unsigned long connectedSince;
+    uint32_t connectionAttempts;            // Since the last stable connection
+
+    // Metrics, labelled with the service name
+    MetricGauge statusMetric;
+    MetricCounter connectionAttemptsTotal;
+    MetricCounter connectionFailures;       // Since boot
 };
 
 #endif // __BASE_SERVICE_H__
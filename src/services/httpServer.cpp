@@ -0,0 +1,428 @@
+#include "httpServer.h"
+#include "managers/loggingManager.h"
+#include "metrics/metricsRegistry.h"
+#include "telemetry/telemetryHub.h"
+#include <LittleFS.h>
+#include <lwip/sockets.h>
+
+static const char *TAG = "HttpServer";
+
+static const char *METRICS_CONTENT_TYPE = "application/openmetrics-text; version=1.0.0; charset=utf-8";
+
+static MetricCounter requestsOk(METRICS_PREFIX "http_requests", "HTTP requests by status code", "code", "200");
+static MetricCounter requestsNotFound(METRICS_PREFIX "http_requests", "HTTP requests by status code", "code", "404");
+static MetricCounter requestsNotAllowed(METRICS_PREFIX "http_requests", "HTTP requests by status code", "code", "405");
+static MetricCounter requestsTimedOut(METRICS_PREFIX "http_requests", "HTTP requests by status code", "code", "408");
+static MetricCounter requestsUnavailable(METRICS_PREFIX "http_requests", "HTTP requests by status code", "code", "503");
+static MetricGauge eventStreams(METRICS_PREFIX "http_event_streams", "Open /events streams");
+static MetricCounter eventStreamsClosed(METRICS_PREFIX "http_event_streams_closed", "Event streams closed (client gone or too slow)");
+
+// Time to serve a request once its headers arrived (microseconds, exposed in seconds)
+static const uint32_t RESPONSE_BOUNDS_US[] = {1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 1000000};
+static MetricHistogram responseTime(METRICS_PREFIX "http_response_seconds", "Time to write an HTTP response",
+                                    RESPONSE_BOUNDS_US, sizeof(RESPONSE_BOUNDS_US) / sizeof(RESPONSE_BOUNDS_US[0]),
+                                    1000000);
+
+HttpServer::ClientWriter::ClientWriter(NetworkClient &client, char *buffer, size_t size)
+    : client(client), buffer(buffer), size(size), used(0), error(false)
+{
+}
+
+size_t HttpServer::ClientWriter::write(const uint8_t *data, size_t length)
+{
+    size_t written = 0;
+    while (!error && written < length)
+    {
+        size_t chunk = min(length - written, size - used);
+        memcpy(buffer + used, data + written, chunk);
+        used += chunk;
+        written += chunk;
+        if (used == size)
+            flush();
+    }
+    return error ? 0 : written;
+}
+
+void HttpServer::ClientWriter::flush()
+{
+    if (used == 0 || error)
+        return;
+
+    if (client.write((const uint8_t *)buffer, used) != used)
+        error = true;
+    used = 0;
+}
+
+HttpServer::HttpServer()
+    : server(HTTP_SERVER_PORT), networkUp(false), listening(false), eventSequence(0), lastEventTime(0),
+      lastStatusTime(0), statusLength(0)
+{
+    for (bool &open : eventOpen)
+        open = false;
+    request[0] = '\0';
+    status[0] = '\0';
+}
+
+void HttpServer::begin()
+{
+    xTaskCreatePinnedToCore(serverTask, "TaskHttpServer", HTTP_SERVER_TASK_STACK_SIZE, this, HTTP_SERVER_TASK_PRIORITY,
+                            NULL, 1);
+}
+
+void HttpServer::serverTask(void *parameter)
+{
+    static_cast<HttpServer *>(parameter)->run();
+}
+
+void HttpServer::run()
+{
+    for (;;)
+    {
+        if (!listening)
+        {
+            if (!networkUp.load(std::memory_order_relaxed))
+            {
+                vTaskDelay(pdMS_TO_TICKS(500));
+                continue;
+            }
+
+            // Bound to all addresses, so it keeps listening across link and DHCP changes
+            server.begin();
+            server.setNoDelay(true);
+            listening = true;
+            LOG_INFO(TAG, "Listening on port %d", HTTP_SERVER_PORT);
+
+            // Normally mounted already by the telemetry store; a no-op then
+            if (!LittleFS.begin(false, "/littlefs", 8, "littlefs"))
+                LOG_WARN(TAG, "LittleFS mount failed - dashboard unavailable");
+        }
+
+        updateEventStreams();
+
+        NetworkClient client = server.accept();
+        if (!client)
+        {
+            vTaskDelay(pdMS_TO_TICKS(HTTP_SERVER_POLL_INTERVAL_MS));
+            continue;
+        }
+
+        // Event streams stay open and are served from updateEventStreams()
+        if (!handleClient(client))
+            client.stop();
+    }
+}
+
+size_t HttpServer::getEventClientCount() const
+{
+    size_t count = 0;
+    for (bool open : eventOpen)
+    {
+        if (open)
+            count++;
+    }
+    return count;
+}
+
+// Returns true when the client became an event stream and must stay open
+bool HttpServer::handleClient(NetworkClient &client)
+{
+    // A client that stops reading fails the write instead of blocking the task
+    timeval timeout = {HTTP_SERVER_REQUEST_TIMEOUT_MS / 1000, (HTTP_SERVER_REQUEST_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(client.fd(), SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    if (!readRequest(client))
+    {
+        requestsTimedOut.increment();
+        sendError(client, 408, "Request Timeout");
+        return false;
+    }
+
+    // "<method> <path>[?query] HTTP/1.1"
+    char *method = request;
+    char *path = strchr(method, ' ');
+    if (!path)
+    {
+        requestsNotAllowed.increment();
+        sendError(client, 405, "Method Not Allowed");
+        return false;
+    }
+    *path++ = '\0';
+    path[strcspn(path, " ?\r\n")] = '\0';
+
+    uint32_t start = micros();
+    bool stream = false;
+    if (strcmp(method, "GET") != 0)
+    {
+        requestsNotAllowed.increment();
+        sendError(client, 405, "Method Not Allowed");
+    }
+    else if (strcmp(path, "/") == 0 || strcmp(path, "/index.html") == 0)
+    {
+        sendDashboard(client);
+    }
+    else if (strcmp(path, "/events") == 0)
+    {
+        stream = openEventStream(client);
+    }
+    else if (strcmp(path, "/api/telemetry") == 0)
+    {
+        requestsOk.increment();
+        size_t length = telemetryHub.copyJson(eventBuffer, sizeof(eventBuffer));
+        sendJson(client, length ? eventBuffer : "{}", length ? length : 2);
+    }
+    else if (strcmp(path, "/api/status") == 0)
+    {
+        requestsOk.increment();
+        size_t length = statusWriter ? statusWriter(statusCandidate, sizeof(statusCandidate)) : 0;
+        sendJson(client, length ? statusCandidate : "{}", length ? length : 2);
+    }
+    else if (strcmp(path, "/api/channels") == 0)
+    {
+        requestsOk.increment();
+        sendChannels(client);
+    }
+    else if (strcmp(path, "/metrics") == 0)
+    {
+        requestsOk.increment();
+        sendMetrics(client);
+    }
+    else
+    {
+        requestsNotFound.increment();
+        sendError(client, 404, "Not Found");
+    }
+    responseTime.observe(micros() - start);
+    return stream;
+}
+
+bool HttpServer::readRequest(NetworkClient &client)
+{
+    // Only the request line matters; headers that do not fit are left unread
+    size_t length = 0;
+    request[0] = '\0';
+    unsigned long start = millis();
+    while (millis() - start < HTTP_SERVER_REQUEST_TIMEOUT_MS)
+    {
+        int available = client.available();
+        if (available <= 0)
+        {
+            if (!client.connected())
+                return false;
+            vTaskDelay(pdMS_TO_TICKS(5));
+            continue;
+        }
+
+        size_t room = sizeof(request) - 1 - length;
+        int count = client.read((uint8_t *)request + length, min((size_t)available, room));
+        if (count <= 0)
+            return false;
+        length += count;
+        request[length] = '\0';
+
+        if (strstr(request, "\r\n\r\n"))
+            return true;
+        if (length == sizeof(request) - 1)
+            return strstr(request, "\r\n") != nullptr;
+    }
+    return false;
+}
+
+// extraHeaders: complete header lines, each ending in "\r\n"
+void HttpServer::sendHeader(Print &out, int code, const char *reason, const char *contentType, const char *extraHeaders)
+{
+    out.printf("HTTP/1.1 %d %s\r\nContent-Type: %s\r\nCache-Control: no-store\r\nConnection: close\r\n%s\r\n", code,
+               reason, contentType, extraHeaders);
+}
+
+void HttpServer::sendError(NetworkClient &client, int code, const char *reason)
+{
+    ClientWriter out(client, writeBuffer, sizeof(writeBuffer));
+    sendHeader(out, code, reason, "text/plain");
+    out.printf("%d %s\n", code, reason);
+}
+
+void HttpServer::sendJson(NetworkClient &client, const char *json, size_t length)
+{
+    ClientWriter out(client, writeBuffer, sizeof(writeBuffer));
+    sendHeader(out, 200, "OK", "application/json");
+    out.write((const uint8_t *)json, length);
+}
+
+void HttpServer::sendDashboard(NetworkClient &client)
+{
+    File file = LittleFS.open(HTTP_SERVER_DASHBOARD_FILE, "r");
+    if (!file)
+    {
+        requestsNotFound.increment();
+        ClientWriter out(client, writeBuffer, sizeof(writeBuffer));
+        sendHeader(out, 404, "Not Found", "text/plain");
+        out.print("Dashboard not installed - upload the LittleFS image (pio run -t uploadfs)\n");
+        return;
+    }
+
+    // Stored pre-compressed; every browser accepts gzip, so it is sent as it is
+    requestsOk.increment();
+    char headers[64];
+    snprintf(headers, sizeof(headers), "Content-Encoding: gzip\r\nContent-Length: %u\r\n", (unsigned)file.size());
+    ClientWriter out(client, writeBuffer, sizeof(writeBuffer));
+    sendHeader(out, 200, "OK", "text/html; charset=utf-8", headers);
+    out.flush();
+
+    // Large chunks go straight to the socket; the event buffer is free between polls
+    size_t count;
+    while (!out.failed() && (count = file.read((uint8_t *)eventBuffer, sizeof(eventBuffer))) > 0)
+    {
+        if (client.write((const uint8_t *)eventBuffer, count) != count)
+            break;
+    }
+    file.close();
+}
+
+void HttpServer::sendChannels(NetworkClient &client)
+{
+    ClientWriter out(client, writeBuffer, sizeof(writeBuffer));
+    sendHeader(out, 200, "OK", "application/json");
+    out.print("{\"channels\":[");
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        const DSEChannel &channel = DSE_CHANNELS[i];
+        out.printf("%s{\"name\":\"%s\",\"unit\":\"%s\"}", i ? "," : "", channel.name, channel.unit);
+    }
+    out.print("]}");
+}
+
+void HttpServer::sendMetrics(NetworkClient &client)
+{
+    ClientWriter out(client, writeBuffer, sizeof(writeBuffer));
+    sendHeader(out, 200, "OK", METRICS_CONTENT_TYPE);
+    metricsRegistry.write(out);
+    out.flush();
+    if (out.failed())
+        LOG_WARN(TAG, "Metrics response aborted - client stopped reading");
+}
+
+// Server-Sent Events ------------------------------------------------------------------------
+
+bool HttpServer::openEventStream(NetworkClient &client)
+{
+    size_t slot = 0;
+    while (slot < HTTP_SERVER_EVENT_CLIENTS && eventOpen[slot])
+        slot++;
+    if (slot == HTTP_SERVER_EVENT_CLIENTS)
+    {
+        requestsUnavailable.increment();
+        ClientWriter out(client, writeBuffer, sizeof(writeBuffer));
+        sendHeader(out, 503, "Service Unavailable", "text/plain", "Retry-After: 10\r\n");
+        out.print("Too many event streams\n");
+        return false;
+    }
+    requestsOk.increment();
+
+    // A stream that stops reading fails the next write instead of blocking the others
+    timeval timeout = {HTTP_SERVER_EVENT_SEND_TIMEOUT_MS / 1000, (HTTP_SERVER_EVENT_SEND_TIMEOUT_MS % 1000) * 1000};
+    setsockopt(client.fd(), SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+    // The current state first, so the page fills in without waiting for the next update
+    {
+        ClientWriter out(client, writeBuffer, sizeof(writeBuffer));
+        sendHeader(out, 200, "OK", "text/event-stream");
+        out.print("retry: 3000\n\n");
+        out.flush();
+        if (out.failed())
+            return false;
+    }
+    size_t length = telemetryHub.copyJson(eventBuffer, sizeof(eventBuffer));
+    if (length && !sendEvent(client, "telemetry", eventBuffer, length))
+        return false;
+    if (refreshStatus())
+        broadcastEvent("status", status, statusLength);   // The open streams missed the change too
+    if (statusLength && !sendEvent(client, "status", status, statusLength))
+        return false;
+
+    eventClients[slot] = client;
+    eventOpen[slot] = true;
+    eventStreams.set(getEventClientCount());
+    LOG_INFO(TAG, "Event stream opened (%u active)", (unsigned)getEventClientCount());
+    return true;
+}
+
+void HttpServer::updateEventStreams()
+{
+    if (getEventClientCount() == 0)
+        return;
+
+    unsigned long now = millis();
+    uint32_t sequence = telemetryHub.getSequence();
+    if (sequence != eventSequence)
+    {
+        uint32_t copied = 0;
+        size_t length = telemetryHub.copyJson(eventBuffer, sizeof(eventBuffer), &copied);
+        eventSequence = copied;
+        if (length)
+            broadcastEvent("telemetry", eventBuffer, length);
+    }
+
+    if (now - lastStatusTime >= HTTP_SERVER_STATUS_INTERVAL_MS)
+    {
+        lastStatusTime = now;
+        if (refreshStatus())
+            broadcastEvent("status", status, statusLength);
+    }
+
+    // Comment line so proxies and browsers keep idle streams open
+    if (now - lastEventTime >= HTTP_SERVER_EVENT_KEEPALIVE_MS)
+        broadcastEvent(nullptr, nullptr, 0);
+}
+
+// Rebuilds the status; returns its length when it differs from the last one sent, otherwise 0
+size_t HttpServer::refreshStatus()
+{
+    if (!statusWriter)
+        return 0;
+
+    size_t length = statusWriter(statusCandidate, sizeof(statusCandidate));
+    if (length == 0 || (length == statusLength && memcmp(statusCandidate, status, length) == 0))
+        return 0;
+
+    memcpy(status, statusCandidate, length);
+    statusLength = length;
+    return length;
+}
+
+// event nullptr: keepalive comment
+bool HttpServer::sendEvent(NetworkClient &client, const char *event, const char *data, size_t length)
+{
+    ClientWriter out(client, writeBuffer, sizeof(writeBuffer));
+    if (event)
+    {
+        out.printf("event: %s\ndata: ", event);
+        out.write((const uint8_t *)data, length);
+        out.print("\n\n");
+    }
+    else
+    {
+        out.print(": keepalive\n\n");
+    }
+    out.flush();
+    return !out.failed();
+}
+
+void HttpServer::broadcastEvent(const char *event, const char *data, size_t length)
+{
+    lastEventTime = millis();
+    for (size_t i = 0; i < HTTP_SERVER_EVENT_CLIENTS; i++)
+    {
+        if (!eventOpen[i])
+            continue;
+
+        NetworkClient &client = eventClients[i];
+        if (!client.connected() || !sendEvent(client, event, data, length))
+        {
+            client.stop();
+            eventOpen[i] = false;
+            eventStreams.set(getEventClientCount());
+            eventStreamsClosed.increment();
+            LOG_INFO(TAG, "Event stream closed (%u active)", (unsigned)getEventClientCount());
+        }
+    }
+}
@@ -0,0 +1,111 @@
+#pragma once
+#ifndef __HTTPSERVER_H__
+#define __HTTPSERVER_H__
+
+#include <Arduino.h>
+#include <NetworkServer.h>
+#include <NetworkClient.h>
+#include <atomic>
+#include <functional>
+
+#include "definitions.h"
+
+/*
+ * Minimal HTTP/1.1 server on the Ethernet interface (HTTP_SERVER_PORT)
+ *
+ *   GET /               on-site dashboard, served gzip-compressed as stored on
+ *                       LittleFS (HTTP_SERVER_DASHBOARD_FILE)
+ *   GET /events         Server-Sent Events: "telemetry" with the telemetry hub
+ *                       JSON on every Modbus update, "status" when the device
+ *                       status changed
+ *   GET /api/telemetry  the last telemetry JSON
+ *   GET /api/status     device status JSON (see setStatusWriter())
+ *   GET /api/channels   channel names and units
+ *   GET /metrics        device metrics as OpenMetrics text (see metrics/metricsRegistry.h)
+ *
+ * It runs on its own low-priority task, so a slow or stalled client can never
+ * hold up the managers task or Modbus acquisition. Requests are served one at
+ * a time: the request line and headers are read into a fixed buffer, and the
+ * response is formatted straight into the socket through a small write buffer.
+ * At most HTTP_SERVER_EVENT_CLIENTS event streams stay open; each event is
+ * copied once from the telemetry hub and written to every stream, and a stream
+ * that cannot take it within HTTP_SERVER_EVENT_SEND_TIMEOUT_MS is closed.
+ * Nothing is allocated per request or per event.
+ */
+
+class HttpServer
+{
+public:
+    HttpServer();
+
+    // Creates the server task; listening starts once the network is up
+    void begin();
+
+    // Managers task
+    void setNetworkUp(bool up) { networkUp.store(up, std::memory_order_relaxed); }
+
+    // Before begin(): writes the status JSON, called on the server task; returns the length
+    void setStatusWriter(std::function<size_t(char *buffer, size_t size)> writer) { statusWriter = writer; }
+
+    bool isListening() const { return listening; }
+    size_t getEventClientCount() const;
+
+private:
+    // Buffered Print over the client socket
+    class ClientWriter : public Print
+    {
+    public:
+        ClientWriter(NetworkClient &client, char *buffer, size_t size);
+        ~ClientWriter() { flush(); }
+
+        size_t write(uint8_t byte) override { return write(&byte, 1); }
+        size_t write(const uint8_t *data, size_t length) override;
+        void flush() override;
+        bool failed() const { return error; }
+
+    private:
+        NetworkClient &client;
+        char *buffer;
+        size_t size;
+        size_t used;
+        bool error;
+    };
+
+    static void serverTask(void *parameter);
+    void run();
+    bool handleClient(NetworkClient &client);
+    bool readRequest(NetworkClient &client);
+    void sendHeader(Print &out, int code, const char *reason, const char *contentType, const char *extraHeaders = "");
+    void sendError(NetworkClient &client, int code, const char *reason);
+    void sendJson(NetworkClient &client, const char *json, size_t length);
+    void sendDashboard(NetworkClient &client);
+    void sendChannels(NetworkClient &client);
+    void sendMetrics(NetworkClient &client);
+
+    // Server-Sent Events
+    bool openEventStream(NetworkClient &client);
+    void updateEventStreams();
+    bool sendEvent(NetworkClient &client, const char *event, const char *data, size_t length);
+    void broadcastEvent(const char *event, const char *data, size_t length);
+    size_t refreshStatus();
+
+    NetworkServer server;
+    std::atomic<bool> networkUp;
+    bool listening;
+    std::function<size_t(char *buffer, size_t size)> statusWriter;
+
+    NetworkClient eventClients[HTTP_SERVER_EVENT_CLIENTS];
+    bool eventOpen[HTTP_SERVER_EVENT_CLIENTS];
+    uint32_t eventSequence;                 // Telemetry hub sequence last sent to the streams
+    unsigned long lastEventTime;
+    unsigned long lastStatusTime;
+    size_t statusLength;
+
+    char request[HTTP_SERVER_REQUEST_SIZE];
+    char writeBuffer[HTTP_SERVER_WRITE_BUFFER_SIZE];
+    char eventBuffer[TELEMETRY_JSON_SIZE];  // Telemetry JSON copy, also the file read buffer
+    char status[HTTP_SERVER_STATUS_SIZE];   // Last status sent
+    char statusCandidate[HTTP_SERVER_STATUS_SIZE];
+};
+
+#endif // __HTTPSERVER_H__
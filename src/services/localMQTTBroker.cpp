@@ -0,0 +1,156 @@
+#include "localMQTTBroker.h"
+#include "managers/loggingManager.h"
+#include "managers/managerEvents.h"
+#include "utils/jsonStreamWriter.h"
+
+static const char *TAG = "LocalBroker";
+
+static const char *modbusStatusName(ModbusMonitorStatus status)
+{
+    switch (status)
+    {
+    case MODBUS_INACTIVE: return "INACTIVE";
+    case MODBUS_ACTIVE: return "ACTIVE";
+    case MODBUS_VALID: return "VALID";
+    case MODBUS_INVALID: return "INVALID";
+    }
+    return "UNKNOWN";
+}
+
+LocalMQTTBroker::LocalMQTTBroker()
+    : PicoMQTT::Server(LOCAL_BROKER_PORT), running(false), clientCount(0), republishAll(false),
+      publishedSequence(0), publishedStatus(MODBUS_INACTIVE), messagesPublished(0)
+{
+}
+
+void LocalMQTTBroker::update(bool networkUp, ModbusMonitorStatus modbusStatus)
+{
+    if (!running)
+    {
+        if (!networkUp)
+        {
+            return;
+        }
+
+        // Bound to all addresses, so it keeps listening across link and DHCP changes
+        begin();
+        running = true;
+        republishAll = true;
+
+        // The listening socket and every accepted connection share the port
+        managerEvents.watchPort(LOCAL_BROKER_PORT);
+        LOG_INFO(TAG, "Listening on port %d (max %d clients)", LOCAL_BROKER_PORT, LOCAL_BROKER_MAX_CLIENTS);
+    }
+
+    // Accept connections and read client packets
+    loop();
+
+    if (clientCount == 0)
+    {
+        // Nothing to deliver; a new subscriber gets everything anyway
+        telemetryHub.takeChanged();
+        publishedSequence = telemetryHub.getSequence();
+        publishedStatus = modbusStatus;
+        republishAll = false;
+        return;
+    }
+
+    bool all = republishAll;
+    republishAll = false;
+    if (all || telemetryHub.getSequence() != publishedSequence)
+    {
+        publishTelemetry(all);
+    }
+    if (all || modbusStatus != publishedStatus)
+    {
+        publishStatus(modbusStatus);
+    }
+}
+
+void LocalMQTTBroker::publishTelemetry(bool all)
+{
+    publishedSequence = telemetryHub.getSequence();
+    if (publishedSequence == 0)
+    {
+        return;
+    }
+
+    // Text was formatted once by the hub; only channels changed since the last publish unless a client just subscribed
+    uint64_t changed = telemetryHub.takeChanged();
+    uint8_t pageMask = telemetryHub.getPageMask();
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        bool valid = dseChannelValid(DSE_CHANNELS[i], pageMask);
+        if ((changed & (1ULL << i)) || (all && valid))
+        {
+            const char *text = telemetryHub.getText(i);
+            publishTopic(DSE_CHANNELS[i].name, text, strlen(text));
+        }
+    }
+
+    if (telemetryHub.getJsonLength() > 0)
+    {
+        publishTopic("snapshot", telemetryHub.getJson(), telemetryHub.getJsonLength());
+    }
+}
+
+void LocalMQTTBroker::publishStatus(ModbusMonitorStatus modbusStatus)
+{
+    publishedStatus = modbusStatus;
+
+    char payload[96];
+    JsonStreamWriter json(payload, sizeof(payload));
+    json.beginObject();
+    json.key("modbus");
+    json.value(modbusStatusName(modbusStatus));
+    json.key("pages");
+    json.value(telemetryHub.getPageMask());
+    json.key("seq");
+    json.value(telemetryHub.getSequence());
+    json.endObject();
+
+    if (!json.overflowed())
+    {
+        publishTopic("status", payload, json.length());
+    }
+}
+
+void LocalMQTTBroker::publishTopic(const char *suffix, const char *payload, size_t length)
+{
+    char topic[LOCAL_BROKER_TOPIC_LENGTH];
+    snprintf(topic, sizeof(topic), "%s/%s", LOCAL_BROKER_TOPIC_PREFIX, suffix);
+    publish(topic, (const void *)payload, length);
+    messagesPublished++;
+}
+
+PicoMQTT::ConnectReturnCode LocalMQTTBroker::auth(const char *client_id, const char *username, const char *password)
+{
+    if (clientCount >= LOCAL_BROKER_MAX_CLIENTS)
+    {
+        LOG_WARN(TAG, "Refused %s - %d clients connected", client_id, (int)clientCount);
+        return PicoMQTT::CRC_SERVER_UNAVAILABLE;
+    }
+    return PicoMQTT::CRC_ACCEPTED;
+}
+
+void LocalMQTTBroker::on_connected(const char *client_id)
+{
+    clientCount++;
+    LOG_INFO(TAG, "Client connected: %s (%d)", client_id, (int)clientCount);
+}
+
+void LocalMQTTBroker::on_disconnected(const char *client_id)
+{
+    if (clientCount > 0)
+    {
+        clientCount--;
+    }
+    LOG_INFO(TAG, "Client disconnected: %s (%d)", client_id, (int)clientCount);
+}
+
+void LocalMQTTBroker::on_subscribe(const char *client_id, const char *topic)
+{
+    // Stand-in for retained messages: the last values go out on the next update
+    republishAll = true;
+    LOG_DEBUG(TAG, "%s subscribed to %s", client_id, topic);
+}
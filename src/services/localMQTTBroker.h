@@ -0,0 +1,59 @@
+#pragma once
+#ifndef __LOCALMQTTBROKER_H__
+#define __LOCALMQTTBROKER_H__
+
+#include <PicoMQTT.h>
+
+#include "definitions.h"
+#include "telemetry/telemetryHub.h"
+
+/*
+ * On-device MQTT broker for LAN consumers
+ *
+ * On-site HMIs and PLC gateways subscribe on the Ethernet interface
+ * (LOCAL_BROKER_PORT) instead of going through the cloud. Each telemetry hub
+ * update is republished in the same managers pass, using the text and JSON the
+ * hub already produced:
+ *   genset/<channel>   real value of a changed channel, e.g. genset/oilPressure "412"
+ *                      ("" once its register page is no longer valid)
+ *   genset/snapshot    every valid channel as one JSON object (see TelemetryHub)
+ *   genset/status      {"modbus":"VALID","pages":15,"seq":12}
+ *
+ * PicoMQTT's broker keeps no retained messages, so the last values are
+ * republished whenever a client subscribes; existing subscribers then receive
+ * them again, which is harmless for last-value topics. At most
+ * LOCAL_BROKER_MAX_CLIENTS clients are accepted at a time.
+ */
+
+class LocalMQTTBroker : public PicoMQTT::Server
+{
+public:
+    LocalMQTTBroker();
+
+    // Managers task: starts listening once the network is up, then publishes new telemetry
+    void update(bool networkUp, ModbusMonitorStatus modbusStatus);
+
+    bool isRunning() const { return running; }
+    size_t getClientCount() const { return clientCount; }
+    uint32_t getMessagesPublished() const { return messagesPublished; }
+
+protected:
+    PicoMQTT::ConnectReturnCode auth(const char *client_id, const char *username, const char *password) override;
+    void on_connected(const char *client_id) override;
+    void on_disconnected(const char *client_id) override;
+    void on_subscribe(const char *client_id, const char *topic) override;
+
+private:
+    void publishTelemetry(bool all);
+    void publishStatus(ModbusMonitorStatus modbusStatus);
+    void publishTopic(const char *suffix, const char *payload, size_t length);
+
+    bool running;
+    size_t clientCount;
+    bool republishAll;                      // A client subscribed since the last publish
+    uint32_t publishedSequence;             // Telemetry hub sequence last published
+    ModbusMonitorStatus publishedStatus;
+    uint32_t messagesPublished;
+};
+
+#endif // __LOCALMQTTBROKER_H__
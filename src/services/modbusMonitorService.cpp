@@ -1,11 +1,15 @@
 #include "services/modbusMonitorService.h"
 #include "managers/loggingManager.h"
+#include "managers/managerEvents.h"
 
 static const char *TAG = "ModbusMonitorService";
 
 // Static instance pointer
 ModbusMonitorService *ModbusMonitorService::instance = nullptr;
 
+// Request to response time (milliseconds, exposed in seconds)
+static const uint32_t RESPONSE_BOUNDS_MS[] = {25, 50, 100, 200, 400, 600, 800, 1000};
+
 ModbusMonitorService::ModbusMonitorService()
     : BaseService("ModbusMonitor"),
       modbusClient(nullptr),
@@ -14,9 +18,13 @@ ModbusMonitorService::ModbusMonitorService()
       modbusStatus(MODBUS_INACTIVE),
       lastActivityTime(0),
       lastValidFrameTime(0),
-      framesReceived(0),
-      validFrames(0),
-      invalidFrames(0),
+      responsePending(false),
+      validResponses(METRICS_PREFIX "modbus_responses", "Modbus responses from the DSE controller", "result", "valid"),
+      errorResponses(METRICS_PREFIX "modbus_responses", "Modbus responses from the DSE controller", "result", "error"),
+      requestsSent(METRICS_PREFIX "modbus_requests", "Modbus read requests queued"),
+      statusGauge(METRICS_PREFIX "modbus_status", "0 inactive, 1 active, 2 valid, 3 invalid"),
+      responseTime(METRICS_PREFIX "modbus_response_seconds", "Time from a request to its valid response",
+                   RESPONSE_BOUNDS_MS, sizeof(RESPONSE_BOUNDS_MS) / sizeof(RESPONSE_BOUNDS_MS[0]), 1000),
       lastRequestTime(0),
       currentPage(4),
       nextToken(1)
@@ -77,10 +85,11 @@ void ModbusMonitorService::loop()
 
     unsigned long currentTime = millis();
 
-    // Update status periodically
+    // Update status periodically, and right after a response or error
     static unsigned long lastStatusUpdate = 0;
-    if (currentTime - lastStatusUpdate >= STATUS_UPDATE_INTERVAL_MS)
+    if (responsePending || currentTime - lastStatusUpdate >= STATUS_UPDATE_INTERVAL_MS)
     {
+        responsePending = false;
         updateStatus();
         lastStatusUpdate = currentTime;
     }
@@ -91,6 +100,7 @@ void ModbusMonitorService::loop()
         requestNextPage();
         lastRequestTime = currentTime;
     }
+    managerEvents.wakeWithin(REQUEST_INTERVAL_MS - (currentTime - lastRequestTime));
 
     // Process any pending Modbus messages - eModbus handles this internally
 }
@@ -212,6 +222,7 @@ void ModbusMonitorService::requestNextPage()
 
     if (err == SUCCESS)
     {
+        requestsSent.increment();
         LOG_DEBUG(TAG, "Requesting Page %d - Address: %d, Count: %d, Token: %lu",
                   currentPage, address, count, nextToken - 1);
 
@@ -329,6 +340,7 @@ void ModbusMonitorService::setModbusStatus(ModbusMonitorStatus status)
     {
         modbusStatus = status;
         xSemaphoreGive(statusMutex);
+        statusGauge.set(status);
     }
 }
 
@@ -343,20 +355,27 @@ ModbusMonitorStatus ModbusMonitorService::getModbusStatus() const
     return status;
 }
 
-void ModbusMonitorService::setModbusConfig(const ModbusConfig &newConfig)
+bool ModbusMonitorService::setModbusConfig(const ModbusConfig &newConfig)
 {
-    if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(100)) == pdTRUE)
+    if (xSemaphoreTake(configMutex, pdMS_TO_TICKS(100)) != pdTRUE)
     {
-        config = newConfig;
-        xSemaphoreGive(configMutex);
+        LOG_WARN(TAG, "Configuration busy - not applied");
+        return false;
+    }
 
-        // Reinitialize if connected
-        if (isConnected())
-        {
-            deinitializeModbusClient();
-            initializeModbusClient();
-        }
+    bool baudRateChanged = newConfig.baudRate != config.baudRate;
+    config = newConfig;
+    xSemaphoreGive(configMutex);
+
+    // The slave ID and output flags are read per request; only a new baud rate needs the serial port
+    // and client rebuilt, so polling continues without a gap otherwise
+    if (baudRateChanged && isConnected())
+    {
+        deinitializeModbusClient();
+        initializeModbusClient();
+        return true;
     }
+    return false;
 }
 
 ModbusConfig ModbusMonitorService::getModbusConfig() const
@@ -395,17 +414,17 @@ void ModbusMonitorService::setOutputFlags(bool serial, bool file, bool mqtt)
 
 unsigned long ModbusMonitorService::getFramesReceived() const
 {
-    return framesReceived;
+    return validResponses.get() + errorResponses.get();
 }
 
 unsigned long ModbusMonitorService::getValidFrames() const
 {
-    return validFrames;
+    return validResponses.get();
 }
 
 unsigned long ModbusMonitorService::getInvalidFrames() const
 {
-    return invalidFrames;
+    return errorResponses.get();
 }
 
 unsigned long ModbusMonitorService::getLastActivityTime() const
@@ -448,9 +467,9 @@ float ModbusMonitorService::getGeneratorL1NVoltage() const
 
 void ModbusMonitorService::handleModbusData(ModbusMessage response, uint32_t token)
 {
-    framesReceived++;
-    validFrames++;
     lastActivityTime = millis();
+    validResponses.increment();
+    responseTime.observe(lastActivityTime - lastRequestTime);
 
     // LOG_DEBUG(TAG, "Received Modbus response - Token: %lu, Size: %d", token, response.size());
     LOG_DEBUG(TAG, "Response: serverID=%d, FC=%d, Token=%08X, length=%d:\n", response.getServerID(), response.getFunctionCode(), token, response.size());
@@ -486,8 +505,7 @@ void ModbusMonitorService::handleModbusData(ModbusMessage response, uint32_t tok
 
 void ModbusMonitorService::handleModbusError(Error error, uint32_t token)
 {
-    framesReceived++;
-    invalidFrames++;
+    errorResponses.increment();
     lastActivityTime = millis();
     ModbusError eModbusError(error);
     LOG_WARN(TAG, "Modbus error - Token: %lu, Error Code: %02X, Error: %s", token, error, (const char *)eModbusError);
@@ -499,6 +517,8 @@ void ModbusMonitorService::onModbusData(ModbusMessage response, uint32_t token)
     if (instance)
     {
         instance->handleModbusData(response, token);
+        instance->responsePending = true;
+        managerEvents.signal(MANAGER_EVENT_MODBUS);
     }
 }
 
@@ -507,5 +527,7 @@ void ModbusMonitorService::onModbusError(Error error, uint32_t token)
     if (instance)
     {
         instance->handleModbusError(error, token);
+        instance->responsePending = true;
+        managerEvents.signal(MANAGER_EVENT_MODBUS);
     }
 }
\ No newline at end of file
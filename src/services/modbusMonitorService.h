@@ -8,6 +8,7 @@
 #include <freertos/queue.h>
 #include "ModbusClientRTU.h"
 #include "services/baseService.h"
+#include "metrics/metricsRegistry.h"
 #include "definitions.h"
 #include "modbusData.h"
 
@@ -51,7 +52,7 @@ public:
 
     // ModBus monitor specific functions
     ModbusMonitorStatus getModbusStatus() const;
-    void setModbusConfig(const ModbusConfig& config);
+    bool setModbusConfig(const ModbusConfig& config);      // true if the client was restarted (baud rate)
     ModbusConfig getModbusConfig() const;
     
     // Configuration setters
@@ -83,11 +84,14 @@ private:
     ModbusMonitorStatus modbusStatus;
     unsigned long lastActivityTime;
     unsigned long lastValidFrameTime;
+    volatile bool responsePending;  // Set by the eModbus callbacks, status refreshed on the next pass
     
-    // Statistics
-    unsigned long framesReceived;
-    unsigned long validFrames;
-    unsigned long invalidFrames;
+    // Statistics (also scraped as metrics; updated from the eModbus task)
+    MetricCounter validResponses;
+    MetricCounter errorResponses;
+    MetricCounter requestsSent;
+    MetricGauge statusGauge;
+    MetricHistogram responseTime;
     
     // DSE Data storage
     DSEData dseData;
@@ -0,0 +1,23 @@
+#include "mqttAckClient.h"
+
+bool MQTTAckClient::publishWithId(const char *topic, const uint8_t *payload, size_t length, bool retain,
+                                  uint16_t packetId)
+{
+    // PicoMQTT has no DUP flag, retransmissions go out as plain QoS1 publishes with the same ID
+    return publish(topic, payload, length, 1, retain, packetId);
+}
+
+void MQTTAckClient::handle_packet(PicoMQTT::IncomingPacket &packet)
+{
+    if (packet.get_type() == PicoMQTT::Packet::PUBACK)
+    {
+        uint16_t packetId = packet.read_u16();
+        if (acknowledged_callback)
+        {
+            acknowledged_callback(packetId);
+        }
+        return;
+    }
+
+    PicoMQTT::Client::handle_packet(packet);
+}
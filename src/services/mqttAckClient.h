@@ -0,0 +1,35 @@
+#pragma once
+#ifndef __MQTTACKCLIENT_H__
+#define __MQTTACKCLIENT_H__
+
+#include <PicoMQTT.h>
+#include <functional>
+
+#include "utils/mqttPublishWindow.h"
+
+/*
+ * PicoMQTT client that reports PUBACKs
+ *
+ * PicoMQTT sends QoS1 publishes but discards the PUBACKs. This subclass takes
+ * them out of the packet stream and hands the packet ID to acknowledged_callback,
+ * which lets an MQTTPublishWindow keep several publishes in flight.
+ *
+ * PUBACKs are matched by packet ID only, so every QoS1 publish of a client must
+ * go through its window; publish anything else at QoS0.
+ */
+
+class MQTTAckClient : public PicoMQTT::Client
+{
+public:
+    using PicoMQTT::Client::Client;
+
+    std::function<void(uint16_t)> acknowledged_callback;
+
+    // QoS1 publish with a caller-managed packet ID (see MQTTPublishWindow::Sender)
+    bool publishWithId(const char *topic, const uint8_t *payload, size_t length, bool retain, uint16_t packetId);
+
+protected:
+    void handle_packet(PicoMQTT::IncomingPacket &packet) override;
+};
+
+#endif // __MQTTACKCLIENT_H__
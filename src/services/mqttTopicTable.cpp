@@ -0,0 +1,60 @@
+#include "mqttTopicTable.h"
+
+// Indexed by MQTTTopic
+static const char *const TOPIC_SUFFIXES[MQTT_TOPIC_COUNT] = {
+    "messages",
+    "version",
+    "model",
+    "connected",
+    "ota/version",
+    "ota/md5",
+    "ota/update",
+    "ota/delta",
+    "ota/compressed",
+    "ota/url",
+    "ota/status",
+    "ota/ack",
+    "logs",
+    "logs/stats",
+    "logging/config",
+    "logging/get_config",
+    "logging/get_logs",
+    "logging/current_config",
+    "logging/transfer",
+    "logging/segments",
+    "logging/logs",
+    "crash/info",
+    "crash/ring",
+    "crash/coredump",
+    "config/update",
+    "config/get",
+    "config/status",
+};
+
+MQTTTopicTable::MQTTTopicTable()
+    : topics(), built(false)
+{
+}
+
+bool MQTTTopicTable::build(const char *deviceId)
+{
+    bool complete = true;
+    for (size_t i = 0; i < MQTT_TOPIC_COUNT; i++)
+    {
+        int length = snprintf(topics[i], MQTT_TOPIC_LENGTH, "%s/%s/%s", MQTT_DEVICE_TOPIC_PREFIX, deviceId,
+                              TOPIC_SUFFIXES[i]);
+        if (length < 0 || length >= MQTT_TOPIC_LENGTH)
+        {
+            topics[i][0] = '\0';
+            complete = false;
+        }
+    }
+
+    built = true;
+    return complete;
+}
+
+const char *MQTTTopicTable::getSuffix(MQTTTopic topic)
+{
+    return topic < MQTT_TOPIC_COUNT ? TOPIC_SUFFIXES[topic] : "";
+}
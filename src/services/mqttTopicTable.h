@@ -0,0 +1,36 @@
+#pragma once
+#ifndef __MQTTTOPICTABLE_H__
+#define __MQTTTOPICTABLE_H__
+
+#include <Arduino.h>
+
+#include "definitions.h"
+
+/*
+ * Interned device topics
+ *
+ * build() formats every MQTTTopic once as devices/<deviceId>/<suffix> into a
+ * fixed table, so publishing and subscribing only look up a pointer by ID
+ * instead of formatting a topic per message. Subscription handlers capture the
+ * MQTTTopic they were registered for, so incoming messages are dispatched by
+ * ID without comparing topic strings.
+ */
+
+class MQTTTopicTable
+{
+public:
+    MQTTTopicTable();
+
+    // Returns false if a topic does not fit MQTT_TOPIC_LENGTH (it is left empty)
+    bool build(const char *deviceId);
+    bool isBuilt() const { return built; }
+
+    const char *get(MQTTTopic topic) const { return topics[topic]; }
+    static const char *getSuffix(MQTTTopic topic);
+
+private:
+    char topics[MQTT_TOPIC_COUNT][MQTT_TOPIC_LENGTH];
+    bool built;
+};
+
+#endif // __MQTTTOPICTABLE_H__
@@ -1,10 +1,16 @@
 #include "novaLogicService.h"
 #include "definitions.h"
+#include "managers/managerEvents.h"
 #include <esp_task_wdt.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
 
 // Logging tag
 static const char* TAG = "NovaLogicService";
 
+// Compressed image and delta patch bytes are staged here on their way to the decoder
+static uint8_t otaInput[OTA_STREAM_INPUT_SIZE];
+
 // Device serial number for MQTT Client ID
 extern String getSerialNumber();
 static String deviceSerialNumber = getSerialNumber();
@@ -12,7 +18,10 @@ static const char* MQTT_DEVICE_ID = deviceSerialNumber.c_str();
 
 NovaLogicService::NovaLogicService(StatusViewModel& statusVM)
     : BaseService("NovaLogicService"), statusViewModel(statusVM), 
-      mqttClient(nullptr), lastKeepAlive(0), initialized(false), commandCallback(nullptr)
+      mqttClient(nullptr), socketPort(0), lastKeepAlive(0), lastReportedLogDrops(0), lastLogChunkTime(0), lastPostMortemTime(0), initialized(false), commandCallback(nullptr),
+      lastHttpOTAProgress(0), otaKind(OTA_NONE), otaSegmented(false), otaTotal(0), otaReceived(0), otaHeaderLength(0),
+      otaStart(0), otaLastSegment(0), otaNextProgress(0), otaResultTime(0), otaResultPending(false),
+      otaRestartPending(false), lastWindowStats(0), lastWindowAcknowledged(0)
 {
 }
 
@@ -31,6 +40,12 @@ void NovaLogicService::begin()
     
     setStatus(SERVICE_STOPPED);
     initialized = true;
+
+    // An HTTP firmware download interrupted by a reboot continues once services are online
+    if (httpOTA.begin())
+    {
+        LOG_INFO(TAG, "HTTP OTA download will resume at %zu/%zu bytes", httpOTA.getOffset(), httpOTA.getImageSize());
+    }
     
     LOG_INFO(serviceName, "Initialized");
 }
@@ -48,6 +63,13 @@ void NovaLogicService::loop()
         mqttClient->loop();
     }
 
+    // Services are only started while online; the HTTP download does not need the broker
+    if (currentStatus != SERVICE_STOPPED)
+    {
+        serviceHttpOTA();
+    }
+    serviceOTATransfer();
+
     // State machine logic
     switch (currentStatus)
     {
@@ -75,6 +97,10 @@ void NovaLogicService::loop()
 
     case SERVICE_CONNECTED:
         processKeepAlive();
+        servicePublishWindow();
+        publishLogBatches();
+        publishLogTransfer();
+        publishPostMortem();
         break;
 
     case SERVICE_ERROR:
@@ -95,6 +121,12 @@ void NovaLogicService::stop()
     if (currentStatus == SERVICE_CONNECTED || currentStatus == SERVICE_CONNECTING)
     {
         disconnectMQTT();
+
+        // The client is destroyed without a disconnect callback
+        if (globalLoggingManager)
+        {
+            globalLoggingManager->onMQTTDisconnected();
+        }
     }
 
     setStatus(SERVICE_STOPPED);
@@ -111,7 +143,7 @@ void NovaLogicService::start()
     }
 }
 
-void NovaLogicService::setCommandCallback(std::function<void(const char*, const char*)> callback)
+void NovaLogicService::setCommandCallback(std::function<void(MQTTTopic, const char*)> callback)
 {
     commandCallback = callback;
     LOG_DEBUG(TAG, "Command callback set");
@@ -119,11 +151,16 @@ void NovaLogicService::setCommandCallback(std::function<void(const char*, const
 
 void NovaLogicService::initializeMQTTClient()
 {
+    if (!topicTable.isBuilt() && !topicTable.build(MQTT_DEVICE_ID))
+    {
+        LOG_ERROR(TAG, "Device ID too long for MQTT_TOPIC_LENGTH - some topics are disabled");
+    }
+
     if (!mqttClient)
     {
         LOG_INFO(TAG, "Creating MQTT client...");
-        mqttClient = new PicoMQTT::Client(MQTT_SERVER_NL_URL, MQTT_SERVER_NL_PORT, 
-                                        MQTT_DEVICE_ID, MQTT_SERVER_NL_USERNAME, MQTT_SERVER_NL_PASSWORD);
+        mqttClient = new MQTTAckClient(MQTT_SERVER_NL_URL, MQTT_SERVER_NL_PORT, 
+                                       MQTT_DEVICE_ID, MQTT_SERVER_NL_USERNAME, MQTT_SERVER_NL_PASSWORD);
         
         // Set up MQTT event handlers
         mqttClient->connected_callback = [this]()
@@ -135,6 +172,11 @@ void NovaLogicService::initializeMQTTClient()
         {
             this->onMQTTDisconnected();
         };
+
+        mqttClient->acknowledged_callback = [this](uint16_t packetId)
+        {
+            this->publishWindow.acknowledge(packetId);
+        };
     }
 }
 
@@ -166,6 +208,8 @@ void NovaLogicService::disconnectMQTT()
         // Destroy and recreate client to ensure clean state
         delete mqttClient;
         mqttClient = nullptr;
+        managerEvents.unwatchPort(socketPort);
+        socketPort = 0;
         
         LOG_DEBUG(TAG, "MQTT client destroyed");
     }
@@ -179,19 +223,15 @@ void NovaLogicService::setupSubscriptions()
         return;
     }
     
-    char mqttTopic[128];
-
     // Subscribe to general messages
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "messages");
-    mqttClient->subscribe(mqttTopic, [this](const char *topic, const char *payload)
+    mqttClient->subscribe(topicTable.get(MQTT_TOPIC_MESSAGES), [this](const char *topic, const char *payload)
     {
         // Use internal MQTT message parser
-        this->parseMQTTMessage(topic, payload);
+        this->parseMQTTMessage(payload);
     });
 
     // Subscribe to OTA version updates
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "ota/version");
-    mqttClient->subscribe(mqttTopic, [this](const char* topic, const char* payload) {
+    mqttClient->subscribe(topicTable.get(MQTT_TOPIC_OTA_VERSION), [this](const char* topic, const char* payload) {
         LOG_INFO(TAG, "OTA version received: %s", payload);
         if (isOTAVersionNewer(payload))
         {
@@ -200,17 +240,58 @@ void NovaLogicService::setupSubscriptions()
     });
 
     // Subscribe to OTA MD5 hash
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "ota/md5");
-    mqttClient->subscribe(mqttTopic, [this](const char* topic, const char* payload) {
-        LOG_INFO(TAG, "OTA MD5 received: %s", payload);
-        // Store MD5 for validation if needed
+    mqttClient->subscribe(topicTable.get(MQTT_TOPIC_OTA_MD5), [this](const char* topic, const char* payload) {
+        // MD5 or SHA-256 of the next image, checked while it streams in
+        if (otaKind != OTA_NONE)
+        {
+            // A segmented transfer being restarted; the hash of the old one must not be reused
+            LOG_WARN(TAG, "OTA transfer abandoned at %zu/%zu bytes - new digest", otaReceived, otaTotal);
+            otaWriter.abort();
+            deltaPatcher.abort();
+            otaKind = OTA_NONE;
+        }
+        if (otaWriter.setExpectedDigest(payload))
+        {
+            LOG_INFO(TAG, "OTA digest received: %s", payload);
+        }
+        else
+        {
+            LOG_WARN(TAG, "Invalid OTA digest: %s", payload);
+        }
     });
 
-    // Subscribe to OTA update binary
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "ota/update");
-    mqttClient->subscribe(mqttTopic, [this](const char* topic, PicoMQTT::IncomingPacket& packets) {
-        LOG_INFO(TAG, "OTA update binary received");
-        handleOTAUpdate(packets);
+    // Subscribe to logging and configuration commands (handled by the external command callback, dispatched by topic ID)
+    static const MQTTTopic externalCommands[] = {MQTT_TOPIC_LOGGING_CONFIG, MQTT_TOPIC_LOGGING_GET_CONFIG,
+                                                 MQTT_TOPIC_LOGGING_GET_LOGS, MQTT_TOPIC_CONFIG_UPDATE,
+                                                 MQTT_TOPIC_CONFIG_GET};
+    for (MQTTTopic command : externalCommands)
+    {
+        mqttClient->subscribe(topicTable.get(command), [this, command](const char* topic, const char* payload) {
+            if (commandCallback)
+            {
+                commandCallback(command, payload);
+            }
+        });
+    }
+
+    // Subscribe to OTA update binary (whole or in segments, see handleOTAMessage)
+    mqttClient->subscribe(topicTable.get(MQTT_TOPIC_OTA_UPDATE), [this](const char* topic, PicoMQTT::IncomingPacket& packets) {
+        handleOTAMessage(OTA_IMAGE, packets);
+    });
+
+    // Subscribe to delta OTA patches (rebuilt against the running image, see scripts/otadelta.py)
+    mqttClient->subscribe(topicTable.get(MQTT_TOPIC_OTA_DELTA), [this](const char* topic, PicoMQTT::IncomingPacket& packets) {
+        handleOTAMessage(OTA_DELTA, packets);
+    });
+
+    // Subscribe to HTTP firmware download requests (resumable, see ota/httpOtaDownloader.h)
+    mqttClient->subscribe(topicTable.get(MQTT_TOPIC_OTA_URL), [this](const char* topic, const char* payload) {
+        startHttpOTA(payload);
+    });
+
+    // Subscribe to LZSS-compressed full images
+    mqttClient->subscribe(topicTable.get(MQTT_TOPIC_OTA_COMPRESSED), [this](const char* topic, PicoMQTT::IncomingPacket& packets) {
+        handleOTAMessage(OTA_COMPRESSED, packets);
     });
 }
 
@@ -222,10 +303,7 @@ void NovaLogicService::setupWillMessage()
         return;
     }
     
-    char mqttTopic[128];
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "connected");
-
-    mqttClient->will.topic = String(mqttTopic);
+    mqttClient->will.topic = topicTable.get(MQTT_TOPIC_CONNECTED);
     mqttClient->will.payload = "false";
     mqttClient->will.qos = 1;
     mqttClient->will.retain = true;
@@ -237,6 +315,13 @@ void NovaLogicService::onMQTTConnected()
 
     setStatus(SERVICE_CONNECTED);
 
+    // Broker messages wake the managers task, which reads them in loop()
+    socketPort = mqttClient->get_local_port();
+    managerEvents.watchPort(socketPort);
+
+    // Unacknowledged QoS1 messages from the previous session go out again first
+    publishWindow.sessionRestarted();
+
     // Set up subscriptions
     setupSubscriptions();
 
@@ -259,6 +344,8 @@ void NovaLogicService::onMQTTDisconnected()
 {
     LOG_WARN(TAG, "MQTT disconnected from NovaLogic broker!");
     setStatus(SERVICE_ERROR);
+    managerEvents.unwatchPort(socketPort);
+    socketPort = 0;
     
     // Notify logging manager about MQTT disconnection
     if (globalLoggingManager)
@@ -280,9 +367,31 @@ void NovaLogicService::processKeepAlive()
     }
 }
 
-void NovaLogicService::buildTopicPath(char* buffer, size_t bufferSize, const char* suffix)
+void NovaLogicService::servicePublishWindow()
 {
-    snprintf(buffer, bufferSize, "devices/%s/%s", MQTT_DEVICE_ID, suffix);
+    if (currentStatus != SERVICE_CONNECTED || !mqttClient)
+        return;
+
+    publishWindow.service([this](const char* topic, const uint8_t* payload, size_t length, bool retain,
+                                 uint16_t packetId, bool) {
+        return mqttClient->publishWithId(topic, payload, length, retain, packetId);
+    });
+
+    unsigned long now = millis();
+    if (now - lastWindowStats >= MQTT_PUBLISH_WINDOW_STATS_INTERVAL_MS)
+    {
+        uint32_t acknowledged = publishWindow.getAcknowledged();
+        if (acknowledged != lastWindowAcknowledged)
+        {
+            LOG_INFO(TAG, "QoS1 window: %lu sent, %lu acked (+%lu), %lu retransmitted, avg ack %lu ms, peak in flight %u",
+                     (unsigned long)publishWindow.getPublished(), (unsigned long)acknowledged,
+                     (unsigned long)(acknowledged - lastWindowAcknowledged),
+                     (unsigned long)publishWindow.getRetransmitted(), (unsigned long)publishWindow.getAverageAckMs(),
+                     (unsigned)publishWindow.getPeakInFlight());
+            lastWindowAcknowledged = acknowledged;
+        }
+        lastWindowStats = now;
+    }
 }
 
 void NovaLogicService::checkOTAVersion()
@@ -290,9 +399,7 @@ void NovaLogicService::checkOTAVersion()
     if (currentStatus != SERVICE_CONNECTED)
         return;
 
-    char mqttTopic[128];
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "messages");
-    mqttClient->publish(mqttTopic, MQTT_DVC_CMD_VERSION);
+    mqttClient->publish(topicTable.get(MQTT_TOPIC_MESSAGES), MQTT_DVC_CMD_VERSION);
 
     LOG_DEBUG(TAG, "OTA version check requested");
 }
@@ -302,9 +409,7 @@ void NovaLogicService::sendFirmwareVersion()
     if (currentStatus != SERVICE_CONNECTED)
         return;
 
-    char mqttTopic[128];
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "version");
-    mqttClient->publish(mqttTopic, FIRMWARE_VERSION, 1);
+    publishReliable(MQTT_TOPIC_VERSION, FIRMWARE_VERSION, strlen(FIRMWARE_VERSION));
 
     LOG_DEBUG(TAG, "Firmware version sent");
 }
@@ -314,9 +419,7 @@ void NovaLogicService::sendDeviceModel()
     if (currentStatus != SERVICE_CONNECTED)
         return;
 
-    char mqttTopic[128];
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "model");
-    mqttClient->publish(mqttTopic, DEVICE_MODEL, 1);
+    publishReliable(MQTT_TOPIC_MODEL, DEVICE_MODEL, strlen(DEVICE_MODEL));
 
     LOG_DEBUG(TAG, "Device model sent");
 }
@@ -326,9 +429,15 @@ void NovaLogicService::sendConnectionStatus(bool connected)
     if (currentStatus != SERVICE_CONNECTED && connected)
         return; // Can't send if not connected
 
-    char mqttTopic[128];
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "connected");
-    mqttClient->publish(mqttTopic, connected ? "true" : "false", 1, true);
+    if (connected)
+    {
+        publishReliable(MQTT_TOPIC_CONNECTED, "true", 4, true);
+    }
+    else
+    {
+        // Goes out immediately at QoS0, the link is about to be closed
+        publish(MQTT_TOPIC_CONNECTED, "false", 5, true);
+    }
 
     LOG_DEBUG(TAG, "Connection status sent: %s", connected ? "true" : "false");
 }
@@ -383,174 +492,622 @@ void NovaLogicService::requestOTAUpdate()
     if (currentStatus != SERVICE_CONNECTED)
         return;
 
-    char mqttTopic[128];
-    buildTopicPath(mqttTopic, sizeof(mqttTopic), "messages");
-    mqttClient->publish(mqttTopic, MQTT_DVC_CMD_UPDATE);
+    mqttClient->publish(topicTable.get(MQTT_TOPIC_MESSAGES), MQTT_DVC_CMD_UPDATE);
 
     LOG_INFO(TAG, "OTA update requested");
 }
 
-void NovaLogicService::handleOTAUpdate(PicoMQTT::IncomingPacket& packets)
+// OTA transfers -------------------------------------------------------------------------
+//
+// ota/update, ota/delta and ota/compressed carry a stream (raw image, delta patch
+// or NLZ1 compressed image) either as one message or as "OTAS" segments
+// (scripts/otapush.py). A whole message can only be read inside its PicoMQTT
+// callback, so it holds the managers task until the last byte; ota/status warns
+// when one arrives. A segment is fed to the same decoder state and the callback
+// returns; the other managers run between segments, and ota/ack tells the sender
+// the next offset expected, so a lost segment or a reconnect only resends from
+// there. Progress and the result report the longest genset data gap
+// (ModbusMonitorManager::getOTADataGap) seen since the transfer began.
+//
+// A delta patch checks the running image and runs long COPYs a slice per pass
+// (continueDelta). While that is pending a segment stops being read where the
+// patcher paused and the ack waits until it is done; the sender resends from
+// the acknowledged offset, so the dropped rest of the segment costs nothing.
+
+static uint32_t readLE32(const uint8_t* p)
 {
-    LOG_INFO(TAG, "Performing OTA update...");
+    return (uint32_t)p[0] | (uint32_t)p[1] << 8 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 24;
+}
 
-    size_t payload_size = packets.get_remaining_size();
-    LOG_INFO(TAG, "OTA Update Size: %zu", payload_size);
+void NovaLogicService::handleOTAMessage(OTAKind kind, PicoMQTT::IncomingPacket& packets)
+{
+    size_t size = packets.get_remaining_size();
+    size_t received = readOTAInput(packets, min((size_t)OTA_SEGMENT_HEADER_SIZE, size));
 
-    // Update status to indicate device is updating
-    statusViewModel.setDeviceStatus(DEVICE_UPDATING);
-    statusViewModel.setOTAActive(true); // Signal other tasks to reduce activity
+    if (received < OTA_SEGMENT_HEADER_SIZE || memcmp(otaInput, OTA_SEGMENT_MAGIC, 4) != 0)
+    {
+        // The whole stream in this message: still accepted for senders without segment
+        // support, but Modbus polling and the other managers stop until it is written
+        if (!beginOTATransfer(kind, size, false))
+            return;
+        LOG_WARN(TAG, "Single-message OTA of %zu bytes holds the managers task until it is written - "
+                      "send it in segments (scripts/otapush.py)", size);
+        publishOTAStatus("Warning: single-message OTA, acquisition pauses until it is written; use segments");
+        if (!feedWholeOTA(otaInput, received))
+            return;
+
+        while (otaKind != OTA_NONE && otaReceived < otaTotal)
+        {
+            size_t count = readOTAInput(packets, min((size_t)OTA_STREAM_INPUT_SIZE, otaTotal - otaReceived));
+            if (count == 0)
+            {
+                failOTATransfer("OTA stream ended early");
+                return;
+            }
+            feedWholeOTA(otaInput, count);
+        }
 
-    if (!Update.begin(packets.available()))
+        if (otaKind != OTA_NONE)
+            completeOTATransfer();
+        return;
+    }
+
+    // "OTAS" [offset:4][total:4] followed by the stream bytes at offset
+    uint32_t offset = readLE32(otaInput + 4);
+    uint32_t total = readLE32(otaInput + 8);
+    size_t length = size - OTA_SEGMENT_HEADER_SIZE;
+
+    if (offset == 0 && !beginOTATransfer(kind, total, true))
+        return;
+
+    // The ack goes out once the delta work is done; a resend meanwhile is dropped
+    if (isDeltaPending())
+    {
+        LOG_DEBUG(TAG, "OTA segment at %lu dropped - delta patch busy", (unsigned long)offset);
+        return;
+    }
+
+    if (otaKind != kind || !otaSegmented || total != otaTotal || offset != otaReceived)
     {
-        publishOTAStatus("Error: Not enough space for update");
-        statusViewModel.setDeviceStatus(DEVICE_UPDATE_FAILED);
-        statusViewModel.setOTAActive(false); // Clear OTA flag
-        LOG_ERROR(TAG, "OTA Update failed: Not enough space");
-        delay(2500);
-        statusViewModel.setDeviceStatus(DEVICE_STARTED);
+        LOG_WARN(TAG, "OTA segment at %lu/%lu ignored, expecting %zu/%zu", (unsigned long)offset,
+                 (unsigned long)total, otaReceived, otaTotal);
+        publishOTAAck();
+        return;
+    }
+
+    if (length > otaTotal - otaReceived)
+    {
+        failOTATransfer("OTA segment past the end of the stream");
+        return;
+    }
+
+    otaLastSegment = millis();
+    while (length > 0 && otaKind != OTA_NONE && !isDeltaPending())
+    {
+        size_t count = readOTAInput(packets, min((size_t)OTA_STREAM_INPUT_SIZE, length));
+        if (count == 0)
+            break;  // Resent from the acknowledged offset
+        length -= count;
+        feedOTA(otaInput, count);
+    }
+
+    if (otaKind == OTA_NONE || isDeltaPending())
         return;
+    if (otaReceived == otaTotal)
+        completeOTATransfer();
+    else
+        publishOTAAck();
+}
+
+bool NovaLogicService::beginOTATransfer(OTAKind kind, size_t total, bool segmented)
+{
+    if (isOTABusy())
+        return false;
+
+    if (otaRestartPending)
+    {
+        LOG_WARN(TAG, "OTA image ignored - restarting into the new firmware");
+        return false;
+    }
+
+    if (otaKind != OTA_NONE)
+    {
+        LOG_WARN(TAG, "OTA transfer restarted at %zu/%zu bytes", otaReceived, otaTotal);
+        otaWriter.abort();
+        deltaPatcher.abort();
+        otaKind = OTA_NONE;
+    }
+
+    if (total == 0)
+    {
+        reportOTAFailure("Empty OTA transfer");
+        return false;
+    }
+
+    static const char* const KIND_NAMES[] = {"", "image", "delta patch", "compressed image"};
+    LOG_INFO(TAG, "Performing OTA update: %s, %zu bytes%s", KIND_NAMES[kind], total, segmented ? " in segments" : "");
+    if (kind != OTA_DELTA && !otaWriter.hasExpectedDigest())
+    {
+        LOG_WARN(TAG, "No OTA digest received - image integrity is not verified");
+    }
+
+    statusViewModel.setDeviceStatus(DEVICE_UPDATING);
+    statusViewModel.setOTAActive(true);
+    statusViewModel.setOTAProgress(0);
+
+    otaKind = kind;
+    otaSegmented = segmented;
+    otaTotal = total;
+    otaReceived = 0;
+    otaHeaderLength = 0;
+    otaNextProgress = OTA_PROGRESS_INTERVAL_BYTES;
+    otaStart = millis();
+    otaLastSegment = otaStart;
+    otaDecoder.reset();
+
+    // Compressed images and delta patches start the writer once their header is in
+    if (kind == OTA_IMAGE && !beginOTAWriter(total))
+    {
+        otaKind = OTA_NONE;
+        reportOTAFailure(otaWriter.getError());
+        return false;
     }
 
     publishOTAStatus("Beginning OTA update, this may take a minute...");
-    
-    // Write in chunks to avoid blocking for too long
-    const size_t CHUNK_SIZE = OTA_CHUNK_SIZE;
-    size_t totalWritten = 0;
-    size_t remaining = payload_size;
-    
-    while (remaining > 0 && packets.available())
+    return true;
+}
+
+// Header of a compressed image or delta patch complete: set up the writer; nullptr or the reason it failed
+const char* NovaLogicService::startDecodedOTA()
+{
+    if (otaKind == OTA_COMPRESSED)
     {
-        size_t toWrite = (remaining > CHUNK_SIZE) ? CHUNK_SIZE : remaining;
-        
-        // Create a temporary buffer for the chunk
-        uint8_t* buffer = new uint8_t[toWrite];
-        if (!buffer)
+        // "NLZ1" [imageSize:4] followed by the LZSS stream of the image (scripts/lzss.py image)
+        if (memcmp(otaHeader, OTA_COMPRESSED_MAGIC, 4) != 0)
+            return "Not a compressed image";
+
+        size_t imageSize = readLE32(otaHeader + 4);
+        if (imageSize == 0)
+            return "Empty compressed image";
+        return beginOTAWriter(imageSize) ? nullptr : otaWriter.getError();
+    }
+
+    const esp_partition_t* running = esp_ota_get_running_partition();
+    DeltaPatcher::SourceReader readRunningImage = [running](size_t offset, uint8_t* data, size_t length) {
+        return offset + length <= running->size && esp_partition_read(running, offset, data, length) == ESP_OK;
+    };
+
+    if (!deltaPatcher.begin(otaHeader, readRunningImage))
+        return deltaPatcher.getError();
+
+    // Refuse a patch built against another image before touching the inactive slot;
+    // continueDelta() hashes the running image and then starts the writer
+    if (deltaPatcher.getSourceSize() > running->size)
+    {
+        LOG_ERROR(TAG, "Delta patch rejected: source too large");
+        return "Patch does not match the running image";
+    }
+    return nullptr;
+}
+
+bool NovaLogicService::isDeltaPending() const
+{
+    return otaKind == OTA_DELTA && (deltaPatcher.isVerifying() || deltaPatcher.isPaused());
+}
+
+// One slice of source verification or of a paused COPY; false when the transfer failed
+bool NovaLogicService::continueDelta()
+{
+    const char* reason = nullptr;
+    if (deltaPatcher.isVerifying())
+    {
+        if (!deltaPatcher.verifySource())
         {
-            LOG_ERROR(TAG, "Failed to allocate memory for OTA chunk");
-            publishOTAStatus("Error: Memory allocation failed");
-            statusViewModel.setDeviceStatus(DEVICE_UPDATE_FAILED);
-            statusViewModel.setOTAActive(false); // Clear OTA flag
-            delay(2500);
-            statusViewModel.setDeviceStatus(DEVICE_STARTED);
-            return;
+            LOG_ERROR(TAG, "Delta patch rejected: %s", deltaPatcher.getError());
+            reason = "Patch does not match the running image";
         }
-        
-        // Read chunk from packets
-        size_t bytesRead = packets.read(buffer, toWrite);
-        if (bytesRead == 0)
+        else if (!deltaPatcher.isVerifying())
         {
-            LOG_ERROR(TAG, "No more data available from packets");
-            delete[] buffer;
-            break;
+            LOG_INFO(TAG, "Delta source verified %lu ms into the transfer (%zu -> %zu bytes)", millis() - otaStart,
+                     deltaPatcher.getSourceSize(), deltaPatcher.getTargetSize());
+
+            // The rebuilt image is checked against the target digest from the patch header
+            otaWriter.setExpectedDigest(deltaPatcher.getTargetDigest(), 32);
+            if (!beginOTAWriter(deltaPatcher.getTargetSize()))
+                reason = otaWriter.getError();
         }
-        
-        // Write chunk to update
-        size_t bytesWritten = Update.write(buffer, bytesRead);
-        delete[] buffer;
-        
-        if (bytesWritten != bytesRead)
+    }
+    else if (!deltaPatcher.resume([this](const uint8_t* image, size_t imageLength) {
+                 return otaWriter.write(image, imageLength);
+             }))
+    {
+        reason = otaWriter.hasFailed() ? otaWriter.getError() : deltaPatcher.getError();
+    }
+
+    if (reason)
+    {
+        failOTATransfer(reason);
+        return false;
+    }
+    return true;
+}
+
+bool NovaLogicService::beginOTAWriter(size_t imageSize)
+{
+    // The inactive slot no longer holds the interrupted HTTP download
+    httpOTA.discardCheckpoint();
+    return otaWriter.begin(imageSize);
+}
+
+// Takes all of the input unless a delta patch goes pending: otaReceived counts what was used
+bool NovaLogicService::feedOTA(const uint8_t* data, size_t length)
+{
+    // Compressed image and delta patch headers may be split across segments
+    size_t used = 0;
+    if (otaHeaderLength < otaHeaderSize())
+    {
+        used = min(length, otaHeaderSize() - otaHeaderLength);
+        memcpy(otaHeader + otaHeaderLength, data, used);
+        otaHeaderLength += used;
+
+        const char* reason = otaHeaderLength == otaHeaderSize() ? startDecodedOTA() : nullptr;
+        if (reason)
         {
-            LOG_ERROR(TAG, "Write failed: %zu/%zu bytes written", bytesWritten, bytesRead);
-            publishOTAStatus("Error: Write failed");
-            statusViewModel.setDeviceStatus(DEVICE_UPDATE_FAILED);
-            statusViewModel.setOTAActive(false); // Clear OTA flag
-            delay(2500);
-            statusViewModel.setDeviceStatus(DEVICE_STARTED);
-            return;
+            failOTATransfer(reason);
+            return false;
         }
-        
-        totalWritten += bytesWritten;
-        remaining -= bytesWritten;
-        
-        // Yield to prevent blocking and allow other tasks to run
-        yield();
-        
-        // Small delay every few chunks to allow critical system tasks to run
-        if (totalWritten % (8 * 1024) == 0) {
-            delay(10); // Delay every 8KB to give system more time
+    }
+
+    bool ok = true;
+    size_t consumed = length;
+    if (used < length)
+    {
+        if (otaKind == OTA_IMAGE)
+        {
+            ok = otaWriter.write(data, length);
         }
-        
-        // Log progress every 64KB
-        if (totalWritten % (64 * 1024) == 0)
+        else if (otaKind == OTA_COMPRESSED)
         {
-            LOG_DEBUG(TAG, "OTA Progress: %zu/%zu bytes (%.1f%%)", 
-                     totalWritten, payload_size, 
-                     (float)totalWritten / payload_size * 100.0);
-            
-            // Publish progress update
-            char progressMsg[128];
-            snprintf(progressMsg, sizeof(progressMsg), "OTA Progress: %.1f%% (%zu/%zu bytes)", 
-                    (float)totalWritten / payload_size * 100.0, totalWritten, payload_size);
-            publishOTAStatus(progressMsg);
+            // Decompressed in the decoder's fixed 4 KB window straight into the flash chunks
+            ok = otaDecoder.feed(data + used, length - used, [this](const uint8_t* image, size_t imageLength) {
+                return otaWriter.write(image, imageLength);
+            });
+        }
+        else
+        {
+            // A step at a time, so a COPY that pauses the patcher leaves it one step of operations to hold
+            LzssDecoder::OutputCallback applyOperations = [this](const uint8_t* operations, size_t count) {
+                return deltaPatcher.feed(operations, count, [this](const uint8_t* image, size_t imageLength) {
+                    return otaWriter.write(image, imageLength);
+                });
+            };
+            consumed = used;
+            while (ok && consumed < length && !isDeltaPending())
+            {
+                size_t step = min((size_t)OTA_DELTA_DECODE_STEP, length - consumed);
+                ok = otaDecoder.feed(data + consumed, step, applyOperations);
+                consumed += step;
+            }
         }
     }
-    
-    LOG_INFO(TAG, "Written: %zu/%zu bytes", totalWritten, payload_size);
+    otaReceived += consumed;
 
-    if (totalWritten == payload_size)
+    if (!ok)
     {
-        LOG_INFO(TAG, "Update size matches payload size: %zu", payload_size);
-        publishOTAStatus("OTA update received, preparing to install...");
+        const char* reason = "OTA stream corrupt";
+        if (otaWriter.hasFailed())
+            reason = otaWriter.getError();
+        else if (otaKind == OTA_DELTA && deltaPatcher.getError())
+            reason = deltaPatcher.getError();
+        failOTATransfer(reason);
+        return false;
     }
-    else
+
+    statusViewModel.setOTAProgress(otaReceived * 100 / otaTotal);
+    if (otaReceived >= otaNextProgress)
     {
-        LOG_ERROR(TAG, "Update size does not match payload size: written %zu, expected %zu", totalWritten, payload_size);
-        publishOTAStatus("OTA update receive failed...");
+        otaNextProgress += OTA_PROGRESS_INTERVAL_BYTES;
+        char progressMsg[96];
+        snprintf(progressMsg, sizeof(progressMsg), "OTA Progress: %.1f%% (%zu/%zu bytes, data gap %lu ms)",
+                 (float)otaReceived / otaTotal * 100.0f, otaReceived, otaTotal, otaDataGap());
+        LOG_DEBUG(TAG, "%s", progressMsg);
+        publishOTAStatus(progressMsg);
     }
+    return true;
+}
 
-    if (Update.hasError())
+// Single-message transfers cannot leave input for a later pass: pending delta work runs in place
+bool NovaLogicService::feedWholeOTA(const uint8_t* data, size_t length)
+{
+    while (length > 0)
     {
-        LOG_ERROR(TAG, "Update error: %d", Update.getError());
-        publishOTAStatus("Error: Update failed!");
-        statusViewModel.setDeviceStatus(DEVICE_UPDATE_FAILED);
-        statusViewModel.setOTAActive(false); // Clear OTA flag
-        delay(2500);
-        statusViewModel.setDeviceStatus(DEVICE_STARTED);
+        size_t received = otaReceived;
+        if (!feedOTA(data, length))
+            return false;
+        data += otaReceived - received;
+        length -= otaReceived - received;
+
+        while (isDeltaPending())
+        {
+            if (!continueDelta())
+                return false;
+        }
+    }
+    return true;
+}
+
+size_t NovaLogicService::otaHeaderSize() const
+{
+    if (otaKind == OTA_DELTA)
+        return DELTA_PATCH_HEADER_SIZE;
+    return otaKind == OTA_COMPRESSED ? OTA_COMPRESSED_HEADER_SIZE : 0;
+}
+
+void NovaLogicService::completeOTATransfer()
+{
+    const char* reason = nullptr;
+    if (otaHeaderLength < otaHeaderSize())
+        reason = "OTA stream truncated";
+    else if (otaKind == OTA_COMPRESSED && (!otaDecoder.isIdle() || otaDecoder.getTotalOutput() != otaWriter.getImageSize()))
+        reason = "Compressed image corrupt or incomplete";
+    else if (otaKind == OTA_DELTA && (!otaDecoder.isIdle() || !deltaPatcher.isComplete()))
+        reason = deltaPatcher.getError() ? deltaPatcher.getError() : "Delta patch incomplete";
+
+    if (reason)
+    {
+        failOTATransfer(reason);
         return;
     }
 
-    if (Update.end(true))
+    if (otaKind == OTA_COMPRESSED)
+    {
+        LOG_INFO(TAG, "Compressed image: %zu bytes received for %zu bytes (%.1f%%)", otaTotal,
+                 otaWriter.getImageSize(), 100.0f * otaTotal / otaWriter.getImageSize());
+    }
+    else if (otaKind == OTA_DELTA)
+    {
+        LOG_INFO(TAG, "Delta applied: %zu byte patch rebuilt %zu bytes (%zu copied from the running image)", otaTotal,
+                 deltaPatcher.getProduced(), deltaPatcher.getCopied());
+    }
+    otaKind = OTA_NONE;
+    finishOTAUpdate(otaStart);
+}
+
+void NovaLogicService::failOTATransfer(const char* reason)
+{
+    LOG_ERROR(TAG, "OTA failed after %zu/%zu bytes: %s", otaReceived, otaTotal, reason);
+    otaWriter.abort();
+    deltaPatcher.abort();
+    otaKind = OTA_NONE;
+    reportOTAFailure(reason);
+}
+
+void NovaLogicService::publishOTAAck()
+{
+    // Next offset expected; total 0 when no transfer is in progress
+    char ack[48];
+    int length = snprintf(ack, sizeof(ack), "{\"offset\":%u,\"total\":%u}",
+                          (unsigned)(otaKind != OTA_NONE ? otaReceived : 0),
+                          (unsigned)(otaKind != OTA_NONE ? otaTotal : 0));
+    publish(MQTT_TOPIC_OTA_ACK, ack, length);
+}
+
+void NovaLogicService::serviceOTATransfer()
+{
+    unsigned long now = millis();
+
+    // Delta work holds the ack back; it counts as activity for the segment timeout
+    if (isDeltaPending() && continueDelta())
+    {
+        otaLastSegment = now;
+        if (isDeltaPending())
+            managerEvents.wakeWithin(0);
+        else if (otaReceived == otaTotal)
+            completeOTATransfer();
+        else
+            publishOTAAck();
+    }
+
+    // A segmented transfer survives reconnects, but not a sender that went away
+    if (otaKind != OTA_NONE && otaSegmented)
     {
-        if (Update.isFinished())
+        if (now - otaLastSegment >= OTA_SEGMENT_TIMEOUT_MS)
+            failOTATransfer("OTA transfer timed out");
+        else
+            managerEvents.wakeWithin(OTA_SEGMENT_TIMEOUT_MS - (now - otaLastSegment));
+    }
+
+    // The result stays on the display (and the status goes out) before moving on
+    if (otaResultPending)
+    {
+        if (now - otaResultTime < OTA_RESULT_DELAY_MS)
+        {
+            managerEvents.wakeWithin(OTA_RESULT_DELAY_MS - (now - otaResultTime));
+            return;
+        }
+
+        otaResultPending = false;
+        if (otaRestartPending)
         {
-            LOG_INFO(TAG, "Update successfully completed. Rebooting...");
-            publishOTAStatus("Update successfully completed.");
-            statusViewModel.setOTAActive(false); // Clear OTA flag before reboot
-            statusViewModel.setDeviceStatus(DEVICE_STARTED);
-            delay(2500);
-            
             LOG_INFO(TAG, "Restarting...");
             ESP.restart();
         }
-        else
-        {
-            LOG_ERROR(TAG, "Update not finished");
-            publishOTAStatus("Update not finished.");
-            statusViewModel.setDeviceStatus(DEVICE_UPDATE_FAILED);
-            statusViewModel.setOTAActive(false); // Clear OTA flag
-            delay(2500);
+        if (statusViewModel.getDeviceStatus() == DEVICE_UPDATE_FAILED)
             statusViewModel.setDeviceStatus(DEVICE_STARTED);
+    }
+}
+
+size_t NovaLogicService::readOTAInput(PicoMQTT::IncomingPacket& packets, size_t length)
+{
+    size_t received = 0;
+    while (received < length && packets.available())
+    {
+        int count = packets.read(otaInput + received, length - received);
+        if (count <= 0)
+            break;
+        received += count;
+    }
+    return received;
+}
+
+bool NovaLogicService::isOTABusy()
+{
+    if (!httpOTA.isActive())
+        return false;
+
+    // Both transports write the same inactive slot
+    LOG_WARN(TAG, "OTA image ignored - HTTP download in progress");
+    publishOTAStatus("Error: HTTP download in progress");
+    return true;
+}
+
+void NovaLogicService::startHttpOTA(const char* payload)
+{
+    if (otaKind != OTA_NONE || otaRestartPending)
+    {
+        LOG_WARN(TAG, "HTTP OTA ignored - MQTT transfer in progress");
+        publishOTAStatus("Error: MQTT transfer in progress");
+        return;
+    }
+
+    // Payload: "<http url> [<md5 or sha256 hex>]"
+    char request[OTA_HTTP_URL_LENGTH + 72];
+    strncpy(request, payload ? payload : "", sizeof(request) - 1);
+    request[sizeof(request) - 1] = '\0';
+
+    char* url = request + strspn(request, " \t\r\n");
+    char* digest = url + strcspn(url, " \t\r\n");
+    if (*digest)
+    {
+        *digest++ = '\0';
+        digest += strspn(digest, " \t\r\n");
+    }
+
+    if (!httpOTA.start(url, digest))
+    {
+        LOG_ERROR(TAG, "HTTP OTA not started: %s", httpOTA.getError());
+        reportOTAFailure(httpOTA.getError());
+        httpOTA.clearResult();
+        return;
+    }
+
+    if (!*digest)
+    {
+        LOG_WARN(TAG, "No OTA digest given - relying on the image's own hash");
+    }
+    LOG_INFO(TAG, "HTTP OTA download from %s%s", url, httpOTA.getResumeCount() ? " (resumed)" : "");
+    publishOTAStatus("HTTP firmware download started");
+    lastHttpOTAProgress = 0;
+}
+
+void NovaLogicService::serviceHttpOTA()
+{
+    HttpOTADownloader::State state = httpOTA.getState();
+    if (state == HttpOTADownloader::STATE_IDLE)
+        return;
+
+    httpOTA.loop();
+
+    if (httpOTA.isActive())
+    {
+        // Body and verification slices run every pass; the socket is not watched
+        managerEvents.wakeWithin(0);
+
+        if (!statusViewModel.isOTAActive())
+        {
+            statusViewModel.setDeviceStatus(DEVICE_UPDATING);
+            statusViewModel.setOTAActive(true);
+        }
+
+        uint8_t progress = httpOTA.getProgress();
+        statusViewModel.setOTAProgress(progress);
+        if (progress >= lastHttpOTAProgress + 10)
+        {
+            lastHttpOTAProgress = progress - progress % 10;
+            char progressMsg[96];
+            snprintf(progressMsg, sizeof(progressMsg), "OTA Progress: %u%% (%zu/%zu bytes, %lu resumes, data gap %lu ms)",
+                     progress, httpOTA.getOffset(), httpOTA.getImageSize(), (unsigned long)httpOTA.getResumeCount(),
+                     otaDataGap());
+            publishOTAStatus(progressMsg);
         }
+        return;
     }
-    else
+
+    if (httpOTA.getState() == HttpOTADownloader::STATE_FAILED)
     {
-        LOG_ERROR(TAG, "Update error!");
-        publishOTAStatus("Update error!");
-        statusViewModel.setDeviceStatus(DEVICE_UPDATE_FAILED);
-        statusViewModel.setOTAActive(false); // Clear OTA flag
-        delay(2500);
-        statusViewModel.setDeviceStatus(DEVICE_STARTED);
+        LOG_ERROR(TAG, "HTTP OTA failed at %zu/%zu bytes: %s", httpOTA.getOffset(), httpOTA.getImageSize(),
+                  httpOTA.getError());
+        reportOTAFailure(httpOTA.getError());
+        httpOTA.clearResult();
+        return;
     }
+
+    // Image downloaded, verified and set as the boot partition
+    LOG_INFO(TAG, "HTTP OTA complete (%zu bytes, %lu resumes). Rebooting...", httpOTA.getImageSize(),
+             (unsigned long)httpOTA.getResumeCount());
+    publishOTACompleted();
+    statusViewModel.setOTAActive(false);
+    statusViewModel.setDeviceStatus(DEVICE_STARTED);
+    scheduleOTAResult(true);
+}
+
+void NovaLogicService::finishOTAUpdate(unsigned long start)
+{
+    // Verifies the digest and only then finalizes the image
+    if (!otaWriter.finish())
+    {
+        LOG_ERROR(TAG, "OTA rejected after %zu bytes: %s", (size_t)otaWriter.getWritten(), otaWriter.getError());
+        reportOTAFailure(otaWriter.getError());
+        return;
+    }
+
+    LOG_INFO(TAG, "Update successfully completed in %lu ms (receive stalled %lu ms on flash). Rebooting...",
+             millis() - start, (unsigned long)otaWriter.getStallTime());
+    publishOTACompleted();
+    statusViewModel.setOTAActive(false); // Clear OTA flag before reboot
+    statusViewModel.setDeviceStatus(DEVICE_STARTED);
+    scheduleOTAResult(true);
+}
+
+// Acquisition continuity is the cost of an update, so it goes out with the result
+void NovaLogicService::publishOTACompleted()
+{
+    char message[96];
+    snprintf(message, sizeof(message), "Update successfully completed. Longest genset data gap: %lu ms", otaDataGap());
+    publishOTAStatus(message);
+}
+
+unsigned long NovaLogicService::otaDataGap() const
+{
+    return otaDataGapProvider ? otaDataGapProvider() : 0;
+}
+
+void NovaLogicService::reportOTAFailure(const char* reason)
+{
+    char message[96];
+    snprintf(message, sizeof(message), "Error: %s", reason ? reason : "Update failed");
+    publishOTAStatus(message);
+
+    statusViewModel.setDeviceStatus(DEVICE_UPDATE_FAILED);
+    statusViewModel.setOTAActive(false); // Clear OTA flag
+    scheduleOTAResult(false);
+}
+
+// The result stays on the display for OTA_RESULT_DELAY_MS; serviceOTATransfer() then
+// restarts or returns to DEVICE_STARTED without holding the managers task meanwhile
+void NovaLogicService::scheduleOTAResult(bool restart)
+{
+    otaResultTime = millis();
+    otaResultPending = true;
+    otaRestartPending = otaRestartPending || restart;
+    managerEvents.wakeWithin(OTA_RESULT_DELAY_MS);
 }
 
 void NovaLogicService::publishOTAStatus(const char* message)
 {
     if (currentStatus == SERVICE_CONNECTED)
     {
-        char mqttTopic[128];
-        buildTopicPath(mqttTopic, sizeof(mqttTopic), "ota/status");
-        mqttClient->publish(mqttTopic, message);
+        mqttClient->publish(topicTable.get(MQTT_TOPIC_OTA_STATUS), message);
         LOG_DEBUG(TAG, "OTA Status: %s", message);
     }
     else
@@ -559,9 +1116,143 @@ void NovaLogicService::publishOTAStatus(const char* message)
     }
 }
 
-void NovaLogicService::parseMQTTMessage(const char* topic, const char* payload)
+void NovaLogicService::publishLogBatches()
+{
+    if (!globalLoggingManager || !mqttClient)
+        return;
+
+    LogMQTTSink& logSink = globalLoggingManager->getMQTTSink();
+
+    const char* mqttTopic = topicTable.get(MQTT_TOPIC_LOGS);
+
+    // Bounded per loop so a log backlog cannot starve the rest of the service
+    for (int i = 0; i < LOG_MQTT_MAX_BATCHES_PER_LOOP; i++)
+    {
+        size_t payloadLength = 0;
+        const LogBatchHeader* batch = logSink.receiveBatch(payloadLength);
+        if (!batch)
+            break;
+
+        bool published = mqttClient->publish(mqttTopic, batch + 1, payloadLength);
+        logSink.returnBatch(batch, published);
+        if (!published)
+        {
+            // The batch is kept; no new log event may come to trigger the retry
+            managerEvents.wakeWithin(LOG_MQTT_FLUSH_INTERVAL_MS);
+            break;
+        }
+    }
+
+    if (logSink.getDroppedTotal() != lastReportedLogDrops)
+    {
+        publishLogStats();
+    }
+}
+
+void NovaLogicService::publishLogTransfer()
+{
+    if (!globalLoggingManager || !mqttClient)
+        return;
+
+    LogTransfer& transfer = globalLoggingManager->getLogTransfer();
+    if (!transfer.isActive())
+        return;
+
+    // One chunk per interval keeps a dump from crowding out telemetry
+    unsigned long now = millis();
+    if (now - lastLogChunkTime < LOG_TRANSFER_CHUNK_INTERVAL_MS)
+    {
+        managerEvents.wakeWithin(LOG_TRANSFER_CHUNK_INTERVAL_MS - (now - lastLogChunkTime));
+        return;
+    }
+    lastLogChunkTime = now;
+    managerEvents.wakeWithin(LOG_TRANSFER_CHUNK_INTERVAL_MS);
+
+    // A chunk that could not be published is read and sent again next time
+    size_t length = transfer.readNextChunk();
+    if (length > 0 && publish(MQTT_TOPIC_LOGGING_LOGS, transfer.getBuffer(), length))
+    {
+        transfer.commitChunk();
+    }
+}
+
+void NovaLogicService::publishPostMortem()
+{
+    if (!globalLoggingManager || !mqttClient)
+        return;
+
+    PostMortem& postMortem = globalLoggingManager->getPostMortem();
+    if (!postMortem.hasPending())
+        return;
+
+    // Lowest priority: wait for requested log transfers and keep a slow pace
+    unsigned long now = millis();
+    if (globalLoggingManager->getLogTransfer().isActive())
+        return;
+    if (now - lastPostMortemTime < LOG_CRASH_UPLOAD_INTERVAL_MS)
+    {
+        managerEvents.wakeWithin(LOG_CRASH_UPLOAD_INTERVAL_MS - (now - lastPostMortemTime));
+        return;
+    }
+    lastPostMortemTime = now;
+    managerEvents.wakeWithin(LOG_CRASH_UPLOAD_INTERVAL_MS);
+
+    MQTTTopic topic;
+    size_t length = postMortem.readNext(topic);
+    if (length > 0 && publish(topic, postMortem.getBuffer(), length))
+    {
+        postMortem.commit();
+        if (!postMortem.hasPending())
+        {
+            LOG_INFO(TAG, "Post-mortem upload complete");
+        }
+    }
+}
+
+bool NovaLogicService::publish(MQTTTopic topic, const void* payload, size_t length, bool retain)
+{
+    if (currentStatus != SERVICE_CONNECTED || !mqttClient)
+        return false;
+
+    return mqttClient->publish(topicTable.get(topic), payload, length, 0, retain);
+}
+
+bool NovaLogicService::publishReliable(MQTTTopic topic, const void* payload, size_t length, bool retain)
+{
+    if (!publishWindow.enqueue(topicTable.get(topic), payload, length, retain))
+    {
+        LOG_WARN(TAG, "QoS1 window full - dropped publish to %s", MQTTTopicTable::getSuffix(topic));
+        return false;
+    }
+
+    servicePublishWindow();
+    return true;
+}
+
+void NovaLogicService::publishLogStats()
+{
+    LogMQTTSink& logSink = globalLoggingManager->getMQTTSink();
+    lastReportedLogDrops = logSink.getDroppedTotal();
+
+    const LogRateLimiter& rateLimiter = globalLoggingManager->getRateLimiter();
+
+    char payload[256];
+    snprintf(payload, sizeof(payload),
+             "{\"dropped\":{\"error\":%lu,\"warn\":%lu,\"info\":%lu,\"debug\":%lu},"
+             "\"batchesDropped\":%lu,\"publishFailures\":%lu,\"batchesSent\":%lu,\"recordsSent\":%lu,"
+             "\"repeated\":%lu,\"rateLimited\":%lu}",
+             (unsigned long)logSink.getDropped(LOG_LEVEL_ERROR), (unsigned long)logSink.getDropped(LOG_LEVEL_WARN),
+             (unsigned long)logSink.getDropped(LOG_LEVEL_INFO), (unsigned long)logSink.getDropped(LOG_LEVEL_DEBUG),
+             (unsigned long)logSink.getBatchesDropped(), (unsigned long)logSink.getPublishFailures(),
+             (unsigned long)logSink.getBatchesSent(), (unsigned long)logSink.getRecordsSent(),
+             (unsigned long)rateLimiter.getRepeatedTotal(), (unsigned long)rateLimiter.getSuppressedTotal());
+
+    mqttClient->publish(topicTable.get(MQTT_TOPIC_LOGS_STATS), payload, 0, true);
+}
+
+void NovaLogicService::parseMQTTMessage(const char* payload)
 {
-    LOG_DEBUG(TAG, "MQTT message received on topic: %s with payload: %s", topic, payload);
+    LOG_DEBUG(TAG, "MQTT message received on messages topic with payload: %s", payload);
 
     // Handle device model request
     if (strcmp(payload, MQTT_SVR_CMD_DEVICE_MODEL) == 0)
@@ -583,7 +1274,7 @@ void NovaLogicService::parseMQTTMessage(const char* topic, const char* payload)
     if (commandCallback)
     {
         LOG_DEBUG(TAG, "Forwarding unhandled message to external callback");
-        commandCallback(topic, payload);
+        commandCallback(MQTT_TOPIC_MESSAGES, payload);
     }
     else
     {
@@ -10,6 +10,13 @@
 
 #include "statusViewModel.h"
 #include "credentials.h"
+#include "mqttAckClient.h"
+#include "mqttTopicTable.h"
+#include "utils/mqttPublishWindow.h"
+#include "ota/otaWriter.h"
+#include "ota/deltaPatcher.h"
+#include "ota/httpOtaDownloader.h"
+#include "utils/lzss.h"
 
 class NovaLogicService : public BaseService
 {
@@ -29,10 +36,29 @@ public:
     void sendDeviceModel();
     void sendConnectionStatus(bool connected);
 
-    // Callback for external command processing
-    void setCommandCallback(std::function<void(const char*, const char*)> callback);
+    // Publish on a device topic (devices/<id>/<suffix>) for external command handlers
+    bool publish(MQTTTopic topic, const void* payload, size_t length, bool retain = false);
+
+    // QoS1 publish through the in-flight window; false if the window has no free slot
+    bool publishReliable(MQTTTopic topic, const void* payload, size_t length, bool retain = false);
+    MQTTPublishWindow& getPublishWindow() { return publishWindow; }
+
+    // Callback for external command processing, called with the topic the command arrived on
+    void setCommandCallback(std::function<void(MQTTTopic, const char*)> callback);
+
+    // Longest gap in genset data during the current OTA update (ms), reported on ota/status
+    void setOTADataGapProvider(std::function<unsigned long()> provider) { otaDataGapProvider = provider; }
 
 private:
+    // Stream carried by an MQTT OTA transfer
+    enum OTAKind : uint8_t
+    {
+        OTA_NONE,
+        OTA_IMAGE,       // ota/update: raw image
+        OTA_DELTA,       // ota/delta: patch against the running image
+        OTA_COMPRESSED   // ota/compressed: NLZ1 image
+    };
+
     // MQTT client management
     void initializeMQTTClient();
     void connectMQTT();
@@ -45,24 +71,81 @@ private:
     void onMQTTDisconnected();
 
     // MQTT message processing
-    void parseMQTTMessage(const char* topic, const char* payload);
+    void parseMQTTMessage(const char* payload);
 
     // OTA functionality
     bool isOTAVersionNewer(const char* version);
     void requestOTAUpdate();
-    void handleOTAUpdate(PicoMQTT::IncomingPacket& packets);
+    void handleOTAMessage(OTAKind kind, PicoMQTT::IncomingPacket& packets);
+    bool beginOTATransfer(OTAKind kind, size_t total, bool segmented);
+    const char* startDecodedOTA();
+    bool beginOTAWriter(size_t imageSize);
+    bool feedOTA(const uint8_t* data, size_t length);
+    bool feedWholeOTA(const uint8_t* data, size_t length);
+    bool isDeltaPending() const;
+    bool continueDelta();
+    size_t otaHeaderSize() const;
+    void completeOTATransfer();
+    void failOTATransfer(const char* reason);
+    void publishOTAAck();
+    void serviceOTATransfer();
+    size_t readOTAInput(PicoMQTT::IncomingPacket& packets, size_t length);
+    void finishOTAUpdate(unsigned long start);
+    bool isOTABusy();
+    void startHttpOTA(const char* payload);
+    void serviceHttpOTA();
+    void scheduleOTAResult(bool restart);
+    void reportOTAFailure(const char* reason);
     void publishOTAStatus(const char* message);
+    void publishOTACompleted();
+    unsigned long otaDataGap() const;
+
+    // Log shipping
+    void publishLogBatches();
+    void publishLogStats();
+    void publishLogTransfer();
+    void publishPostMortem();
 
     // Utility functions
-    void buildTopicPath(char* buffer, size_t bufferSize, const char* suffix);
     void processKeepAlive();
+    void servicePublishWindow();
 
     // Member variables
     StatusViewModel& statusViewModel;
-    PicoMQTT::Client* mqttClient;
+    MQTTAckClient* mqttClient;
+    uint16_t socketPort;            // Local port of the broker connection, watched by managerEvents
     unsigned long lastKeepAlive;
+    uint32_t lastReportedLogDrops;
+    unsigned long lastLogChunkTime;
+    unsigned long lastPostMortemTime;
     bool initialized;
-    std::function<void(const char*, const char*)> commandCallback;
+    std::function<void(MQTTTopic, const char*)> commandCallback;
+    std::function<unsigned long()> otaDataGapProvider;
+    uint8_t lastHttpOTAProgress;
+    MQTTTopicTable topicTable;
+    OTAWriter otaWriter;
+    DeltaPatcher deltaPatcher;
+    LzssDecoder otaDecoder;
+    HttpOTADownloader httpOTA;
+
+    // MQTT OTA transfer in progress (segments arrive across loop() calls)
+    OTAKind otaKind;
+    bool otaSegmented;
+    size_t otaTotal;                                // Stream bytes: image, patch or compressed image
+    size_t otaReceived;
+    uint8_t otaHeader[DELTA_PATCH_HEADER_SIZE];     // Patch or NLZ1 header, possibly split across segments
+    size_t otaHeaderLength;
+    unsigned long otaStart;
+    unsigned long otaLastSegment;
+    size_t otaNextProgress;
+    unsigned long otaResultTime;
+    bool otaResultPending;
+    bool otaRestartPending;
+
+    // QoS1 messages awaiting PUBACK (kept across reconnects)
+    MQTTPublishWindow publishWindow;
+    unsigned long lastWindowStats;
+    uint32_t lastWindowAcknowledged;
 };
 
 #endif // __NOVALOGICSERVICE_H__
\ No newline at end of file
@@ -1,4 +1,6 @@
 #include "tagoIOService.h"
+#include "utils/jsonStreamWriter.h"
+#include <time.h>
 
 // Logging tag
 static const char* TAG = "TagoIOService";
@@ -7,9 +9,23 @@ extern String getSerialNumber();
 static String deviceSerial = getSerialNumber();
 const char *MQTT_DEVICE_ID = deviceSerial.c_str();
 
+// Uplink volume before and after compression; raw / sent is the compression ratio
+static MetricCounter dataRawBytes(METRICS_PREFIX "uplink_raw_bytes", "Uplink payload bytes before compression", "payload", "data");
+static MetricCounter dataSentBytes(METRICS_PREFIX "uplink_sent_bytes", "Uplink payload bytes published", "payload", "data");
+static MetricCounter backfillRawBytes(METRICS_PREFIX "uplink_raw_bytes", "Uplink payload bytes before compression", "payload", "backfill");
+static MetricCounter backfillSentBytes(METRICS_PREFIX "uplink_sent_bytes", "Uplink payload bytes published", "payload", "backfill");
+
+#if TAGOIO_COMPRESSION_ENABLED
+// CPU time per compressed payload (microseconds, exposed in seconds)
+static const uint32_t COMPRESS_BOUNDS_US[] = {250, 500, 1000, 2500, 5000, 10000, 25000, 50000};
+static MetricHistogram compressTime(METRICS_PREFIX "uplink_compress_seconds", "Time to compress one uplink payload",
+                                    COMPRESS_BOUNDS_US, sizeof(COMPRESS_BOUNDS_US) / sizeof(COMPRESS_BOUNDS_US[0]), 1000000);
+#endif
+
 TagoIOService::TagoIOService()
     : BaseService("TagoIOService"), mqttClient(nullptr), 
-      lastKeepAlive(0), lastDataSend(0), initialized(false)
+      lastKeepAlive(0), lastDataSend(0), initialized(false), batchesSent(0),
+      lastStoreTime(0), lastBackfill(0), outageStart(0), backfillStart(0), backfillRecords(0)
 {
 }
 
@@ -28,6 +44,19 @@ void TagoIOService::begin()
     
     setStatus(SERVICE_STOPPED);
     initialized = true;
+
+    if (store.begin())
+    {
+        // Sizing for a 24 hour outage at the offline snapshot interval
+        uint32_t dayRecords = 86400000UL / TELEMETRY_STORE_INTERVAL_MS;
+        uint32_t recoverySeconds = dayRecords / TELEMETRY_BACKFILL_BURST * TELEMETRY_BACKFILL_INTERVAL_MS / 1000;
+        LOG_INFO(TAG, "Store-and-forward: %lu records pending, 24h outage = %lu records, backfill ~%lu s",
+                 (unsigned long)store.getPendingCount(), (unsigned long)dayRecords, (unsigned long)recoverySeconds);
+    }
+    else
+    {
+        LOG_WARN(TAG, "Store-and-forward unavailable - offline data will be lost");
+    }
     
     LOG_INFO(TAG, "Initialized");
 }
@@ -45,6 +74,11 @@ void TagoIOService::loop()
         mqttClient->loop();
     }
 
+    if (currentStatus != SERVICE_CONNECTED)
+    {
+        storeOfflineSnapshot();
+    }
+
     // State machine logic
     switch (currentStatus)
     {
@@ -72,7 +106,11 @@ void TagoIOService::loop()
 
     case SERVICE_CONNECTED:
         processKeepAlive();
-        processDataQueue();
+        if (!processDataQueue())
+        {
+            processBackfill();
+        }
+        servicePublishWindow();
         break;
 
     case SERVICE_ERROR:
@@ -114,7 +152,7 @@ void TagoIOService::initializeMQTTClient()
     if (!mqttClient)
     {
         LOG_INFO(TAG, "Creating MQTT client...");
-        mqttClient = new PicoMQTT::Client(MQTT_SERVER_TAGO_URL, MQTT_SERVER_TAGO_PORT, MQTT_DEVICE_ID, "Token", MQTT_SERVER_TAGO_DEVICE_TOKEN);
+        mqttClient = new MQTTAckClient(MQTT_SERVER_TAGO_URL, MQTT_SERVER_TAGO_PORT, MQTT_DEVICE_ID, "Token", MQTT_SERVER_TAGO_DEVICE_TOKEN);
 
         // Set up MQTT event handlers
         mqttClient->connected_callback = [this]()
@@ -126,6 +164,11 @@ void TagoIOService::initializeMQTTClient()
         {
             this->onMQTTDisconnected();
         };
+
+        mqttClient->acknowledged_callback = [this](uint16_t packetId)
+        {
+            this->publishWindow.acknowledge(packetId);
+        };
     }
 }
 
@@ -178,12 +221,18 @@ void TagoIOService::onMQTTConnected()
 
     setStatus(SERVICE_CONNECTED);
 
+    // Unacknowledged snapshots from the previous session go out again first
+    publishWindow.sessionRestarted();
+
     // Set up subscriptions (if any)
     setupSubscriptions();
 
     // Send initial connection status
     publishDeviceStatus("connected");
 
+    // Deltas sent before the disconnect may not have arrived
+    telemetryEncoder.forceKeyframe();
+
     lastKeepAlive = millis();
     lastDataSend = millis();
 }
@@ -208,37 +257,245 @@ void TagoIOService::processKeepAlive()
     }
 }
 
-void TagoIOService::processDataQueue()
+bool TagoIOService::processDataQueue()
 {
-    // This method can be extended to process queued data
-    // For now, it's a placeholder for future batch data processing
     unsigned long now = millis();
-    if (now - lastDataSend >= DATA_SEND_INTERVAL_MS)
+    if (now - lastDataSend < DATA_SEND_INTERVAL_MS)
+    {
+        return false;
+    }
+    lastDataSend = now;
+
+    if (snapshotProvider && snapshotProvider(snapshot))
     {
-        // Example: Send periodic system status
-        // This could be replaced with actual sensor data
-        lastDataSend = now;
+        publishSnapshot(snapshot);
     }
+    flushBatch();
+    return true;
 }
 
-void TagoIOService::publishSensorData(const char* variable, float value, const char* unit)
+void TagoIOService::storeOfflineSnapshot()
 {
-    if (currentStatus != SERVICE_CONNECTED)
+    unsigned long now = millis();
+    if (!store.isReady() || !snapshotProvider || now - lastStoreTime < TELEMETRY_STORE_INTERVAL_MS)
     {
-        LOG_WARN(TAG, "Cannot publish sensor data - not connected");
         return;
     }
+    lastStoreTime = now;
 
-    JsonDocument doc;
-    buildDataPayload(doc, variable, value, unit);
-    
-    String payload;
-    serializeJson(doc, payload);
-    
-    publishToTago(payload.c_str());
-    
-    LOG_DEBUG(TAG, "Published sensor data: %s = %.2f %s", 
-                variable, value, unit ? unit : "");
+    if (!snapshotProvider(snapshot))
+    {
+        return;
+    }
+
+    // Wall-clock time once SNTP has synced, otherwise uptime and boot count only
+    time_t unixTime = time(nullptr);
+    size_t length = TelemetryEncoder::encodeStandalone(snapshot, store.getNextSequence(), now,
+                                                       unixTime > 1600000000 ? (uint32_t)unixTime : 0,
+                                                       store.getBootCount(), storeBuffer, sizeof(storeBuffer));
+    if (length == 0 || !store.append(storeBuffer, length))
+    {
+        LOG_WARN(TAG, "Failed to store offline snapshot");
+        return;
+    }
+
+    if (outageStart == 0)
+    {
+        outageStart = now;
+    }
+    LOG_DEBUG(TAG, "Stored offline snapshot seq=%lu bytes=%u pending=%lu",
+              (unsigned long)(store.getNextSequence() - 1), (unsigned)length, (unsigned long)store.getPendingCount());
+}
+
+void TagoIOService::processBackfill()
+{
+    unsigned long now = millis();
+    if (!store.isReady())
+    {
+        return;
+    }
+
+    // Runs on its own service task, which calls loop() at least every SERVICES_TASK_INTERVAL_MS
+    unsigned long elapsed = now - lastBackfill;
+    if (elapsed < TELEMETRY_BACKFILL_INTERVAL_MS)
+    {
+        return;
+    }
+    lastBackfill = now;
+
+    bool drained = false;
+    for (int i = 0; i < TELEMETRY_BACKFILL_BURST && !drained; i++)
+    {
+        // Only top up the in-flight window, the remaining slots stay free for live data
+        if (publishWindow.getQueued() > 0)
+        {
+            break;
+        }
+
+        size_t length = store.readNext();
+        if (length == 0)
+        {
+            drained = true;
+            break;
+        }
+
+        if (backfillStart == 0)
+        {
+            backfillStart = now;
+            backfillRecords = 0;
+            uint32_t pending = store.getPendingCount();
+            LOG_INFO(TAG, "Backfill started: %lu records, estimated %lu s", (unsigned long)pending,
+                     (unsigned long)(pending / TELEMETRY_BACKFILL_BURST * TELEMETRY_BACKFILL_INTERVAL_MS / 1000));
+        }
+
+        // Left in the store if the window is full and retried next interval
+        const char* topic = MQTT_SERVER_TAGO_BACKFILL_TOPIC;
+        const uint8_t* payload = store.getPayload();
+        size_t sendLength = length;
+        uint32_t records = 1;
+#if TAGOIO_COMPRESSION_ENABLED
+        payload = compressBackfill(length, sendLength, records, topic);
+#endif
+        if (!publishWindow.enqueue(topic, payload, sendLength))
+        {
+            return;
+        }
+        backfillRawBytes.increment(length);
+        backfillSentBytes.increment(sendLength);
+        store.commit();
+        backfillRecords += records;
+        servicePublishWindow();
+    }
+
+    if (backfillStart != 0 && drained)
+    {
+        unsigned long recoverySeconds = (now - backfillStart) / 1000;
+        unsigned long outageSeconds = outageStart ? (backfillStart - outageStart) / 1000 : 0;
+        LOG_INFO(TAG, "Backfill complete: %lu records in %lu s after a %lu s outage",
+                 (unsigned long)backfillRecords, recoverySeconds, outageSeconds);
+        publishSensorData("backfill_recovery_s", (float)recoverySeconds, "s");
+
+        backfillStart = 0;
+        outageStart = 0;
+    }
+}
+
+#if TAGOIO_COMPRESSION_ENABLED
+// A stored keyframe on its own barely compresses, but it repeats the layout and most
+// values of the one before. The record just read is therefore sent together with the
+// ones after it as a CBOR sequence, compressed in one piece; length and records
+// become those of the block. A block that does not fit a window slot compressed is
+// rebuilt at half the size; a single record that does not shrink goes out as it is.
+const uint8_t* TagoIOService::compressBackfill(size_t& length, size_t& sendLength, uint32_t& records,
+                                               const char*& topic)
+{
+    size_t limit = sizeof(backfillBlock);
+    for (;;)
+    {
+        memcpy(backfillBlock, store.getPayload(), length);
+        size_t blockLength = length;
+        size_t next;
+        while ((next = store.readFollowing(limit > blockLength ? limit - blockLength : 0)) > 0)
+        {
+            memcpy(backfillBlock + blockLength, store.getPayload(), next);
+            blockLength += next;
+            records++;
+        }
+
+        size_t compressed = compressor.compress(backfillBlock, blockLength, TELEMETRY_BACKFILL_BLOCK_COMPRESSED_SIZE);
+        compressTime.observe(compressor.getLastMicros());
+        if (compressed > 0)
+        {
+            LOG_DEBUG(TAG, "Backfill block of %lu records: %u -> %u bytes (%u%%) in %lu us", (unsigned long)records,
+                      (unsigned)blockLength, (unsigned)compressed, (unsigned)(compressed * 100 / blockLength),
+                      (unsigned long)compressor.getLastMicros());
+            length = blockLength;
+            sendLength = compressed;
+            topic = MQTT_SERVER_TAGO_COMPRESSED_BACKFILL_TOPIC;
+            return compressor.getBuffer();
+        }
+
+        // The store buffer may hold a record readFollowing() turned down by now
+        if (records == 1)
+        {
+            sendLength = length;
+            return backfillBlock;
+        }
+
+        // Back to the first record alone
+        limit = blockLength / 2;
+        records = 1;
+        length = store.readNext();
+    }
+}
+#endif
+
+void TagoIOService::servicePublishWindow()
+{
+    if (!mqttClient || currentStatus != SERVICE_CONNECTED)
+    {
+        return;
+    }
+
+    publishWindow.service([this](const char* topic, const uint8_t* payload, size_t length, bool retain,
+                                 uint16_t packetId, bool) {
+        return mqttClient->publishWithId(topic, payload, length, retain, packetId);
+    });
+}
+
+void TagoIOService::flushBatch()
+{
+    size_t length = batch.serialize();
+    if (length == 0)
+    {
+        return;
+    }
+
+    // One publish per interval; on failure the merged values are kept for the next one
+    if (publishToTago(batch.getPayload(), length))
+    {
+        size_t variables = batch.getSerializedCount();
+        batch.commit();
+        batchesSent++;
+        LOG_DEBUG(TAG, "Published batch: %u variables, %u bytes", (unsigned)variables, (unsigned)length);
+    }
+}
+
+void TagoIOService::publishSensorData(const char* variable, float value, const char* unit)
+{
+    if (!batch.add(variable, value, unit))
+    {
+        LOG_WARN(TAG, "Batch full - dropped sensor data: %s", variable);
+    }
+}
+
+bool TagoIOService::publishSnapshot(const DSEValues& values)
+{
+    if (!mqttClient || currentStatus != SERVICE_CONNECTED)
+    {
+        return false;
+    }
+
+    unsigned long start = micros();
+    size_t length = telemetryEncoder.encode(values, millis());
+    unsigned long encodeTime = micros() - start;
+    if (length == 0)
+    {
+        return false;
+    }
+
+    if (!publishWindow.enqueue(MQTT_SERVER_TAGO_TELEMETRY_TOPIC, telemetryEncoder.getBuffer(), length))
+    {
+        LOG_WARN(TAG, "QoS1 window full - snapshot not sent");
+        return false;
+    }
+    telemetryEncoder.commit();
+    servicePublishWindow();
+
+    LOG_DEBUG(TAG, "Published %s snapshot seq=%lu bytes=%u encode_us=%lu",
+              telemetryEncoder.isKeyframe() ? "keyframe" : "delta",
+              (unsigned long)(telemetryEncoder.getSequence() - 1), (unsigned)length, encodeTime);
+    return true;
 }
 
 void TagoIOService::publishDeviceStatus(const char* status)
@@ -249,61 +506,92 @@ void TagoIOService::publishDeviceStatus(const char* status)
         return;
     }
 
-    JsonDocument doc;
-    buildDataPayload(doc, "device_status", 0, status);
-    
-    String payload;
-    serializeJson(doc, payload);
-    
-    publishToTago(payload.c_str());
-    
+    char payload[160];
+    JsonStreamWriter json(payload, sizeof(payload));
+    json.beginObject();
+    json.key("variable");
+    json.value("device_status");
+    json.key("value");
+    json.value(status);
+    json.key("timestamp");
+    json.value(millis());
+    json.key("metadata");
+    json.beginObject();
+    json.key("device");
+    json.value(DEVICE_NAME);
+    json.key("source");
+    json.value(serviceName);
+    json.endObject();
+    json.endObject();
+
+    if (!json.overflowed())
+    {
+        publishToTago(payload, json.length());
+    }
+
     LOG_DEBUG(TAG, "Published device status: %s", status);
 }
 
 void TagoIOService::publishBatchData(JsonDocument& dataArray)
 {
-    if (currentStatus != SERVICE_CONNECTED)
+    // Merged into the interval batch like individual variables
+    size_t added = 0;
+    for (JsonObject item : dataArray.as<JsonArray>())
     {
-        LOG_WARN(TAG, "Cannot publish batch data - not connected");
-        return;
+        const char* variable = item["variable"];
+        if (variable && item["value"].is<float>())
+        {
+            publishSensorData(variable, item["value"].as<float>(), item["unit"] | (const char*)nullptr);
+            added++;
+        }
     }
 
-    String payload;
-    serializeJson(dataArray, payload);
-    
-    publishToTago(payload.c_str());
-    
-    LOG_DEBUG(TAG, "Published batch data (%d items)", dataArray.size());
+    LOG_DEBUG(TAG, "Queued batch data (%u items)", (unsigned)added);
 }
 
-void TagoIOService::buildDataPayload(JsonDocument& doc, const char* variable, float value, const char* unit)
+// Compressed copy of the payload when compression is enabled and it gets smaller;
+// topic and length are switched to it. Otherwise the payload as it is.
+const uint8_t* TagoIOService::preparePayload(const uint8_t* payload, size_t& length, const char*& topic,
+                                             const char* compressedTopic)
 {
-    doc["variable"] = variable;
-    doc["value"] = value;
-    doc["timestamp"] = millis(); // This should be replaced with actual timestamp
-    
-    if (unit)
+#if TAGOIO_COMPRESSION_ENABLED
+    size_t compressed = compressor.compress(payload, length);
+    compressTime.observe(compressor.getLastMicros());
+    if (compressed > 0)
     {
-        doc["unit"] = unit;
+        LOG_DEBUG(TAG, "Compressed %u -> %u bytes (%u%%) in %lu us for %s", (unsigned)length, (unsigned)compressed,
+                  (unsigned)(compressed * 100 / length), (unsigned long)compressor.getLastMicros(), compressedTopic);
+        length = compressed;
+        topic = compressedTopic;
+        return compressor.getBuffer();
     }
-    
-    // Add device metadata
-    doc["metadata"]["device"] = "DL1000";
-    doc["metadata"]["source"] = serviceName;
+#endif
+    return payload;
 }
 
-void TagoIOService::publishToTago(const char* payload)
+bool TagoIOService::publishToTago(const char* payload, size_t length)
 {
     if (mqttClient && currentStatus == SERVICE_CONNECTED)
     {
-        // TagoIO typically uses a specific topic format
-        String topic = String("tago/data/post");
-        mqttClient->publish(topic.c_str(), payload, 1);
-        
-        LOG_DEBUG(TAG, "Data sent to TagoIO: %s", payload);
+        const char* topic = MQTT_SERVER_TAGO_DATA_TOPIC;
+        size_t sendLength = length;
+        const uint8_t* data = preparePayload((const uint8_t*)payload, sendLength, topic,
+                                             MQTT_SERVER_TAGO_COMPRESSED_DATA_TOPIC);
+        // QoS0: batches are larger than a window slot, and a QoS1 publish outside the
+        // window would take a packet ID the window may also use, so its PUBACK could
+        // release a window message that was never delivered
+        if (mqttClient->publish(topic, data, sendLength, 0))
+        {
+            dataRawBytes.increment(length);
+            dataSentBytes.increment(sendLength);
+            LOG_DEBUG(TAG, "Data sent to TagoIO: %u bytes", (unsigned)sendLength);
+            return true;
+        }
+        LOG_WARN(TAG, "TagoIO publish failed");
     }
     else
     {
         LOG_WARN(TAG, "Cannot send to TagoIO - not connected");
     }
+    return false;
 }
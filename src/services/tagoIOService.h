@@ -6,8 +6,16 @@
 
 #include <PicoMQTT.h>
 #include <ArduinoJson.h>
+#include <functional>
 
 #include "credentials.h"
+#include "mqttAckClient.h"
+#include "utils/mqttPublishWindow.h"
+#include "telemetry/telemetryEncoder.h"
+#include "telemetry/tagoIOBatch.h"
+#include "telemetry/telemetryStore.h"
+#include "telemetry/uplinkCompressor.h"
+#include "metrics/metricsRegistry.h"
 
 class TagoIOService : public BaseService
 {
@@ -22,9 +30,21 @@ public:
     void start() override;
 
     // Data publishing interface
+    // Sensor values are merged per variable and sent as one batch every DATA_SEND_INTERVAL_MS
     void publishSensorData(const char* variable, float value, const char* unit = nullptr);
     void publishDeviceStatus(const char* status);
     void publishBatchData(JsonDocument& dataArray);
+    uint32_t getBatchesSent() const { return batchesSent; }
+
+    // Full DSE snapshot in the compact binary format (see TelemetryEncoder)
+    bool publishSnapshot(const DSEValues& values);
+
+    // Source of the decoded DSE snapshots sent every DATA_SEND_INTERVAL_MS
+    void setSnapshotProvider(std::function<bool(DSEValues&)> provider) { snapshotProvider = provider; }
+
+    // Snapshots kept on flash while TagoIO is unreachable
+    const TelemetryStore& getTelemetryStore() const { return store; }
+    MQTTPublishWindow& getPublishWindow() { return publishWindow; }
 
 private:
     // MQTT client management
@@ -38,19 +58,55 @@ private:
     void onMQTTDisconnected();
 
     // Data publishing helpers
-    void buildDataPayload(JsonDocument& doc, const char* variable, float value, const char* unit = nullptr);
-    void publishToTago(const char* payload);
-    void processDataQueue();
+    bool publishToTago(const char* payload, size_t length);
+    const uint8_t* preparePayload(const uint8_t* payload, size_t& length, const char*& topic, const char* compressedTopic);
+    bool processDataQueue();
+    void flushBatch();
+
+    // Store-and-forward
+    void storeOfflineSnapshot();
+    void processBackfill();
+    void servicePublishWindow();
+#if TAGOIO_COMPRESSION_ENABLED
+    const uint8_t* compressBackfill(size_t& length, size_t& sendLength, uint32_t& records, const char*& topic);
+#endif
 
     // Utility functions
     void processKeepAlive();
 
     // Member variables
-    PicoMQTT::Client* mqttClient;
+    MQTTAckClient* mqttClient;
     unsigned long lastKeepAlive;
     unsigned long lastDataSend;
     bool initialized;
 
+    // Coalesced variables
+    TagoIOBatch batch;
+    uint32_t batchesSent;
+
+    // Binary telemetry
+    std::function<bool(DSEValues&)> snapshotProvider;
+    TelemetryEncoder telemetryEncoder;
+    DSEValues snapshot;
+
+    // Store-and-forward (live data always goes first, the backlog is paced)
+    TelemetryStore store;
+    uint8_t storeBuffer[TELEMETRY_STORE_RECORD_SIZE];
+    unsigned long lastStoreTime;
+    unsigned long lastBackfill;
+    unsigned long outageStart;      // First snapshot stored in the current outage (0 = none)
+    unsigned long backfillStart;    // First record replayed (0 = not replaying)
+    uint32_t backfillRecords;
+
+    // Snapshots and backfill records awaiting PUBACK
+    MQTTPublishWindow publishWindow;
+
+#if TAGOIO_COMPRESSION_ENABLED
+    // Data and backfill payloads, both sent from this service's task
+    UplinkCompressor compressor;
+    uint8_t backfillBlock[TELEMETRY_BACKFILL_BLOCK_SIZE];
+#endif
+
     // Configuration constants
     static const unsigned long CONNECTION_TIMEOUT_MS = 30000;  // 30 seconds
     static const unsigned long KEEPALIVE_INTERVAL_MS = 60000; // 60 seconds
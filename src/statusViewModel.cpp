@@ -1,7 +1,7 @@
 #include "statusViewModel.h"
 
 StatusViewModel::StatusViewModel()
-    : version(FIRMWARE_VERSION), deviceStatus(DEVICE_STARTED), networkStatus(NETWORK_STOPPED), connectivityStatus(CONNECTIVITY_OFFLINE), servicesStatus(SERVICES_STOPPED), modbusStatus(MODBUS_INACTIVE), otaActive(false), dirty(true) // Start as dirty to trigger initial updates
+    : version(FIRMWARE_VERSION), deviceStatus(DEVICE_STARTED), networkStatus(NETWORK_STOPPED), connectivityStatus(CONNECTIVITY_OFFLINE), servicesStatus(SERVICES_STOPPED), modbusStatus(MODBUS_INACTIVE), otaActive(false), otaProgress(0), dirty(true) // Start as dirty to trigger initial updates
 {
     // Initialize strings
     strncpy(macAddress, "", sizeof(macAddress) - 1);
@@ -162,7 +162,11 @@ void StatusViewModel::setDirty()
 void StatusViewModel::updateStatusString()
 {
     // Create aggregated status based on current states
-    if (deviceStatus == DEVICE_UPDATING)
+    if (deviceStatus == DEVICE_UPDATING && otaActive)
+    {
+        snprintf(statusString, sizeof(statusString), "UPD %u%%", otaProgress);
+    }
+    else if (deviceStatus == DEVICE_UPDATING)
     {
         strncpy(statusString, "UPDATING", sizeof(statusString) - 1);
     }
@@ -213,10 +217,25 @@ void StatusViewModel::setOTAActive(bool active)
     if (otaActive != active)
     {
         otaActive = active;
-        setDirty();
+        otaProgress = 0;
+        updateStatusString();
     }
 }
 
+void StatusViewModel::setOTAProgress(uint8_t percent)
+{
+    if (otaProgress != percent)
+    {
+        otaProgress = percent;
+        updateStatusString();
+    }
+}
+
+uint8_t StatusViewModel::getOTAProgress() const
+{
+    return otaProgress;
+}
+
 bool StatusViewModel::isOTAActive() const
 {
     return otaActive;
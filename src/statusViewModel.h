@@ -2,6 +2,8 @@
 #ifndef __STATUSVIEWMODEL_H__
 #define __STATUSVIEWMODEL_H__
 
+#include <cstdint>
+#include <cstdio>
 #include <cstring>
 #include "definitions.h"
 
@@ -34,6 +36,8 @@ public:
     // OTA management
     void setOTAActive(bool active);
     bool isOTAActive() const;
+    void setOTAProgress(uint8_t percent);
+    uint8_t getOTAProgress() const;
 
     // Dirty flag management
     bool isDirty() const;
@@ -58,6 +62,7 @@ private:
 
     // OTA status
     bool otaActive;
+    uint8_t otaProgress;   // Percent shown in the status string while updating
 
     // Dirty flag
     mutable bool dirty;
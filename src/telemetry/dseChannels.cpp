@@ -0,0 +1,140 @@
+#include "dseChannels.h"
+#include <stddef.h>
+
+const DSEChannel DSE_CHANNELS[DSE_CHANNEL_COUNT] = {
+    { 1, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, oilPressure), DSE_U16,  0, "oilPressure", "kPa"},
+    { 2, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, coolantTemp), DSE_S16,  0, "coolantTemp", "C"},
+    { 3, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, oilTemp), DSE_S16,  0, "oilTemp", "C"},
+    { 4, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, fuelLevel), DSE_U16,  0, "fuelLevel", "%"},
+    { 5, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, chargeAlternatorVoltage), DSE_U16, -1, "chargeAlternatorVoltage", "V"},
+    { 6, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, engineBatteryVoltage), DSE_U16, -1, "engineBatteryVoltage", "V"},
+    { 7, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, engineSpeed), DSE_U16,  0, "engineSpeed", "rpm"},
+    { 8, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorFrequency), DSE_U16, -1, "generatorFrequency", "Hz"},
+    { 9, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL1NVoltage), DSE_U32, -1, "generatorL1NVoltage", "V"},
+    {10, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL2NVoltage), DSE_U32, -1, "generatorL2NVoltage", "V"},
+    {11, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL3NVoltage), DSE_U32, -1, "generatorL3NVoltage", "V"},
+    {12, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL1L2Voltage), DSE_U32, -1, "generatorL1L2Voltage", "V"},
+    {13, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL2L3Voltage), DSE_U32, -1, "generatorL2L3Voltage", "V"},
+    {14, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL3L1Voltage), DSE_U32, -1, "generatorL3L1Voltage", "V"},
+    {15, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL1Current), DSE_U32, -1, "generatorL1Current", "A"},
+    {16, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL2Current), DSE_U32, -1, "generatorL2Current", "A"},
+    {17, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL3Current), DSE_U32, -1, "generatorL3Current", "A"},
+    {18, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorEarthCurrent), DSE_U32, -1, "generatorEarthCurrent", "A"},
+    {19, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL1Watts), DSE_S32,  0, "generatorL1Watts", "W"},
+    {20, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL2Watts), DSE_S32,  0, "generatorL2Watts", "W"},
+    {21, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorL3Watts), DSE_S32,  0, "generatorL3Watts", "W"},
+    {22, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorCurrentLagLead), DSE_S16,  0, "generatorCurrentLagLead", "deg"},
+    {23, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsFrequency), DSE_U16, -1, "mainsFrequency", "Hz"},
+    {24, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL1NVoltage), DSE_U32, -1, "mainsL1NVoltage", "V"},
+    {25, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL2NVoltage), DSE_U32, -1, "mainsL2NVoltage", "V"},
+    {26, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL3NVoltage), DSE_U32, -1, "mainsL3NVoltage", "V"},
+    {27, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL1L2Voltage), DSE_U32, -1, "mainsL1L2Voltage", "V"},
+    {28, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL2L3Voltage), DSE_U32, -1, "mainsL2L3Voltage", "V"},
+    {29, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL3L1Voltage), DSE_U32, -1, "mainsL3L1Voltage", "V"},
+    {30, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsVoltagePhaseLagLead), DSE_S16,  0, "mainsVoltagePhaseLagLead", "deg"},
+    {31, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, generatorPhaseRotation), DSE_U16,  0, "generatorPhaseRotation", ""},
+    {32, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsPhaseRotation), DSE_U16,  0, "mainsPhaseRotation", ""},
+    {33, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsCurrentLagLead), DSE_S16,  0, "mainsCurrentLagLead", "deg"},
+    {34, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL1Current), DSE_U32, -1, "mainsL1Current", "A"},
+    {35, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL2Current), DSE_U32, -1, "mainsL2Current", "A"},
+    {36, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL3Current), DSE_U32, -1, "mainsL3Current", "A"},
+    {37, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsEarthCurrent), DSE_U32, -1, "mainsEarthCurrent", "A"},
+    {38, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL1Watts), DSE_S32,  0, "mainsL1Watts", "W"},
+    {39, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL2Watts), DSE_S32,  0, "mainsL2Watts", "W"},
+    {40, 4, offsetof(DSEData, page4) + offsetof(DSEPage4_BasicInstrumentation, mainsL3Watts), DSE_S32,  0, "mainsL3Watts", "W"},
+    {41, 5, offsetof(DSEData, page5) + offsetof(DSEPage5_ExtendedInstrumentation, fuelConsumption), DSE_U32, -2, "fuelConsumption", "L/h"},
+    {42, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorTotalWatts), DSE_S32,  0, "generatorTotalWatts", "W"},
+    {43, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorL1VA), DSE_U32,  0, "generatorL1VA", "VA"},
+    {44, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorL2VA), DSE_U32,  0, "generatorL2VA", "VA"},
+    {45, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorL3VA), DSE_U32,  0, "generatorL3VA", "VA"},
+    {46, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorTotalVA), DSE_U32,  0, "generatorTotalVA", "VA"},
+    {47, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorL1VAR), DSE_S32,  0, "generatorL1VAR", "var"},
+    {48, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorL2VAR), DSE_S32,  0, "generatorL2VAR", "var"},
+    {49, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorL3VAR), DSE_S32,  0, "generatorL3VAR", "var"},
+    {50, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorTotalVAR), DSE_S32,  0, "generatorTotalVAR", "var"},
+    {51, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorPowerFactorL1), DSE_S16, -2, "generatorPowerFactorL1", ""},
+    {52, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorPowerFactorL2), DSE_S16, -2, "generatorPowerFactorL2", ""},
+    {53, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorPowerFactorL3), DSE_S16, -2, "generatorPowerFactorL3", ""},
+    {54, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorAveragePowerFactor), DSE_S16, -2, "generatorAveragePowerFactor", ""},
+    {55, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorPercentageFullPower), DSE_S16, -1, "generatorPercentageFullPower", "%"},
+    {56, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, generatorPercentageFullVar), DSE_S16, -1, "generatorPercentageFullVar", "%"},
+    {57, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, mainsTotalWatts), DSE_S32,  0, "mainsTotalWatts", "W"},
+    {58, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, mainsL1VA), DSE_U32,  0, "mainsL1VA", "VA"},
+    {59, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, mainsL2VA), DSE_U32,  0, "mainsL2VA", "VA"},
+    {60, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, mainsL3VA), DSE_U32,  0, "mainsL3VA", "VA"},
+    {61, 6, offsetof(DSEData, page6) + offsetof(DSEPage6_DerivedInstrumentation, mainsTotalVA), DSE_U32,  0, "mainsTotalVA", "VA"},
+    {62, 7, offsetof(DSEData, page7) + offsetof(DSEPage7_AccumulatedInstrumentation, engineRunTime), DSE_U32,  0, "engineRunTime", "s"},
+};
+
+int64_t dseChannelValue(const DSEData &data, const DSEChannel &channel)
+{
+    const uint8_t *field = reinterpret_cast<const uint8_t *>(&data) + channel.offset;
+
+    switch (channel.type)
+    {
+    case DSE_U16:
+    {
+        uint16_t value;
+        memcpy(&value, field, sizeof(value));
+        return value;
+    }
+    case DSE_S16:
+    {
+        int16_t value;
+        memcpy(&value, field, sizeof(value));
+        return value;
+    }
+    case DSE_U32:
+    {
+        uint32_t value;
+        memcpy(&value, field, sizeof(value));
+        return value;
+    }
+    case DSE_S32:
+    {
+        int32_t value;
+        memcpy(&value, field, sizeof(value));
+        return value;
+    }
+    }
+    return 0;
+}
+
+uint8_t dsePageMask(const DSEData &data)
+{
+    return (data.page4Valid ? 0x01 : 0) | (data.page5Valid ? 0x02 : 0) |
+           (data.page6Valid ? 0x04 : 0) | (data.page7Valid ? 0x08 : 0);
+}
+
+void dseDecode(const DSEData &data, DSEValues &values)
+{
+    values.pageMask = dsePageMask(data);
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        const DSEChannel &channel = DSE_CHANNELS[i];
+        values.raw[i] = dseChannelValid(channel, values.pageMask) ? dseChannelValue(data, channel) : 0;
+    }
+}
+
+size_t dseFormatValue(const DSEChannel &channel, int64_t raw, char *out, size_t size)
+{
+    // Fixed point, no float rounding: scale -1 gives one decimal, -2 two
+    int written;
+    if (channel.scale >= 0)
+    {
+        int64_t value = raw;
+        for (int8_t i = 0; i < channel.scale; i++)
+            value *= 10;
+        written = snprintf(out, size, "%lld", (long long)value);
+    }
+    else
+    {
+        uint64_t divisor = 1;
+        for (int8_t i = 0; i > channel.scale; i--)
+            divisor *= 10;
+        uint64_t magnitude = raw < 0 ? (uint64_t)(-raw) : (uint64_t)raw;
+        written = snprintf(out, size, "%s%llu.%0*llu", raw < 0 ? "-" : "", (unsigned long long)(magnitude / divisor),
+                           (int)-channel.scale, (unsigned long long)(magnitude % divisor));
+    }
+    return written < 0 ? 0 : min((size_t)written, size ? size - 1 : 0);
+}
@@ -0,0 +1,68 @@
+#pragma once
+#ifndef __DSECHANNELS_H__
+#define __DSECHANNELS_H__
+
+#include <Arduino.h>
+
+#include "services/modbusMonitorService.h"
+
+/*
+ * DSE telemetry channel table
+ *
+ * Every instrumentation value in DSEData has a fixed channel ID so telemetry
+ * can carry small integers instead of variable names. Values are the raw
+ * register integers; the real value is raw * 10^scale in the given unit.
+ *
+ * IDs are part of the wire format: only append new channels, never renumber.
+ * scripts/telemetrydecode.py carries the same table.
+ */
+
+enum DSEChannelType : uint8_t
+{
+    DSE_U16,
+    DSE_S16,
+    DSE_U32,
+    DSE_S32
+};
+
+struct DSEChannel
+{
+    uint8_t id;
+    uint8_t page;           // DSE register page (4-7), decides validity
+    uint16_t offset;        // Byte offset of the field in DSEData
+    DSEChannelType type;
+    int8_t scale;           // Power of ten applied to the raw value
+    const char *name;
+    const char *unit;
+};
+
+#define DSE_CHANNEL_COUNT 62
+
+extern const DSEChannel DSE_CHANNELS[DSE_CHANNEL_COUNT];
+
+// Decoded snapshot, shared by every consumer of the same Modbus data
+struct DSEValues
+{
+    uint8_t pageMask;                       // dsePageMask() of the source data
+    int64_t raw[DSE_CHANNEL_COUNT];         // Indexed like DSE_CHANNELS, 0 on invalid pages
+};
+
+// Raw register value of a channel
+int64_t dseChannelValue(const DSEData &data, const DSEChannel &channel);
+
+// Bit (page - 4) set for every valid page
+uint8_t dsePageMask(const DSEData &data);
+
+// Whether the channel's page is valid in pageMask
+inline bool dseChannelValid(const DSEChannel &channel, uint8_t pageMask)
+{
+    return pageMask & (1 << (channel.page - 4));
+}
+
+// Raw values of every channel in one pass
+void dseDecode(const DSEData &data, DSEValues &values);
+
+// Real value (raw * 10^scale) as decimal text, e.g. "230.5"; returns the length
+size_t dseFormatValue(const DSEChannel &channel, int64_t raw, char *out, size_t size);
+
+#endif // __DSECHANNELS_H__
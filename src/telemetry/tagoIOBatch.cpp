@@ -0,0 +1,132 @@
+#include "tagoIOBatch.h"
+#include "utils/jsonStreamWriter.h"
+
+// Upper bound of a serialized variable: escaping at most doubles the strings,
+// plus keys, number and punctuation
+static size_t maxItemLength(const char *name, const char *unit)
+{
+    return 2 * strlen(name) + 2 * strlen(unit) + 80;
+}
+
+static void copyBounded(char *dest, const char *src, size_t size)
+{
+    strncpy(dest, src ? src : "", size - 1);
+    dest[size - 1] = '\0';
+}
+
+TagoIOBatch::TagoIOBatch()
+    : variables(), count(0), updateCounter(0), dropped(0), serializedCount(0)
+{
+    arena[0] = '\0';
+    batchMutex = xSemaphoreCreateMutex();
+}
+
+TagoIOBatch::~TagoIOBatch()
+{
+    if (batchMutex)
+        vSemaphoreDelete(batchMutex);
+}
+
+bool TagoIOBatch::add(const char *variable, float value, const char *unit)
+{
+    if (!variable || xSemaphoreTake(batchMutex, pdMS_TO_TICKS(10)) != pdTRUE)
+    {
+        dropped++;
+        return false;
+    }
+
+    Variable *slot = nullptr;
+    for (size_t i = 0; i < count; i++)
+    {
+        if (strncmp(variables[i].name, variable, TAGOIO_VARIABLE_NAME_LENGTH - 1) == 0)
+        {
+            slot = &variables[i];
+            break;
+        }
+    }
+
+    if (!slot && count < TAGOIO_BATCH_MAX_VARIABLES)
+    {
+        slot = &variables[count++];
+        copyBounded(slot->name, variable, sizeof(slot->name));
+        slot->sentStamp = 0;
+    }
+
+    if (slot)
+    {
+        copyBounded(slot->unit, unit, sizeof(slot->unit));
+        slot->value = value;
+        slot->timestamp = millis();
+        slot->stamp = ++updateCounter;
+    }
+    else
+    {
+        dropped++;
+    }
+
+    xSemaphoreGive(batchMutex);
+    return slot != nullptr;
+}
+
+size_t TagoIOBatch::serialize()
+{
+    serializedCount = 0;
+    if (xSemaphoreTake(batchMutex, pdMS_TO_TICKS(100)) != pdTRUE)
+        return 0;
+
+    JsonStreamWriter json(arena, sizeof(arena));
+    json.beginArray();
+    for (size_t i = 0; i < count; i++)
+    {
+        Variable &variable = variables[i];
+        variable.sentStamp = 0;
+
+        // Keep room for the closing bracket; the rest waits for the next interval
+        if (json.length() + maxItemLength(variable.name, variable.unit) + 2 > sizeof(arena))
+            continue;
+
+        json.beginObject();
+        json.key("variable");
+        json.value(variable.name);
+        json.key("value");
+        json.value(variable.value);
+        if (variable.unit[0])
+        {
+            json.key("unit");
+            json.value(variable.unit);
+        }
+        json.key("timestamp");
+        json.value(variable.timestamp);
+        json.endObject();
+
+        variable.sentStamp = variable.stamp;
+        serializedCount++;
+    }
+    json.endArray();
+
+    xSemaphoreGive(batchMutex);
+    return (serializedCount > 0 && !json.overflowed()) ? json.length() : 0;
+}
+
+void TagoIOBatch::commit()
+{
+    if (xSemaphoreTake(batchMutex, pdMS_TO_TICKS(100)) != pdTRUE)
+        return;
+
+    // Release the published slots unless a newer value arrived meanwhile
+    size_t i = 0;
+    while (i < count)
+    {
+        if (variables[i].sentStamp == variables[i].stamp)
+        {
+            variables[i] = variables[--count];
+        }
+        else
+        {
+            i++;
+        }
+    }
+    serializedCount = 0;
+
+    xSemaphoreGive(batchMutex);
+}
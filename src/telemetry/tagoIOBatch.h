@@ -0,0 +1,69 @@
+#pragma once
+#ifndef __TAGOIOBATCH_H__
+#define __TAGOIOBATCH_H__
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "definitions.h"
+
+/*
+ * Coalescing TagoIO variable batch
+ *
+ * Variables added during one send interval are merged by name, keeping only
+ * the latest value, in a fixed table of TAGOIO_BATCH_MAX_VARIABLES slots.
+ * serialize() writes the pending variables in one pass into a fixed arena as a
+ * single TagoIO data array:
+ *   [{"variable":"oil_pressure","value":412,"unit":"kPa","timestamp":1234},...]
+ * Nothing is allocated after construction.
+ *
+ * Slots are released by commit() only after the publish succeeded, and only if
+ * they were not updated in the meantime, so a failed interval is retried with
+ * the latest values. Variables that do not fit in the arena stay for the next
+ * interval.
+ */
+
+class TagoIOBatch
+{
+public:
+    TagoIOBatch();
+    ~TagoIOBatch();
+
+    // Merge a value; returns false if the table is full (counted as dropped)
+    bool add(const char *variable, float value, const char *unit = nullptr);
+
+    // Serialize pending variables into the arena; returns the payload length (0 if empty)
+    size_t serialize();
+    const char *getPayload() const { return arena; }
+    size_t getSerializedCount() const { return serializedCount; }
+
+    // The last serialized payload was published
+    void commit();
+
+    size_t getPendingCount() const { return count; }
+    uint32_t getDropped() const { return dropped; }
+
+private:
+    struct Variable
+    {
+        char name[TAGOIO_VARIABLE_NAME_LENGTH];
+        char unit[TAGOIO_VARIABLE_UNIT_LENGTH];
+        float value;
+        uint32_t timestamp;
+        uint32_t stamp;         // Update counter value of the latest add()
+        uint32_t sentStamp;     // stamp that went into the last serialize()
+    };
+
+    Variable variables[TAGOIO_BATCH_MAX_VARIABLES];
+    size_t count;
+    uint32_t updateCounter;
+    uint32_t dropped;
+
+    char arena[TAGOIO_BATCH_ARENA_SIZE];
+    size_t serializedCount;
+
+    SemaphoreHandle_t batchMutex;
+};
+
+#endif // __TAGOIOBATCH_H__
@@ -0,0 +1,140 @@
+#include "telemetryEncoder.h"
+#include "utils/cborWriter.h"
+
+// Map keys
+static const uint8_t KEY_VERSION = 0;
+static const uint8_t KEY_SEQUENCE = 1;
+static const uint8_t KEY_TIMESTAMP = 2;
+static const uint8_t KEY_PAGES = 3;
+static const uint8_t KEY_KEYFRAME = 4;
+static const uint8_t KEY_DELTA = 5;
+static const uint8_t KEY_UNIX_TIME = 6;
+static const uint8_t KEY_BOOT = 7;
+
+TelemetryEncoder::TelemetryEncoder()
+    : basis(), pending(), basisMask(0), pendingMask(0), pendingKeyframe(false),
+      sequence(0), sinceKeyframe(0), keyframeDue(true)
+{
+}
+
+size_t TelemetryEncoder::encode(const DSEValues &values, uint32_t timestamp)
+{
+    pendingMask = values.pageMask;
+    if (pendingMask == 0)
+        return 0;
+
+    size_t changed = 0;
+    size_t validCount = 0;
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        const DSEChannel &channel = DSE_CHANNELS[i];
+        if (!dseChannelValid(channel, pendingMask))
+            continue;
+
+        pending[i] = values.raw[i];
+        validCount++;
+        if (pending[i] != basis[i])
+            changed++;
+    }
+
+    pendingKeyframe = keyframeDue || pendingMask != basisMask || sinceKeyframe >= TELEMETRY_KEYFRAME_INTERVAL;
+
+    CborWriter cbor(buffer, sizeof(buffer));
+    cbor.beginMap(5);
+    cbor.value(KEY_VERSION);
+    cbor.value(TELEMETRY_FORMAT_VERSION);
+    cbor.value(KEY_SEQUENCE);
+    cbor.value(sequence);
+    cbor.value(KEY_TIMESTAMP);
+    cbor.value(timestamp);
+    cbor.value(KEY_PAGES);
+    cbor.value(pendingMask);
+
+    if (pendingKeyframe)
+    {
+        cbor.value(KEY_KEYFRAME);
+        cbor.beginArray(validCount);
+        for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+        {
+            if (dseChannelValid(DSE_CHANNELS[i], pendingMask))
+                cbor.valueSigned(pending[i]);
+        }
+    }
+    else
+    {
+        cbor.value(KEY_DELTA);
+        cbor.beginArray(changed * 2);
+        uint8_t previousId = 0;
+        for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+        {
+            if (!dseChannelValid(DSE_CHANNELS[i], pendingMask) || pending[i] == basis[i])
+                continue;
+
+            cbor.value((uint8_t)(DSE_CHANNELS[i].id - previousId));
+            cbor.valueSigned(pending[i] - basis[i]);
+            previousId = DSE_CHANNELS[i].id;
+        }
+    }
+
+    return cbor.overflowed() ? 0 : cbor.length();
+}
+
+void TelemetryEncoder::commit()
+{
+    memcpy(basis, pending, sizeof(basis));
+    basisMask = pendingMask;
+    sequence++;
+
+    if (pendingKeyframe)
+    {
+        sinceKeyframe = 0;
+        keyframeDue = false;
+    }
+    else
+    {
+        sinceKeyframe++;
+    }
+}
+
+size_t TelemetryEncoder::encodeStandalone(const DSEValues &values, uint32_t sequence, uint32_t timestamp,
+                                          uint32_t unixTime, uint32_t bootCount, uint8_t *out, size_t outSize)
+{
+    uint8_t pageMask = values.pageMask;
+    if (pageMask == 0)
+        return 0;
+
+    size_t validCount = 0;
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        if (dseChannelValid(DSE_CHANNELS[i], pageMask))
+            validCount++;
+    }
+
+    CborWriter cbor(out, outSize);
+    cbor.beginMap(unixTime ? 7 : 6);
+    cbor.value(KEY_VERSION);
+    cbor.value(TELEMETRY_FORMAT_VERSION);
+    cbor.value(KEY_SEQUENCE);
+    cbor.value(sequence);
+    cbor.value(KEY_TIMESTAMP);
+    cbor.value(timestamp);
+    cbor.value(KEY_PAGES);
+    cbor.value(pageMask);
+    if (unixTime)
+    {
+        cbor.value(KEY_UNIX_TIME);
+        cbor.value(unixTime);
+    }
+    cbor.value(KEY_BOOT);
+    cbor.value(bootCount);
+
+    cbor.value(KEY_KEYFRAME);
+    cbor.beginArray(validCount);
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        if (dseChannelValid(DSE_CHANNELS[i], pageMask))
+            cbor.valueSigned(values.raw[i]);
+    }
+
+    return cbor.overflowed() ? 0 : cbor.length();
+}
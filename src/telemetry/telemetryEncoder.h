@@ -0,0 +1,71 @@
+#pragma once
+#ifndef __TELEMETRYENCODER_H__
+#define __TELEMETRYENCODER_H__
+
+#include <Arduino.h>
+
+#include "definitions.h"
+#include "telemetry/dseChannels.h"
+
+/*
+ * Compact binary encoding of DSE snapshots
+ *
+ * One CBOR map per snapshot, integer keys only:
+ *   0: format version (TELEMETRY_FORMAT_VERSION)
+ *   1: sequence number (+1 per published snapshot)
+ *   2: timestamp (millis)
+ *   3: valid page mask (bit 0 = page 4 ... bit 3 = page 7)
+ *   4: keyframe - raw values of every channel on a valid page, in channel ID order
+ *   5: delta    - [idGap, valueDelta, idGap, valueDelta, ...] for changed channels
+ *                 only, against the previous snapshot (idGap from the previous
+ *                 changed ID, starting at 0)
+ *   6: unix time in seconds (standalone snapshots, only once the clock is set)
+ *   7: boot count (standalone snapshots; key 2 restarts at every boot)
+ *
+ * A keyframe is sent first, every TELEMETRY_KEYFRAME_INTERVAL snapshots, when
+ * the page mask changes and after forceKeyframe() (e.g. on reconnect). A
+ * receiver that sees a sequence gap waits for the next keyframe.
+ *
+ * The delta basis only advances on commit(), so a snapshot that could not be
+ * published is re-encoded against the same basis next time.
+ */
+
+#define TELEMETRY_FORMAT_VERSION 1
+
+class TelemetryEncoder
+{
+public:
+    TelemetryEncoder();
+
+    // Encode into the internal buffer; returns the payload size (0 if no page is valid)
+    size_t encode(const DSEValues &values, uint32_t timestamp);
+    const uint8_t *getBuffer() const { return buffer; }
+    bool isKeyframe() const { return pendingKeyframe; }
+
+    // The last encoded snapshot was published
+    void commit();
+    void forceKeyframe() { keyframeDue = true; }
+
+    uint32_t getSequence() const { return sequence; }
+
+    // Self-contained keyframe for the store-and-forward queue; does not touch the
+    // delta chain. unixTime 0 means the wall clock is not known yet.
+    static size_t encodeStandalone(const DSEValues &values, uint32_t sequence, uint32_t timestamp, uint32_t unixTime,
+                                   uint32_t bootCount, uint8_t *out, size_t outSize);
+
+private:
+    uint8_t buffer[TELEMETRY_BUFFER_SIZE];
+
+    // Values of the last committed snapshot and of the one being published
+    int64_t basis[DSE_CHANNEL_COUNT];
+    int64_t pending[DSE_CHANNEL_COUNT];
+    uint8_t basisMask;
+    uint8_t pendingMask;
+    bool pendingKeyframe;
+
+    uint32_t sequence;
+    uint16_t sinceKeyframe;
+    bool keyframeDue;
+};
+
+#endif // __TELEMETRYENCODER_H__
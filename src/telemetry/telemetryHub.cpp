@@ -0,0 +1,118 @@
+#include "telemetryHub.h"
+#include "utils/jsonStreamWriter.h"
+#include "managers/loggingManager.h"
+
+static const char *TAG = "TelemetryHub";
+
+TelemetryHub telemetryHub;
+
+TelemetryHub::TelemetryHub()
+    : values(), changed(0), text(), jsonLength(0), sequence(0), timestamp(0)
+{
+    json[0] = '\0';
+    valuesMutex = xSemaphoreCreateMutex();
+}
+
+TelemetryHub::~TelemetryHub()
+{
+    if (valuesMutex)
+        vSemaphoreDelete(valuesMutex);
+}
+
+void TelemetryHub::update(const DSEData &data)
+{
+    DSEValues decoded;
+    dseDecode(data, decoded);
+
+    // Text, values and JSON change together for copyJson() on other tasks
+    if (xSemaphoreTake(valuesMutex, pdMS_TO_TICKS(10)) != pdTRUE)
+    {
+        LOG_WARN(TAG, "Values busy - update skipped");
+        return;
+    }
+
+    // Only changed channels are formatted again
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        const DSEChannel &channel = DSE_CHANNELS[i];
+        bool valid = dseChannelValid(channel, decoded.pageMask);
+        bool wasValid = dseChannelValid(channel, values.pageMask);
+        bool same = valid == wasValid && (!valid || decoded.raw[i] == values.raw[i]);
+        if (sequence != 0 ? same : !valid)
+            continue;
+
+        changed |= 1ULL << i;
+        if (valid)
+            dseFormatValue(channel, decoded.raw[i], text[i], sizeof(text[i]));
+        else
+            text[i][0] = '\0';
+    }
+
+    values = decoded;
+    sequence++;
+    timestamp = millis();
+    encodeJson();
+    xSemaphoreGive(valuesMutex);
+}
+
+uint64_t TelemetryHub::takeChanged()
+{
+    uint64_t taken = changed;
+    changed = 0;
+    return taken;
+}
+
+void TelemetryHub::encodeJson()
+{
+    JsonStreamWriter writer(json, sizeof(json));
+    writer.beginObject();
+    writer.key("seq");
+    writer.value(sequence);
+    writer.key("ts");
+    writer.value(timestamp);
+    writer.key("pages");
+    writer.value(values.pageMask);
+    writer.key("values");
+    writer.beginObject();
+    for (size_t i = 0; i < DSE_CHANNEL_COUNT; i++)
+    {
+        if (!dseChannelValid(DSE_CHANNELS[i], values.pageMask))
+            continue;
+        writer.key(DSE_CHANNELS[i].name);
+        writer.rawValue(text[i], strlen(text[i]));
+    }
+    writer.endObject();
+    writer.endObject();
+
+    if (writer.overflowed())
+    {
+        LOG_WARN(TAG, "Snapshot exceeds TELEMETRY_JSON_SIZE");
+        jsonLength = 0;
+        json[0] = '\0';
+        return;
+    }
+    jsonLength = writer.length();
+}
+
+size_t TelemetryHub::copyJson(char *out, size_t size, uint32_t *copiedSequence) const
+{
+    if (xSemaphoreTake(valuesMutex, pdMS_TO_TICKS(100)) != pdTRUE)
+        return 0;
+
+    size_t length = jsonLength < size ? jsonLength : 0;
+    memcpy(out, json, length);
+    if (copiedSequence)
+        *copiedSequence = sequence;
+    xSemaphoreGive(valuesMutex);
+    return length;
+}
+
+bool TelemetryHub::getValues(DSEValues &out) const
+{
+    if (xSemaphoreTake(valuesMutex, pdMS_TO_TICKS(100)) != pdTRUE)
+        return false;
+
+    out = values;
+    xSemaphoreGive(valuesMutex);
+    return out.pageMask != 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+#ifndef __TELEMETRYHUB_H__
+#define __TELEMETRYHUB_H__
+
+#include <Arduino.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/semphr.h>
+
+#include "definitions.h"
+#include "telemetry/dseChannels.h"
+
+/*
+ * Latest DSE telemetry, decoded and encoded once per Modbus update
+ *
+ * update() runs on the managers task right after new Modbus data arrived. It
+ * decodes every channel once (DSEValues), formats the real value of each
+ * changed channel as text, and writes one JSON object with every valid
+ * channel:
+ *   {"seq":12,"ts":123456,"pages":15,"values":{"oilPressure":412,...}}
+ *
+ * Consumers share that work instead of repeating it: the local MQTT broker
+ * republishes the text and JSON as they are, the web dashboard streams a copy
+ * of the JSON (copyJson()), and the cloud uplink builds its CBOR snapshots from
+ * the decoded values (getValues()); both copies are safe from any task. The
+ * other text/JSON accessors belong to the managers task. An update writes the
+ * text, values and JSON under one mutex hold, or skips all of them.
+ */
+
+class TelemetryHub
+{
+public:
+    TelemetryHub();
+    ~TelemetryHub();
+
+    // Managers task: new Modbus data
+    void update(const DSEData &data);
+
+    // Managers task: the last update
+    uint32_t getSequence() const { return sequence; }       // +1 per update, 0 = none yet
+    uint8_t getPageMask() const { return values.pageMask; }
+    const char *getText(size_t channel) const { return text[channel]; }   // "" on an invalid page
+    const char *getJson() const { return json; }
+    size_t getJsonLength() const { return jsonLength; }
+
+    // Managers task: bit n = DSE_CHANNELS[n] changed or became (in)valid since the last call.
+    // Bits accumulate over updates until taken, so a consumer that skipped a pass misses none.
+    uint64_t takeChanged();
+
+    // Any task: copy of the decoded values; false while no page is valid
+    bool getValues(DSEValues &out) const;
+
+    // Any task: copy of the last JSON object and its sequence; 0 if none yet or it does not fit
+    size_t copyJson(char *out, size_t size, uint32_t *copiedSequence = nullptr) const;
+
+private:
+    void encodeJson();
+
+    DSEValues values;
+    uint64_t changed;                       // Not taken yet by takeChanged()
+    char text[DSE_CHANNEL_COUNT][TELEMETRY_TEXT_LENGTH];
+    char json[TELEMETRY_JSON_SIZE];
+    size_t jsonLength;
+    uint32_t sequence;
+    uint32_t timestamp;
+
+    SemaphoreHandle_t valuesMutex;          // values, json and sequence for other tasks
+};
+
+extern TelemetryHub telemetryHub;
+
+#endif // __TELEMETRYHUB_H__
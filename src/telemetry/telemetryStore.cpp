@@ -0,0 +1,380 @@
+#include "telemetryStore.h"
+#include <esp_rom_crc.h>
+#include "managers/loggingManager.h"
+
+static const char *TAG = "TelemetryStore";
+
+#define TELEMETRY_STORE_CURSOR_MAGIC 0x52534354   // "TCSR"
+
+static bool parseSegmentName(const char *name, uint32_t &segment)
+{
+    char *end = nullptr;
+    segment = strtoul(name, &end, 10);
+    return end != name && segment > 0 && strcmp(end, ".q") == 0;
+}
+
+TelemetryStore::TelemetryStore()
+    : mounted(false), cursor(), oldestSegment(1), writeSegment(1), writeOffset(0), totalSize(0), nextSequence(1),
+      pendingRecordSize(0), pendingRecords(0), pendingSequence(0), commitsSinceSave(0), droppedSegments(0), corruptRecords(0)
+{
+}
+
+void TelemetryStore::buildSegmentPath(char *buffer, size_t bufferSize, uint32_t segment)
+{
+    snprintf(buffer, bufferSize, "%s/%08lu.q", TELEMETRY_STORE_DIRECTORY, (unsigned long)segment);
+}
+
+uint32_t TelemetryStore::recordCrc(uint32_t sequence, const uint8_t *payload, size_t length)
+{
+    uint32_t crc = esp_rom_crc32_le(0, (const uint8_t *)&sequence, sizeof(sequence));
+    return esp_rom_crc32_le(crc, payload, length);
+}
+
+bool TelemetryStore::begin()
+{
+    if (mounted)
+        return true;
+
+    if (!LittleFS.begin(false, "/littlefs", 8, "littlefs"))
+    {
+        LOG_ERROR(TAG, "LittleFS mount failed - offline data will not be kept");
+        return false;
+    }
+    mounted = true;
+
+    if (!LittleFS.exists(TELEMETRY_STORE_DIRECTORY))
+    {
+        LittleFS.mkdir(TELEMETRY_STORE_DIRECTORY);
+    }
+
+    uint32_t lowest = 0;
+    uint32_t highest = 0;
+    File dir = LittleFS.open(TELEMETRY_STORE_DIRECTORY);
+    for (File entry = dir.openNextFile(); entry; entry = dir.openNextFile())
+    {
+        uint32_t segment;
+        if (!parseSegmentName(entry.name(), segment))
+            continue;
+
+        totalSize += entry.size();
+        if (lowest == 0 || segment < lowest)
+            lowest = segment;
+        if (segment > highest)
+            highest = segment;
+    }
+    dir.close();
+
+    File cursorFile = LittleFS.open(TELEMETRY_STORE_CURSOR_FILE, "r");
+    if (!cursorFile || cursorFile.read((uint8_t *)&cursor, sizeof(cursor)) != sizeof(cursor) ||
+        cursor.magic != TELEMETRY_STORE_CURSOR_MAGIC)
+    {
+        cursor = Cursor();
+        cursor.magic = TELEMETRY_STORE_CURSOR_MAGIC;
+    }
+    if (cursorFile)
+        cursorFile.close();
+    cursor.bootCount++;
+
+    uint32_t lastSequence = 0;
+    if (highest == 0)
+    {
+        writeSegment = cursor.segment > 0 ? cursor.segment : 1;
+        oldestSegment = writeSegment;
+        cursor.segment = writeSegment;
+        cursor.offset = 0;
+    }
+    else
+    {
+        oldestSegment = lowest;
+        writeSegment = highest;
+        scanWriteSegment(highest);
+
+        // Sequence numbers continue after the newest stored record
+        for (uint32_t segment = highest; segment >= lowest && lastSequence == 0; segment--)
+        {
+            char path[48];
+            buildSegmentPath(path, sizeof(path), segment);
+            File file = LittleFS.open(path, "r");
+            uint32_t sequence;
+            size_t length;
+            while (file && readRecord(file, sequence, length))
+                lastSequence = sequence;
+            if (file)
+                file.close();
+        }
+
+        if (cursor.segment < oldestSegment || cursor.segment > writeSegment)
+        {
+            cursor.segment = oldestSegment;
+            cursor.offset = 0;
+        }
+    }
+
+    nextSequence = (lastSequence > cursor.ackedSequence ? lastSequence : cursor.ackedSequence) + 1;
+    saveCursor();
+
+    LOG_INFO(TAG, "%lu records pending in %s (%u bytes)",
+             (unsigned long)getPendingCount(), TELEMETRY_STORE_DIRECTORY, (unsigned)totalSize);
+    return true;
+}
+
+// Find the end of the newest segment; after a torn write appending continues in a new one
+void TelemetryStore::scanWriteSegment(uint32_t segment)
+{
+    char path[48];
+    buildSegmentPath(path, sizeof(path), segment);
+    File file = LittleFS.open(path, "r");
+    if (!file)
+    {
+        writeOffset = 0;
+        return;
+    }
+
+    size_t end = 0;
+    uint32_t sequence;
+    size_t length;
+    while (readRecord(file, sequence, length))
+        end += TELEMETRY_STORE_HEADER_SIZE + length;
+
+    size_t size = file.size();
+    file.close();
+
+    if (end < size)
+    {
+        writeSegment = segment + 1;
+        writeOffset = 0;
+    }
+    else
+    {
+        writeOffset = end;
+    }
+}
+
+bool TelemetryStore::readRecord(File &file, uint32_t &sequence, size_t &length)
+{
+    if (file.read(recordBuffer, TELEMETRY_STORE_HEADER_SIZE) != TELEMETRY_STORE_HEADER_SIZE ||
+        recordBuffer[0] != TELEMETRY_STORE_RECORD_MAGIC)
+        return false;
+
+    uint16_t payloadLength;
+    uint32_t crc;
+    memcpy(&payloadLength, recordBuffer + 2, sizeof(payloadLength));
+    memcpy(&sequence, recordBuffer + 4, sizeof(sequence));
+    memcpy(&crc, recordBuffer + 8, sizeof(crc));
+
+    if (payloadLength > TELEMETRY_STORE_RECORD_SIZE ||
+        file.read(recordBuffer + TELEMETRY_STORE_HEADER_SIZE, payloadLength) != payloadLength ||
+        recordCrc(sequence, recordBuffer + TELEMETRY_STORE_HEADER_SIZE, payloadLength) != crc)
+        return false;
+
+    length = payloadLength;
+    return true;
+}
+
+void TelemetryStore::saveCursor()
+{
+    // Write-then-rename so a reset never leaves a half-written cursor
+    static const char *tempPath = TELEMETRY_STORE_CURSOR_FILE ".tmp";
+    File file = LittleFS.open(tempPath, "w");
+    if (!file)
+        return;
+
+    bool written = file.write((const uint8_t *)&cursor, sizeof(cursor)) == sizeof(cursor);
+    file.close();
+    if (written)
+        LittleFS.rename(tempPath, TELEMETRY_STORE_CURSOR_FILE);
+    commitsSinceSave = 0;
+}
+
+// Producer -----------------------------------------------------------------------------
+
+bool TelemetryStore::append(const uint8_t *payload, size_t length)
+{
+    if (!mounted || length == 0 || length > TELEMETRY_STORE_RECORD_SIZE)
+        return false;
+
+    size_t recordSize = TELEMETRY_STORE_HEADER_SIZE + length;
+    if (writeOffset > 0 && writeOffset + recordSize > TELEMETRY_STORE_SEGMENT_SIZE)
+    {
+        writeSegment++;
+        writeOffset = 0;
+    }
+
+    while (totalSize + recordSize > TELEMETRY_STORE_TOTAL_LIMIT && oldestSegment < writeSegment)
+    {
+        dropOldestSegment();
+    }
+
+    uint8_t header[TELEMETRY_STORE_HEADER_SIZE] = {TELEMETRY_STORE_RECORD_MAGIC, 0};
+    uint16_t payloadLength = (uint16_t)length;
+    uint32_t crc = recordCrc(nextSequence, payload, length);
+    memcpy(header + 2, &payloadLength, sizeof(payloadLength));
+    memcpy(header + 4, &nextSequence, sizeof(nextSequence));
+    memcpy(header + 8, &crc, sizeof(crc));
+
+    char path[48];
+    buildSegmentPath(path, sizeof(path), writeSegment);
+    File file = LittleFS.open(path, "a");
+    if (!file)
+        return false;
+
+    bool written = file.write(header, sizeof(header)) == sizeof(header) && file.write(payload, length) == length;
+    file.close();
+
+    if (!written)
+    {
+        // Never append behind a partial record
+        writeSegment++;
+        writeOffset = 0;
+        return false;
+    }
+
+    writeOffset += recordSize;
+    totalSize += recordSize;
+    nextSequence++;
+    return true;
+}
+
+void TelemetryStore::dropOldestSegment()
+{
+    char path[48];
+    buildSegmentPath(path, sizeof(path), oldestSegment);
+    File file = LittleFS.open(path, "r");
+    if (file)
+    {
+        size_t size = file.size();
+        file.close();
+        LittleFS.remove(path);
+        totalSize = totalSize > size ? totalSize - size : 0;
+    }
+    droppedSegments++;
+    oldestSegment++;
+
+    if (cursor.segment < oldestSegment)
+    {
+        // Records of the dropped segment count as acknowledged
+        uint32_t firstSequence = 0;
+        buildSegmentPath(path, sizeof(path), oldestSegment);
+        file = LittleFS.open(path, "r");
+        size_t length;
+        if (!file || !readRecord(file, firstSequence, length))
+            firstSequence = nextSequence;
+        if (file)
+            file.close();
+
+        cursor.segment = oldestSegment;
+        cursor.offset = 0;
+        cursor.ackedSequence = firstSequence - 1;
+        pendingRecordSize = 0;
+        pendingRecords = 0;
+        saveCursor();
+    }
+
+    LOG_WARN(TAG, "Store full - dropped oldest segment");
+}
+
+// Replay -------------------------------------------------------------------------------
+
+size_t TelemetryStore::readNext()
+{
+    if (!mounted)
+        return 0;
+
+    char path[48];
+    for (;;)
+    {
+        if (cursor.segment == writeSegment && cursor.offset >= writeOffset)
+            return 0;
+
+        buildSegmentPath(path, sizeof(path), cursor.segment);
+        File file = LittleFS.open(path, "r");
+        size_t size = file ? file.size() : 0;
+
+        if (cursor.offset >= size)
+        {
+            if (file)
+                file.close();
+            if (cursor.segment >= writeSegment)
+                return 0;
+
+            // Segment fully replayed
+            LittleFS.remove(path);
+            totalSize = totalSize > size ? totalSize - size : 0;
+            cursor.segment++;
+            cursor.offset = 0;
+            oldestSegment = cursor.segment;
+            saveCursor();
+            continue;
+        }
+
+        file.seek(cursor.offset);
+        uint32_t sequence;
+        size_t length;
+        bool valid = readRecord(file, sequence, length);
+        file.close();
+
+        if (!valid)
+        {
+            // Skip the rest of a damaged segment
+            corruptRecords++;
+            if (cursor.segment == writeSegment)
+            {
+                writeSegment++;
+                writeOffset = 0;
+            }
+            cursor.offset = size;
+            continue;
+        }
+
+        pendingRecordSize = TELEMETRY_STORE_HEADER_SIZE + length;
+        pendingRecords = 1;
+        pendingSequence = sequence;
+        return length;
+    }
+}
+
+size_t TelemetryStore::readFollowing(size_t maxLength)
+{
+    if (!mounted || pendingRecordSize == 0)
+        return 0;
+
+    // Segment ends and damaged records are left to readNext() once they come first
+    size_t offset = cursor.offset + pendingRecordSize;
+    if (cursor.segment == writeSegment && offset >= writeOffset)
+        return 0;
+
+    char path[48];
+    buildSegmentPath(path, sizeof(path), cursor.segment);
+    File file = LittleFS.open(path, "r");
+    if (!file)
+        return 0;
+
+    uint32_t sequence;
+    size_t length = 0;
+    bool valid = offset < file.size() && file.seek(offset) && readRecord(file, sequence, length);
+    file.close();
+    if (!valid || length > maxLength)
+        return 0;
+
+    pendingRecordSize += TELEMETRY_STORE_HEADER_SIZE + length;
+    pendingRecords++;
+    pendingSequence = sequence;
+    return length;
+}
+
+void TelemetryStore::commit()
+{
+    if (pendingRecordSize == 0)
+        return;
+
+    cursor.offset += pendingRecordSize;
+    cursor.ackedSequence = pendingSequence;
+    commitsSinceSave += pendingRecords;
+    pendingRecordSize = 0;
+    pendingRecords = 0;
+
+    if (commitsSinceSave >= TELEMETRY_STORE_CURSOR_SAVE_RECORDS || getPendingCount() == 0)
+    {
+        saveCursor();
+    }
+}
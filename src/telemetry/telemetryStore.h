@@ -0,0 +1,98 @@
+#pragma once
+#ifndef __TELEMETRYSTORE_H__
+#define __TELEMETRYSTORE_H__
+
+#include <Arduino.h>
+#include <LittleFS.h>
+
+#include "definitions.h"
+
+/*
+ * Flash-backed store-and-forward queue
+ *
+ * Payloads produced while offline are appended to segment files
+ * TELEMETRY_STORE_DIRECTORY/<segment>.q as records:
+ *   [magic:1][reserved:1][length:2][sequence:4][crc32:4][payload...]
+ * (little endian, CRC over sequence and payload). Sequence numbers increase by
+ * one per record and continue after a reboot; if the tail of the newest segment
+ * was damaged they may restart lower, so payloads also carry getBootCount().
+ *
+ * The replay cursor (segment, offset, last acknowledged sequence) is saved to
+ * TELEMETRY_STORE_CURSOR_FILE by the commit() that reaches
+ * TELEMETRY_STORE_CURSOR_SAVE_RECORDS records, so after a reboot replay resumes
+ * there; at most that many records (plus the rest of a multi-record commit) are
+ * sent twice and receivers drop them by (boot count, sequence).
+ *
+ * Fully replayed segments are deleted. Above TELEMETRY_STORE_TOTAL_LIMIT the
+ * oldest segment is dropped. A torn or corrupt record ends its segment.
+ */
+
+#define TELEMETRY_STORE_RECORD_MAGIC 0xA7
+#define TELEMETRY_STORE_HEADER_SIZE 12
+
+class TelemetryStore
+{
+public:
+    TelemetryStore();
+
+    bool begin();
+    bool isReady() const { return mounted; }
+
+    // Producer: the payload should carry getNextSequence() so receivers can deduplicate
+    bool append(const uint8_t *payload, size_t length);
+    uint32_t getNextSequence() const { return nextSequence; }
+    uint32_t getBootCount() const { return cursor.bootCount; }
+
+    // Replay: read the oldest unacknowledged record, then commit() once it was published
+    size_t readNext();
+    const uint8_t *getPayload() const { return recordBuffer + TELEMETRY_STORE_HEADER_SIZE; }
+    void commit();
+
+    // Read the record after the ones read since readNext() so that one commit() covers
+    // them all. Stays within the segment; returns 0 (reading nothing) at its end or if
+    // the record is longer than maxLength, in which case getPayload() no longer holds the
+    // last record returned. readNext() goes back to the oldest record alone.
+    size_t readFollowing(size_t maxLength);
+
+    uint32_t getPendingCount() const { return nextSequence - 1 - cursor.ackedSequence; }
+    size_t getTotalSize() const { return totalSize; }
+    uint32_t getDroppedSegments() const { return droppedSegments; }
+    uint32_t getCorruptRecords() const { return corruptRecords; }
+
+private:
+    struct Cursor
+    {
+        uint32_t magic;
+        uint32_t segment;
+        uint32_t offset;
+        uint32_t ackedSequence;
+        uint32_t bootCount;
+    };
+
+    static void buildSegmentPath(char *buffer, size_t bufferSize, uint32_t segment);
+    static uint32_t recordCrc(uint32_t sequence, const uint8_t *payload, size_t length);
+    bool readRecord(File &file, uint32_t &sequence, size_t &length);
+    void scanWriteSegment(uint32_t segment);
+    void dropOldestSegment();
+    void saveCursor();
+
+    bool mounted;
+    Cursor cursor;
+    uint32_t oldestSegment;
+    uint32_t writeSegment;
+    size_t writeOffset;
+    size_t totalSize;
+    uint32_t nextSequence;
+
+    // Record handed out by readNext()
+    uint8_t recordBuffer[TELEMETRY_STORE_HEADER_SIZE + TELEMETRY_STORE_RECORD_SIZE];
+    size_t pendingRecordSize;       // All records read since readNext()
+    uint16_t pendingRecords;
+    uint32_t pendingSequence;       // Last of them
+    uint16_t commitsSinceSave;
+
+    uint32_t droppedSegments;
+    uint32_t corruptRecords;
+};
+
+#endif // __TELEMETRYSTORE_H__
@@ -0,0 +1,57 @@
+#include "uplinkCompressor.h"
+
+// The JSON TagoIOService sends on the data topic, least frequent first: the end of the
+// dictionary stays in the window longest. Keep in sync with DICTIONARY in scripts/uplinkdecode.py.
+const char UPLINK_DICTIONARY[] =
+    // publishDeviceStatus(): "connected" once per session, "online" every keep-alive
+    "{\"variable\":\"device_status\",\"value\":\"connected\",\"timestamp\":"
+    ",\"metadata\":{\"device\":\"" DEVICE_NAME "\",\"source\":\"TagoIOService\"}}"
+    // TagoIOBatch item of processBackfill()
+    "[{\"variable\":\"backfill_recovery_s\",\"value\":,\"unit\":\"s\",\"timestamp\":"
+    "{\"variable\":\"device_status\",\"value\":\"online\",\"timestamp\":";
+
+const size_t UPLINK_DICTIONARY_LENGTH = sizeof(UPLINK_DICTIONARY) - 1;
+
+static_assert(sizeof(UPLINK_DICTIONARY) - 1 <= UPLINK_DICTIONARY_SIZE, "UPLINK_DICTIONARY_SIZE too small");
+static_assert(sizeof(UPLINK_DICTIONARY) - 1 <= LZSS_WINDOW_SIZE, "dictionary must fit the LZSS window");
+static_assert(LZSS_FRAME_SIZE >= LZSS_WINDOW_SIZE, "later frames take a whole window of history from the payload");
+
+UplinkCompressor::UplinkCompressor()
+    : lastMicros(0)
+{
+    memcpy(work, UPLINK_DICTIONARY, UPLINK_DICTIONARY_LENGTH);
+}
+
+size_t UplinkCompressor::compress(const uint8_t *payload, size_t length, size_t maxSize)
+{
+    uint32_t start = micros();
+    lastMicros = 0;
+    if (length == 0)
+        return 0;
+
+    // Output at least a byte smaller than the input, or not worth sending compressed
+    size_t limit = length - 1 < maxSize ? length - 1 : maxSize;
+    if (limit > sizeof(output))
+        limit = sizeof(output);
+    size_t outPos = 0;
+
+    // First frame: the dictionary is its history
+    size_t frameLength = length < LZSS_FRAME_SIZE ? length : LZSS_FRAME_SIZE;
+    memcpy(work + UPLINK_DICTIONARY_LENGTH, payload, frameLength);
+    size_t written = encoder.compressFrame(work, UPLINK_DICTIONARY_LENGTH, UPLINK_DICTIONARY_LENGTH + frameLength,
+                                           output, limit);
+
+    // Later frames: the previous frame (a whole window) is their history
+    for (size_t pos = frameLength; written > 0 && pos < length; pos += frameLength)
+    {
+        outPos += written;
+        frameLength = length - pos < LZSS_FRAME_SIZE ? length - pos : LZSS_FRAME_SIZE;
+        written = encoder.compressFrame(payload + pos - LZSS_WINDOW_SIZE, LZSS_WINDOW_SIZE,
+                                        LZSS_WINDOW_SIZE + frameLength, output + outPos, limit - outPos);
+    }
+
+    lastMicros = micros() - start;
+    if (written == 0)
+        return 0;
+    return outPos + written;
+}
@@ -0,0 +1,60 @@
+#pragma once
+#ifndef __UPLINKCOMPRESSOR_H__
+#define __UPLINKCOMPRESSOR_H__
+
+#include <Arduino.h>
+
+#include "definitions.h"
+#include "utils/lzss.h"
+
+/*
+ * LZSS compression of uplink payloads with a preset dictionary
+ *
+ * Two kinds of payload are compressed (see TagoIOService):
+ *   - backfill blocks: consecutive standalone CBOR keyframes from the
+ *     store-and-forward queue, concatenated. One keyframe has little internal
+ *     redundancy, but each repeats the layout and most values of the previous
+ *     one, so the block compresses well without any dictionary.
+ *   - data topic JSON (device status, the backfill_recovery_s batch): short
+ *     documents that LZSS finds little in on their own, so every payload is
+ *     compressed as if it followed UPLINK_DICTIONARY, their fixed layout, which
+ *     the receiver primes its window with as well.
+ * The output is a regular framed LZSS stream (see utils/lzss.h);
+ * scripts/uplinkdecode.py decodes it and carries the same dictionary.
+ * python scripts/hostcheck.py uplinkCompressor reports the gain on both.
+ *
+ * Memory is fixed: the constructor copies the dictionary into the working
+ * buffer, which then holds the first frame after it (later frames are
+ * compressed in place with the previous frame as history); the output buffer
+ * is sized for the largest payload. compress() gives up as soon as the output
+ * would not be smaller than the input (or maxSize), so incompressible payloads
+ * cost little CPU and are sent as they are.
+ *
+ * The dictionary is part of the wire format: change it only together with the
+ * receiver, on new topics.
+ */
+
+extern const char UPLINK_DICTIONARY[];
+extern const size_t UPLINK_DICTIONARY_LENGTH;
+
+class UplinkCompressor
+{
+public:
+    UplinkCompressor();
+
+    // Compress into the internal buffer; returns the compressed size, or 0 if it would
+    // exceed maxSize or not get smaller (send the payload uncompressed)
+    size_t compress(const uint8_t *payload, size_t length, size_t maxSize = UPLINK_COMPRESSED_SIZE);
+    const uint8_t *getBuffer() const { return output; }
+
+    // Time taken by the last compress() call
+    uint32_t getLastMicros() const { return lastMicros; }
+
+private:
+    LzssEncoder encoder;
+    uint8_t work[UPLINK_DICTIONARY_SIZE + LZSS_FRAME_SIZE];    // Dictionary, then the first frame
+    uint8_t output[UPLINK_COMPRESSED_SIZE];
+    uint32_t lastMicros;
+};
+
+#endif // __UPLINKCOMPRESSOR_H__
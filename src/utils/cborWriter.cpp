@@ -0,0 +1,137 @@
+#include "cborWriter.h"
+
+// Major types
+static const uint8_t CBOR_UNSIGNED = 0;
+static const uint8_t CBOR_NEGATIVE = 1;
+static const uint8_t CBOR_BYTES = 2;
+static const uint8_t CBOR_TEXT = 3;
+static const uint8_t CBOR_ARRAY = 4;
+static const uint8_t CBOR_MAP = 5;
+static const uint8_t CBOR_SIMPLE = 7;
+
+CborWriter::CborWriter(uint8_t *buffer, size_t bufferSize)
+    : buffer(buffer), bufferSize(bufferSize)
+{
+    reset();
+}
+
+void CborWriter::reset()
+{
+    pos = 0;
+    overflow = false;
+}
+
+void CborWriter::append(const uint8_t *data, size_t length)
+{
+    if (overflow || pos + length > bufferSize)
+    {
+        overflow = true;
+        return;
+    }
+    memcpy(buffer + pos, data, length);
+    pos += length;
+}
+
+// Initial byte plus the argument in the shortest big-endian form
+void CborWriter::head(uint8_t majorType, uint64_t argument)
+{
+    uint8_t bytes[9];
+    size_t length;
+    majorType <<= 5;
+
+    if (argument < 24)
+    {
+        bytes[0] = majorType | (uint8_t)argument;
+        length = 1;
+    }
+    else if (argument <= 0xFF)
+    {
+        bytes[0] = majorType | 24;
+        bytes[1] = (uint8_t)argument;
+        length = 2;
+    }
+    else if (argument <= 0xFFFF)
+    {
+        bytes[0] = majorType | 25;
+        bytes[1] = (uint8_t)(argument >> 8);
+        bytes[2] = (uint8_t)argument;
+        length = 3;
+    }
+    else if (argument <= 0xFFFFFFFFull)
+    {
+        bytes[0] = majorType | 26;
+        for (int i = 0; i < 4; i++)
+            bytes[1 + i] = (uint8_t)(argument >> (24 - 8 * i));
+        length = 5;
+    }
+    else
+    {
+        bytes[0] = majorType | 27;
+        for (int i = 0; i < 8; i++)
+            bytes[1 + i] = (uint8_t)(argument >> (56 - 8 * i));
+        length = 9;
+    }
+
+    append(bytes, length);
+}
+
+void CborWriter::beginMap(size_t pairs)
+{
+    head(CBOR_MAP, pairs);
+}
+
+void CborWriter::beginArray(size_t items)
+{
+    head(CBOR_ARRAY, items);
+}
+
+void CborWriter::value(const char *text)
+{
+    value(text ? text : "", text ? strlen(text) : 0);
+}
+
+void CborWriter::value(const char *text, size_t length)
+{
+    head(CBOR_TEXT, length);
+    append((const uint8_t *)text, length);
+}
+
+void CborWriter::value(bool flag)
+{
+    uint8_t byte = (CBOR_SIMPLE << 5) | (flag ? 21 : 20);
+    append(&byte, 1);
+}
+
+void CborWriter::value(float number)
+{
+    uint32_t raw;
+    memcpy(&raw, &number, sizeof(raw));
+    uint8_t bytes[5] = {(uint8_t)((CBOR_SIMPLE << 5) | 26), (uint8_t)(raw >> 24), (uint8_t)(raw >> 16),
+                        (uint8_t)(raw >> 8), (uint8_t)raw};
+    append(bytes, sizeof(bytes));
+}
+
+void CborWriter::valueBytes(const uint8_t *data, size_t length)
+{
+    head(CBOR_BYTES, length);
+    append(data, length);
+}
+
+void CborWriter::valueNull()
+{
+    uint8_t byte = (CBOR_SIMPLE << 5) | 22;
+    append(&byte, 1);
+}
+
+void CborWriter::valueSigned(int64_t number)
+{
+    if (number >= 0)
+        head(CBOR_UNSIGNED, (uint64_t)number);
+    else
+        head(CBOR_NEGATIVE, (uint64_t)(-1 - number));
+}
+
+void CborWriter::valueUnsigned(uint64_t number)
+{
+    head(CBOR_UNSIGNED, number);
+}
@@ -0,0 +1,67 @@
+#pragma once
+#ifndef __CBORWRITER_H__
+#define __CBORWRITER_H__
+
+#include <Arduino.h>
+#include <type_traits>
+
+/*
+ * Minimal CBOR (RFC 8949) encoder into a caller-owned buffer
+ *
+ * Only definite-length maps and arrays are written, so the element count is
+ * passed up front. Integers use the shortest head (1, 2, 3, 5 or 9 bytes),
+ * which makes small values and deltas as cheap as a varint. If the buffer runs
+ * out the writer stops appending and overflowed() reports it.
+ *
+ *   CborWriter cbor(buffer, sizeof(buffer));
+ *   cbor.beginMap(2);
+ *   cbor.value(0);  cbor.value(1);
+ *   cbor.value(1);  cbor.value("DL1000");
+ */
+
+class CborWriter
+{
+public:
+    CborWriter(uint8_t *buffer, size_t bufferSize);
+
+    void beginMap(size_t pairs);
+    void beginArray(size_t items);
+
+    void value(const char *text);
+    void value(const char *text, size_t length);
+    void value(bool flag);
+    void value(float number);
+    void valueBytes(const uint8_t *data, size_t length);
+    void valueNull();
+
+    // Any integral type (int32_t is long on the ESP32 toolchain, so no fixed overload set)
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type value(T number)
+    {
+        if (std::is_signed<T>::value)
+            valueSigned((int64_t)number);
+        else
+            valueUnsigned((uint64_t)number);
+    }
+
+    void valueSigned(int64_t number);
+    void valueUnsigned(uint64_t number);
+
+    size_t length() const { return pos; }
+    bool overflowed() const { return overflow; }
+    const uint8_t *data() const { return buffer; }
+
+    // Start over at the beginning of the buffer
+    void reset();
+
+private:
+    void head(uint8_t majorType, uint64_t argument);
+    void append(const uint8_t *data, size_t length);
+
+    uint8_t *buffer;
+    size_t bufferSize;
+    size_t pos;
+    bool overflow;
+};
+
+#endif // __CBORWRITER_H__
@@ -0,0 +1,210 @@
+#include "jsonStreamWriter.h"
+#include <math.h>
+
+JsonStreamWriter::JsonStreamWriter(char *buffer, size_t bufferSize)
+    : buffer(buffer), bufferSize(bufferSize)
+{
+    reset();
+}
+
+void JsonStreamWriter::reset()
+{
+    pos = 0;
+    overflow = bufferSize == 0;
+    depth = 0;
+    needsComma = 0;
+    afterKey = false;
+    if (bufferSize > 0)
+        buffer[0] = '\0';
+}
+
+void JsonStreamWriter::append(char c)
+{
+    if (pos + 1 >= bufferSize)
+    {
+        overflow = true;
+        return;
+    }
+    buffer[pos++] = c;
+    buffer[pos] = '\0';
+}
+
+void JsonStreamWriter::append(const char *text, size_t length)
+{
+    if (pos + length >= bufferSize)
+    {
+        overflow = true;
+        length = bufferSize > pos + 1 ? bufferSize - pos - 1 : 0;
+    }
+    memcpy(buffer + pos, text, length);
+    pos += length;
+    if (bufferSize > 0)
+        buffer[pos] = '\0';
+}
+
+void JsonStreamWriter::appendNumber(const char *format, ...)
+{
+    char number[32];
+    va_list args;
+    va_start(args, format);
+    int written = vsnprintf(number, sizeof(number), format, args);
+    va_end(args);
+    if (written > 0)
+        append(number, (size_t)written < sizeof(number) ? (size_t)written : sizeof(number) - 1);
+}
+
+void JsonStreamWriter::appendEscaped(const char *text, size_t length)
+{
+    for (size_t i = 0; i < length && !overflow; i++)
+    {
+        char c = text[i];
+        switch (c)
+        {
+        case '"':
+            append("\\\"", 2);
+            break;
+        case '\\':
+            append("\\\\", 2);
+            break;
+        case '\n':
+            append("\\n", 2);
+            break;
+        case '\r':
+            append("\\r", 2);
+            break;
+        case '\t':
+            append("\\t", 2);
+            break;
+        default:
+            if ((uint8_t)c < 0x20)
+                appendNumber("\\u%04x", (unsigned)(uint8_t)c);
+            else
+                append(c);
+            break;
+        }
+    }
+}
+
+// Emit the comma between siblings; a value directly after a key needs none
+void JsonStreamWriter::separator()
+{
+    if (afterKey)
+    {
+        afterKey = false;
+        return;
+    }
+    if (needsComma & levelBit())
+        append(',');
+    needsComma |= levelBit();
+}
+
+void JsonStreamWriter::beginObject()
+{
+    separator();
+    append('{');
+    depth++;
+    needsComma &= ~levelBit();
+}
+
+void JsonStreamWriter::endObject()
+{
+    if (depth > 0)
+        depth--;
+    append('}');
+}
+
+void JsonStreamWriter::beginArray()
+{
+    separator();
+    append('[');
+    depth++;
+    needsComma &= ~levelBit();
+}
+
+void JsonStreamWriter::endArray()
+{
+    if (depth > 0)
+        depth--;
+    append(']');
+}
+
+void JsonStreamWriter::key(const char *name)
+{
+    separator();
+    append('"');
+    appendEscaped(name, strlen(name));
+    append("\":", 2);
+    afterKey = true;
+}
+
+void JsonStreamWriter::value(const char *text)
+{
+    value(text ? text : "", text ? strlen(text) : 0);
+}
+
+void JsonStreamWriter::value(const char *text, size_t length)
+{
+    separator();
+    append('"');
+    appendEscaped(text, length);
+    append('"');
+}
+
+void JsonStreamWriter::value(bool flag)
+{
+    separator();
+    if (flag)
+        append("true", 4);
+    else
+        append("false", 5);
+}
+
+void JsonStreamWriter::valueSigned(int64_t number)
+{
+    separator();
+    appendNumber("%lld", (long long)number);
+}
+
+void JsonStreamWriter::valueUnsigned(uint64_t number)
+{
+    separator();
+    appendNumber("%llu", (unsigned long long)number);
+}
+
+void JsonStreamWriter::value(double number, int8_t decimals)
+{
+    // JSON has no NaN/Infinity
+    if (isnan(number) || isinf(number))
+    {
+        valueNull();
+        return;
+    }
+    separator();
+    if (decimals < 0)
+        appendNumber("%.9g", number);
+    else
+        appendNumber("%.*f", (int)decimals, number);
+}
+
+void JsonStreamWriter::value(float number)
+{
+    if (isnan(number) || isinf(number))
+    {
+        valueNull();
+        return;
+    }
+    separator();
+    appendNumber("%.7g", (double)number);
+}
+
+void JsonStreamWriter::valueNull()
+{
+    separator();
+    append("null", 4);
+}
+
+void JsonStreamWriter::rawValue(const char *json, size_t length)
+{
+    separator();
+    append(json, length);
+}
@@ -0,0 +1,84 @@
+#pragma once
+#ifndef __JSONSTREAMWRITER_H__
+#define __JSONSTREAMWRITER_H__
+
+#include <Arduino.h>
+#include <type_traits>
+
+/*
+ * Streaming JSON encoder into a caller-owned buffer
+ *
+ * No heap, no document tree: values are appended as they are written and
+ * commas are tracked per nesting level. If the buffer runs out the writer
+ * stops appending and overflowed() reports it; the output is then truncated
+ * and must be discarded.
+ *
+ *   JsonStreamWriter json(buffer, sizeof(buffer));
+ *   json.beginObject();
+ *   json.key("ts");    json.value(1234UL);
+ *   json.key("tag");   json.value("Modbus");
+ *   json.endObject();
+ */
+
+#define JSON_WRITER_MAX_DEPTH 8
+
+class JsonStreamWriter
+{
+public:
+    JsonStreamWriter(char *buffer, size_t bufferSize);
+
+    void beginObject();
+    void endObject();
+    void beginArray();
+    void endArray();
+    void key(const char *name);
+
+    void value(const char *text);
+    void value(const char *text, size_t length);
+    void value(bool flag);
+    void value(double number, int8_t decimals = -1);   // -1: shortest form (up to 9 significant digits)
+    void value(float number);                          // Up to 7 significant digits (float precision)
+    void valueNull();
+
+    // Any integral type (int32_t is long on the ESP32 toolchain, so no fixed overload set)
+    template <typename T>
+    typename std::enable_if<std::is_integral<T>::value && !std::is_same<T, bool>::value>::type value(T number)
+    {
+        if (std::is_signed<T>::value)
+            valueSigned((int64_t)number);
+        else
+            valueUnsigned((uint64_t)number);
+    }
+
+    // Append pre-encoded JSON as the next value
+    void rawValue(const char *json, size_t length);
+
+    // Append text to the output with JSON string escaping (no quotes)
+    void appendEscaped(const char *text, size_t length);
+
+    size_t length() const { return pos; }
+    bool overflowed() const { return overflow; }
+    const char *c_str() const { return buffer; }
+
+    // Start over at the beginning of the buffer
+    void reset();
+
+private:
+    void separator();
+    uint8_t levelBit() const { return 1 << (depth < JSON_WRITER_MAX_DEPTH ? depth : JSON_WRITER_MAX_DEPTH - 1); }
+    void append(char c);
+    void append(const char *text, size_t length);
+    void appendNumber(const char *format, ...);
+    void valueSigned(int64_t number);
+    void valueUnsigned(uint64_t number);
+
+    char *buffer;
+    size_t bufferSize;
+    size_t pos;
+    bool overflow;
+    uint8_t depth;
+    uint8_t needsComma;   // Bit per nesting level
+    bool afterKey;
+};
+
+#endif // __JSONSTREAMWRITER_H__
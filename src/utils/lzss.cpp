@@ -0,0 +1,262 @@
+#include "lzss.h"
+
+// LzssEncoder --------------------------------------------------------------------------
+
+LzssEncoder::LzssEncoder()
+{
+    memset(hashTable, 0xFF, sizeof(hashTable));
+}
+
+uint16_t LzssEncoder::hash(const uint8_t *p)
+{
+    uint32_t value = (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16);
+    return (uint16_t)((value * 2654435761u) >> (32 - HASH_BITS));
+}
+
+size_t LzssEncoder::compress(const uint8_t *buffer, size_t historyLength, size_t totalLength, uint8_t *out, size_t outSize)
+{
+    // Positions are stored as uint16_t
+    if (totalLength > 0xFFFE || historyLength > totalLength)
+        return 0;
+
+    memset(hashTable, 0xFF, sizeof(hashTable));
+
+    // Seed the hash table with the reachable part of the history
+    size_t seedStart = historyLength > LZSS_WINDOW_SIZE ? historyLength - LZSS_WINDOW_SIZE : 0;
+    for (size_t i = seedStart; i + LZSS_MIN_MATCH <= historyLength; i++)
+    {
+        hashTable[hash(buffer + i)] = (uint16_t)i;
+    }
+
+    size_t pos = historyLength;
+    size_t outPos = 0;
+
+    while (pos < totalLength)
+    {
+        // Room for a flag byte and eight matches
+        if (outPos + 17 > outSize)
+            return 0;
+
+        size_t flagPos = outPos++;
+        uint8_t flags = 0;
+
+        for (uint8_t bit = 0; bit < 8 && pos < totalLength; bit++)
+        {
+            size_t bestLength = 0;
+            size_t bestOffset = 0;
+
+            if (pos + LZSS_MIN_MATCH <= totalLength)
+            {
+                uint16_t slot = hash(buffer + pos);
+                uint16_t candidate = hashTable[slot];
+                hashTable[slot] = (uint16_t)pos;
+
+                if (candidate != EMPTY_SLOT && candidate < pos && pos - candidate <= LZSS_WINDOW_SIZE)
+                {
+                    size_t maxLength = totalLength - pos;
+                    if (maxLength > LZSS_MAX_MATCH)
+                        maxLength = LZSS_MAX_MATCH;
+
+                    size_t length = 0;
+                    while (length < maxLength && buffer[candidate + length] == buffer[pos + length])
+                        length++;
+
+                    if (length >= LZSS_MIN_MATCH)
+                    {
+                        bestLength = length;
+                        bestOffset = pos - candidate;
+                    }
+                }
+            }
+
+            if (bestLength)
+            {
+                uint16_t offset = (uint16_t)(bestOffset - 1);
+                out[outPos++] = (uint8_t)(((offset >> 8) << 4) | (bestLength - LZSS_MIN_MATCH));
+                out[outPos++] = (uint8_t)(offset & 0xFF);
+                flags |= (uint8_t)(1 << bit);
+
+                // Index the positions covered by the match
+                for (size_t i = 1; i < bestLength && pos + i + LZSS_MIN_MATCH <= totalLength; i++)
+                {
+                    hashTable[hash(buffer + pos + i)] = (uint16_t)(pos + i);
+                }
+                pos += bestLength;
+            }
+            else
+            {
+                out[outPos++] = buffer[pos++];
+            }
+        }
+
+        out[flagPos] = flags;
+    }
+
+    return outPos;
+}
+
+size_t LzssEncoder::compressFrame(const uint8_t *buffer, size_t historyLength, size_t totalLength, uint8_t *out, size_t outSize)
+{
+    size_t rawLength = totalLength - historyLength;
+    if (rawLength > LZSS_FRAME_SIZE || outSize < LZSS_FRAME_HEADER_SIZE)
+        return 0;
+
+    size_t compressed = compress(buffer, historyLength, totalLength, out + LZSS_FRAME_HEADER_SIZE,
+                                 outSize - LZSS_FRAME_HEADER_SIZE);
+    if (compressed == 0 && rawLength > 0)
+        return 0;
+
+    out[0] = (uint8_t)(rawLength & 0xFF);
+    out[1] = (uint8_t)(rawLength >> 8);
+    out[2] = (uint8_t)(compressed & 0xFF);
+    out[3] = (uint8_t)(compressed >> 8);
+    return compressed + LZSS_FRAME_HEADER_SIZE;
+}
+
+// LzssDecoder --------------------------------------------------------------------------
+
+LzssDecoder::LzssDecoder()
+{
+    reset();
+}
+
+void LzssDecoder::reset()
+{
+    windowPos = 0;
+    flushedPos = 0;
+    windowFill = 0;
+    state = STATE_FRAME_HEADER;
+    headerBytes = 0;
+    frameRaw = 0;
+    frameCompressed = 0;
+    flags = 0;
+    flagBit = 0;
+    matchHigh = 0;
+    totalOutput = 0;
+}
+
+void LzssDecoder::setDictionary(const uint8_t *dictionary, size_t length)
+{
+    if (length > LZSS_WINDOW_SIZE)
+    {
+        dictionary += length - LZSS_WINDOW_SIZE;
+        length = LZSS_WINDOW_SIZE;
+    }
+
+    memcpy(window, dictionary, length);
+    windowPos = length % LZSS_WINDOW_SIZE;
+    flushedPos = windowPos;
+    windowFill = length;
+}
+
+bool LzssDecoder::flushWindow(const OutputCallback &output)
+{
+    if (windowPos == flushedPos)
+        return true;
+
+    size_t length = windowPos - flushedPos;
+    bool ok = output(window + flushedPos, length);
+    totalOutput += length;
+    flushedPos = windowPos;
+    return ok;
+}
+
+bool LzssDecoder::emit(uint8_t value, const OutputCallback &output)
+{
+    window[windowPos++] = value;
+    if (windowFill < LZSS_WINDOW_SIZE)
+        windowFill++;
+
+    if (windowPos == LZSS_WINDOW_SIZE)
+    {
+        bool ok = flushWindow(output);
+        windowPos = 0;
+        flushedPos = 0;
+        return ok;
+    }
+    return true;
+}
+
+bool LzssDecoder::feed(const uint8_t *input, size_t length, const OutputCallback &output)
+{
+    for (size_t i = 0; i < length; i++)
+    {
+        uint8_t value = input[i];
+
+        if (state == STATE_FRAME_HEADER)
+        {
+            header[headerBytes++] = value;
+            if (headerBytes == LZSS_FRAME_HEADER_SIZE)
+            {
+                headerBytes = 0;
+                frameRaw = (uint16_t)(header[0] | (header[1] << 8));
+                frameCompressed = (uint16_t)(header[2] | (header[3] << 8));
+                if (frameRaw > LZSS_FRAME_SIZE || (frameCompressed == 0 && frameRaw != 0))
+                    return false;
+                if (frameCompressed > 0)
+                    state = STATE_FLAGS;
+            }
+            continue;
+        }
+
+        frameCompressed--;
+
+        switch (state)
+        {
+        case STATE_FLAGS:
+            flags = value;
+            flagBit = 0;
+            state = STATE_ITEM;
+            break;
+
+        case STATE_ITEM:
+            if (flags & (1 << flagBit))
+            {
+                matchHigh = value;
+                state = STATE_MATCH_LOW;
+            }
+            else
+            {
+                if (frameRaw == 0 || !emit(value, output))
+                    return false;
+                frameRaw--;
+                flagBit++;
+                state = (flagBit == 8) ? STATE_FLAGS : STATE_ITEM;
+            }
+            break;
+
+        case STATE_MATCH_LOW:
+        {
+            size_t offset = ((size_t)(matchHigh >> 4) << 8 | value) + 1;
+            size_t matchLength = (size_t)(matchHigh & 0x0F) + LZSS_MIN_MATCH;
+            if (offset > windowFill || matchLength > frameRaw)
+                return false;
+
+            size_t source = (windowPos + LZSS_WINDOW_SIZE - offset) % LZSS_WINDOW_SIZE;
+            for (size_t n = 0; n < matchLength; n++)
+            {
+                if (!emit(window[source], output))
+                    return false;
+                source = (source + 1) % LZSS_WINDOW_SIZE;
+            }
+            frameRaw -= matchLength;
+            flagBit++;
+            state = (flagBit == 8) ? STATE_FLAGS : STATE_ITEM;
+            break;
+        }
+
+        default:
+            return false;
+        }
+
+        if (frameCompressed == 0)
+        {
+            // Frame complete: a new flag group starts with the next frame
+            if (frameRaw != 0 || state == STATE_MATCH_LOW)
+                return false;
+            state = STATE_FRAME_HEADER;
+        }
+    }
+
+    return flushWindow(output);
+}
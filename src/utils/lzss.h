@@ -0,0 +1,104 @@
+#pragma once
+#ifndef __LZSS_H__
+#define __LZSS_H__
+
+#include <Arduino.h>
+#include <functional>
+
+/*
+ * Small-footprint LZSS codec
+ *
+ * Stream format: a sequence of frames, each [rawLength:2][compressedLength:2]
+ * (little endian) followed by compressedLength bytes of LZSS data. The 4 KB
+ * window carries over between frames, so a stream compresses like one block
+ * while the encoder only ever holds two frames in RAM.
+ *
+ * LZSS data: groups of one flag byte followed by up to 8 items (LSB first).
+ *   flag bit 0 -> literal byte
+ *   flag bit 1 -> match, 2 bytes: [(offset-1) >> 8 << 4 | (length-3)][(offset-1) & 0xFF]
+ *                 offset 1..4096, length 3..18
+ *
+ * scripts/lzss.py implements the same format for host-side tools.
+ */
+
+#define LZSS_WINDOW_SIZE 4096
+#define LZSS_MIN_MATCH 3
+#define LZSS_MAX_MATCH 18
+#define LZSS_FRAME_SIZE 4096                                   // Max raw bytes per frame
+#define LZSS_FRAME_HEADER_SIZE 4
+#define LZSS_MAX_COMPRESSED_SIZE(n) ((n) + ((n) + 7) / 8 + 17)  // Worst case (all literals)
+
+class LzssEncoder
+{
+public:
+    LzssEncoder();
+
+    // Compress buffer[historyLength, totalLength). The bytes before historyLength are the
+    // stream history (previous frame or a preset dictionary) and may be referenced by
+    // matches. Returns the compressed size, or 0 if out is too small.
+    size_t compress(const uint8_t *buffer, size_t historyLength, size_t totalLength, uint8_t *out, size_t outSize);
+
+    // Compress one frame and prepend the frame header. Returns bytes written, 0 on overflow.
+    size_t compressFrame(const uint8_t *buffer, size_t historyLength, size_t totalLength, uint8_t *out, size_t outSize);
+
+private:
+    static const uint16_t HASH_BITS = 10;
+    static const uint16_t HASH_SIZE = 1 << HASH_BITS;
+    static const uint16_t EMPTY_SLOT = 0xFFFF;
+
+    static uint16_t hash(const uint8_t *p);
+
+    uint16_t hashTable[HASH_SIZE];
+};
+
+class LzssDecoder
+{
+public:
+    // Receives decoded bytes; return false to abort decoding
+    typedef std::function<bool(const uint8_t *data, size_t length)> OutputCallback;
+
+    LzssDecoder();
+
+    void reset();
+
+    // Prime the window with a preset dictionary (call after reset, before feeding)
+    void setDictionary(const uint8_t *dictionary, size_t length);
+
+    // Feed any slice of a framed stream. Decoded output is delivered through the callback
+    // in pieces of at most LZSS_WINDOW_SIZE bytes. Returns false on a corrupt stream or when
+    // the callback aborts.
+    bool feed(const uint8_t *input, size_t length, const OutputCallback &output);
+
+    // True when the stream ended on a frame boundary
+    bool isIdle() const { return state == STATE_FRAME_HEADER && headerBytes == 0; }
+    size_t getTotalOutput() const { return totalOutput; }
+
+private:
+    enum State : uint8_t
+    {
+        STATE_FRAME_HEADER,
+        STATE_FLAGS,
+        STATE_ITEM,
+        STATE_MATCH_LOW
+    };
+
+    bool emit(uint8_t value, const OutputCallback &output);
+    bool flushWindow(const OutputCallback &output);
+
+    uint8_t window[LZSS_WINDOW_SIZE];
+    size_t windowPos;          // Next write position in the window
+    size_t flushedPos;         // Start of bytes not yet delivered to the callback
+    size_t windowFill;         // Valid history bytes (saturates at LZSS_WINDOW_SIZE)
+
+    State state;
+    uint8_t header[LZSS_FRAME_HEADER_SIZE];
+    uint8_t headerBytes;
+    uint16_t frameRaw;         // Raw bytes still expected in this frame
+    uint16_t frameCompressed;  // Compressed bytes still expected in this frame
+    uint8_t flags;
+    uint8_t flagBit;
+    uint8_t matchHigh;
+    size_t totalOutput;
+};
+
+#endif // __LZSS_H__
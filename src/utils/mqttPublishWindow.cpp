@@ -0,0 +1,128 @@
+#include "mqttPublishWindow.h"
+
+MQTTPublishWindow::MQTTPublishWindow()
+    : slots(), windowSize(MQTT_PUBLISH_WINDOW_SIZE), inFlight(0), queued(0), nextOrder(0), nextPacketId(1),
+      published(0), acknowledged(0), retransmitted(0), ackTimeTotal(0), peakInFlight(0)
+{
+}
+
+void MQTTPublishWindow::setWindowSize(size_t size)
+{
+    // A window of 1 is plain stop-and-wait
+    windowSize = constrain(size, (size_t)1, (size_t)MQTT_PUBLISH_WINDOW_SLOTS);
+}
+
+bool MQTTPublishWindow::enqueue(const char *topic, const void *payload, size_t length, bool retain)
+{
+    if (!topic || length > MQTT_PUBLISH_WINDOW_PAYLOAD_SIZE || strlen(topic) >= MQTT_PUBLISH_WINDOW_TOPIC_LENGTH)
+        return false;
+
+    for (Slot &slot : slots)
+    {
+        if (slot.state != SLOT_FREE)
+            continue;
+
+        strcpy(slot.topic, topic);
+        memcpy(slot.payload, payload, length);
+        slot.length = (uint16_t)length;
+        slot.retain = retain;
+        slot.duplicate = false;
+        slot.packetId = 0;
+        slot.order = nextOrder++;
+        slot.state = SLOT_QUEUED;
+        queued++;
+        return true;
+    }
+    return false;
+}
+
+MQTTPublishWindow::Slot *MQTTPublishWindow::oldestQueued()
+{
+    Slot *oldest = nullptr;
+    for (Slot &slot : slots)
+    {
+        if (slot.state == SLOT_QUEUED && (!oldest || (int32_t)(slot.order - oldest->order) < 0))
+            oldest = &slot;
+    }
+    return oldest;
+}
+
+uint16_t MQTTPublishWindow::allocatePacketId()
+{
+    // Packet IDs are 1..65535 and must not collide with an unacknowledged one
+    for (;;)
+    {
+        uint16_t packetId = nextPacketId++;
+        if (nextPacketId == 0)
+            nextPacketId = 1;
+
+        bool used = false;
+        for (const Slot &slot : slots)
+        {
+            if (slot.state != SLOT_FREE && slot.packetId == packetId)
+            {
+                used = true;
+                break;
+            }
+        }
+        if (!used)
+            return packetId;
+    }
+}
+
+void MQTTPublishWindow::service(const Sender &sender)
+{
+    while (inFlight < windowSize)
+    {
+        Slot *slot = oldestQueued();
+        if (!slot)
+            return;
+
+        if (slot->packetId == 0)
+            slot->packetId = allocatePacketId();
+
+        if (!sender(slot->topic, slot->payload, slot->length, slot->retain, slot->packetId, slot->duplicate))
+            return;
+
+        if (slot->duplicate)
+            retransmitted++;
+        else
+            published++;
+
+        slot->state = SLOT_IN_FLIGHT;
+        slot->sentAt = millis();
+        queued--;
+        inFlight++;
+        if (inFlight > peakInFlight)
+            peakInFlight = inFlight;
+    }
+}
+
+void MQTTPublishWindow::acknowledge(uint16_t packetId)
+{
+    for (Slot &slot : slots)
+    {
+        if (slot.state == SLOT_IN_FLIGHT && slot.packetId == packetId)
+        {
+            ackTimeTotal += millis() - slot.sentAt;
+            acknowledged++;
+            slot.state = SLOT_FREE;
+            inFlight--;
+            return;
+        }
+    }
+}
+
+void MQTTPublishWindow::sessionRestarted()
+{
+    for (Slot &slot : slots)
+    {
+        if (slot.state == SLOT_IN_FLIGHT)
+        {
+            slot.state = SLOT_QUEUED;
+            slot.duplicate = true;
+            inFlight--;
+            queued++;
+        }
+    }
+}
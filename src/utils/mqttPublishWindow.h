@@ -0,0 +1,98 @@
+#pragma once
+#ifndef __MQTTPUBLISHWINDOW_H__
+#define __MQTTPUBLISHWINDOW_H__
+
+#include <Arduino.h>
+#include <functional>
+
+#include "definitions.h"
+
+/*
+ * QoS1 in-flight window
+ *
+ * Messages are copied into one of MQTT_PUBLISH_WINDOW_SLOTS fixed slots and
+ * sent by service() with their own packet ID, up to the window size without
+ * waiting for a PUBACK in between, so throughput is no longer one message per
+ * broker round trip. acknowledge() frees the slot of a PUBACK'd packet ID.
+ *
+ * After a reconnect, sessionRestarted() requeues every unacknowledged message
+ * for retransmission with the same packet ID (MQTT 3.1.1 section 4.4), so
+ * delivery is at least once. Messages go out in enqueue order, which puts
+ * retransmissions first.
+ *
+ * Not thread safe: enqueue, service and acknowledge run on the task that owns
+ * the MQTT client.
+ */
+
+class MQTTPublishWindow
+{
+public:
+    // Writes one PUBLISH; returns false if the client could not send it
+    typedef std::function<bool(const char *topic, const uint8_t *payload, size_t length, bool retain,
+                               uint16_t packetId, bool duplicate)>
+        Sender;
+
+    MQTTPublishWindow();
+
+    void setWindowSize(size_t size);
+    size_t getWindowSize() const { return windowSize; }
+
+    // Copy a message into a free slot; false if all slots are taken or it is too large
+    bool enqueue(const char *topic, const void *payload, size_t length, bool retain = false);
+
+    // Send queued messages while fewer than the window size are unacknowledged
+    void service(const Sender &sender);
+
+    void acknowledge(uint16_t packetId);
+    void sessionRestarted();
+
+    size_t getInFlight() const { return inFlight; }
+    size_t getQueued() const { return queued; }
+    size_t getFreeSlots() const { return MQTT_PUBLISH_WINDOW_SLOTS - inFlight - queued; }
+
+    // Statistics since boot
+    uint32_t getPublished() const { return published; }
+    uint32_t getAcknowledged() const { return acknowledged; }
+    uint32_t getRetransmitted() const { return retransmitted; }
+    uint32_t getAverageAckMs() const { return acknowledged ? (uint32_t)(ackTimeTotal / acknowledged) : 0; }
+    size_t getPeakInFlight() const { return peakInFlight; }
+
+private:
+    enum SlotState : uint8_t
+    {
+        SLOT_FREE = 0,
+        SLOT_QUEUED,
+        SLOT_IN_FLIGHT
+    };
+
+    struct Slot
+    {
+        SlotState state;
+        bool retain;
+        bool duplicate;             // Sent before, awaiting retransmission
+        uint16_t packetId;
+        uint16_t length;
+        uint32_t order;             // Enqueue order
+        uint32_t sentAt;
+        char topic[MQTT_PUBLISH_WINDOW_TOPIC_LENGTH];
+        uint8_t payload[MQTT_PUBLISH_WINDOW_PAYLOAD_SIZE];
+    };
+
+    Slot *oldestQueued();
+    uint16_t allocatePacketId();
+
+    Slot slots[MQTT_PUBLISH_WINDOW_SLOTS];
+    size_t windowSize;
+    size_t inFlight;
+    size_t queued;
+    uint32_t nextOrder;
+    uint16_t nextPacketId;
+
+    uint32_t published;
+    uint32_t acknowledged;
+    uint32_t retransmitted;
+    uint64_t ackTimeTotal;
+    size_t peakInFlight;
+};
+
+#endif // __MQTTPUBLISHWINDOW_H__